@@ -0,0 +1,546 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "csi_capture.h"
+
+#define CAPTURE_ALIGN_UP(n)     (((n) + CSI_CAPTURE_ALIGN - 1) & ~(uint64_t)(CSI_CAPTURE_ALIGN - 1))
+
+/**
+ * @brief Largest value of one column the reader accepts, e.g. a (64,)f8 array
+ */
+#define CAPTURE_MAX_VALUE_SIZE  512
+
+/**
+ * @brief A record as laid out in the column blocks: the timestamp widened to 64 bits
+ */
+typedef struct {
+    csi_capture_record_t record;
+    uint64_t timestamp;
+} capture_row_t;
+
+#define ROW_FIELD(field)        offsetof(capture_row_t, record.field)
+
+static const struct {
+    const char *name;
+    const char *type;
+    uint8_t size;
+    uint8_t offset;
+} s_columns[] = {
+    {"host_time",           "<u8",      8, ROW_FIELD(host_time)},
+    {"timestamp",           "<u8",      8, offsetof(capture_row_t, timestamp)},
+    {"seq",                 "<u4",      4, ROW_FIELD(seq)},
+    {"compensate_gain",     "<f4",      4, ROW_FIELD(compensate_gain)},
+    {"len",                 "<u2",      2, ROW_FIELD(len)},
+    {"sig_len",             "<u2",      2, ROW_FIELD(sig_len)},
+    {"mac",                 "(6,)u1",   6, ROW_FIELD(mac)},
+    {"rssi",                "i1",       1, ROW_FIELD(rssi)},
+    {"noise_floor",         "i1",       1, ROW_FIELD(noise_floor)},
+    {"rate",                "u1",       1, ROW_FIELD(rate)},
+    {"sig_mode",            "u1",       1, ROW_FIELD(sig_mode)},
+    {"mcs",                 "u1",       1, ROW_FIELD(mcs)},
+    {"cwb",                 "u1",       1, ROW_FIELD(cwb)},
+    {"channel",             "u1",       1, ROW_FIELD(channel)},
+    {"secondary_channel",   "u1",       1, ROW_FIELD(secondary_channel)},
+    {"stbc",                "u1",       1, ROW_FIELD(stbc)},
+    {"sgi",                 "u1",       1, ROW_FIELD(sgi)},
+    {"rx_state",            "u1",       1, ROW_FIELD(rx_state)},
+    {"agc_gain",            "u1",       1, ROW_FIELD(agc_gain)},
+    {"fft_gain",            "i1",       1, ROW_FIELD(fft_gain)},
+    {"flags",               "u1",       1, ROW_FIELD(flags)},
+    {"ampdu_cnt",           "u1",       1, ROW_FIELD(ampdu_cnt)},
+    {"rx_misc",             "u1",       1, ROW_FIELD(rx_misc)},
+    {"format",              "u1",       1, ROW_FIELD(format)},
+};
+
+#define CAPTURE_COLUMN_COUNT    (sizeof(s_columns) / sizeof(s_columns[0]))
+
+_Static_assert(CAPTURE_COLUMN_COUNT <= CSI_CAPTURE_MAX_COLUMNS, "too many capture columns");
+
+/**
+ * @brief Add the aligned block of `count` values of `value_size` bytes to `size`
+ *
+ * @return false if the sum does not fit in 64 bits, which only a corrupt file can ask for
+ */
+static bool capture_add_block(uint64_t *size, uint64_t value_size, uint32_t count)
+{
+    if (count && value_size > (UINT64_MAX - CSI_CAPTURE_ALIGN) / count) {
+        return false;
+    }
+
+    uint64_t block = CAPTURE_ALIGN_UP(value_size * count);
+
+    if (block > UINT64_MAX - *size) {
+        return false;
+    }
+
+    *size += block;
+    return true;
+}
+
+/**
+ * @brief Bytes of a chunk of `count` records, header and footer included, 0 if that overflows
+ */
+static uint64_t capture_chunk_size(const uint64_t *column_size, size_t column_count, uint16_t iq_width, uint32_t count)
+{
+    uint64_t size = sizeof(csi_capture_chunk_header_t) + sizeof(csi_capture_chunk_footer_t);
+
+    for (size_t i = 0; i < column_count; i++) {
+        if (!capture_add_block(&size, column_size[i], count)) {
+            return 0;
+        }
+    }
+
+    return capture_add_block(&size, (uint64_t)iq_width * sizeof(int16_t), count) ? size : 0;
+}
+
+static bool capture_write_padded(FILE *fp, const void *data, size_t len)
+{
+    static const uint8_t s_zero[CSI_CAPTURE_ALIGN] = {0};
+    size_t pad = CAPTURE_ALIGN_UP(len) - len;
+
+    return fwrite(data, 1, len, fp) == len && fwrite(s_zero, 1, pad, fp) == pad;
+}
+
+bool csi_capture_writer_open(csi_capture_writer_t *writer, FILE *fp, uint16_t iq_width,
+                             uint32_t chunk_records, uint64_t created)
+{
+    if (!writer || !fp || !iq_width || iq_width > CSI_CAPTURE_MAX_IQ_WIDTH) {
+        return false;
+    }
+
+    csi_capture_file_header_t header = {
+        .version       = CSI_CAPTURE_VERSION,
+        .header_size   = sizeof(csi_capture_file_header_t) + CAPTURE_COLUMN_COUNT * sizeof(csi_capture_column_t),
+        .column_count  = CAPTURE_COLUMN_COUNT,
+        .iq_width      = iq_width,
+        .chunk_records = chunk_records ? chunk_records : CSI_CAPTURE_DEFAULT_CHUNK_RECORDS,
+        .created       = created,
+    };
+    memcpy(header.magic, CSI_CAPTURE_MAGIC, sizeof(header.magic));
+
+    memset(writer, 0, sizeof(csi_capture_writer_t));
+    writer->fp            = fp;
+    writer->iq_width      = iq_width;
+    writer->chunk_records = header.chunk_records;
+
+    size_t row_size = 0;
+
+    for (size_t i = 0; i < CAPTURE_COLUMN_COUNT; i++) {
+        row_size += s_columns[i].size;
+    }
+
+    writer->columns = malloc(row_size * writer->chunk_records);
+    writer->iq = malloc((size_t)iq_width * sizeof(int16_t) * writer->chunk_records);
+
+    if (!writer->columns || !writer->iq) {
+        goto ERR;
+    }
+
+    if (fwrite(&header, sizeof(header), 1, fp) != 1) {
+        goto ERR;
+    }
+
+    for (size_t i = 0; i < CAPTURE_COLUMN_COUNT; i++) {
+        csi_capture_column_t column = {0};
+        strncpy(column.name, s_columns[i].name, sizeof(column.name) - 1);
+        strncpy(column.type, s_columns[i].type, sizeof(column.type) - 1);
+
+        if (fwrite(&column, sizeof(column), 1, fp) != 1) {
+            goto ERR;
+        }
+    }
+
+    writer->offset = header.header_size;
+
+    return true;
+
+ERR:
+    free(writer->columns);
+    free(writer->iq);
+    writer->columns = NULL;
+    writer->iq = NULL;
+    return false;
+}
+
+/**
+ * @brief Write the pending records as one chunk
+ */
+static bool capture_write_chunk(csi_capture_writer_t *writer)
+{
+    uint64_t column_size[CAPTURE_COLUMN_COUNT];
+    uint32_t count = writer->count;
+
+    if (!count) {
+        return true;
+    }
+
+    for (size_t i = 0; i < CAPTURE_COLUMN_COUNT; i++) {
+        column_size[i] = s_columns[i].size;
+    }
+
+    csi_capture_chunk_header_t header = {
+        .count = count,
+        .size  = capture_chunk_size(column_size, CAPTURE_COLUMN_COUNT, writer->iq_width, count),
+    };
+    memcpy(header.magic, CSI_CAPTURE_CHUNK_MAGIC, sizeof(header.magic));
+
+    if (fwrite(&header, sizeof(header), 1, writer->fp) != 1) {
+        return false;
+    }
+
+    const uint8_t *block = writer->columns;
+
+    for (size_t i = 0; i < CAPTURE_COLUMN_COUNT; i++) {
+        if (!capture_write_padded(writer->fp, block, (size_t)s_columns[i].size * count)) {
+            return false;
+        }
+
+        block += (size_t)s_columns[i].size * writer->chunk_records;
+    }
+
+    if (!capture_write_padded(writer->fp, writer->iq, (size_t)writer->iq_width * sizeof(int16_t) * count)) {
+        return false;
+    }
+
+    writer->footer.offset = writer->offset;
+    writer->footer.count  = count;
+    memcpy(writer->footer.magic, CSI_CAPTURE_FOOTER_MAGIC, sizeof(writer->footer.magic));
+
+    if (fwrite(&writer->footer, sizeof(writer->footer), 1, writer->fp) != 1) {
+        return false;
+    }
+
+    writer->offset += header.size;
+    writer->count = 0;
+
+    return true;
+}
+
+bool csi_capture_writer_append(csi_capture_writer_t *writer, const csi_capture_record_t *record,
+                               const int16_t *iq, size_t count)
+{
+    if (writer->count == writer->chunk_records && !capture_write_chunk(writer)) {
+        return false;
+    }
+
+    /**
+     * @brief The rx_ctrl timestamp wraps every 71 minutes; count the elapsed time modulo 2^32
+     *        so the stored timestamps never decrease, even across a device restart
+     */
+    capture_row_t row = {.record = *record};
+
+    writer->timestamp = writer->records ? writer->timestamp + (uint32_t)(record->timestamp - writer->last_timestamp) :
+                        record->timestamp;
+    writer->last_timestamp = record->timestamp;
+    row.timestamp = writer->timestamp;
+
+    uint32_t slot = writer->count;
+    uint8_t *block = writer->columns;
+
+    for (size_t i = 0; i < CAPTURE_COLUMN_COUNT; i++) {
+        memcpy(block + (size_t)slot * s_columns[i].size, (const uint8_t *)&row + s_columns[i].offset, s_columns[i].size);
+        block += (size_t)s_columns[i].size * writer->chunk_records;
+    }
+
+    int16_t *iq_row = writer->iq + (size_t)slot * writer->iq_width;
+    size_t kept = count < writer->iq_width ? count : writer->iq_width;
+
+    memcpy(iq_row, iq, kept * sizeof(int16_t));
+    memset(iq_row + kept, 0, (writer->iq_width - kept) * sizeof(int16_t));
+    writer->truncated += count > writer->iq_width;
+
+    csi_capture_chunk_footer_t *footer = &writer->footer;
+
+    if (!slot) {
+        footer->first_timestamp = row.timestamp;
+        footer->first_host_time = record->host_time;
+        footer->min_seq         = record->seq;
+        footer->max_seq         = record->seq;
+    }
+
+    footer->last_timestamp = row.timestamp;
+    footer->last_host_time = record->host_time;
+    footer->min_seq        = record->seq < footer->min_seq ? record->seq : footer->min_seq;
+    footer->max_seq        = record->seq > footer->max_seq ? record->seq : footer->max_seq;
+
+    writer->count++;
+    writer->records++;
+
+    return true;
+}
+
+bool csi_capture_writer_flush(csi_capture_writer_t *writer)
+{
+    return capture_write_chunk(writer) && !fflush(writer->fp);
+}
+
+bool csi_capture_writer_close(csi_capture_writer_t *writer)
+{
+    bool ret = writer->columns ? csi_capture_writer_flush(writer) : true;
+
+    free(writer->columns);
+    free(writer->iq);
+    writer->columns = NULL;
+    writer->iq = NULL;
+
+    return ret;
+}
+
+size_t csi_capture_column_size(const csi_capture_column_t *column)
+{
+    const char *p = column->type;
+    const char *nul = memchr(column->type, '\0', sizeof(column->type));
+    const char *end = nul ? nul : column->type + sizeof(column->type);
+    size_t count = 1;
+    size_t size = 0;
+
+    if (p < end && *p == '(') {
+        for (count = 0, p++; p < end && *p >= '0' && *p <= '9' && count <= CAPTURE_MAX_VALUE_SIZE; p++) {
+            count = count * 10 + (*p - '0');
+        }
+
+        if (end - p < 2 || p[0] != ',' || p[1] != ')') {
+            return 0;
+        }
+
+        p += 2;
+    }
+
+    if (p < end && (*p == '<' || *p == '|')) {
+        p++;
+    }
+
+    if (p == end || !strchr("iuf", *p)) {
+        return 0;
+    }
+
+    char kind = *p;
+
+    for (p++; p < end && *p >= '0' && *p <= '9' && size <= 8; p++) {
+        size = size * 10 + (*p - '0');
+    }
+
+    /**
+     * @brief Only the sizes NumPy has, so the Python reader maps the same bytes
+     */
+    if (p != end || !(size == 2 || size == 4 || size == 8 || (size == 1 && kind != 'f'))
+            || count > CAPTURE_MAX_VALUE_SIZE / size) {
+        return 0;
+    }
+
+    return count * size;
+}
+
+int csi_capture_reader_column(const csi_capture_reader_t *reader, const char *name)
+{
+    for (int i = 0; i < reader->header.column_count; i++) {
+        if (!strncmp(reader->columns[i].name, name, sizeof(reader->columns[i].name))) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool csi_capture_reader_open(csi_capture_reader_t *reader, const void *data, size_t size)
+{
+    const csi_capture_file_header_t *header = data;
+    uint64_t column_size[CSI_CAPTURE_MAX_COLUMNS];
+    size_t chunk_capacity = 0;
+
+    memset(reader, 0, sizeof(csi_capture_reader_t));
+
+    if (size < sizeof(csi_capture_file_header_t)) {
+        return false;
+    }
+
+    memcpy(&reader->header, header, sizeof(reader->header));
+
+    if (memcmp(reader->header.magic, CSI_CAPTURE_MAGIC, sizeof(reader->header.magic))
+            || reader->header.version != CSI_CAPTURE_VERSION
+            || reader->header.column_count > CSI_CAPTURE_MAX_COLUMNS
+            || !reader->header.iq_width
+            || reader->header.iq_width > CSI_CAPTURE_MAX_IQ_WIDTH
+            || reader->header.header_size % CSI_CAPTURE_ALIGN
+            || reader->header.header_size < sizeof(csi_capture_file_header_t) +
+               reader->header.column_count * sizeof(csi_capture_column_t)
+            || reader->header.header_size > size) {
+        return false;
+    }
+
+    reader->data    = data;
+    reader->size    = size;
+    reader->columns = (const csi_capture_column_t *)(reader->data + sizeof(csi_capture_file_header_t));
+
+    for (size_t i = 0; i < reader->header.column_count; i++) {
+        if (!(column_size[i] = csi_capture_column_size(&reader->columns[i]))) {
+            return false;
+        }
+    }
+
+    for (uint64_t offset = reader->header.header_size; offset < size;) {
+        csi_capture_chunk_header_t chunk_header;
+        csi_capture_chunk_footer_t footer;
+
+        /**
+         * @brief A chunk is only taken once its footer is there and agrees with its header,
+         *        so a file whose writer was killed mid-chunk reads up to the last complete chunk
+         */
+        if (size - offset < sizeof(chunk_header) + sizeof(footer)) {
+            reader->truncated = true;
+            break;
+        }
+
+        memcpy(&chunk_header, reader->data + offset, sizeof(chunk_header));
+
+        /**
+         * @brief The size must be the one computed from the count, without overflow, so every
+         *        block derived from the count below lies inside the chunk
+         */
+        uint64_t chunk_size = capture_chunk_size(column_size, reader->header.column_count,
+                                                 reader->header.iq_width, chunk_header.count);
+
+        if (memcmp(chunk_header.magic, CSI_CAPTURE_CHUNK_MAGIC, sizeof(chunk_header.magic))
+                || !chunk_size || chunk_header.size != chunk_size
+                || chunk_header.size > size - offset) {
+            reader->truncated = true;
+            break;
+        }
+
+        memcpy(&footer, reader->data + offset + chunk_header.size - sizeof(footer), sizeof(footer));
+
+        if (memcmp(footer.magic, CSI_CAPTURE_FOOTER_MAGIC, sizeof(footer.magic))
+                || footer.offset != offset || footer.count != chunk_header.count) {
+            reader->truncated = true;
+            break;
+        }
+
+        if (reader->chunk_count == chunk_capacity) {
+            size_t new_capacity = chunk_capacity ? chunk_capacity * 2 : 64;
+            csi_capture_chunk_t *chunks = realloc(reader->chunks, new_capacity * sizeof(csi_capture_chunk_t));
+
+            if (!chunks) {
+                csi_capture_reader_close(reader);
+                return false;
+            }
+
+            reader->chunks = chunks;
+            chunk_capacity = new_capacity;
+        }
+
+        csi_capture_chunk_t *chunk = &reader->chunks[reader->chunk_count++];
+        uint64_t block = offset + sizeof(chunk_header);
+
+        chunk->index        = footer;
+        chunk->first_record = reader->records;
+
+        for (size_t i = 0; i < reader->header.column_count; i++) {
+            chunk->column_offset[i] = block;
+            block += CAPTURE_ALIGN_UP(column_size[i] * footer.count);
+        }
+
+        chunk->iq_offset = block;
+        reader->records += footer.count;
+        offset += chunk_header.size;
+    }
+
+    return true;
+}
+
+void csi_capture_reader_close(csi_capture_reader_t *reader)
+{
+    free(reader->chunks);
+    reader->chunks = NULL;
+    reader->chunk_count = 0;
+}
+
+static inline uint64_t capture_read_u64(const uint8_t *p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t csi_capture_reader_find_time(const csi_capture_reader_t *reader, bool host_time, uint64_t value)
+{
+    int column = csi_capture_reader_column(reader, host_time ? "host_time" : "timestamp");
+    size_t low = 0;
+    size_t high = reader->chunk_count;
+
+    if (column < 0 || csi_capture_column_size(&reader->columns[column]) != sizeof(uint64_t)) {
+        return reader->records;
+    }
+
+    /**
+     * @brief First chunk that ends at or after `value`, then the first record in it
+     */
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        const csi_capture_chunk_footer_t *index = &reader->chunks[mid].index;
+
+        if ((host_time ? index->last_host_time : index->last_timestamp) < value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low == reader->chunk_count) {
+        return reader->records;
+    }
+
+    const csi_capture_chunk_t *chunk = &reader->chunks[low];
+    const uint8_t *values = reader->data + chunk->column_offset[column];
+    uint32_t first = 0;
+    uint32_t last = chunk->index.count;
+
+    while (first < last) {
+        uint32_t mid = first + (last - first) / 2;
+
+        if (capture_read_u64(values + (size_t)mid * sizeof(uint64_t)) < value) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+
+    return chunk->first_record + first;
+}
+
+uint64_t csi_capture_reader_find_seq(const csi_capture_reader_t *reader, uint32_t seq, uint64_t start)
+{
+    int column = csi_capture_reader_column(reader, "seq");
+
+    if (column < 0 || csi_capture_column_size(&reader->columns[column]) != sizeof(uint32_t)) {
+        return reader->records;
+    }
+
+    for (size_t i = 0; i < reader->chunk_count; i++) {
+        const csi_capture_chunk_t *chunk = &reader->chunks[i];
+
+        if (chunk->first_record + chunk->index.count <= start
+                || seq < chunk->index.min_seq || seq > chunk->index.max_seq) {
+            continue;
+        }
+
+        const uint8_t *values = reader->data + chunk->column_offset[column];
+        uint32_t first = start > chunk->first_record ? (uint32_t)(start - chunk->first_record) : 0;
+
+        for (uint32_t j = first; j < chunk->index.count; j++) {
+            uint32_t value;
+            memcpy(&value, values + (size_t)j * sizeof(uint32_t), sizeof(value));
+
+            if (value == seq) {
+                return chunk->first_record + j;
+            }
+        }
+    }
+
+    return reader->records;
+}
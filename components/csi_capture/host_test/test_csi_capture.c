@@ -0,0 +1,444 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief csi_capture writer and reader on a host:
+ *
+ * - Round trip of records and I/Q rows, find_time() and find_seq().
+ * - A capture cut at every length reads up to its last complete chunk.
+ * - Column types, and captures whose directory or chunk headers are corrupt: huge chunk counts with
+ *   matching sizes, time and seq columns of the wrong width, random byte flips. Every block the reader
+ *   indexes must lie within the file, checked against sizes computed in 128 bits. The buffers are
+ *   allocated to the exact file size, so an address sanitizer build catches any read past them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "csi_capture.h"
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define TEST_RECORDS        50
+#define TEST_CHUNK_RECORDS  16
+#define TEST_IQ_WIDTH       8
+#define FUZZ_ROUNDS         20000
+
+static uint32_t test_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static uint64_t align_up(uint64_t n)
+{
+    return (n + CSI_CAPTURE_ALIGN - 1) & ~(uint64_t)(CSI_CAPTURE_ALIGN - 1);
+}
+
+static uint64_t test_host_time(uint32_t i)
+{
+    return 1700000000000000ull + i * 1000ull;
+}
+
+/**
+ * @brief A capture of `records` records written by csi_capture_writer, copied to a buffer of its exact size
+ */
+static uint8_t *capture_build(uint32_t records, uint32_t chunk_records, size_t *size)
+{
+    csi_capture_writer_t writer;
+    FILE *fp = tmpfile();
+
+    CHECK(fp && csi_capture_writer_open(&writer, fp, TEST_IQ_WIDTH, chunk_records, 42));
+
+    for (uint32_t i = 0; i < records; i++) {
+        csi_capture_record_t record = {
+            .host_time = test_host_time(i),
+            .seq       = i * 3,
+            .timestamp = 0xfffff000u + i * 100,         /**< Wraps halfway through */
+            .len       = TEST_IQ_WIDTH + i % 2,
+            .rssi      = -(int8_t)(i % 90),
+        };
+        int16_t iq[TEST_IQ_WIDTH + 1];
+
+        for (int j = 0; j < TEST_IQ_WIDTH + 1; j++) {
+            iq[j] = (int16_t)(i * 100 + j);
+        }
+
+        CHECK(csi_capture_writer_append(&writer, &record, iq, record.len));
+    }
+
+    CHECK(csi_capture_writer_close(&writer));
+
+    long end = ftell(fp);
+    uint8_t *data = malloc(end);
+
+    CHECK(end > 0 && data);
+    rewind(fp);
+    CHECK(fread(data, 1, end, fp) == (size_t)end);
+    fclose(fp);
+    *size = end;
+
+    return data;
+}
+
+/**
+ * @brief Chunk size in 128 bits, the reference for the overflow checks of the reader
+ */
+static unsigned __int128 ref_chunk_size(const csi_capture_reader_t *reader, uint32_t count)
+{
+    unsigned __int128 size = sizeof(csi_capture_chunk_header_t) + sizeof(csi_capture_chunk_footer_t);
+
+    for (size_t i = 0; i < reader->header.column_count; i++) {
+        unsigned __int128 block = (unsigned __int128)csi_capture_column_size(&reader->columns[i]) * count;
+        size += (block + CSI_CAPTURE_ALIGN - 1) & ~(unsigned __int128)(CSI_CAPTURE_ALIGN - 1);
+    }
+
+    return size + align_up((uint64_t)reader->header.iq_width * sizeof(int16_t) * count);
+}
+
+/**
+ * @brief Every column and I/Q block of every indexed chunk lies inside its chunk, inside the file
+ */
+static void check_blocks(const csi_capture_reader_t *reader)
+{
+    uint64_t records = 0;
+
+    for (size_t i = 0; i < reader->chunk_count; i++) {
+        const csi_capture_chunk_t *chunk = &reader->chunks[i];
+        uint32_t count = chunk->index.count;
+        unsigned __int128 end = (unsigned __int128)chunk->index.offset + ref_chunk_size(reader, count);
+
+        CHECK(chunk->first_record == records);
+        CHECK(end <= reader->size);
+
+        for (size_t j = 0; j < reader->header.column_count; j++) {
+            uint64_t column_size = csi_capture_column_size(&reader->columns[j]);
+
+            CHECK(column_size);
+            CHECK(chunk->column_offset[j] > chunk->index.offset);
+            CHECK((unsigned __int128)chunk->column_offset[j] + column_size * count <= end);
+        }
+
+        CHECK((unsigned __int128)chunk->iq_offset + (uint64_t)reader->header.iq_width * 2 * count
+              + sizeof(csi_capture_chunk_footer_t) <= end);
+        records += count;
+    }
+
+    CHECK(records == reader->records);
+}
+
+static void test_column_size(void)
+{
+    static const struct {
+        const char *type;
+        size_t size;
+    } s_types[] = {
+        {"<u8", 8}, {"<u4", 4}, {"<f4", 4}, {"<u2", 2}, {"i1", 1}, {"|u1", 1}, {"f2", 2}, {"<f8", 8},
+        {"(6,)u1", 6}, {"(512,)u1", 512}, {"(64,)f8", 512},
+        {"f1", 0}, {"u3", 0}, {"u16", 0}, {"u99999999", 0}, {"c8", 0}, {"", 0}, {"<", 0},
+        {"(0,)u1", 0}, {"(6)u1", 0}, {"(6,u1", 0}, {"(65,)f8", 0}, {"(513,)u1", 0},
+        {"(9999999,)u8", 0}, {"(99999999,)u", 0},
+    };
+
+    for (size_t i = 0; i < sizeof(s_types) / sizeof(s_types[0]); i++) {
+        csi_capture_column_t column = {0};
+
+        memcpy(column.type, s_types[i].type, strlen(s_types[i].type));
+        CHECK(csi_capture_column_size(&column) == s_types[i].size);
+    }
+}
+
+static void test_round_trip(void)
+{
+    size_t size;
+    uint8_t *data = capture_build(TEST_RECORDS, TEST_CHUNK_RECORDS, &size);
+    csi_capture_reader_t reader;
+
+    CHECK(csi_capture_reader_open(&reader, data, size));
+    CHECK(!reader.truncated && reader.records == TEST_RECORDS);
+    CHECK(reader.chunk_count == (TEST_RECORDS + TEST_CHUNK_RECORDS - 1) / TEST_CHUNK_RECORDS);
+    CHECK(reader.header.iq_width == TEST_IQ_WIDTH && reader.header.created == 42);
+    check_blocks(&reader);
+
+    int seq = csi_capture_reader_column(&reader, "seq");
+    int timestamp = csi_capture_reader_column(&reader, "timestamp");
+
+    CHECK(seq >= 0 && timestamp >= 0 && csi_capture_reader_column(&reader, "nope") == -1);
+
+    for (uint32_t i = 0; i < TEST_RECORDS; i++) {
+        const csi_capture_chunk_t *chunk = &reader.chunks[i / TEST_CHUNK_RECORDS];
+        uint32_t slot = i % TEST_CHUNK_RECORDS;
+        uint32_t seq_value;
+        uint64_t timestamp_value;
+        int16_t iq[TEST_IQ_WIDTH];
+
+        memcpy(&seq_value, data + chunk->column_offset[seq] + slot * 4, 4);
+        memcpy(&timestamp_value, data + chunk->column_offset[timestamp] + slot * 8, 8);
+        memcpy(iq, data + chunk->iq_offset + slot * TEST_IQ_WIDTH * 2, sizeof(iq));
+
+        CHECK(seq_value == i * 3);
+        CHECK(timestamp_value == 0xfffff000ull + i * 100);
+
+        for (int j = 0; j < TEST_IQ_WIDTH; j++) {
+            CHECK(iq[j] == (int16_t)(i * 100 + j));
+        }
+
+        CHECK(csi_capture_reader_find_seq(&reader, i * 3, 0) == i);
+        CHECK(csi_capture_reader_find_seq(&reader, i * 3, i + 1) == TEST_RECORDS);
+        CHECK(csi_capture_reader_find_seq(&reader, i * 3 + 1, 0) == TEST_RECORDS);
+        CHECK(csi_capture_reader_find_time(&reader, true, test_host_time(i)) == i);
+        CHECK(csi_capture_reader_find_time(&reader, true, test_host_time(i) - 1) == i);
+        CHECK(csi_capture_reader_find_time(&reader, false, timestamp_value) == i);
+    }
+
+    CHECK(csi_capture_reader_find_time(&reader, true, test_host_time(TEST_RECORDS)) == TEST_RECORDS);
+
+    csi_capture_reader_close(&reader);
+    free(data);
+}
+
+static void test_truncated(void)
+{
+    size_t size;
+    uint8_t *data = capture_build(TEST_RECORDS, TEST_CHUNK_RECORDS, &size);
+    csi_capture_reader_t reader;
+
+    CHECK(csi_capture_reader_open(&reader, data, size));
+    uint64_t header_size = reader.header.header_size;
+    csi_capture_reader_close(&reader);
+
+    CHECK(!csi_capture_reader_open(&reader, data, header_size - 1));
+
+    for (size_t cut = header_size; cut <= size; cut++) {
+        uint8_t *copy = malloc(cut);
+        size_t complete = 0;
+        size_t end = header_size;
+
+        memcpy(copy, data, cut);
+        CHECK(csi_capture_reader_open(&reader, copy, cut));
+        check_blocks(&reader);
+
+        /**
+         * @brief Chunks are all full but the last, so the complete ones are found from their sizes
+         */
+        for (uint64_t records = 0; records < TEST_RECORDS; records += TEST_CHUNK_RECORDS) {
+            uint32_t count = TEST_RECORDS - records < TEST_CHUNK_RECORDS ? TEST_RECORDS - records : TEST_CHUNK_RECORDS;
+            size_t chunk_size = (size_t)ref_chunk_size(&reader, count);
+
+            if (end + chunk_size > cut) {
+                break;
+            }
+
+            end += chunk_size;
+            complete++;
+        }
+
+        CHECK(reader.chunk_count == complete && reader.truncated == (end != cut));
+        CHECK(csi_capture_reader_find_seq(&reader, (TEST_RECORDS - 1) * 3, 0) <= reader.records);
+
+        csi_capture_reader_close(&reader);
+        free(copy);
+    }
+
+    free(data);
+}
+
+/**
+ * @brief Chunk counts far beyond the file, with the size that matches them, end the index
+ */
+static void test_huge_count(void)
+{
+    size_t size;
+    uint8_t *data = capture_build(TEST_RECORDS, TEST_CHUNK_RECORDS, &size);
+    csi_capture_reader_t reader;
+
+    CHECK(csi_capture_reader_open(&reader, data, size));
+    uint64_t offset = reader.chunks[1].index.offset;
+
+    for (uint32_t count = 0xffffffffu; count > TEST_CHUNK_RECORDS; count >>= 1) {
+        csi_capture_chunk_header_t chunk = {.count = count, .size = (uint64_t)ref_chunk_size(&reader, count)};
+
+        memcpy(chunk.magic, CSI_CAPTURE_CHUNK_MAGIC, sizeof(chunk.magic));
+        memcpy(data + offset, &chunk, sizeof(chunk));
+        csi_capture_reader_close(&reader);
+
+        CHECK(csi_capture_reader_open(&reader, data, size));
+        CHECK(reader.chunk_count == 1 && reader.truncated);
+        check_blocks(&reader);
+    }
+
+    csi_capture_reader_close(&reader);
+    free(data);
+}
+
+/**
+ * @brief A hand-made capture whose time and seq columns are one byte wide: the chunks are
+ *        consistent, but searching them as 64- and 32-bit values would read past the file
+ */
+static void test_narrow_columns(void)
+{
+    static const char *s_columns[][2] = {{"timestamp", "u1"}, {"host_time", "u1"}, {"seq", "u1"}};
+    const uint32_t count = 64;
+    const uint16_t iq_width = 1;
+    csi_capture_file_header_t header = {
+        .version       = CSI_CAPTURE_VERSION,
+        .header_size   = sizeof(csi_capture_file_header_t) + 3 * sizeof(csi_capture_column_t),
+        .column_count  = 3,
+        .iq_width      = iq_width,
+        .chunk_records = count,
+    };
+    size_t chunk_size = sizeof(csi_capture_chunk_header_t) + 3 * align_up(count) + align_up(count * 2)
+                        + sizeof(csi_capture_chunk_footer_t);
+    size_t size = header.header_size + chunk_size;
+    uint8_t *data = calloc(1, size);
+    csi_capture_chunk_header_t chunk = {.count = count, .size = chunk_size};
+    csi_capture_chunk_footer_t footer = {
+        .offset = header.header_size, .last_timestamp = UINT64_MAX, .last_host_time = UINT64_MAX,
+        .max_seq = UINT32_MAX, .count = count,
+    };
+    csi_capture_reader_t reader;
+
+    CHECK(data);
+    memcpy(header.magic, CSI_CAPTURE_MAGIC, sizeof(header.magic));
+    memcpy(chunk.magic, CSI_CAPTURE_CHUNK_MAGIC, sizeof(chunk.magic));
+    memcpy(footer.magic, CSI_CAPTURE_FOOTER_MAGIC, sizeof(footer.magic));
+    memcpy(data, &header, sizeof(header));
+
+    for (int i = 0; i < 3; i++) {
+        csi_capture_column_t *column = (csi_capture_column_t *)(data + sizeof(header)) + i;
+        strcpy(column->name, s_columns[i][0]);
+        strcpy(column->type, s_columns[i][1]);
+    }
+
+    memcpy(data + header.header_size, &chunk, sizeof(chunk));
+    memcpy(data + size - sizeof(footer), &footer, sizeof(footer));
+    memset(data + header.header_size + sizeof(chunk), 0xff, 3 * align_up(count));
+
+    CHECK(csi_capture_reader_open(&reader, data, size));
+    CHECK(!reader.truncated && reader.records == count);
+    check_blocks(&reader);
+
+    CHECK(csi_capture_reader_find_time(&reader, false, 1) == count);
+    CHECK(csi_capture_reader_find_time(&reader, true, 1) == count);
+    CHECK(csi_capture_reader_find_seq(&reader, 0xff, 0) == count);
+
+    csi_capture_reader_close(&reader);
+    free(data);
+}
+
+/**
+ * @brief Random corruption of a valid capture: byte flips anywhere, or a chunk header given a random
+ *        count and the size that matches it
+ */
+static void test_fuzz(void)
+{
+    size_t size;
+    uint8_t *data = capture_build(TEST_RECORDS, TEST_CHUNK_RECORDS, &size);
+    uint8_t *copy = malloc(size);
+    uint32_t seed = 7;
+    csi_capture_reader_t reader;
+    size_t opened = 0, chunks = 0;
+    uint64_t chunk_offsets[8];
+    size_t chunk_total = 0;
+
+    CHECK(copy && csi_capture_reader_open(&reader, data, size));
+    for (size_t i = 0; i < reader.chunk_count && i < 8; i++) {
+        chunk_offsets[chunk_total++] = reader.chunks[i].index.offset;
+    }
+
+    uint64_t header_size = reader.header.header_size;
+    csi_capture_reader_close(&reader);
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++) {
+        memcpy(copy, data, size);
+
+        if (test_rand(&seed) % 2) {
+            for (uint32_t n = test_rand(&seed) % 4 + 1; n; n--) {
+                /**
+                 * @brief Half the flips go to the file header and the column directory
+                 */
+                size_t at = test_rand(&seed) % 2 ? test_rand(&seed) % header_size : test_rand(&seed) % size;
+                copy[at] ^= (uint8_t)(1 << test_rand(&seed) % 8);
+            }
+        } else {
+            csi_capture_chunk_header_t chunk;
+            uint64_t offset = chunk_offsets[test_rand(&seed) % chunk_total];
+            uint32_t shift = test_rand(&seed) % 32;
+
+            CHECK(csi_capture_reader_open(&reader, copy, size));
+            memcpy(&chunk, copy + offset, sizeof(chunk));
+            chunk.count = test_rand(&seed) >> shift;
+            chunk.size  = (uint64_t)ref_chunk_size(&reader, chunk.count);
+            memcpy(copy + offset, &chunk, sizeof(chunk));
+            csi_capture_reader_close(&reader);
+        }
+
+        if (!csi_capture_reader_open(&reader, copy, size)) {
+            continue;
+        }
+
+        opened++;
+        chunks += reader.chunk_count;
+        check_blocks(&reader);
+        csi_capture_reader_find_time(&reader, test_rand(&seed) % 2, (uint64_t)test_rand(&seed) << 20);
+        csi_capture_reader_find_seq(&reader, test_rand(&seed) % (TEST_RECORDS * 3), test_rand(&seed) % TEST_RECORDS);
+        csi_capture_reader_close(&reader);
+    }
+
+    printf("fuzz: %zu of %d corrupt captures opened, %zu chunks indexed\n", opened, FUZZ_ROUNDS, chunks);
+
+    free(copy);
+    free(data);
+}
+
+static void benchmark(void)
+{
+    const uint32_t records = 200000;
+    size_t size;
+    uint8_t *data = capture_build(records, 1000, &size);
+    csi_capture_reader_t reader;
+    struct timespec start, end;
+    const int rounds = 200;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < rounds; i++) {
+        CHECK(csi_capture_reader_open(&reader, data, size));
+        csi_capture_reader_close(&reader);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("open of %u records in %u chunks (%zu KB): %.1f us\n", (unsigned int)records, (unsigned int)(records / 1000),
+           size / 1024, elapsed / rounds * 1e6);
+
+    free(data);
+}
+
+int main(void)
+{
+    test_column_size();
+    test_round_trip();
+    test_truncated();
+    test_huge_count();
+    test_narrow_columns();
+    test_fuzz();
+    benchmark();
+
+    printf("test_csi_capture: all tests passed\n");
+
+    return 0;
+}
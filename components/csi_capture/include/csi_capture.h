@@ -0,0 +1,237 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Chunked columnar capture file for recorded CSI sessions
+ *
+ * A capture is `csi_capture_file_header_t | column directory | chunk...`, and
+ * a chunk is
+ *
+ *     csi_capture_chunk_header_t
+ *     one block per column: `count` values of that column
+ *     I/Q block: `count` rows of `iq_width` int16 values
+ *     csi_capture_chunk_footer_t
+ *
+ * with every block 8-byte aligned in the file, so a memory-mapped capture can
+ * be read in place. The footer holds the timestamp and sequence range of its
+ * chunk, so a reader finds a record by time or id without touching the other
+ * chunks. Values are stored in the byte order of the writer; all ESP chips and
+ * common hosts are little-endian.
+ *
+ * Plain C99 with stdio only, like csi_frame, so the writer runs on a device
+ * with a file system as well as on a host, and the reader on any mapped buffer.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSI_CAPTURE_MAGIC               "CCAP"
+#define CSI_CAPTURE_CHUNK_MAGIC         "CHNK"
+#define CSI_CAPTURE_FOOTER_MAGIC        "CIDX"
+#define CSI_CAPTURE_VERSION             1
+
+#define CSI_CAPTURE_ALIGN               8
+#define CSI_CAPTURE_MAX_COLUMNS         32
+#define CSI_CAPTURE_MAX_IQ_WIDTH        1024
+#define CSI_CAPTURE_DEFAULT_CHUNK_RECORDS  4096
+
+/**
+ * @brief One received packet, as handed to the writer
+ *
+ * The fields follow csi_frame_header_t. Fields a source does not report are zero.
+ */
+typedef struct {
+    uint64_t host_time;             /**< Wall clock at reception, microseconds since the epoch, 0 if unknown */
+    uint32_t seq;
+    uint32_t timestamp;             /**< rx_ctrl timestamp, microseconds; stored unwrapped to 64 bits */
+    float    compensate_gain;
+    uint16_t len;                   /**< I/Q values of the packet, before truncation to `iq_width` */
+    uint16_t sig_len;
+    uint8_t  mac[6];
+    int8_t   rssi;
+    int8_t   noise_floor;
+    uint8_t  rate;
+    uint8_t  sig_mode;
+    uint8_t  mcs;
+    uint8_t  cwb;
+    uint8_t  channel;
+    uint8_t  secondary_channel;
+    uint8_t  stbc;
+    uint8_t  sgi;
+    uint8_t  rx_state;
+    uint8_t  agc_gain;
+    int8_t   fft_gain;
+    uint8_t  flags;                 /**< CSI_FRAME_FLAG_* */
+    uint8_t  ampdu_cnt;
+    uint8_t  rx_misc;               /**< CSI_FRAME_MISC_* */
+    uint8_t  format;                /**< Source of the record, application defined */
+} csi_capture_record_t;
+
+typedef struct {
+    char     magic[4];              /**< CSI_CAPTURE_MAGIC */
+    uint16_t version;               /**< CSI_CAPTURE_VERSION */
+    uint16_t header_size;           /**< This header and the column directory, where the first chunk starts */
+    uint16_t column_count;
+    uint16_t iq_width;              /**< int16 values per I/Q row */
+    uint32_t chunk_records;         /**< Records per chunk, the last one may hold fewer */
+    uint64_t created;               /**< host_time of the file creation */
+    uint64_t reserved;
+} csi_capture_file_header_t;
+
+/**
+ * @brief Column directory entry, `column_count` of them follow the file header
+ */
+typedef struct {
+    char     name[20];              /**< NUL-terminated, e.g. "rssi" */
+    char     type[12];              /**< NUL-terminated NumPy type string, e.g. "<u4" or "(6,)u1" */
+} csi_capture_column_t;
+
+typedef struct {
+    char     magic[4];              /**< CSI_CAPTURE_CHUNK_MAGIC */
+    uint32_t count;                 /**< Records in the chunk */
+    uint64_t size;                  /**< Bytes from this header to the end of the footer */
+} csi_capture_chunk_header_t;
+
+typedef struct {
+    uint64_t offset;                /**< File offset of the chunk header */
+    uint64_t first_timestamp;       /**< Unwrapped rx_ctrl timestamps of the first and last record */
+    uint64_t last_timestamp;
+    uint64_t first_host_time;
+    uint64_t last_host_time;
+    uint32_t min_seq;
+    uint32_t max_seq;
+    uint32_t count;
+    char     magic[4];              /**< CSI_CAPTURE_FOOTER_MAGIC */
+} csi_capture_chunk_footer_t;
+
+_Static_assert(sizeof(csi_capture_file_header_t) == 32, "csi_capture_file_header_t is part of the file format");
+_Static_assert(sizeof(csi_capture_column_t) == 32, "csi_capture_column_t is part of the file format");
+_Static_assert(sizeof(csi_capture_chunk_header_t) == 16, "csi_capture_chunk_header_t is part of the file format");
+_Static_assert(sizeof(csi_capture_chunk_footer_t) == 56, "csi_capture_chunk_footer_t is part of the file format");
+
+typedef struct {
+    FILE     *fp;
+    uint16_t  iq_width;
+    uint32_t  chunk_records;
+    uint32_t  count;                /**< Records in the pending chunk */
+    uint8_t  *columns;              /**< Pending column blocks, each chunk_records values wide */
+    int16_t  *iq;                   /**< Pending I/Q rows */
+    uint64_t  offset;               /**< File offset of the pending chunk */
+    uint64_t  timestamp;            /**< Unwrapped timestamp of the last record */
+    uint32_t  last_timestamp;
+    csi_capture_chunk_footer_t footer;  /**< Index of the pending chunk */
+    uint64_t  records;              /**< Records appended */
+    uint64_t  truncated;            /**< Records with more than iq_width values */
+} csi_capture_writer_t;
+
+/**
+ * @brief Start a capture: write the file header and the column directory
+ *
+ * @param fp            File opened for binary writing, positioned at its start. Not closed by the writer.
+ * @param iq_width      int16 values kept per record, 1 to CSI_CAPTURE_MAX_IQ_WIDTH
+ * @param chunk_records Records per chunk, 0 for CSI_CAPTURE_DEFAULT_CHUNK_RECORDS
+ * @param created       Wall clock of the creation, microseconds since the epoch, 0 if unknown
+ *
+ * @return false if the arguments are invalid, memory is short or the write failed (see errno)
+ */
+bool csi_capture_writer_open(csi_capture_writer_t *writer, FILE *fp, uint16_t iq_width,
+                             uint32_t chunk_records, uint64_t created);
+
+/**
+ * @brief Add a record; a full chunk is written to the file
+ *
+ * @param iq    I/Q values of the record, `count` of them; values beyond `iq_width` are dropped
+ *
+ * @return false if writing a full chunk failed
+ */
+bool csi_capture_writer_append(csi_capture_writer_t *writer, const csi_capture_record_t *record,
+                               const int16_t *iq, size_t count);
+
+/**
+ * @brief Write the pending records as a (short) chunk and flush the file
+ */
+bool csi_capture_writer_flush(csi_capture_writer_t *writer);
+
+/**
+ * @brief Flush and free the writer; the file is left open
+ */
+bool csi_capture_writer_close(csi_capture_writer_t *writer);
+
+/**
+ * @brief Chunk of a capture being read, see csi_capture_reader_open()
+ */
+typedef struct {
+    csi_capture_chunk_footer_t index;
+    uint64_t first_record;          /**< Number of the chunk's first record in the capture */
+    uint64_t column_offset[CSI_CAPTURE_MAX_COLUMNS];  /**< File offset of each column block */
+    uint64_t iq_offset;             /**< File offset of the I/Q block */
+} csi_capture_chunk_t;
+
+typedef struct {
+    const uint8_t *data;
+    size_t    size;
+    csi_capture_file_header_t header;
+    const csi_capture_column_t *columns;
+    csi_capture_chunk_t *chunks;
+    size_t    chunk_count;
+    uint64_t  records;
+    bool      truncated;            /**< The file ends in an incomplete chunk, e.g. the writer was killed */
+} csi_capture_reader_t;
+
+/**
+ * @brief Index a capture held in memory, typically a mapped file
+ *
+ * Only the chunk headers and footers are read. A trailing incomplete chunk is ignored, as is
+ * everything from the first chunk whose size does not match its count, so every column and
+ * I/Q block of the indexed chunks lies within `size`.
+ *
+ * @return false if `data` does not start with a capture header or memory is short
+ */
+bool csi_capture_reader_open(csi_capture_reader_t *reader, const void *data, size_t size);
+
+void csi_capture_reader_close(csi_capture_reader_t *reader);
+
+/**
+ * @brief Size in bytes of one value of a column, 0 for a type NumPy does not have or a value over 512 bytes
+ */
+size_t csi_capture_column_size(const csi_capture_column_t *column);
+
+/**
+ * @brief Column number of `name`, -1 if the capture has no such column
+ */
+int csi_capture_reader_column(const csi_capture_reader_t *reader, const char *name);
+
+/**
+ * @brief Number of the first record whose unwrapped `timestamp` (or `host_time`) is at least `value`
+ *
+ * Chunks are found from their footers, then the column is searched within the chunk; both are
+ * assumed to be non-decreasing along the capture.
+ *
+ * @return `records` if every record is earlier, or the column is missing or not 64-bit
+ */
+uint64_t csi_capture_reader_find_time(const csi_capture_reader_t *reader, bool host_time, uint64_t value);
+
+/**
+ * @brief Number of the first record with sequence id `seq`, at or after record `start`
+ *
+ * Chunks whose footer range excludes `seq` are skipped.
+ *
+ * @return `records` if there is none, or the `seq` column is missing or not 32-bit
+ */
+uint64_t csi_capture_reader_find_seq(const csi_capture_reader_t *reader, uint32_t seq, uint64_t start);
+
+#ifdef __cplusplus
+}
+#endif
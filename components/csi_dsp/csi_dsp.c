@@ -0,0 +1,498 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "csi_dsp.h"
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+#include <immintrin.h>
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+#include <emmintrin.h>
+#endif
+
+#define CSI_DSP_PI          3.14159265358979f
+#define CSI_DSP_PI_2        1.57079632679490f
+
+/**
+ * @brief atan(z) for z in [0, 1], Abramowitz & Stegun 4.4.49 (|error| <= 2e-8 before float rounding)
+ */
+#define CSI_DSP_ATAN_C1     -0.3333314528f
+#define CSI_DSP_ATAN_C2      0.1999355085f
+#define CSI_DSP_ATAN_C3     -0.1420889944f
+#define CSI_DSP_ATAN_C4      0.1065626393f
+#define CSI_DSP_ATAN_C5     -0.0752896400f
+#define CSI_DSP_ATAN_C6      0.0429096138f
+#define CSI_DSP_ATAN_C7     -0.0161657367f
+#define CSI_DSP_ATAN_C8      0.0028662257f
+
+static inline float csi_dsp_phase_one(float real, float imag)
+{
+    float ax = fabsf(real);
+    float ay = fabsf(imag);
+    float mx = ax > ay ? ax : ay;
+    float mn = ax > ay ? ay : ax;
+    float z  = mx > 0 ? mn / mx : 0;
+    float z2 = z * z;
+
+    float p = CSI_DSP_ATAN_C8;
+    p = p * z2 + CSI_DSP_ATAN_C7;
+    p = p * z2 + CSI_DSP_ATAN_C6;
+    p = p * z2 + CSI_DSP_ATAN_C5;
+    p = p * z2 + CSI_DSP_ATAN_C4;
+    p = p * z2 + CSI_DSP_ATAN_C3;
+    p = p * z2 + CSI_DSP_ATAN_C2;
+    p = p * z2 + CSI_DSP_ATAN_C1;
+    float r = z + z * z2 * p;
+
+    if (ay > ax) {
+        r = CSI_DSP_PI_2 - r;
+    }
+
+    if (real < 0) {
+        r = CSI_DSP_PI - r;
+    }
+
+    return copysignf(r, imag);
+}
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2 || CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+/**
+ * @brief Sign-extend the even (low) and odd (high) bytes of each 16-bit lane
+ */
+static inline __m128i csi_dsp_even_i8_to_i16(__m128i v)
+{
+    return _mm_srai_epi16(_mm_slli_epi16(v, 8), 8);
+}
+
+static inline __m128i csi_dsp_odd_i8_to_i16(__m128i v)
+{
+    return _mm_srai_epi16(v, 8);
+}
+
+static inline __m128 csi_dsp_i16_lo_to_f32(__m128i v)
+{
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+static inline __m128 csi_dsp_i16_hi_to_f32(__m128i v)
+{
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+
+/**
+ * @brief Q15 products to integers, truncated toward zero
+ */
+static inline __m128i csi_dsp_q15_trunc_epi32(__m128i p)
+{
+    return _mm_srai_epi32(_mm_add_epi32(p, _mm_and_si128(_mm_srai_epi32(p, 31), _mm_set1_epi32(0x7fff))), 15);
+}
+#endif
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+/**
+ * @brief Low 32 bits of the lane products, SSE2 has no _mm_mullo_epi32
+ */
+static inline __m128i csi_dsp_mullo_epi32(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, 0x08), _mm_shuffle_epi32(odd, 0x08));
+}
+
+/**
+ * @brief gain_q15 * v for eight int16 lanes, truncated back to int16 with saturation
+ */
+static inline __m128i csi_dsp_scale_i16_q15(__m128i v, __m128i g)
+{
+    __m128i lo = csi_dsp_mullo_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), g);
+    __m128i hi = csi_dsp_mullo_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), g);
+    return _mm_packs_epi32(csi_dsp_q15_trunc_epi32(lo), csi_dsp_q15_trunc_epi32(hi));
+}
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+static inline __m256i csi_dsp_q15_trunc_epi32_x8(__m256i p)
+{
+    return _mm256_srai_epi32(_mm256_add_epi32(p, _mm256_and_si256(_mm256_srai_epi32(p, 31), _mm256_set1_epi32(0x7fff))), 15);
+}
+#endif
+
+static inline int16_t csi_dsp_q15_trunc(int32_t p)
+{
+    return (int16_t)((p + (p < 0 ? 0x7fff : 0)) >> 15);
+}
+
+const char *csi_dsp_impl_name(void)
+{
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    return "avx2";
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void csi_dsp_deinterleave_i8(const int8_t *iq, int8_t *real, int8_t *imag, size_t count)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2 || CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    for (; i + 16 <= count; i += 16) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(iq + 2 * i));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(iq + 2 * i + 16));
+        __m128i im = _mm_packs_epi16(csi_dsp_even_i8_to_i16(v0), csi_dsp_even_i8_to_i16(v1));
+        __m128i re = _mm_packs_epi16(csi_dsp_odd_i8_to_i16(v0), csi_dsp_odd_i8_to_i16(v1));
+        _mm_storeu_si128((__m128i *)(imag + i), im);
+        _mm_storeu_si128((__m128i *)(real + i), re);
+    }
+#endif
+
+    for (; i < count; i++) {
+        imag[i] = iq[2 * i];
+        real[i] = iq[2 * i + 1];
+    }
+}
+
+void csi_dsp_deinterleave_i8_f32(const int8_t *iq, float *real, float *imag, size_t count)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(iq + 2 * i));
+        __m256i im = _mm256_cvtepi16_epi32(csi_dsp_even_i8_to_i16(v));
+        __m256i re = _mm256_cvtepi16_epi32(csi_dsp_odd_i8_to_i16(v));
+        _mm256_storeu_ps(imag + i, _mm256_cvtepi32_ps(im));
+        _mm256_storeu_ps(real + i, _mm256_cvtepi32_ps(re));
+    }
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(iq + 2 * i));
+        __m128i im = csi_dsp_even_i8_to_i16(v);
+        __m128i re = csi_dsp_odd_i8_to_i16(v);
+        _mm_storeu_ps(imag + i, csi_dsp_i16_lo_to_f32(im));
+        _mm_storeu_ps(imag + i + 4, csi_dsp_i16_hi_to_f32(im));
+        _mm_storeu_ps(real + i, csi_dsp_i16_lo_to_f32(re));
+        _mm_storeu_ps(real + i + 4, csi_dsp_i16_hi_to_f32(re));
+    }
+#endif
+
+    for (; i < count; i++) {
+        imag[i] = iq[2 * i];
+        real[i] = iq[2 * i + 1];
+    }
+}
+
+void csi_dsp_i8_to_f32(const int8_t *in, float *out, size_t len)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    for (; i + 8 <= len; i += 8) {
+        __m256i v = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(v));
+    }
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadl_epi64((const __m128i *)(in + i));
+        v = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+        _mm_storeu_ps(out + i, csi_dsp_i16_lo_to_f32(v));
+        _mm_storeu_ps(out + i + 4, csi_dsp_i16_hi_to_f32(v));
+    }
+#endif
+
+    for (; i < len; i++) {
+        out[i] = in[i];
+    }
+}
+
+void csi_dsp_i8_to_q16(const int8_t *in, int32_t *out, size_t len)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    for (; i + 8 <= len; i += 8) {
+        __m256i v = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(in + i)));
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_slli_epi32(v, 16));
+    }
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadl_epi64((const __m128i *)(in + i));
+        v = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+        // Interleaving zeros below each int16 sample is the same as shifting it left by 16
+        _mm_storeu_si128((__m128i *)(out + i), _mm_unpacklo_epi16(_mm_setzero_si128(), v));
+        _mm_storeu_si128((__m128i *)(out + i + 4), _mm_unpackhi_epi16(_mm_setzero_si128(), v));
+    }
+#endif
+
+    for (; i < len; i++) {
+        out[i] = (int32_t)in[i] * 65536;
+    }
+}
+
+void csi_dsp_scale_i8_i16(const int8_t *in, int16_t *out, size_t len, float gain)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    const __m256 g = _mm256_set1_ps(gain);
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(v));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(v, 8)));
+        __m256i packed = _mm256_packs_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(lo, g)),
+                                            _mm256_cvttps_epi32(_mm256_mul_ps(hi, g)));
+        // packs works within 128-bit lanes, restore the element order
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    const __m128 g = _mm_set1_ps(gain);
+
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadl_epi64((const __m128i *)(in + i));
+        v = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+        __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(csi_dsp_i16_lo_to_f32(v), g));
+        __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(csi_dsp_i16_hi_to_f32(v), g));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+
+    for (; i < len; i++) {
+        out[i] = (int16_t)(gain * in[i]);
+    }
+}
+
+void csi_dsp_scale_i12_i16(const uint8_t *in, int16_t *out, size_t len, float gain)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    const __m256 g = _mm256_set1_ps(gain);
+
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + 2 * i));
+        v = _mm_srai_epi16(_mm_slli_epi16(v, 4), 4);
+        __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v));
+        __m256i s = _mm256_cvttps_epi32(_mm256_mul_ps(f, g));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1)));
+    }
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    const __m128 g = _mm_set1_ps(gain);
+
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + 2 * i));
+        v = _mm_srai_epi16(_mm_slli_epi16(v, 4), 4);
+        __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(csi_dsp_i16_lo_to_f32(v), g));
+        __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(csi_dsp_i16_hi_to_f32(v), g));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+
+    for (; i < len; i++) {
+        int16_t csi = (int16_t)(((((uint16_t)in[2 * i + 1]) << 8) | in[2 * i]) << 4) >> 4;
+        out[i] = (int16_t)(gain * csi);
+    }
+}
+
+int32_t csi_dsp_gain_to_q15(float gain)
+{
+    return (int32_t)(gain * CSI_DSP_Q15_ONE + (gain < 0 ? -0.5f : 0.5f));
+}
+
+void csi_dsp_scale_i8_i16_q15(const int8_t *in, int16_t *out, size_t len, int32_t gain_q15)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    const __m256i g = _mm256_set1_epi32(gain_q15);
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        __m256i lo = _mm256_mullo_epi32(_mm256_cvtepi8_epi32(v), g);
+        __m256i hi = _mm256_mullo_epi32(_mm256_cvtepi8_epi32(_mm_srli_si128(v, 8)), g);
+        __m256i packed = _mm256_packs_epi32(csi_dsp_q15_trunc_epi32_x8(lo), csi_dsp_q15_trunc_epi32_x8(hi));
+        // packs works within 128-bit lanes, restore the element order
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    const __m128i g = _mm_set1_epi32(gain_q15);
+
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadl_epi64((const __m128i *)(in + i));
+        v = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+        _mm_storeu_si128((__m128i *)(out + i), csi_dsp_scale_i16_q15(v, g));
+    }
+#endif
+
+    for (; i < len; i++) {
+        out[i] = csi_dsp_q15_trunc(in[i] * gain_q15);
+    }
+}
+
+void csi_dsp_scale_i12_i16_q15(const uint8_t *in, int16_t *out, size_t len, int32_t gain_q15)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    const __m256i g = _mm256_set1_epi32(gain_q15);
+
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + 2 * i));
+        v = _mm_srai_epi16(_mm_slli_epi16(v, 4), 4);
+        __m256i s = csi_dsp_q15_trunc_epi32_x8(_mm256_mullo_epi32(_mm256_cvtepi16_epi32(v), g));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1)));
+    }
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    const __m128i g = _mm_set1_epi32(gain_q15);
+
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + 2 * i));
+        v = _mm_srai_epi16(_mm_slli_epi16(v, 4), 4);
+        _mm_storeu_si128((__m128i *)(out + i), csi_dsp_scale_i16_q15(v, g));
+    }
+#endif
+
+    for (; i < len; i++) {
+        int16_t csi = (int16_t)(((((uint16_t)in[2 * i + 1]) << 8) | in[2 * i]) << 4) >> 4;
+        out[i] = csi_dsp_q15_trunc(csi * gain_q15);
+    }
+}
+
+const csi_dsp_gain_t csi_dsp_gain_unity = {
+    .valid    = true,
+    .gain     = 1.0f,
+    .gain_q15 = CSI_DSP_Q15_ONE,
+};
+
+static inline size_t csi_dsp_gain_cache_index(uint8_t agc_gain, int8_t fft_gain)
+{
+    return ((agc_gain * 7u) ^ (uint8_t)fft_gain) & (CSI_DSP_GAIN_CACHE_SIZE - 1);
+}
+
+void csi_dsp_gain_cache_init(csi_dsp_gain_cache_t *cache)
+{
+    memset(cache, 0, sizeof(csi_dsp_gain_cache_t));
+}
+
+const csi_dsp_gain_t *csi_dsp_gain_cache_get(csi_dsp_gain_cache_t *cache, uint8_t agc_gain, int8_t fft_gain)
+{
+    const csi_dsp_gain_t *entry = &cache->entries[csi_dsp_gain_cache_index(agc_gain, fft_gain)];
+
+    if (entry->valid && entry->agc_gain == agc_gain && entry->fft_gain == fft_gain) {
+        cache->hit_count++;
+        return entry;
+    }
+
+    cache->miss_count++;
+    return NULL;
+}
+
+const csi_dsp_gain_t *csi_dsp_gain_cache_put(csi_dsp_gain_cache_t *cache, uint8_t agc_gain, int8_t fft_gain, float gain)
+{
+    csi_dsp_gain_t *entry = &cache->entries[csi_dsp_gain_cache_index(agc_gain, fft_gain)];
+
+    entry->agc_gain = agc_gain;
+    entry->fft_gain = fft_gain;
+    entry->valid    = true;
+    entry->gain     = gain;
+    entry->gain_q15 = csi_dsp_gain_to_q15(gain);
+
+    return entry;
+}
+
+void csi_dsp_magnitude_f32(const float *real, const float *imag, float *mag, size_t len)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    for (; i + 8 <= len; i += 8) {
+        __m256 re = _mm256_loadu_ps(real + i);
+        __m256 im = _mm256_loadu_ps(imag + i);
+        _mm256_storeu_ps(mag + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im))));
+    }
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    for (; i + 4 <= len; i += 4) {
+        __m128 re = _mm_loadu_ps(real + i);
+        __m128 im = _mm_loadu_ps(imag + i);
+        _mm_storeu_ps(mag + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im))));
+    }
+#endif
+
+    for (; i < len; i++) {
+        mag[i] = sqrtf(real[i] * real[i] + imag[i] * imag[i]);
+    }
+}
+
+void csi_dsp_phase_f32(const float *real, const float *imag, float *phase, size_t len)
+{
+    size_t i = 0;
+
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (; i + 8 <= len; i += 8) {
+        __m256 re = _mm256_loadu_ps(real + i);
+        __m256 im = _mm256_loadu_ps(imag + i);
+        __m256 ax = _mm256_andnot_ps(sign, re);
+        __m256 ay = _mm256_andnot_ps(sign, im);
+        __m256 mx = _mm256_max_ps(ax, ay);
+        __m256 mn = _mm256_min_ps(ax, ay);
+        __m256 z  = _mm256_and_ps(_mm256_div_ps(mn, mx), _mm256_cmp_ps(mx, zero, _CMP_GT_OQ));
+        __m256 z2 = _mm256_mul_ps(z, z);
+
+        __m256 p = _mm256_set1_ps(CSI_DSP_ATAN_C8);
+        p = _mm256_add_ps(_mm256_mul_ps(p, z2), _mm256_set1_ps(CSI_DSP_ATAN_C7));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z2), _mm256_set1_ps(CSI_DSP_ATAN_C6));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z2), _mm256_set1_ps(CSI_DSP_ATAN_C5));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z2), _mm256_set1_ps(CSI_DSP_ATAN_C4));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z2), _mm256_set1_ps(CSI_DSP_ATAN_C3));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z2), _mm256_set1_ps(CSI_DSP_ATAN_C2));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z2), _mm256_set1_ps(CSI_DSP_ATAN_C1));
+        __m256 r = _mm256_add_ps(z, _mm256_mul_ps(_mm256_mul_ps(z, z2), p));
+
+        r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(CSI_DSP_PI_2), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+        r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(CSI_DSP_PI), r), _mm256_cmp_ps(re, zero, _CMP_LT_OQ));
+        _mm256_storeu_ps(phase + i, _mm256_or_ps(r, _mm256_and_ps(sign, im)));
+    }
+#elif CSI_DSP_IMPL == CSI_DSP_IMPL_SSE2
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= len; i += 4) {
+        __m128 re = _mm_loadu_ps(real + i);
+        __m128 im = _mm_loadu_ps(imag + i);
+        __m128 ax = _mm_andnot_ps(sign, re);
+        __m128 ay = _mm_andnot_ps(sign, im);
+        __m128 mx = _mm_max_ps(ax, ay);
+        __m128 mn = _mm_min_ps(ax, ay);
+        __m128 z  = _mm_and_ps(_mm_div_ps(mn, mx), _mm_cmpgt_ps(mx, zero));
+        __m128 z2 = _mm_mul_ps(z, z);
+
+        __m128 p = _mm_set1_ps(CSI_DSP_ATAN_C8);
+        p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(CSI_DSP_ATAN_C7));
+        p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(CSI_DSP_ATAN_C6));
+        p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(CSI_DSP_ATAN_C5));
+        p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(CSI_DSP_ATAN_C4));
+        p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(CSI_DSP_ATAN_C3));
+        p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(CSI_DSP_ATAN_C2));
+        p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(CSI_DSP_ATAN_C1));
+        __m128 r = _mm_add_ps(z, _mm_mul_ps(_mm_mul_ps(z, z2), p));
+
+        __m128 swap = _mm_cmpgt_ps(ay, ax);
+        r = _mm_or_ps(_mm_andnot_ps(swap, r), _mm_and_ps(swap, _mm_sub_ps(_mm_set1_ps(CSI_DSP_PI_2), r)));
+        __m128 left = _mm_cmplt_ps(re, zero);
+        r = _mm_or_ps(_mm_andnot_ps(left, r), _mm_and_ps(left, _mm_sub_ps(_mm_set1_ps(CSI_DSP_PI), r)));
+        _mm_storeu_ps(phase + i, _mm_or_ps(r, _mm_and_ps(sign, im)));
+    }
+#endif
+
+    for (; i < len; i++) {
+        phase[i] = csi_dsp_phase_one(real[i], imag[i]);
+    }
+}
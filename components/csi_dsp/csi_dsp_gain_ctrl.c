@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_log.h"
+#include "esp_csi_gain_ctrl.h"
+
+#include "csi_dsp_gain_ctrl.h"
+
+static const char *TAG = "csi_dsp_gain_ctrl";
+
+void csi_dsp_gain_ctrl_init(csi_dsp_gain_ctrl_t *ctrl, bool force_gain)
+{
+    ctrl->count             = 0;
+    ctrl->force_gain        = force_gain;
+    ctrl->agc_gain_baseline = 0;
+    ctrl->fft_gain_baseline = 0;
+    csi_dsp_gain_cache_init(&ctrl->cache);
+}
+
+const csi_dsp_gain_t *csi_dsp_gain_ctrl_update(csi_dsp_gain_ctrl_t *ctrl, const wifi_pkt_rx_ctrl_t *rx_ctrl,
+                                               uint8_t *agc_gain, int8_t *fft_gain)
+{
+    const csi_dsp_gain_t *gain = NULL;
+
+    esp_csi_gain_ctrl_get_rx_gain(rx_ctrl, agc_gain, fft_gain);
+
+    if (ctrl->count < CSI_DSP_GAIN_CTRL_BASELINE_NUM) {
+        esp_csi_gain_ctrl_record_rx_gain(*agc_gain, *fft_gain);
+    } else if (ctrl->count == CSI_DSP_GAIN_CTRL_BASELINE_NUM) {
+        esp_csi_gain_ctrl_get_rx_gain_baseline(&ctrl->agc_gain_baseline, &ctrl->fft_gain_baseline);
+
+        if (ctrl->force_gain) {
+            esp_csi_gain_ctrl_set_rx_force_gain(ctrl->agc_gain_baseline, ctrl->fft_gain_baseline);
+            ESP_LOGD(TAG, "fft_force %d, agc_force %d", ctrl->fft_gain_baseline, ctrl->agc_gain_baseline);
+        }
+
+        csi_dsp_gain_cache_init(&ctrl->cache);
+    } else {
+        /**
+         * @brief The factors only stay the same for a given (agc, fft) pair once the baseline is set
+         */
+        gain = csi_dsp_gain_cache_get(&ctrl->cache, *agc_gain, *fft_gain);
+    }
+
+    if (!gain) {
+        float compensate_gain = 1.0f;
+        esp_csi_gain_ctrl_get_gain_compensation(&compensate_gain, *agc_gain, *fft_gain);
+        gain = csi_dsp_gain_cache_put(&ctrl->cache, *agc_gain, *fft_gain, compensate_gain);
+    }
+
+    ctrl->count += ctrl->count <= CSI_DSP_GAIN_CTRL_BASELINE_NUM;
+
+    return gain;
+}
@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the esp_csi_gain_ctrl component, implemented by test_csi_dsp_gain_ctrl.c
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_wifi_types.h"
+
+typedef int esp_err_t;
+
+void esp_csi_gain_ctrl_get_rx_gain(const wifi_pkt_rx_ctrl_t *rx_ctrl, uint8_t *agc_gain, int8_t *fft_gain);
+void esp_csi_gain_ctrl_record_rx_gain(uint8_t agc_gain, int8_t fft_gain);
+void esp_csi_gain_ctrl_get_rx_gain_baseline(uint8_t *agc_gain, int8_t *fft_gain);
+void esp_csi_gain_ctrl_set_rx_force_gain(uint8_t agc_gain, int8_t fft_gain);
+esp_err_t esp_csi_gain_ctrl_get_gain_compensation(float *compensate_gain, uint8_t agc_gain, int8_t fft_gain);
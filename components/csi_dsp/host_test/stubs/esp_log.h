@@ -0,0 +1,17 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the ESP-IDF logging macros
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#define ESP_LOGD(tag, format, ...) (void)(tag)
+#define ESP_LOGI(tag, format, ...) printf("I %s: " format "\n", tag, ##__VA_ARGS__)
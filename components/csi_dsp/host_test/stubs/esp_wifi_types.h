@@ -0,0 +1,20 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the ESP-IDF header, only what csi_dsp_gain_ctrl.c uses.
+ *        test_csi_dsp_gain_ctrl.c reads the gains of a packet from these two fields.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t agc_gain;
+    int8_t  fft_gain;
+} wifi_pkt_rx_ctrl_t;
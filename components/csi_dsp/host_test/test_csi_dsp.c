@@ -0,0 +1,421 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Every csi_dsp kernel against the plain expression it replaces, for every length from 0 to
+ *        CHECK_MAX_LEN plus a full HT40 buffer, so each SIMD body and scalar tail is covered, with
+ *        guard words after each output. Integer results must match exactly, Q15 scaling also within
+ *        one of the float scaling, magnitude to float rounding and phase within CSI_DSP_PHASE_MAX_ERROR.
+ *        Also the gain cache, then time per element against the reference loops.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "csi_dsp.h"
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define CHECK_MAX_LEN       40
+#define CHECK_ROUNDS        200
+#define BUF_LEN             612         /**< Largest wifi_csi_info_t::len, HT40 with STBC */
+#define GUARD               8
+#define BENCH_ROUNDS        20000
+
+static uint32_t s_seed = 0x2026;
+
+static uint32_t rand_u32(void)
+{
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return s_seed;
+}
+
+static void rand_i8(int8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (int8_t)rand_u32();
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Lengths under test: all short ones, then a full buffer
+ */
+static size_t test_len(int i)
+{
+    return i <= CHECK_MAX_LEN ? (size_t)i : BUF_LEN / 2;
+}
+
+#define FOR_EACH_LEN(len) for (int _i = 0; _i <= CHECK_MAX_LEN + 1; _i++) for (size_t len = test_len(_i), _once = 1; _once; _once = 0)
+
+static void test_deinterleave(void)
+{
+    static int8_t iq[BUF_LEN], real[BUF_LEN + GUARD], imag[BUF_LEN + GUARD];
+    static float real_f[BUF_LEN + GUARD], imag_f[BUF_LEN + GUARD];
+
+    for (int round = 0; round < CHECK_ROUNDS; round++) {
+        FOR_EACH_LEN(count) {
+            rand_i8(iq, 2 * count);
+            memset(real, 0x5a, sizeof(real));
+            memset(imag, 0x5a, sizeof(imag));
+            memset(real_f, 0, sizeof(real_f));
+            memset(imag_f, 0, sizeof(imag_f));
+            real_f[count] = imag_f[count] = 12345.0f;
+
+            csi_dsp_deinterleave_i8(iq, real, imag, count);
+            csi_dsp_deinterleave_i8_f32(iq, real_f, imag_f, count);
+
+            for (size_t i = 0; i < count; i++) {
+                CHECK(imag[i] == iq[2 * i] && real[i] == iq[2 * i + 1]);
+                CHECK(imag_f[i] == (float)iq[2 * i] && real_f[i] == (float)iq[2 * i + 1]);
+            }
+
+            CHECK(real[count] == 0x5a && imag[count] == 0x5a);
+            CHECK(real_f[count] == 12345.0f && imag_f[count] == 12345.0f);
+        }
+    }
+}
+
+static void test_convert(void)
+{
+    static int8_t in[BUF_LEN];
+    static float out_f[BUF_LEN + GUARD];
+    static int32_t out_q[BUF_LEN + GUARD];
+
+    for (int round = 0; round < CHECK_ROUNDS; round++) {
+        FOR_EACH_LEN(len) {
+            rand_i8(in, len);
+            out_f[len] = -1.5f;
+            out_q[len] = 0x5a5a5a5a;
+
+            csi_dsp_i8_to_f32(in, out_f, len);
+            csi_dsp_i8_to_q16(in, out_q, len);
+
+            for (size_t i = 0; i < len; i++) {
+                CHECK(out_f[i] == (float)in[i]);
+                CHECK(out_q[i] == in[i] * 65536);
+            }
+
+            CHECK(out_f[len] == -1.5f && out_q[len] == 0x5a5a5a5a);
+        }
+    }
+}
+
+static float rand_gain(float max)
+{
+    return (rand_u32() % 1000000) / 1000000.0f * max;
+}
+
+/**
+ * @brief The float scaling is exact against (int16_t)(gain * x) over every int8 value and a spread of gains
+ */
+static void test_scale(void)
+{
+    static int8_t in[BUF_LEN];
+    static uint8_t in12[2 * BUF_LEN];
+    static int16_t out[BUF_LEN + GUARD];
+
+    for (int round = 0; round < CHECK_ROUNDS * 10; round++) {
+        float gain = round < 4 ? (float[]) {0.0f, 1.0f, 0.5f, 255.0f}[round] : rand_gain(round & 1 ? 4.0f : 255.0f);
+
+        FOR_EACH_LEN(len) {
+            for (size_t i = 0; i < len; i++) {
+                in[i] = (int8_t)(i + round * 7);
+            }
+            out[len] = 0x5a5a;
+
+            csi_dsp_scale_i8_i16(in, out, len, gain);
+
+            for (size_t i = 0; i < len; i++) {
+                CHECK(out[i] == (int16_t)(gain * in[i]));
+            }
+            CHECK(out[len] == 0x5a5a);
+        }
+
+        /**
+         * @brief 12-bit samples in 16-bit little-endian words, only bits 0..11 are meaningful
+         */
+        gain = fminf(gain, 15.9f);
+
+        FOR_EACH_LEN(len) {
+            for (size_t i = 0; i < len; i++) {
+                uint16_t word = (uint16_t)((i * 37 + round * 4093) & 0xffff);
+                in12[2 * i] = word & 0xff;
+                in12[2 * i + 1] = word >> 8;
+            }
+            out[len] = 0x5a5a;
+
+            csi_dsp_scale_i12_i16(in12, out, len, gain);
+
+            for (size_t i = 0; i < len; i++) {
+                int16_t value = (int16_t)((in12[2 * i] | in12[2 * i + 1] << 8) << 4) >> 4;
+                CHECK(out[i] == (int16_t)(gain * value));
+            }
+            CHECK(out[len] == 0x5a5a);
+        }
+    }
+}
+
+/**
+ * @brief q15 * x / 32768 truncated toward zero, in 64 bits
+ */
+static int16_t ref_q15(int32_t x, int32_t gain_q15)
+{
+    int64_t p = (int64_t)x * gain_q15;
+    return (int16_t)(p < 0 ? -(-p >> 15) : p >> 15);
+}
+
+static void test_gain_to_q15(void)
+{
+    CHECK(csi_dsp_gain_to_q15(0.0f) == 0);
+    CHECK(csi_dsp_gain_to_q15(1.0f) == CSI_DSP_Q15_ONE);
+    CHECK(csi_dsp_gain_to_q15(0.5f) == CSI_DSP_Q15_ONE / 2);
+    CHECK(csi_dsp_gain_to_q15(1.0f / 65536) == 1);              // Half a step rounds up
+    CHECK(csi_dsp_gain_to_q15(255.0f) == 255 * CSI_DSP_Q15_ONE);
+
+    for (int round = 0; round < CHECK_ROUNDS * 100; round++) {
+        float gain = rand_gain(255.0f);
+        CHECK(fabs(csi_dsp_gain_to_q15(gain) / (double)CSI_DSP_Q15_ONE - gain) <= 1.0 / 65536 + gain * 1e-7);
+    }
+}
+
+/**
+ * @brief The Q15 scaling is exact against the integer expression, and within one of the float scaling
+ */
+static void test_scale_q15(void)
+{
+    static int8_t in[BUF_LEN];
+    static uint8_t in12[2 * BUF_LEN];
+    static int16_t out[BUF_LEN + GUARD], out_f[BUF_LEN];
+
+    for (int round = 0; round < CHECK_ROUNDS * 10; round++) {
+        float gain = round < 4 ? (float[]) {0.0f, 1.0f, 0.5f, 255.0f}[round] : rand_gain(round & 1 ? 4.0f : 255.0f);
+        int32_t gain_q15 = csi_dsp_gain_to_q15(gain);
+
+        FOR_EACH_LEN(len) {
+            rand_i8(in, len);
+            out[len] = 0x5a5a;
+
+            csi_dsp_scale_i8_i16_q15(in, out, len, gain_q15);
+            csi_dsp_scale_i8_i16(in, out_f, len, gain);
+
+            for (size_t i = 0; i < len; i++) {
+                CHECK(out[i] == ref_q15(in[i], gain_q15));
+                CHECK(abs(out[i] - out_f[i]) <= 1);
+            }
+            CHECK(out[len] == 0x5a5a);
+        }
+
+        gain = fminf(gain, 15.9f);
+        gain_q15 = csi_dsp_gain_to_q15(gain);
+
+        FOR_EACH_LEN(len) {
+            for (size_t i = 0; i < len; i++) {
+                uint16_t word = (uint16_t)rand_u32();
+                in12[2 * i] = word & 0xff;
+                in12[2 * i + 1] = word >> 8;
+            }
+            out[len] = 0x5a5a;
+
+            csi_dsp_scale_i12_i16_q15(in12, out, len, gain_q15);
+            csi_dsp_scale_i12_i16(in12, out_f, len, gain);
+
+            for (size_t i = 0; i < len; i++) {
+                int16_t value = (int16_t)((in12[2 * i] | in12[2 * i + 1] << 8) << 4) >> 4;
+                CHECK(out[i] == ref_q15(value, gain_q15));
+                CHECK(abs(out[i] - out_f[i]) <= 1);
+            }
+            CHECK(out[len] == 0x5a5a);
+        }
+    }
+}
+
+/**
+ * @brief Hits, misses, a pair evicting another from its slot, and init clearing everything
+ */
+static void test_gain_cache(void)
+{
+    static csi_dsp_gain_cache_t cache;
+    const csi_dsp_gain_t *entry;
+
+    csi_dsp_gain_cache_init(&cache);
+    CHECK(!csi_dsp_gain_cache_get(&cache, 0, 0) && cache.miss_count == 1);
+
+    entry = csi_dsp_gain_cache_put(&cache, 30, -2, 1.25f);
+    CHECK(entry->valid && entry->agc_gain == 30 && entry->fft_gain == -2);
+    CHECK(entry->gain == 1.25f && entry->gain_q15 == csi_dsp_gain_to_q15(1.25f));
+    CHECK(csi_dsp_gain_cache_get(&cache, 30, -2) == entry && cache.hit_count == 1);
+    CHECK(!csi_dsp_gain_cache_get(&cache, 30, 2) && !csi_dsp_gain_cache_get(&cache, 31, -2));
+
+    /**
+     * @brief Find a pair sharing the slot, putting it must evict the first one
+     */
+    uint8_t agc = 0;
+    int8_t fft = 0;
+
+    for (int candidate = 0; candidate < 256 * 256; candidate++) {
+        agc = (uint8_t)(candidate >> 8);
+        fft = (int8_t)candidate;
+
+        if (!(agc == 30 && fft == -2) && csi_dsp_gain_cache_put(&cache, agc, fft, 2.0f) == entry) {
+            break;
+        }
+
+        csi_dsp_gain_cache_init(&cache);
+        csi_dsp_gain_cache_put(&cache, 30, -2, 1.25f);
+    }
+
+    CHECK(entry->agc_gain == agc && entry->fft_gain == fft);
+    CHECK(!csi_dsp_gain_cache_get(&cache, 30, -2));
+    CHECK(csi_dsp_gain_cache_get(&cache, agc, fft)->gain == 2.0f);
+
+    /**
+     * @brief Every entry is reachable, CSI_DSP_GAIN_CACHE_SIZE pairs can be cached at once
+     */
+    csi_dsp_gain_cache_init(&cache);
+    for (int fft_gain = 0; fft_gain < CSI_DSP_GAIN_CACHE_SIZE; fft_gain++) {
+        csi_dsp_gain_cache_put(&cache, 0, (int8_t)fft_gain, fft_gain);
+    }
+    for (int fft_gain = 0; fft_gain < CSI_DSP_GAIN_CACHE_SIZE; fft_gain++) {
+        CHECK(csi_dsp_gain_cache_get(&cache, 0, (int8_t)fft_gain)->gain == fft_gain);
+    }
+    CHECK(cache.hit_count == CSI_DSP_GAIN_CACHE_SIZE && cache.miss_count == 0);
+
+    csi_dsp_gain_cache_init(&cache);
+    CHECK(!csi_dsp_gain_cache_get(&cache, 0, 0));
+}
+
+static void test_magnitude_phase(void)
+{
+    static int8_t iq[BUF_LEN];
+    static float real[BUF_LEN], imag[BUF_LEN], mag[BUF_LEN + GUARD], phase[BUF_LEN + GUARD];
+    double worst_phase = 0;
+
+    for (int round = 0; round < CHECK_ROUNDS * 10; round++) {
+        FOR_EACH_LEN(count) {
+            rand_i8(iq, 2 * count);
+
+            /**
+             * @brief Zeros and the axes, where atan2 switches branches
+             */
+            if (round == 0) {
+                for (size_t i = 0; i < count; i++) {
+                    iq[2 * i] = (int8_t)((int)(i % 3) - 1) * (int8_t)(i & 4 ? 0 : 100);
+                    iq[2 * i + 1] = (int8_t)((int)(i / 3 % 3) - 1) * 100;
+                }
+            }
+
+            csi_dsp_deinterleave_i8_f32(iq, real, imag, count);
+            mag[count] = phase[count] = 99.0f;
+
+            csi_dsp_magnitude_f32(real, imag, mag, count);
+            csi_dsp_phase_f32(real, imag, phase, count);
+
+            for (size_t i = 0; i < count; i++) {
+                CHECK(mag[i] == sqrtf(real[i] * real[i] + imag[i] * imag[i]));
+
+                double expected = (real[i] == 0 && imag[i] == 0) ? 0 : atan2(imag[i], real[i]);
+                double error = fabs(phase[i] - expected);
+                worst_phase = fmax(worst_phase, error);
+                CHECK(error <= CSI_DSP_PHASE_MAX_ERROR);
+            }
+
+            CHECK(mag[count] == 99.0f && phase[count] == 99.0f);
+        }
+    }
+
+    printf("%s: worst phase error %.2e rad\n", csi_dsp_impl_name(), worst_phase);
+}
+
+/**
+ * @brief ns per element of a kernel call against its reference loop, over a full HT40 buffer
+ */
+static void benchmark(void)
+{
+    static int8_t iq[BUF_LEN];
+    static float real[BUF_LEN], imag[BUF_LEN], out[BUF_LEN];
+    static int16_t scaled[BUF_LEN];
+    const size_t count = BUF_LEN / 2;
+    const int32_t gain_q15 = csi_dsp_gain_to_q15(1.37f);
+    volatile float sink = 0;
+    double start;
+
+    rand_i8(iq, BUF_LEN);
+    csi_dsp_deinterleave_i8_f32(iq, real, imag, count);
+
+#define BENCH(label, body) \
+    start = now(); \
+    for (int round = 0; round < BENCH_ROUNDS; round++) { \
+        body; \
+        sink += out[round % count] + scaled[round % count]; \
+    } \
+    printf("%s %-24s %6.2f ns/element\n", csi_dsp_impl_name(), label, (now() - start) / BENCH_ROUNDS / count * 1e9)
+
+    BENCH("deinterleave_i8_f32", csi_dsp_deinterleave_i8_f32(iq, out, imag, count));
+    BENCH("  reference", for (size_t i = 0; i < count; i++) {
+        out[i] = iq[2 * i + 1];
+        imag[i] = iq[2 * i];
+    });
+    BENCH("scale_i8_i16", csi_dsp_scale_i8_i16(iq, scaled, BUF_LEN, 1.37f));
+    BENCH("  reference", for (size_t i = 0; i < BUF_LEN; i++) {
+        scaled[i] = (int16_t)(1.37f * iq[i]);
+    });
+    BENCH("scale_i8_i16_q15", csi_dsp_scale_i8_i16_q15(iq, scaled, BUF_LEN, gain_q15));
+    BENCH("  reference", for (size_t i = 0; i < BUF_LEN; i++) {
+        scaled[i] = ref_q15(iq[i], gain_q15);
+    });
+    BENCH("magnitude_f32", csi_dsp_magnitude_f32(real, imag, out, count));
+    BENCH("  reference", for (size_t i = 0; i < count; i++) {
+        out[i] = sqrtf(real[i] * real[i] + imag[i] * imag[i]);
+    });
+    BENCH("phase_f32", csi_dsp_phase_f32(real, imag, out, count));
+    BENCH("  reference atan2f", for (size_t i = 0; i < count; i++) {
+        out[i] = atan2f(imag[i], real[i]);
+    });
+
+#undef BENCH
+    (void)sink;
+}
+
+int main(void)
+{
+#if CSI_DSP_IMPL == CSI_DSP_IMPL_AVX2
+    if (!__builtin_cpu_supports("avx2")) {
+        printf("avx2: not supported by this CPU, skipped\n");
+        return 77;
+    }
+#endif
+
+    test_deinterleave();
+    test_convert();
+    test_scale();
+    test_gain_to_q15();
+    test_scale_q15();
+    test_gain_cache();
+    test_magnitude_phase();
+    benchmark();
+
+    printf("test_csi_dsp (%s): all tests passed\n", csi_dsp_impl_name());
+
+    return 0;
+}
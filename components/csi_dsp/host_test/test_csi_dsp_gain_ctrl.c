@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief csi_dsp_gain_ctrl against stubs of esp_csi_gain_ctrl (stubs/) that count every call:
+ *        the first CSI_DSP_GAIN_CTRL_BASELINE_NUM packets are recorded and never cached, the next
+ *        one takes and optionally forces the baseline, and from then on the gain controller is
+ *        only asked for pairs that miss the cache.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_csi_gain_ctrl.h"
+#include "csi_dsp_gain_ctrl.h"
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define BASELINE_AGC        40
+#define BASELINE_FFT        -3
+
+static struct {
+    int record_count;
+    int baseline_count;
+    int force_count;
+    int compensation_count;
+    bool baseline_set;
+} s_stub;
+
+void esp_csi_gain_ctrl_get_rx_gain(const wifi_pkt_rx_ctrl_t *rx_ctrl, uint8_t *agc_gain, int8_t *fft_gain)
+{
+    *agc_gain = rx_ctrl->agc_gain;
+    *fft_gain = rx_ctrl->fft_gain;
+}
+
+void esp_csi_gain_ctrl_record_rx_gain(uint8_t agc_gain, int8_t fft_gain)
+{
+    (void)agc_gain;
+    (void)fft_gain;
+    s_stub.record_count++;
+}
+
+void esp_csi_gain_ctrl_get_rx_gain_baseline(uint8_t *agc_gain, int8_t *fft_gain)
+{
+    *agc_gain = BASELINE_AGC;
+    *fft_gain = BASELINE_FFT;
+    s_stub.baseline_count++;
+    s_stub.baseline_set = true;
+}
+
+void esp_csi_gain_ctrl_set_rx_force_gain(uint8_t agc_gain, int8_t fft_gain)
+{
+    CHECK(agc_gain == BASELINE_AGC && fft_gain == BASELINE_FFT);
+    s_stub.force_count++;
+}
+
+/**
+ * @brief 1.0 until the baseline is known, then a factor that depends on the pair
+ */
+static float stub_compensation(uint8_t agc_gain, int8_t fft_gain)
+{
+    return s_stub.baseline_set ? 1.0f + (agc_gain - BASELINE_AGC) * 0.05f + (fft_gain - BASELINE_FFT) * 0.01f : 1.0f;
+}
+
+esp_err_t esp_csi_gain_ctrl_get_gain_compensation(float *compensate_gain, uint8_t agc_gain, int8_t fft_gain)
+{
+    *compensate_gain = stub_compensation(agc_gain, fft_gain);
+    s_stub.compensation_count++;
+    return 0;
+}
+
+static const csi_dsp_gain_t *update(csi_dsp_gain_ctrl_t *ctrl, uint8_t agc_gain, int8_t fft_gain)
+{
+    wifi_pkt_rx_ctrl_t rx_ctrl = {.agc_gain = agc_gain, .fft_gain = fft_gain};
+    uint8_t agc_out = 0;
+    int8_t fft_out = 0;
+    const csi_dsp_gain_t *gain = csi_dsp_gain_ctrl_update(ctrl, &rx_ctrl, &agc_out, &fft_out);
+
+    CHECK(agc_out == agc_gain && fft_out == fft_gain);
+    CHECK(gain && gain->valid && gain->agc_gain == agc_gain && gain->fft_gain == fft_gain);
+    CHECK(gain->gain == stub_compensation(agc_gain, fft_gain));
+    CHECK(gain->gain_q15 == csi_dsp_gain_to_q15(gain->gain));
+
+    return gain;
+}
+
+static void check_state_machine(bool force_gain)
+{
+    csi_dsp_gain_ctrl_t ctrl;
+
+    memset(&s_stub, 0, sizeof(s_stub));
+    csi_dsp_gain_ctrl_init(&ctrl, force_gain);
+
+    /**
+     * @brief Recording: every packet is passed on and asks for its factor, nothing is served from the cache
+     */
+    for (int i = 0; i < CSI_DSP_GAIN_CTRL_BASELINE_NUM; i++) {
+        update(&ctrl, 30 + i % 3, 0);
+    }
+
+    CHECK(s_stub.record_count == CSI_DSP_GAIN_CTRL_BASELINE_NUM && s_stub.baseline_count == 0);
+    CHECK(s_stub.compensation_count == CSI_DSP_GAIN_CTRL_BASELINE_NUM);
+    CHECK(ctrl.cache.hit_count == 0);
+
+    /**
+     * @brief The baseline packet clears the factors cached while recording
+     */
+    update(&ctrl, 30, 0);
+    CHECK(s_stub.baseline_count == 1 && s_stub.force_count == (force_gain ? 1 : 0));
+    CHECK(ctrl.agc_gain_baseline == BASELINE_AGC && ctrl.fft_gain_baseline == BASELINE_FFT);
+    CHECK(s_stub.compensation_count == CSI_DSP_GAIN_CTRL_BASELINE_NUM + 1);
+
+    /**
+     * @brief Afterwards one lookup per distinct pair, however many packets
+     */
+    for (int i = 0; i < 1000; i++) {
+        update(&ctrl, 30 + i % 3, (int8_t)(i % 2 - 1));
+    }
+
+    CHECK(s_stub.record_count == CSI_DSP_GAIN_CTRL_BASELINE_NUM && s_stub.baseline_count == 1);
+    CHECK(s_stub.compensation_count == CSI_DSP_GAIN_CTRL_BASELINE_NUM + 1 + 6 - 1);
+    CHECK(ctrl.cache.hit_count == 1000 - 5);
+
+    /**
+     * @brief Init starts over
+     */
+    csi_dsp_gain_ctrl_init(&ctrl, force_gain);
+    update(&ctrl, 30, 0);
+    CHECK(s_stub.record_count == CSI_DSP_GAIN_CTRL_BASELINE_NUM + 1);
+}
+
+int main(void)
+{
+    check_state_machine(false);
+    check_state_machine(true);
+
+    CHECK(csi_dsp_gain_unity.valid && csi_dsp_gain_unity.gain == 1.0f);
+    CHECK(csi_dsp_gain_unity.gain_q15 == CSI_DSP_Q15_ONE);
+
+    printf("test_csi_dsp_gain_ctrl: all tests passed\n");
+
+    return 0;
+}
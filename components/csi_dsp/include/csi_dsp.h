@@ -0,0 +1,185 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Kernels for interleaved CSI I/Q buffers
+ *
+ * `wifi_csi_info_t::buf` stores one subcarrier as two signed bytes, imaginary
+ * part first, then real part. These kernels de-interleave such buffers, convert
+ * them to float or Q16, apply the gain compensation factor, in float or Q15
+ * fixed point with a per-(agc, fft) cache of factors, and compute magnitude
+ * and phase.
+ *
+ * The implementation is selected at compile time from the target: AVX2 or SSE2
+ * on x86 hosts, portable C everywhere else, including every ESP32 target (there
+ * is no PIE variant for the ESP32-S3). All variants return the same results, up
+ * to float rounding for magnitude and phase.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSI_DSP_IMPL_SCALAR     0
+#define CSI_DSP_IMPL_SSE2       1
+#define CSI_DSP_IMPL_AVX2       2
+
+#ifndef CSI_DSP_IMPL
+#if defined(__AVX2__)
+#define CSI_DSP_IMPL            CSI_DSP_IMPL_AVX2
+#elif defined(__SSE2__)
+#define CSI_DSP_IMPL            CSI_DSP_IMPL_SSE2
+#else
+#define CSI_DSP_IMPL            CSI_DSP_IMPL_SCALAR
+#endif
+#endif
+
+/**
+ * @brief Maximum absolute error of csi_dsp_phase_f32(), in radians
+ */
+#define CSI_DSP_PHASE_MAX_ERROR 1e-6f
+
+/**
+ * @brief Name of the compiled-in implementation, "scalar", "sse2" or "avx2"
+ */
+const char *csi_dsp_impl_name(void);
+
+/**
+ * @brief Split `count` interleaved (imag, real) int8 pairs into two arrays
+ */
+void csi_dsp_deinterleave_i8(const int8_t *iq, int8_t *real, int8_t *imag, size_t count);
+
+/**
+ * @brief Split `count` interleaved (imag, real) int8 pairs into two float arrays
+ */
+void csi_dsp_deinterleave_i8_f32(const int8_t *iq, float *real, float *imag, size_t count);
+
+/**
+ * @brief Convert int8 samples to float
+ */
+void csi_dsp_i8_to_f32(const int8_t *in, float *out, size_t len);
+
+/**
+ * @brief Convert int8 samples to Q16 fixed point (IQmath `_iq16`)
+ */
+void csi_dsp_i8_to_q16(const int8_t *in, int32_t *out, size_t len);
+
+/**
+ * @brief out[i] = (int16_t)(gain * in[i]), truncated toward zero
+ *
+ * @note gain * in[i] must fit in int16_t, which holds for any gain below 256
+ */
+void csi_dsp_scale_i8_i16(const int8_t *in, int16_t *out, size_t len, float gain);
+
+/**
+ * @brief Same as csi_dsp_scale_i8_i16() for 12-bit signed samples stored in 16-bit little-endian words,
+ *        the payload format of `acquire_csi_force_lltf`
+ *
+ * @param in  `2 * len` bytes
+ *
+ * @note gain * in[i] must fit in int16_t, which holds for any gain below 16
+ */
+void csi_dsp_scale_i12_i16(const uint8_t *in, int16_t *out, size_t len, float gain);
+
+/**
+ * @brief 1.0 in the Q15 gain format of csi_dsp_scale_i8_i16_q15()
+ */
+#define CSI_DSP_Q15_ONE         32768
+
+/**
+ * @brief Gain as a Q15 fixed-point factor, rounded to nearest
+ */
+int32_t csi_dsp_gain_to_q15(float gain);
+
+/**
+ * @brief out[i] = gain_q15 * in[i] / 32768, truncated toward zero like csi_dsp_scale_i8_i16()
+ *
+ * Integer only, for targets without an FPU. The Q15 factor is within 2^-16 of the float gain,
+ * so a result can differ by one from csi_dsp_scale_i8_i16() when the float product is within
+ * |in[i]| * 2^-16 of an integer.
+ *
+ * @note gain_q15 * in[i] must fit in int32_t and the result in int16_t, which holds for any gain below 256
+ */
+void csi_dsp_scale_i8_i16_q15(const int8_t *in, int16_t *out, size_t len, int32_t gain_q15);
+
+/**
+ * @brief Same as csi_dsp_scale_i8_i16_q15() for the 12-bit payload of csi_dsp_scale_i12_i16()
+ *
+ * @note gain_q15 * in[i] must fit in int32_t and the result in int16_t, which holds for any gain below 16
+ */
+void csi_dsp_scale_i12_i16_q15(const uint8_t *in, int16_t *out, size_t len, int32_t gain_q15);
+
+#ifndef CSI_DSP_GAIN_CACHE_SIZE
+#define CSI_DSP_GAIN_CACHE_SIZE 16      /**< Power of two */
+#endif
+
+/**
+ * @brief Gain compensation factor for one (agc_gain, fft_gain) pair
+ */
+typedef struct {
+    uint8_t  agc_gain;
+    int8_t   fft_gain;
+    bool     valid;
+    float    gain;
+    int32_t  gain_q15;
+} csi_dsp_gain_t;
+
+/**
+ * @brief Factor 1.0, for when gain compensation is off
+ */
+extern const csi_dsp_gain_t csi_dsp_gain_unity;
+
+/**
+ * @brief Direct-mapped cache of gain compensation factors
+ *
+ * The AGC and FFT gains of consecutive packets rarely change, so computing the factor once per
+ * pair and keeping it next to its Q15 form saves the lookup and float conversion per packet.
+ * Clear the cache with csi_dsp_gain_cache_init() whenever the factors change, e.g. after the
+ * gain baseline is set.
+ */
+typedef struct {
+    csi_dsp_gain_t entries[CSI_DSP_GAIN_CACHE_SIZE];
+    uint32_t hit_count;
+    uint32_t miss_count;
+} csi_dsp_gain_cache_t;
+
+void csi_dsp_gain_cache_init(csi_dsp_gain_cache_t *cache);
+
+/**
+ * @return The cached factor, NULL on a miss
+ */
+const csi_dsp_gain_t *csi_dsp_gain_cache_get(csi_dsp_gain_cache_t *cache, uint8_t agc_gain, int8_t fft_gain);
+
+/**
+ * @brief Store a factor, replacing whatever shared its slot
+ *
+ * @return The stored entry
+ */
+const csi_dsp_gain_t *csi_dsp_gain_cache_put(csi_dsp_gain_cache_t *cache, uint8_t agc_gain, int8_t fft_gain, float gain);
+
+/**
+ * @brief mag[i] = sqrt(real[i]^2 + imag[i]^2)
+ */
+void csi_dsp_magnitude_f32(const float *real, const float *imag, float *mag, size_t len);
+
+/**
+ * @brief phase[i] = atan2(imag[i], real[i]) in [-pi, pi], within CSI_DSP_PHASE_MAX_ERROR
+ *
+ * Uses a polynomial approximation of atan() so that every variant, including the
+ * scalar one, evaluates the same expression. atan2(0, 0) is 0.
+ */
+void csi_dsp_phase_f32(const float *real, const float *imag, float *phase, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Per-receiver gain compensation on top of esp_csi_gain_ctrl
+ *
+ * The RX gains of the first CSI_DSP_GAIN_CTRL_BASELINE_NUM packets are recorded,
+ * the next packet takes their baseline, forces it if requested, and from then on
+ * the compensation factor of each (agc_gain, fft_gain) pair comes from a
+ * csi_dsp_gain_cache_t. Unlike csi_dsp.h this part needs ESP-IDF.
+ */
+
+#pragma once
+
+#include "esp_wifi_types.h"
+#include "csi_dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSI_DSP_GAIN_CTRL_BASELINE_NUM  100     /**< Packets whose RX gains make up the baseline */
+
+typedef struct {
+    uint32_t count;                 /**< Packets passed to csi_dsp_gain_ctrl_update() */
+    bool     force_gain;            /**< Force the baseline gains with esp_csi_gain_ctrl_set_rx_force_gain() */
+    uint8_t  agc_gain_baseline;
+    int8_t   fft_gain_baseline;
+    csi_dsp_gain_cache_t cache;
+} csi_dsp_gain_ctrl_t;
+
+/**
+ * @param force_gain Force the baseline gains once they are known
+ */
+void csi_dsp_gain_ctrl_init(csi_dsp_gain_ctrl_t *ctrl, bool force_gain);
+
+/**
+ * @brief Read the RX gains of one packet and return its compensation factor
+ *
+ * Not thread-safe, call it for every packet from the CSI callback or a single task.
+ *
+ * @param agc_gain Set to the packet's AGC gain
+ * @param fft_gain Set to the packet's FFT gain
+ *
+ * @return The factor, valid until the next call
+ */
+const csi_dsp_gain_t *csi_dsp_gain_ctrl_update(csi_dsp_gain_ctrl_t *ctrl, const wifi_pkt_rx_ctrl_t *rx_ctrl,
+                                               uint8_t *agc_gain, int8_t *fft_gain);
+
+#ifdef __cplusplus
+}
+#endif
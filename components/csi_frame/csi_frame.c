@@ -0,0 +1,213 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "csi_frame.h"
+
+static const uint16_t s_crc16_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
+    0x9339, 0x8318, 0xb37b, 0xa35a, 0xd3bd, 0xc39c, 0xf3ff, 0xe3de,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485,
+    0xa56a, 0xb54b, 0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+    0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc,
+    0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b,
+    0x5af5, 0x4ad4, 0x7ab7, 0x6a96, 0x1a71, 0x0a50, 0x3a33, 0x2a12,
+    0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a,
+    0x6ca6, 0x7c87, 0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41,
+    0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+    0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70,
+    0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a, 0x9f59, 0x8f78,
+    0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f,
+    0x1080, 0x00a1, 0x30c2, 0x20e3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e,
+    0x02b1, 0x1290, 0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+    0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e, 0xc71d, 0xd73c,
+    0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xd94c, 0xc96d, 0xf90e, 0xe92f, 0x99c8, 0x89e9, 0xb98a, 0xa9ab,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3,
+    0xcb7d, 0xdb5c, 0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a,
+    0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+    0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9,
+    0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1,
+    0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
+    0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0,
+};
+
+uint16_t csi_frame_crc16(uint16_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    while (len--) {
+        crc = (uint16_t)(crc << 8) ^ s_crc16_table[((crc >> 8) ^ *p++) & 0xff];
+    }
+
+    return crc;
+}
+
+size_t csi_frame_encode(const csi_frame_header_t *header, const void *payload, size_t payload_len,
+                        uint8_t *buf, size_t size)
+{
+    size_t frame_len = sizeof(csi_frame_header_t) + payload_len + CSI_FRAME_CRC_LEN;
+
+    if (!header || !buf || payload_len > CSI_FRAME_MAX_PAYLOAD_LEN || size < frame_len) {
+        return 0;
+    }
+
+    csi_frame_header_t *out = (csi_frame_header_t *)buf;
+    memcpy(out, header, sizeof(csi_frame_header_t));
+    out->sync[0]     = CSI_FRAME_SYNC0;
+    out->sync[1]     = CSI_FRAME_SYNC1;
+    out->version     = CSI_FRAME_VERSION;
+    out->length      = (uint16_t)frame_len;
+    out->payload_len = (uint16_t)payload_len;
+
+    if (payload_len) {
+        memcpy(buf + sizeof(csi_frame_header_t), payload, payload_len);
+    }
+
+    uint16_t crc = csi_frame_crc16(0xffff, buf, frame_len - CSI_FRAME_CRC_LEN);
+    buf[frame_len - 2] = crc & 0xff;
+    buf[frame_len - 1] = crc >> 8;
+
+    return frame_len;
+}
+
+csi_frame_status_t csi_frame_decode(const uint8_t *data, size_t len, csi_frame_header_t *header,
+                                    const uint8_t **payload, size_t *consumed)
+{
+    *consumed = 0;
+
+    if (len < 1) {
+        return CSI_FRAME_NEED_MORE;
+    }
+
+    if (data[0] != CSI_FRAME_SYNC0 || (len > 1 && data[1] != CSI_FRAME_SYNC1)
+            || (len > 2 && data[2] != CSI_FRAME_VERSION)) {
+        *consumed = 1;
+        return CSI_FRAME_INVALID;
+    }
+
+    if (len < sizeof(csi_frame_header_t)) {
+        return CSI_FRAME_NEED_MORE;
+    }
+
+    memcpy(header, data, sizeof(csi_frame_header_t));
+
+    if (header->payload_len > CSI_FRAME_MAX_PAYLOAD_LEN
+            || header->length != sizeof(csi_frame_header_t) + header->payload_len + CSI_FRAME_CRC_LEN) {
+        *consumed = 1;
+        return CSI_FRAME_INVALID;
+    }
+
+    if (len < header->length) {
+        return CSI_FRAME_NEED_MORE;
+    }
+
+    uint16_t crc = csi_frame_crc16(0xffff, data, header->length - CSI_FRAME_CRC_LEN);
+
+    if ((crc & 0xff) != data[header->length - 2] || (crc >> 8) != data[header->length - 1]) {
+        *consumed = 1;
+        return CSI_FRAME_INVALID;
+    }
+
+    *payload  = data + sizeof(csi_frame_header_t);
+    *consumed = header->length;
+
+    return CSI_FRAME_OK;
+}
+
+size_t csi_frame_payload_to_int16(const csi_frame_header_t *header, const uint8_t *payload,
+                                  int16_t *out, size_t max_count)
+{
+    size_t count = 0;
+
+    if (header->flags & CSI_FRAME_FLAG_PAYLOAD_INT12) {
+        for (size_t i = 0; i + 1 < header->payload_len && count < max_count; i += 2) {
+            out[count++] = (int16_t)((uint16_t)((payload[i + 1] << 8) | payload[i]) << 4) >> 4;
+        }
+    } else {
+        for (size_t i = 0; i < header->payload_len && count < max_count; i++) {
+            out[count++] = (int8_t)payload[i];
+        }
+    }
+
+    return count;
+}
+
+void csi_frame_decoder_init(csi_frame_decoder_t *decoder)
+{
+    memset(decoder, 0, sizeof(csi_frame_decoder_t));
+}
+
+size_t csi_frame_decoder_feed(csi_frame_decoder_t *decoder, const uint8_t *data, size_t len,
+                              csi_frame_cb_t cb, void *ctx)
+{
+    size_t frames = 0;
+
+    while (len > 0) {
+        size_t copy = sizeof(decoder->buf) - decoder->len;
+
+        if (copy > len) {
+            copy = len;
+        }
+
+        memcpy(decoder->buf + decoder->len, data, copy);
+        decoder->len += copy;
+        data += copy;
+        len  -= copy;
+
+        size_t offset = 0;
+
+        while (offset < decoder->len) {
+            csi_frame_header_t header;
+            const uint8_t *payload = NULL;
+            size_t consumed = 0;
+            csi_frame_status_t status = csi_frame_decode(decoder->buf + offset, decoder->len - offset,
+                                                         &header, &payload, &consumed);
+
+            if (status == CSI_FRAME_NEED_MORE) {
+                break;
+            }
+
+            if (status == CSI_FRAME_OK) {
+                decoder->frame_count++;
+                frames++;
+
+                if (cb) {
+                    cb(&header, payload, ctx);
+                }
+
+                offset += consumed;
+                continue;
+            }
+
+            if (decoder->buf[offset] == CSI_FRAME_SYNC0) {
+                decoder->error_count++;
+            }
+
+            /**< Skip to the next candidate sync byte */
+            const uint8_t *next = memchr(decoder->buf + offset + 1, CSI_FRAME_SYNC0, decoder->len - offset - 1);
+            size_t skip = next ? (size_t)(next - (decoder->buf + offset)) : decoder->len - offset;
+            decoder->skipped_bytes += skip;
+            offset += skip;
+        }
+
+        decoder->len -= offset;
+
+        if (decoder->len && offset) {
+            memmove(decoder->buf, decoder->buf + offset, decoder->len);
+        }
+    }
+
+    return frames;
+}
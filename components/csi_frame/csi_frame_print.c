@@ -0,0 +1,146 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/ringbuf.h"
+#include "esp_log.h"
+#include "driver/uart.h"
+
+#include "csi_frame.h"
+
+#define CSI_FRAME_UART_TX_BUF_SIZE  (8 * 1024)
+#define CSI_FRAME_PRINT_QUEUE_SIZE  (16 * 1024)
+#define CSI_FRAME_PRINT_TASK_STACK  (3 * 1024)
+#define CSI_FRAME_PRINT_TASK_PRIO   (5)
+
+#ifdef CONFIG_ESP_CONSOLE_UART_NUM
+#define CSI_FRAME_UART_NUM          CONFIG_ESP_CONSOLE_UART_NUM
+#else
+#define CSI_FRAME_UART_NUM          UART_NUM_0
+#endif
+
+static const char *TAG = "csi_frame";
+
+static RingbufHandle_t s_print_queue = NULL;
+static volatile uint32_t s_print_dropped = 0;
+
+static void csi_frame_print_task(void *arg)
+{
+    for (;;) {
+        size_t len = 0;
+        uint8_t *frame = xRingbufferReceive(s_print_queue, &len, portMAX_DELAY);
+
+        if (frame) {
+            uart_write_bytes(CSI_FRAME_UART_NUM, frame, len);
+            vRingbufferReturnItem(s_print_queue, frame);
+        }
+    }
+}
+
+esp_err_t csi_frame_print_init(void)
+{
+    if (s_print_queue) {
+        return ESP_OK;
+    }
+
+    if (!uart_is_driver_installed(CSI_FRAME_UART_NUM)) {
+        esp_err_t ret = uart_driver_install(CSI_FRAME_UART_NUM, 256, CSI_FRAME_UART_TX_BUF_SIZE, 0, NULL, 0);
+
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "<%s> uart_driver_install", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    /**
+     * @brief Frames are encoded straight into a no-split ring buffer and written out by a task,
+     *        so a full UART never blocks the Wi-Fi task and concurrent callers never share a buffer
+     */
+    s_print_queue = xRingbufferCreate(CSI_FRAME_PRINT_QUEUE_SIZE, RINGBUF_TYPE_NOSPLIT);
+
+    if (!s_print_queue) {
+        ESP_LOGE(TAG, "xRingbufferCreate");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(csi_frame_print_task, "csi_frame_print", CSI_FRAME_PRINT_TASK_STACK,
+                    NULL, CSI_FRAME_PRINT_TASK_PRIO, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "xTaskCreate");
+        vRingbufferDelete(s_print_queue);
+        s_print_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+uint32_t csi_frame_print_dropped(void)
+{
+    return s_print_dropped;
+}
+
+esp_err_t csi_frame_print(const wifi_csi_info_t *info, uint32_t seq, uint8_t agc_gain,
+                          int8_t fft_gain, float compensate_gain, uint8_t flags)
+{
+    const wifi_pkt_rx_ctrl_t *rx_ctrl = &info->rx_ctrl;
+    size_t frame_len = sizeof(csi_frame_header_t) + info->len + CSI_FRAME_CRC_LEN;
+
+    if (!s_print_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (info->len > CSI_FRAME_MAX_PAYLOAD_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    csi_frame_header_t header = {
+        .type              = CSI_FRAME_TYPE_CSI,
+        .seq               = seq,
+        .timestamp         = rx_ctrl->timestamp,
+        .rssi              = rx_ctrl->rssi,
+        .noise_floor       = rx_ctrl->noise_floor,
+        .rate              = rx_ctrl->rate,
+        .channel           = rx_ctrl->channel,
+        .sig_len           = rx_ctrl->sig_len,
+        .rx_state          = rx_ctrl->rx_state,
+        .agc_gain          = agc_gain,
+        .fft_gain          = fft_gain,
+        .flags             = flags | (info->first_word_invalid ? CSI_FRAME_FLAG_FIRST_WORD_INVALID : 0),
+        .compensate_gain   = compensate_gain,
+    };
+    memcpy(header.mac, info->mac, sizeof(header.mac));
+
+#if !(CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32C61)
+    header.secondary_channel = rx_ctrl->secondary_channel;
+    header.sig_mode          = rx_ctrl->sig_mode;
+    header.mcs               = rx_ctrl->mcs;
+    header.cwb               = rx_ctrl->cwb;
+    header.stbc              = rx_ctrl->stbc;
+    header.sgi               = rx_ctrl->sgi;
+    header.ampdu_cnt         = rx_ctrl->ampdu_cnt;
+    header.rx_misc           = (rx_ctrl->smoothing ? CSI_FRAME_MISC_SMOOTHING : 0)
+                               | (rx_ctrl->not_sounding ? CSI_FRAME_MISC_NOT_SOUNDING : 0)
+                               | (rx_ctrl->aggregation ? CSI_FRAME_MISC_AGGREGATION : 0)
+                               | (rx_ctrl->fec_coding ? CSI_FRAME_MISC_FEC_CODING : 0)
+                               | ((rx_ctrl->ant << CSI_FRAME_MISC_ANT_SHIFT) & CSI_FRAME_MISC_ANT_MASK);
+#endif
+
+    void *frame = NULL;
+
+    if (xRingbufferSendAcquire(s_print_queue, &frame, frame_len, 0) != pdTRUE) {
+        s_print_dropped++;
+        return ESP_ERR_NO_MEM;
+    }
+
+    csi_frame_encode(&header, info->buf, info->len, frame, frame_len);
+    xRingbufferSendComplete(s_print_queue, frame);
+
+    return ESP_OK;
+}
@@ -0,0 +1,431 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief csi_frame_encode() against the documented layout and a bitwise CRC16, then round trips:
+ *
+ * - Every header field and int8 payloads of the CSI lengths up to CSI_FRAME_MAX_PAYLOAD_LEN,
+ *   through csi_frame_decode() and csi_frame_payload_to_int16().
+ * - INT12 payloads, whose upper nibble is ignored and whose values are sign-extended from bit 11.
+ * - The streaming decoder fed the same frames at once, byte by byte and in random chunks.
+ * - Resynchronization behind log text, stray sync bytes, a bad CRC, a bad length and a cut frame.
+ * - Decode throughput of HT40 frames.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "csi_frame.h"
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define STREAM_FRAMES       64
+#define BENCH_FRAMES        100000
+
+static uint32_t s_seed = 0x2026;
+
+static uint32_t rand_u32(void)
+{
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return s_seed;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint16_t crc16_bitwise(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xffff;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (uint16_t)(crc << 1) ^ 0x1021 : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Every header field random, the fields the encoder fills in left as garbage
+ */
+static csi_frame_header_t random_header(uint8_t flags)
+{
+    csi_frame_header_t header;
+    uint8_t *p = (uint8_t *)&header;
+
+    for (size_t i = 0; i < sizeof(header); i++) {
+        p[i] = (uint8_t)rand_u32();
+    }
+
+    header.type = CSI_FRAME_TYPE_CSI;
+    header.flags = flags;
+    header.compensate_gain = (rand_u32() % 4000) / 1000.0f;
+
+    return header;
+}
+
+static size_t random_frame(uint8_t *buf, size_t payload_len, uint8_t flags)
+{
+    uint8_t payload[CSI_FRAME_MAX_PAYLOAD_LEN];
+    csi_frame_header_t header = random_header(flags);
+
+    for (size_t i = 0; i < payload_len; i++) {
+        payload[i] = (uint8_t)rand_u32();
+    }
+
+    return csi_frame_encode(&header, payload, payload_len, buf, CSI_FRAME_MAX_SIZE);
+}
+
+static void test_encode(void)
+{
+    static const uint8_t s_payload[] = {0x01, 0xff, 0x80, 0x7f};
+    csi_frame_header_t header = random_header(0);
+    uint8_t buf[CSI_FRAME_MAX_SIZE];
+
+    header.seq = 0x12345678;
+    header.timestamp = 0x9abcdef0;
+
+    size_t len = csi_frame_encode(&header, s_payload, sizeof(s_payload), buf, sizeof(buf));
+
+    CHECK(len == 44 + sizeof(s_payload) + 2);
+    CHECK(buf[0] == CSI_FRAME_SYNC0 && buf[1] == CSI_FRAME_SYNC1 && buf[2] == CSI_FRAME_VERSION);
+    CHECK(buf[3] == CSI_FRAME_TYPE_CSI);
+    CHECK(buf[4] == len && buf[5] == 0 && buf[6] == sizeof(s_payload) && buf[7] == 0);
+    CHECK(buf[8] == 0x78 && buf[9] == 0x56 && buf[10] == 0x34 && buf[11] == 0x12);
+    CHECK(buf[12] == 0xf0 && buf[15] == 0x9a);
+    CHECK(!memcmp(buf + 16, header.mac, 6));
+    CHECK(!memcmp(buf + 44, s_payload, sizeof(s_payload)));
+
+    uint16_t crc = crc16_bitwise(buf, len - 2);
+    CHECK(buf[len - 2] == (crc & 0xff) && buf[len - 1] == crc >> 8);
+    CHECK(csi_frame_crc16(0xffff, buf, len - 2) == crc);
+
+    /**
+     * @brief A buffer one byte short, or a payload over the limit, encodes nothing
+     */
+    CHECK(csi_frame_encode(&header, s_payload, sizeof(s_payload), buf, len - 1) == 0);
+    CHECK(csi_frame_encode(&header, buf, CSI_FRAME_MAX_PAYLOAD_LEN + 1, buf, sizeof(buf)) == 0);
+    CHECK(csi_frame_encode(&header, NULL, 0, buf, sizeof(buf)) == 44 + 2);
+}
+
+static void check_decode(const uint8_t *buf, size_t len, const csi_frame_header_t *expected,
+                         const uint8_t *payload, size_t payload_len)
+{
+    csi_frame_header_t header;
+    const uint8_t *decoded = NULL;
+    size_t consumed;
+
+    CHECK(csi_frame_decode(buf, len, &header, &decoded, &consumed) == CSI_FRAME_OK);
+    CHECK(consumed == len && decoded == buf + sizeof(csi_frame_header_t));
+    CHECK(header.payload_len == payload_len && header.length == len);
+    CHECK(!memcmp((const uint8_t *)&header + 8, (const uint8_t *)expected + 8, sizeof(header) - 8));
+    CHECK(!memcmp(decoded, payload, payload_len));
+
+    /**
+     * @brief Every proper prefix asks for more
+     */
+    for (size_t cut = 0; cut < len; cut++) {
+        CHECK(csi_frame_decode(buf, cut, &header, &decoded, &consumed) == CSI_FRAME_NEED_MORE);
+        CHECK(consumed == 0);
+    }
+}
+
+static void test_round_trip_int8(void)
+{
+    static const size_t s_lengths[] = {0, 1, 104, 128, 212, 228, 234, 256, 384, 490, 512, CSI_FRAME_MAX_PAYLOAD_LEN};
+
+    for (size_t i = 0; i < sizeof(s_lengths) / sizeof(s_lengths[0]); i++) {
+        size_t payload_len = s_lengths[i];
+        csi_frame_header_t header = random_header(i % 2 ? CSI_FRAME_FLAG_FIRST_WORD_INVALID : 0);
+        uint8_t payload[CSI_FRAME_MAX_PAYLOAD_LEN];
+        uint8_t buf[CSI_FRAME_MAX_SIZE];
+        int16_t values[CSI_FRAME_MAX_PAYLOAD_LEN];
+
+        for (size_t j = 0; j < payload_len; j++) {
+            payload[j] = (uint8_t)(j * 37 + i);
+        }
+
+        size_t len = csi_frame_encode(&header, payload, payload_len, buf, sizeof(buf));
+        CHECK(len == sizeof(csi_frame_header_t) + payload_len + CSI_FRAME_CRC_LEN);
+        check_decode(buf, len, &header, payload, payload_len);
+
+        csi_frame_header_t decoded;
+        memcpy(&decoded, buf, sizeof(decoded));
+        CHECK(csi_frame_payload_to_int16(&decoded, buf + sizeof(decoded), values, sizeof(values) / 2) == payload_len);
+
+        for (size_t j = 0; j < payload_len; j++) {
+            CHECK(values[j] == (int8_t)payload[j]);
+        }
+
+        if (payload_len > 3) {
+            CHECK(csi_frame_payload_to_int16(&decoded, buf + sizeof(decoded), values, 3) == 3);
+        }
+    }
+}
+
+static void test_round_trip_int12(void)
+{
+    static const size_t s_counts[] = {0, 1, 53, 64, 128, 256, CSI_FRAME_MAX_PAYLOAD_LEN / 2};
+
+    for (size_t i = 0; i < sizeof(s_counts) / sizeof(s_counts[0]); i++) {
+        size_t count = s_counts[i];
+        csi_frame_header_t header = random_header(CSI_FRAME_FLAG_PAYLOAD_INT12);
+        uint8_t payload[CSI_FRAME_MAX_PAYLOAD_LEN];
+        int16_t expected[CSI_FRAME_MAX_PAYLOAD_LEN / 2];
+        int16_t values[CSI_FRAME_MAX_PAYLOAD_LEN / 2];
+        uint8_t buf[CSI_FRAME_MAX_SIZE];
+
+        /**
+         * @brief The extremes first, then random values; the upper nibble carries noise
+         */
+        for (size_t j = 0; j < count; j++) {
+            int16_t value = j == 0 ? -2048 : j == 1 ? 2047 : j == 2 ? -1 : (int16_t)(rand_u32() % 4096) - 2048;
+            uint16_t word = (uint16_t)(value & 0xfff) | (uint16_t)((rand_u32() & 0xf) << 12);
+
+            expected[j] = value;
+            payload[2 * j] = word & 0xff;
+            payload[2 * j + 1] = word >> 8;
+        }
+
+        size_t len = csi_frame_encode(&header, payload, count * 2, buf, sizeof(buf));
+        check_decode(buf, len, &header, payload, count * 2);
+
+        csi_frame_header_t decoded;
+        memcpy(&decoded, buf, sizeof(decoded));
+        CHECK(csi_frame_payload_to_int16(&decoded, buf + sizeof(decoded), values, count) == count);
+        CHECK(!memcmp(values, expected, count * sizeof(int16_t)));
+    }
+
+    /**
+     * @brief An odd trailing byte is not half a value
+     */
+    csi_frame_header_t header = {.payload_len = 3, .flags = CSI_FRAME_FLAG_PAYLOAD_INT12};
+    static const uint8_t s_odd[] = {0xff, 0x07, 0x12};
+    int16_t value;
+
+    CHECK(csi_frame_payload_to_int16(&header, s_odd, &value, 4) == 1 && value == 2047);
+}
+
+/**
+ * @brief Frames as delivered by the streaming decoder: seq and payload checksum
+ */
+typedef struct {
+    uint32_t seq[STREAM_FRAMES * 2];
+    uint16_t crc[STREAM_FRAMES * 2];
+    size_t count;
+} frame_log_t;
+
+static void log_cb(const csi_frame_header_t *header, const uint8_t *payload, void *ctx)
+{
+    frame_log_t *log = ctx;
+
+    CHECK(log->count < STREAM_FRAMES * 2);
+    log->seq[log->count] = header->seq;
+    log->crc[log->count] = csi_frame_crc16(0xffff, payload, header->payload_len);
+    log->count++;
+}
+
+/**
+ * @brief STREAM_FRAMES frames of random lengths, logged as expected
+ */
+static size_t build_stream(uint8_t *stream, frame_log_t *expected)
+{
+    size_t len = 0;
+
+    memset(expected, 0, sizeof(frame_log_t));
+
+    for (uint32_t i = 0; i < STREAM_FRAMES; i++) {
+        size_t n = random_frame(stream + len, rand_u32() % 600, i % 3 ? 0 : CSI_FRAME_FLAG_PAYLOAD_INT12);
+        csi_frame_header_t *header = (csi_frame_header_t *)(stream + len);
+
+        header->seq = i;
+        uint16_t crc = csi_frame_crc16(0xffff, stream + len, n - 2);
+        stream[len + n - 2] = crc & 0xff;
+        stream[len + n - 1] = crc >> 8;
+        log_cb(header, stream + len + sizeof(csi_frame_header_t), expected);
+        len += n;
+    }
+
+    return len;
+}
+
+static void check_log(const frame_log_t *log, const frame_log_t *expected)
+{
+    CHECK(log->count == expected->count);
+    CHECK(!memcmp(log->seq, expected->seq, log->count * sizeof(log->seq[0])));
+    CHECK(!memcmp(log->crc, expected->crc, log->count * sizeof(log->crc[0])));
+}
+
+static void test_stream(void)
+{
+    static uint8_t stream[STREAM_FRAMES * CSI_FRAME_MAX_SIZE];
+    static frame_log_t expected, log;
+    static csi_frame_decoder_t decoder;
+    size_t len = build_stream(stream, &expected);
+
+    for (int mode = 0; mode < 3; mode++) {
+        memset(&log, 0, sizeof(log));
+        csi_frame_decoder_init(&decoder);
+
+        size_t frames = 0;
+
+        for (size_t offset = 0; offset < len;) {
+            size_t chunk = mode == 0 ? len : mode == 1 ? 1 : 1 + rand_u32() % 300;
+            chunk = chunk < len - offset ? chunk : len - offset;
+            frames += csi_frame_decoder_feed(&decoder, stream + offset, chunk, log_cb, &log);
+            offset += chunk;
+        }
+
+        check_log(&log, &expected);
+        CHECK(frames == STREAM_FRAMES && decoder.frame_count == STREAM_FRAMES);
+        CHECK(decoder.error_count == 0 && decoder.skipped_bytes == 0 && decoder.len == 0);
+    }
+}
+
+static void test_resync(void)
+{
+    static uint8_t stream[STREAM_FRAMES * CSI_FRAME_MAX_SIZE * 2];
+    static uint8_t frames[STREAM_FRAMES * CSI_FRAME_MAX_SIZE];
+    static frame_log_t all, expected, log;
+    static csi_frame_decoder_t decoder;
+    size_t frames_len = build_stream(frames, &all);
+    size_t len = 0;
+    size_t offset = 0;
+
+    memset(&expected, 0, sizeof(expected));
+
+    /**
+     * @brief Every even frame is damaged and must be dropped without costing the next one;
+     *        log text or stray sync bytes follow most frames
+     */
+    for (size_t i = 0; i < STREAM_FRAMES; i++) {
+        const csi_frame_header_t *header = (const csi_frame_header_t *)(frames + offset);
+        size_t n = header->length;
+        uint8_t *out = stream + len;
+
+        memcpy(out, frames + offset, n);
+
+        switch (i % 8) {
+        case 0:
+            out[sizeof(csi_frame_header_t) + (n > 46 ? 1 : -2)] ^= 0x40;      /**< Bad CRC */
+            break;
+        case 2:
+            out[4] ^= 0x01;                                                 /**< Length off by one */
+            break;
+        case 4:
+            n = n / 2;                                                      /**< Cut, the next frame follows */
+            break;
+        case 6:
+            out[1] = 0x00;                                                  /**< Broken sync */
+            break;
+        default:
+            expected.seq[expected.count] = all.seq[i];
+            expected.crc[expected.count] = all.crc[i];
+            expected.count++;
+        }
+
+        len += n;
+        offset += header->length;
+
+        static const char *s_garbage[] = {"I (1234) csi_recv: text\n", "\xc5", "\xc5\x1f", "\xc5\x1f\x01", ""};
+        const char *garbage = s_garbage[i % 5];
+        memcpy(stream + len, garbage, strlen(garbage));
+        len += strlen(garbage);
+    }
+
+    for (int mode = 0; mode < 3; mode++) {
+        memset(&log, 0, sizeof(log));
+        csi_frame_decoder_init(&decoder);
+
+        for (size_t at = 0; at < len;) {
+            size_t chunk = mode == 0 ? len : mode == 1 ? 1 : 1 + rand_u32() % 500;
+            chunk = chunk < len - at ? chunk : len - at;
+            csi_frame_decoder_feed(&decoder, stream + at, chunk, log_cb, &log);
+            at += chunk;
+        }
+
+        /**
+         * @brief A cut frame may hide the last frame until more bytes arrive: flush with one more
+         */
+        uint8_t tail[CSI_FRAME_MAX_SIZE * 2];
+        size_t tail_len = random_frame(tail, CSI_FRAME_MAX_PAYLOAD_LEN, 0);
+        tail_len += random_frame(tail + tail_len, CSI_FRAME_MAX_PAYLOAD_LEN, 0);
+        csi_frame_decoder_feed(&decoder, tail, tail_len, NULL, NULL);
+
+        CHECK(log.count == expected.count);
+        CHECK(!memcmp(log.seq, expected.seq, log.count * sizeof(log.seq[0])));
+        CHECK(!memcmp(log.crc, expected.crc, log.count * sizeof(log.crc[0])));
+        CHECK(decoder.error_count >= STREAM_FRAMES / 8 * 2 && decoder.skipped_bytes > 0);
+        CHECK(frames_len == offset);
+    }
+}
+
+static void count_cb(const csi_frame_header_t *header, const uint8_t *payload, void *ctx)
+{
+    (void)payload;
+    *(size_t *)ctx += header->payload_len;
+}
+
+static void benchmark(void)
+{
+    static uint8_t stream[64 * CSI_FRAME_MAX_SIZE];
+    csi_frame_decoder_t *decoder = malloc(sizeof(csi_frame_decoder_t));
+    size_t len = 0;
+    size_t bytes = 0;
+
+    CHECK(decoder);
+
+    for (int i = 0; i < 64; i++) {
+        len += random_frame(stream + len, 490, 0);
+    }
+
+    csi_frame_decoder_init(decoder);
+
+    double start = now();
+    for (int i = 0; i < BENCH_FRAMES / 64; i++) {
+        for (size_t offset = 0; offset < len; offset += 256) {
+            csi_frame_decoder_feed(decoder, stream + offset, len - offset < 256 ? len - offset : 256, count_cb, &bytes);
+        }
+    }
+    double elapsed = now() - start;
+
+    CHECK(decoder->frame_count == BENCH_FRAMES / 64 * 64);
+    printf("decode of 490-byte frames in 256-byte reads: %.0f frames/s, %.0f MB/s\n",
+           decoder->frame_count / elapsed, len * (BENCH_FRAMES / 64) / elapsed / 1e6);
+
+    free(decoder);
+}
+
+int main(void)
+{
+    test_encode();
+    test_round_trip_int8();
+    test_round_trip_int12();
+    test_stream();
+    test_resync();
+    benchmark();
+
+    printf("test_csi_frame: all tests passed\n");
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Compact binary CSI frame format
+ *
+ * A frame is laid out as `csi_frame_header_t | payload | crc16`, all fields
+ * little-endian. The encoder and the decoder are plain C99 with no ESP-IDF
+ * dependency, so this file and csi_frame.c can be built on a host to decode
+ * captured serial streams.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSI_FRAME_SYNC0                 0xC5
+#define CSI_FRAME_SYNC1                 0x1F
+#define CSI_FRAME_VERSION               1
+
+#define CSI_FRAME_MAX_PAYLOAD_LEN       1024
+#define CSI_FRAME_CRC_LEN               2
+#define CSI_FRAME_MAX_SIZE              (sizeof(csi_frame_header_t) + CSI_FRAME_MAX_PAYLOAD_LEN + CSI_FRAME_CRC_LEN)
+
+/**
+ * @brief Frame types
+ */
+typedef enum {
+    CSI_FRAME_TYPE_CSI = 1,          /**< Raw `wifi_csi_info_t` I/Q payload */
+    CSI_FRAME_TYPE_REPLAY,           /**< Recorded esp-radar input, see CSI_FRAME_REPLAY_TIMESTAMP_LEN */
+} csi_frame_type_t;
+
+/**
+ * @brief A CSI_FRAME_TYPE_REPLAY payload starts with the recording's wall-clock timestamp text,
+ *        NUL-padded to this length, followed by the `wifi_csi_filtered_info_t::valid_data` bytes.
+ *        `timestamp` in the header is the `rx_ctrl` timestamp of the recorded packet.
+ */
+#define CSI_FRAME_REPLAY_TIMESTAMP_LEN  32
+
+/**
+ * @brief Bits of `csi_frame_header_t::flags`
+ */
+#define CSI_FRAME_FLAG_FIRST_WORD_INVALID   (1 << 0)  /**< First four bytes of the payload are invalid */
+#define CSI_FRAME_FLAG_PAYLOAD_INT12        (1 << 1)  /**< Payload is 12-bit signed values in 16-bit LE words (forced LLTF), otherwise int8 */
+
+/**
+ * @brief Bits of `csi_frame_header_t::rx_misc`
+ */
+#define CSI_FRAME_MISC_SMOOTHING            (1 << 0)
+#define CSI_FRAME_MISC_NOT_SOUNDING         (1 << 1)
+#define CSI_FRAME_MISC_AGGREGATION          (1 << 2)
+#define CSI_FRAME_MISC_FEC_CODING           (1 << 3)
+#define CSI_FRAME_MISC_ANT_SHIFT            4
+#define CSI_FRAME_MISC_ANT_MASK             (0x3 << CSI_FRAME_MISC_ANT_SHIFT)
+
+/**
+ * @brief Fixed frame header, followed by `payload_len` bytes of I/Q and a CRC16
+ *
+ * Fields that a target does not report (e.g. `sig_mode` on ESP32-C5/C6) are zero.
+ */
+typedef struct {
+    uint8_t  sync[2];                /**< CSI_FRAME_SYNC0, CSI_FRAME_SYNC1 */
+    uint8_t  version;                /**< CSI_FRAME_VERSION */
+    uint8_t  type;                   /**< csi_frame_type_t */
+    uint16_t length;                 /**< Total frame length including header and CRC */
+    uint16_t payload_len;            /**< Length of the I/Q payload in bytes */
+    uint32_t seq;                    /**< Sequence id */
+    uint32_t timestamp;              /**< Local timestamp of the received packet, in microseconds */
+    uint8_t  mac[6];                 /**< Source MAC address of the packet */
+    int8_t   rssi;
+    int8_t   noise_floor;
+    uint8_t  rate;
+    uint8_t  sig_mode;
+    uint8_t  mcs;
+    uint8_t  cwb;
+    uint8_t  channel;
+    uint8_t  secondary_channel;
+    uint8_t  stbc;
+    uint8_t  sgi;
+    uint16_t sig_len;
+    uint8_t  rx_state;
+    uint8_t  agc_gain;
+    int8_t   fft_gain;
+    uint8_t  flags;                  /**< CSI_FRAME_FLAG_* */
+    uint8_t  ampdu_cnt;
+    uint8_t  rx_misc;                /**< CSI_FRAME_MISC_* */
+    float    compensate_gain;        /**< Gain compensation factor, not applied to the payload */
+} __attribute__((packed)) csi_frame_header_t;
+
+_Static_assert(sizeof(csi_frame_header_t) == 44, "csi_frame_header_t is part of the wire format");
+
+/**
+ * @brief Result of decoding a frame
+ */
+typedef enum {
+    CSI_FRAME_OK = 0,                /**< A complete, valid frame was decoded */
+    CSI_FRAME_NEED_MORE,             /**< The buffer holds the start of a frame but not all of it */
+    CSI_FRAME_INVALID,               /**< The buffer does not start with a valid frame */
+} csi_frame_status_t;
+
+/**
+ * @brief Compute the CRC16-CCITT (poly 0x1021, init 0xFFFF) of a buffer
+ */
+uint16_t csi_frame_crc16(uint16_t crc, const void *data, size_t len);
+
+/**
+ * @brief Encode a frame
+ *
+ * @param header      Header fields; sync, version, length and payload_len are filled in by the encoder
+ * @param payload     Raw I/Q bytes
+ * @param payload_len Length of payload, at most CSI_FRAME_MAX_PAYLOAD_LEN
+ * @param buf         Output buffer
+ * @param size        Size of buf
+ *
+ * @return Number of bytes written, or 0 if the payload is too long or buf is too small
+ */
+size_t csi_frame_encode(const csi_frame_header_t *header, const void *payload, size_t payload_len,
+                        uint8_t *buf, size_t size);
+
+/**
+ * @brief Decode one frame from the start of a buffer
+ *
+ * @param data     Input bytes
+ * @param len      Number of input bytes
+ * @param header   Decoded header, valid when CSI_FRAME_OK is returned
+ * @param payload  Points into data at the payload, valid when CSI_FRAME_OK is returned
+ * @param consumed Bytes to drop from the input: the frame size on CSI_FRAME_OK,
+ *                 1 on CSI_FRAME_INVALID, 0 on CSI_FRAME_NEED_MORE
+ */
+csi_frame_status_t csi_frame_decode(const uint8_t *data, size_t len, csi_frame_header_t *header,
+                                    const uint8_t **payload, size_t *consumed);
+
+/**
+ * @brief Expand a payload to signed 16-bit I/Q values
+ *
+ * @return Number of values written to out
+ */
+size_t csi_frame_payload_to_int16(const csi_frame_header_t *header, const uint8_t *payload,
+                                  int16_t *out, size_t max_count);
+
+typedef void (*csi_frame_cb_t)(const csi_frame_header_t *header, const uint8_t *payload, void *ctx);
+
+/**
+ * @brief Streaming decoder that resynchronizes on the sync bytes after garbage or corrupted frames
+ */
+typedef struct {
+    uint8_t  buf[CSI_FRAME_MAX_SIZE];
+    size_t   len;
+    uint32_t frame_count;            /**< Frames delivered */
+    uint32_t error_count;            /**< Frames rejected by length or CRC check */
+    uint32_t skipped_bytes;          /**< Bytes discarded while searching for sync */
+} csi_frame_decoder_t;
+
+void csi_frame_decoder_init(csi_frame_decoder_t *decoder);
+
+/**
+ * @brief Feed bytes into the decoder, calling cb for every complete frame
+ *
+ * @return Number of frames delivered by this call
+ */
+size_t csi_frame_decoder_feed(csi_frame_decoder_t *decoder, const uint8_t *data, size_t len,
+                              csi_frame_cb_t cb, void *ctx);
+
+#ifdef ESP_PLATFORM
+#include "esp_err.h"
+#include "esp_wifi_types.h"
+
+/**
+ * @brief Install the console UART driver and start the task that writes queued frames to it
+ */
+esp_err_t csi_frame_print_init(void);
+
+/**
+ * @brief Encode a received CSI packet and queue it for the console UART
+ *
+ * Never blocks and may be called from several tasks, including the Wi-Fi CSI callback.
+ * The frame is encoded into a ring buffer drained by a print task; when the ring buffer
+ * is full the frame is dropped and counted, see csi_frame_print_dropped().
+ *
+ * @param flags Extra CSI_FRAME_FLAG_* bits, e.g. CSI_FRAME_FLAG_PAYLOAD_INT12 when `acquire_csi_force_lltf` is set
+ *
+ * @return
+ *    - ESP_OK: The frame is queued
+ *    - ESP_ERR_NO_MEM: The queue is full and the frame was dropped
+ *    - ESP_ERR_INVALID_SIZE: The payload is longer than CSI_FRAME_MAX_PAYLOAD_LEN
+ *    - ESP_ERR_INVALID_STATE: csi_frame_print_init() has not been called
+ */
+esp_err_t csi_frame_print(const wifi_csi_info_t *info, uint32_t seq, uint8_t agc_gain,
+                          int8_t fft_gain, float compensate_gain, uint8_t flags);
+
+/**
+ * @brief Number of frames dropped by csi_frame_print() because the print queue was full
+ */
+uint32_t csi_frame_print_dropped(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
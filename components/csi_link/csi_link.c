@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "csi_frame.h"
+#include "csi_link.h"
+
+size_t csi_link_encode(uint8_t type, const void *payload, size_t payload_len, uint8_t *buf, size_t size)
+{
+    size_t frame_len = CSI_LINK_FRAME_SIZE(payload_len);
+
+    if (payload_len > CSI_LINK_MAX_PAYLOAD_LEN || size < frame_len) {
+        return 0;
+    }
+
+    buf[0] = CSI_LINK_SYNC0;
+    buf[1] = CSI_LINK_SYNC1;
+    buf[2] = type;
+    buf[3] = (uint8_t)payload_len;
+
+    if (payload_len) {
+        memcpy(buf + CSI_LINK_HEADER_LEN, payload, payload_len);
+    }
+
+    uint16_t crc = csi_frame_crc16(0xffff, buf, frame_len - CSI_LINK_CRC_LEN);
+    buf[frame_len - 2] = crc & 0xff;
+    buf[frame_len - 1] = crc >> 8;
+
+    return frame_len;
+}
+
+void csi_link_decoder_init(csi_link_decoder_t *decoder)
+{
+    memset(decoder, 0, sizeof(csi_link_decoder_t));
+}
+
+size_t csi_link_decoder_feed(csi_link_decoder_t *decoder, const uint8_t *data, size_t len,
+                             csi_link_cb_t cb, void *ctx)
+{
+    size_t frames = 0;
+
+    while (len > 0) {
+        size_t copy = sizeof(decoder->buf) - decoder->len;
+
+        if (copy > len) {
+            copy = len;
+        }
+
+        memcpy(decoder->buf + decoder->len, data, copy);
+        decoder->len += copy;
+        data += copy;
+        len  -= copy;
+
+        size_t offset = 0;
+
+        while (offset < decoder->len) {
+            const uint8_t *frame = decoder->buf + offset;
+            size_t avail = decoder->len - offset;
+
+            if (frame[0] == CSI_LINK_SYNC0 && (avail < 2 || frame[1] == CSI_LINK_SYNC1)) {
+                if (avail < CSI_LINK_HEADER_LEN) {
+                    break;
+                }
+
+                size_t frame_len = CSI_LINK_FRAME_SIZE(frame[3]);
+
+                if (avail < frame_len) {
+                    break;
+                }
+
+                uint16_t crc = csi_frame_crc16(0xffff, frame, frame_len - CSI_LINK_CRC_LEN);
+
+                if ((crc & 0xff) == frame[frame_len - 2] && (crc >> 8) == frame[frame_len - 1]) {
+                    decoder->frame_count++;
+                    frames++;
+
+                    if (cb) {
+                        cb(frame[2], frame + CSI_LINK_HEADER_LEN, frame[3], ctx);
+                    }
+
+                    offset += frame_len;
+                    continue;
+                }
+
+                /**
+                 * @brief A corrupted frame, or sync bytes inside other data: rescan from the next byte,
+                 *        a real frame may start within the bytes the bad length claimed
+                 */
+                decoder->error_count++;
+            }
+
+            /**< Skip to the next candidate sync byte */
+            const uint8_t *next = memchr(frame + 1, CSI_LINK_SYNC0, avail - 1);
+            size_t skip = next ? (size_t)(next - frame) : avail;
+            decoder->skipped_bytes += skip;
+            offset += skip;
+        }
+
+        decoder->len -= offset;
+
+        if (decoder->len && offset) {
+            memmove(decoder->buf, decoder->buf + offset, decoder->len);
+        }
+    }
+
+    return frames;
+}
@@ -0,0 +1,389 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief csi_link_encode() against the documented layout and a bitwise CRC16, and the streaming
+ *        decoder against a reference that scans the whole stream at once:
+ *
+ * - Every payload length round-trips, fed at once and byte by byte.
+ * - Garbage, truncated and corrupted frames in front of a valid one never cost that frame.
+ * - Fuzzed streams (valid frames mixed with garbage, cut frames, bit flips and bad lengths)
+ *   split into random chunk sizes deliver exactly the frames of the reference, in order.
+ * - Decode throughput for the 28-byte CIR records of esp-crab at several UART read sizes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "csi_frame.h"
+#include "csi_link.h"
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define FUZZ_STREAMS        2000
+#define FUZZ_STREAM_SIZE    8192
+#define CIR_PAYLOAD_LEN     28          /**< esp-crab CRAB_LINK_TYPE_CIR record */
+#define BENCH_FRAMES        200000
+
+static uint32_t s_seed = 0x2026;
+
+static uint32_t rand_u32(void)
+{
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return s_seed;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Frames as delivered: type, length and payload back to back
+ */
+typedef struct {
+    uint8_t data[FUZZ_STREAM_SIZE * 2];
+    size_t len;
+    size_t count;
+} frame_log_t;
+
+static void log_frame(frame_log_t *log, uint8_t type, const uint8_t *payload, size_t payload_len)
+{
+    CHECK(payload_len <= CSI_LINK_MAX_PAYLOAD_LEN);
+    CHECK(log->len + 2 + payload_len <= sizeof(log->data));
+
+    log->data[log->len++] = type;
+    log->data[log->len++] = (uint8_t)payload_len;
+    memcpy(log->data + log->len, payload, payload_len);
+    log->len += payload_len;
+    log->count++;
+}
+
+static void log_cb(uint8_t type, const uint8_t *payload, size_t payload_len, void *ctx)
+{
+    log_frame(ctx, type, payload, payload_len);
+}
+
+static uint16_t crc16_bitwise(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xffff;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (uint16_t)(crc << 1) ^ 0x1021 : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief The whole stream at once: a frame is taken wherever sync, length and CRC check out,
+ *        otherwise the scan moves on by one byte. Like the decoder, it stops at a candidate
+ *        whose claimed length runs past the end, since more bytes could still complete it.
+ */
+static void reference_decode(const uint8_t *stream, size_t len, frame_log_t *log)
+{
+    for (size_t i = 0; i < len;) {
+        const uint8_t *frame = stream + i;
+        size_t avail = len - i;
+
+        if (frame[0] == CSI_LINK_SYNC0 && (avail < 2 || frame[1] == CSI_LINK_SYNC1)) {
+            if (avail < CSI_LINK_HEADER_LEN || avail < (size_t)CSI_LINK_FRAME_SIZE(frame[3])) {
+                return;
+            }
+
+            size_t frame_len = CSI_LINK_FRAME_SIZE(frame[3]);
+
+            if (crc16_bitwise(frame, frame_len - CSI_LINK_CRC_LEN) == (frame[frame_len - 2] | frame[frame_len - 1] << 8)) {
+                log_frame(log, frame[2], frame + CSI_LINK_HEADER_LEN, frame[3]);
+                i += frame_len;
+                continue;
+            }
+        }
+
+        i++;
+    }
+}
+
+static size_t random_frame(uint8_t *buf, size_t max_payload_len)
+{
+    uint8_t payload[CSI_LINK_MAX_PAYLOAD_LEN];
+    size_t payload_len = rand_u32() % (max_payload_len + 1);
+
+    for (size_t i = 0; i < payload_len; i++) {
+        payload[i] = (uint8_t)rand_u32();
+    }
+
+    return csi_link_encode((uint8_t)rand_u32(), payload, payload_len, buf, CSI_LINK_MAX_FRAME_SIZE);
+}
+
+static void test_encode(void)
+{
+    static uint8_t payload[CSI_LINK_MAX_PAYLOAD_LEN + 1], buf[CSI_LINK_MAX_FRAME_SIZE + 8];
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)rand_u32();
+    }
+
+    for (size_t payload_len = 0; payload_len <= CSI_LINK_MAX_PAYLOAD_LEN; payload_len++) {
+        size_t frame_len = CSI_LINK_FRAME_SIZE(payload_len);
+
+        memset(buf, 0x5a, sizeof(buf));
+        CHECK(csi_link_encode(0x42, payload, payload_len, buf, frame_len - 1) == 0);
+        CHECK(csi_link_encode(0x42, payload, payload_len, buf, frame_len) == frame_len);
+
+        CHECK(buf[0] == CSI_LINK_SYNC0 && buf[1] == CSI_LINK_SYNC1 && buf[2] == 0x42 && buf[3] == payload_len);
+        CHECK(!memcmp(buf + CSI_LINK_HEADER_LEN, payload, payload_len));
+        CHECK((buf[frame_len - 2] | buf[frame_len - 1] << 8) == crc16_bitwise(buf, frame_len - CSI_LINK_CRC_LEN));
+        CHECK(csi_frame_crc16(0xffff, buf, frame_len - CSI_LINK_CRC_LEN) == crc16_bitwise(buf, frame_len - CSI_LINK_CRC_LEN));
+        CHECK(buf[frame_len] == 0x5a);
+    }
+
+    CHECK(csi_link_encode(0, payload, CSI_LINK_MAX_PAYLOAD_LEN + 1, buf, sizeof(buf)) == 0);
+    CHECK(csi_link_encode(0, NULL, 0, buf, CSI_LINK_FRAME_SIZE(0)) == CSI_LINK_FRAME_SIZE(0));
+}
+
+static void test_round_trip(void)
+{
+    static uint8_t stream[CSI_LINK_MAX_FRAME_SIZE];
+    static frame_log_t log, expected;
+    csi_link_decoder_t decoder;
+
+    for (size_t payload_len = 0; payload_len <= CSI_LINK_MAX_PAYLOAD_LEN; payload_len++) {
+        uint8_t payload[CSI_LINK_MAX_PAYLOAD_LEN];
+
+        for (size_t i = 0; i < payload_len; i++) {
+            payload[i] = (uint8_t)(i * 31 + payload_len);
+        }
+
+        size_t len = csi_link_encode((uint8_t)payload_len, payload, payload_len, stream, sizeof(stream));
+        expected.len = expected.count = 0;
+        log_frame(&expected, (uint8_t)payload_len, payload, payload_len);
+
+        for (int bytewise = 0; bytewise <= 1; bytewise++) {
+            log.len = log.count = 0;
+            csi_link_decoder_init(&decoder);
+
+            for (size_t offset = 0; offset < len;) {
+                size_t n = bytewise ? 1 : len;
+                CHECK(csi_link_decoder_feed(&decoder, stream + offset, n, log_cb, &log) == (size_t)(offset + n == len));
+                offset += n;
+            }
+
+            CHECK(log.len == expected.len && !memcmp(log.data, expected.data, log.len));
+            CHECK(decoder.frame_count == 1 && decoder.error_count == 0 && decoder.skipped_bytes == 0);
+            CHECK(decoder.len == 0);
+        }
+    }
+}
+
+/**
+ * @brief Whatever comes in front, the valid frame behind it must be delivered once the stream
+ *        has moved CSI_LINK_MAX_FRAME_SIZE bytes past the bad data
+ */
+static void test_resync(void)
+{
+    static uint8_t stream[4 * CSI_LINK_MAX_FRAME_SIZE];
+    uint8_t good[CSI_LINK_MAX_FRAME_SIZE], bad[CSI_LINK_MAX_FRAME_SIZE];
+    static frame_log_t log;
+    csi_link_decoder_t decoder;
+
+    for (int round = 0; round < 10000; round++) {
+        size_t good_len = random_frame(good, CSI_LINK_MAX_PAYLOAD_LEN);
+        size_t bad_len = random_frame(bad, CSI_LINK_MAX_PAYLOAD_LEN);
+        size_t len = 0;
+
+        switch (round % 5) {
+        case 0:     // Sync bytes followed by noise
+            bad[0] = CSI_LINK_SYNC0;
+            bad[1] = CSI_LINK_SYNC1;
+            for (size_t i = 2; i < bad_len; i++) {
+                bad[i] = (uint8_t)rand_u32();
+            }
+            break;
+        case 1:     // Cut short, its length byte claims bytes of the good frame
+            bad_len = CSI_LINK_HEADER_LEN + rand_u32() % (bad_len - CSI_LINK_HEADER_LEN);
+            break;
+        case 2:     // One bit flipped
+            bad[rand_u32() % bad_len] ^= 1 << (rand_u32() % 8);
+            break;
+        case 3:     // Length byte corrupted, the CRC is checked over the wrong span
+            bad[3] ^= (uint8_t)(1 + rand_u32() % 255);
+            break;
+        default:    // A lone sync byte right in front
+            bad_len = 1;
+            bad[0] = CSI_LINK_SYNC0;
+            break;
+        }
+
+        memcpy(stream + len, bad, bad_len);
+        len += bad_len;
+        memcpy(stream + len, good, good_len);
+        len += good_len;
+
+        /**
+         * @brief Padding ends any claim the bad length byte still holds
+         */
+        memset(stream + len, 0, CSI_LINK_MAX_FRAME_SIZE);
+        len += CSI_LINK_MAX_FRAME_SIZE;
+
+        log.len = log.count = 0;
+        csi_link_decoder_init(&decoder);
+        csi_link_decoder_feed(&decoder, stream, len, log_cb, &log);
+
+        size_t good_entry_len = 2 + good[3];
+
+        CHECK(log.count >= 1 && log.len >= good_entry_len);
+        CHECK(log.data[log.len - good_entry_len] == good[2] && log.data[log.len - good_entry_len + 1] == good[3]);
+        CHECK(!memcmp(log.data + log.len - good[3], good + CSI_LINK_HEADER_LEN, good[3]));
+        CHECK(round % 5 == 4 || decoder.error_count >= 1 || decoder.skipped_bytes >= 1);
+    }
+}
+
+/**
+ * @brief Valid frames, biased garbage, cut frames and flipped bits, mostly small payloads like the real link
+ */
+static size_t fuzz_stream(uint8_t *stream, size_t size)
+{
+    uint8_t frame[CSI_LINK_MAX_FRAME_SIZE];
+    size_t len = 0;
+
+    while (len + CSI_LINK_MAX_FRAME_SIZE <= size) {
+        uint32_t what = rand_u32() % 16;
+        size_t frame_len = random_frame(frame, rand_u32() % 4 ? 40 : CSI_LINK_MAX_PAYLOAD_LEN);
+
+        if (what == 0) {
+            frame_len = 1 + rand_u32() % (frame_len - 1);
+        } else if (what == 1) {
+            frame[rand_u32() % frame_len] ^= 1 << (rand_u32() % 8);
+        } else if (what == 2) {
+            frame[3] = (uint8_t)rand_u32();
+        } else if (what <= 4) {
+            static const uint8_t s_alphabet[] = {CSI_LINK_SYNC0, CSI_LINK_SYNC1, 0x00, 0xff};
+            frame_len = rand_u32() % 32;
+
+            for (size_t i = 0; i < frame_len; i++) {
+                frame[i] = rand_u32() % 2 ? s_alphabet[rand_u32() % 4] : (uint8_t)rand_u32();
+            }
+        }
+
+        memcpy(stream + len, frame, frame_len);
+        len += frame_len;
+    }
+
+    return len;
+}
+
+static void test_fuzz(void)
+{
+    static uint8_t stream[FUZZ_STREAM_SIZE];
+    static frame_log_t log, expected;
+    csi_link_decoder_t decoder;
+    uint64_t frames = 0, errors = 0;
+
+    for (int round = 0; round < FUZZ_STREAMS; round++) {
+        size_t len = fuzz_stream(stream, sizeof(stream));
+        size_t max_chunk = (size_t[]) {1, 7, 64, 300, FUZZ_STREAM_SIZE}[round % 5];
+
+        expected.len = expected.count = 0;
+        reference_decode(stream, len, &expected);
+
+        log.len = log.count = 0;
+        csi_link_decoder_init(&decoder);
+
+        for (size_t offset = 0; offset < len;) {
+            size_t n = 1 + rand_u32() % max_chunk;
+            n = n < len - offset ? n : len - offset;
+
+            csi_link_decoder_feed(&decoder, stream + offset, n, log_cb, &log);
+            offset += n;
+        }
+
+        CHECK(log.count == expected.count && decoder.frame_count == expected.count);
+        CHECK(log.len == expected.len && !memcmp(log.data, expected.data, log.len));
+        CHECK(decoder.len <= CSI_LINK_MAX_FRAME_SIZE);
+
+        frames += decoder.frame_count;
+        errors += decoder.error_count;
+    }
+
+    printf("fuzz: %d streams, %llu frames delivered, %llu candidates rejected by the CRC\n",
+           FUZZ_STREAMS, (unsigned long long)frames, (unsigned long long)errors);
+}
+
+static void count_cb(uint8_t type, const uint8_t *payload, size_t payload_len, void *ctx)
+{
+    (void)type;
+    (void)payload;
+    *(size_t *)ctx += payload_len;
+}
+
+static void benchmark(void)
+{
+    static const size_t s_chunks[] = {1, 34, 128, 1024};
+    const size_t frame_len = CSI_LINK_FRAME_SIZE(CIR_PAYLOAD_LEN);
+    uint8_t *stream = malloc(BENCH_FRAMES * frame_len);
+    uint8_t payload[CIR_PAYLOAD_LEN];
+    csi_link_decoder_t decoder;
+
+    CHECK(stream);
+
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        for (size_t j = 0; j < sizeof(payload); j++) {
+            payload[j] = (uint8_t)rand_u32();
+        }
+
+        csi_link_encode(1, payload, sizeof(payload), stream + i * frame_len, frame_len);
+    }
+
+    for (size_t c = 0; c < sizeof(s_chunks) / sizeof(s_chunks[0]); c++) {
+        size_t total = BENCH_FRAMES * frame_len, delivered = 0;
+
+        csi_link_decoder_init(&decoder);
+        double start = now();
+
+        for (size_t offset = 0; offset < total; offset += s_chunks[c]) {
+            size_t n = s_chunks[c] < total - offset ? s_chunks[c] : total - offset;
+            csi_link_decoder_feed(&decoder, stream + offset, n, count_cb, &delivered);
+        }
+
+        double elapsed = now() - start;
+
+        CHECK(decoder.frame_count == BENCH_FRAMES && delivered == BENCH_FRAMES * sizeof(payload));
+        printf("decode %zu-byte frames in %4zu-byte reads: %.1f Mframes/s, %.0f MB/s\n",
+               frame_len, s_chunks[c], BENCH_FRAMES / elapsed / 1e6, total / elapsed / 1e6);
+    }
+
+    free(stream);
+}
+
+int main(void)
+{
+    test_encode();
+    test_round_trip();
+    test_resync();
+    test_fuzz();
+    benchmark();
+
+    printf("test_csi_link: all tests passed\n");
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Length and CRC16 framed records for board-to-board serial links
+ *
+ * A frame is laid out as `sync0 sync1 type length | payload | crc16`, the CRC
+ * (csi_frame_crc16(), little-endian) covering everything before it. The
+ * streaming decoder takes the byte stream in chunks of any size, so frames
+ * split across UART reads are reassembled, and resynchronizes on the next
+ * sync bytes after garbage, truncated or corrupted frames without losing a
+ * valid frame that starts inside them.
+ *
+ * No ESP-IDF dependency beyond csi_frame, everything builds on a host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSI_LINK_SYNC0                  0xAA
+#define CSI_LINK_SYNC1                  0x55
+
+#define CSI_LINK_HEADER_LEN             4
+#define CSI_LINK_CRC_LEN                2
+#define CSI_LINK_MAX_PAYLOAD_LEN        255
+#define CSI_LINK_FRAME_SIZE(payload_len) (CSI_LINK_HEADER_LEN + (payload_len) + CSI_LINK_CRC_LEN)
+#define CSI_LINK_MAX_FRAME_SIZE         CSI_LINK_FRAME_SIZE(CSI_LINK_MAX_PAYLOAD_LEN)
+
+/**
+ * @brief Encode a frame
+ *
+ * @param type        Application defined record type
+ * @param payload     Record bytes
+ * @param payload_len Length of payload, at most CSI_LINK_MAX_PAYLOAD_LEN
+ * @param buf         Output buffer, CSI_LINK_FRAME_SIZE(payload_len) bytes are needed
+ * @param size        Size of buf
+ *
+ * @return Number of bytes written, or 0 if the payload is too long or buf is too small
+ */
+size_t csi_link_encode(uint8_t type, const void *payload, size_t payload_len, uint8_t *buf, size_t size);
+
+typedef void (*csi_link_cb_t)(uint8_t type, const uint8_t *payload, size_t payload_len, void *ctx);
+
+/**
+ * @brief Streaming decoder, `buf` holds at most one unfinished frame between calls
+ */
+typedef struct {
+    uint8_t  buf[CSI_LINK_MAX_FRAME_SIZE];
+    size_t   len;
+    uint32_t frame_count;            /**< Frames delivered */
+    uint32_t error_count;            /**< Candidate frames rejected by the CRC check */
+    uint32_t skipped_bytes;          /**< Bytes discarded while searching for sync */
+} csi_link_decoder_t;
+
+void csi_link_decoder_init(csi_link_decoder_t *decoder);
+
+/**
+ * @brief Feed bytes into the decoder, calling cb for every complete frame
+ *
+ * The payload passed to cb is only valid during the call.
+ *
+ * @return Number of frames delivered by this call
+ */
+size_t csi_link_decoder_feed(csi_link_decoder_t *decoder, const uint8_t *data, size_t len,
+                             csi_link_cb_t cb, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,143 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "csi_metrics.h"
+
+#define CSI_METRICS_SUB_COUNT       (1u << CSI_METRICS_HIST_SUB_BITS)
+
+static inline size_t csi_metrics_bucket_index(uint32_t value)
+{
+    if (value < CSI_METRICS_SUB_COUNT) {
+        return value;
+    }
+
+    int exponent = 31 - __builtin_clz(value);
+    int shift = exponent - CSI_METRICS_HIST_SUB_BITS;
+
+    return ((size_t)(shift + 1) << CSI_METRICS_HIST_SUB_BITS) + ((value >> shift) & (CSI_METRICS_SUB_COUNT - 1));
+}
+
+/**
+ * @brief Largest value that falls in a bucket
+ */
+static inline uint32_t csi_metrics_bucket_upper(size_t index)
+{
+    if (index < CSI_METRICS_SUB_COUNT) {
+        return index;
+    }
+
+    int shift = (int)(index >> CSI_METRICS_HIST_SUB_BITS) - 1;
+    uint32_t lower = (uint32_t)(CSI_METRICS_SUB_COUNT + (index & (CSI_METRICS_SUB_COUNT - 1))) << shift;
+
+    return lower + ((1u << shift) - 1);
+}
+
+void csi_metrics_hist_record(csi_metrics_hist_t *hist, uint32_t value)
+{
+    __atomic_fetch_add(&hist->buckets[csi_metrics_bucket_index(value)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&hist->count, 1, __ATOMIC_RELAXED);
+
+    uint32_t max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+
+    while (value > max && !__atomic_compare_exchange_n(&hist->max, &max, value, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void csi_metrics_hist_summary(const csi_metrics_hist_t *hist, csi_metrics_summary_t *summary)
+{
+    static const uint16_t permille[] = {500, 900, 990};
+    uint32_t *values[] = {&summary->p50, &summary->p90, &summary->p99};
+    uint32_t total = 0;
+
+    /**
+     * @brief Sum the buckets rather than trusting `count`, a concurrent record may have updated only one of them
+     */
+    for (size_t i = 0; i < CSI_METRICS_HIST_BUCKETS; i++) {
+        total += __atomic_load_n(&hist->buckets[i], __ATOMIC_RELAXED);
+    }
+
+    memset(summary, 0, sizeof(csi_metrics_summary_t));
+    summary->count = total;
+    summary->max   = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+
+    if (!total) {
+        return;
+    }
+
+    uint32_t seen = 0;
+    size_t next = 0;
+
+    for (size_t i = 0; i < CSI_METRICS_HIST_BUCKETS && next < 3; i++) {
+        seen += __atomic_load_n(&hist->buckets[i], __ATOMIC_RELAXED);
+
+        while (next < 3 && (uint64_t)seen * 1000 >= (uint64_t)total * permille[next]) {
+            uint32_t upper = csi_metrics_bucket_upper(i);
+            *values[next++] = upper < summary->max ? upper : summary->max;
+        }
+    }
+}
+
+void csi_metrics_hist_reset(csi_metrics_hist_t *hist)
+{
+    for (size_t i = 0; i < CSI_METRICS_HIST_BUCKETS; i++) {
+        __atomic_store_n(&hist->buckets[i], 0, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&hist->count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->max, 0, __ATOMIC_RELAXED);
+}
+
+size_t csi_metrics_format(const csi_metrics_t *metrics, char *buf, size_t size)
+{
+    size_t len = 0;
+
+    if (!size) {
+        return 0;
+    }
+
+    buf[0] = '\0';
+
+    for (size_t i = 0; i < metrics->stage_count + metrics->counter_count && len < size - 1; i++) {
+        const char *separator = i ? "," : "";
+        int ret;
+
+        if (i < metrics->stage_count) {
+            csi_metrics_summary_t summary;
+            csi_metrics_hist_summary(&metrics->stages[i].latency, &summary);
+            ret = snprintf(buf + len, size - len, "%s%s=%u/%u/%u/%u/%u", separator, metrics->stages[i].name,
+                           (unsigned int)summary.count, (unsigned int)summary.p50, (unsigned int)summary.p90,
+                           (unsigned int)summary.p99, (unsigned int)summary.max);
+        } else {
+            const csi_metrics_counter_t *counter = &metrics->counters[i - metrics->stage_count];
+            ret = snprintf(buf + len, size - len, "%s%s=%u", separator, counter->name,
+                           (unsigned int)csi_metrics_counter_get(counter));
+        }
+
+        if (ret < 0) {
+            break;
+        }
+
+        len += ret;
+    }
+
+    return len < size ? len : size - 1;
+}
+
+void csi_metrics_reset(csi_metrics_t *metrics)
+{
+    for (size_t i = 0; i < metrics->stage_count; i++) {
+        csi_metrics_hist_reset(&metrics->stages[i].latency);
+    }
+
+    for (size_t i = 0; i < metrics->counter_count; i++) {
+        __atomic_store_n(&metrics->counters[i].count, 0, __ATOMIC_RELAXED);
+    }
+}
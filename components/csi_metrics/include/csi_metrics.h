@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Always-on latency histograms and drop counters for the CSI pipeline
+ *
+ * A pipeline stamps each packet when the Wi-Fi driver hands it over and, at the
+ * end of every later stage (queue, processing, serialization, transport),
+ * records the time since that stamp in the stage's histogram. Every place that
+ * can drop a packet has a counter.
+ *
+ * Histograms are log-linear like HDR histograms: exact below 8, then 8
+ * buckets per power of two, so any uint32_t value is kept within 12.5% in
+ * 960 bytes. Recording and counting are a few relaxed atomic operations,
+ * safe from any task or core; reading takes no lock and may see a packet
+ * that is half-recorded.
+ *
+ * No ESP-IDF dependency, the caller supplies the timestamps.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSI_METRICS_HIST_SUB_BITS   3
+#define CSI_METRICS_HIST_BUCKETS    ((32 - CSI_METRICS_HIST_SUB_BITS + 1) << CSI_METRICS_HIST_SUB_BITS)
+
+typedef struct {
+    uint32_t buckets[CSI_METRICS_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+} csi_metrics_hist_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t p50;                   /**< Percentiles are the upper bound of their bucket, at most max */
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+} csi_metrics_summary_t;
+
+/**
+ * @brief A pipeline stage, `latency` holds the microseconds from the driver callback to the end of the stage
+ */
+typedef struct {
+    const char *name;
+    csi_metrics_hist_t latency;
+} csi_metrics_stage_t;
+
+typedef struct {
+    const char *name;
+    uint32_t count;
+} csi_metrics_counter_t;
+
+typedef struct {
+    csi_metrics_stage_t *stages;
+    size_t stage_count;
+    csi_metrics_counter_t *counters;
+    size_t counter_count;
+} csi_metrics_t;
+
+/**
+ * @brief Initializer from two arrays, e.g. `csi_metrics_t m = CSI_METRICS_INIT(s_stages, s_drops);`
+ */
+#define CSI_METRICS_INIT(stage_array, counter_array) { \
+    .stages        = (stage_array), \
+    .stage_count   = sizeof(stage_array) / sizeof((stage_array)[0]), \
+    .counters      = (counter_array), \
+    .counter_count = sizeof(counter_array) / sizeof((counter_array)[0]), \
+}
+
+void csi_metrics_hist_record(csi_metrics_hist_t *hist, uint32_t value);
+
+void csi_metrics_hist_summary(const csi_metrics_hist_t *hist, csi_metrics_summary_t *summary);
+
+void csi_metrics_hist_reset(csi_metrics_hist_t *hist);
+
+static inline void csi_metrics_counter_add(csi_metrics_counter_t *counter, uint32_t n)
+{
+    __atomic_fetch_add(&counter->count, n, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t csi_metrics_counter_get(const csi_metrics_counter_t *counter)
+{
+    return __atomic_load_n(&counter->count, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Compact one-line record: `<stage>=<count>/<p50>/<p90>/<p99>/<max>` for every stage, then
+ *        `<counter>=<count>` for every counter, comma separated, no newline
+ *
+ * @return Length written, excluding the NUL, truncated to size - 1
+ */
+size_t csi_metrics_format(const csi_metrics_t *metrics, char *buf, size_t size);
+
+/**
+ * @brief Clear every histogram and counter
+ */
+void csi_metrics_reset(csi_metrics_t *metrics);
+
+#ifdef __cplusplus
+}
+#endif
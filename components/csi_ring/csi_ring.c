@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "csi_ring.h"
+
+/**
+ * @brief head and tail are free-running counters; the slot index is the counter masked by
+ *        slot_mask and the fill level is head - tail, which stays correct across wrap-around.
+ */
+bool csi_ring_init(csi_ring_t *ring, void *storage, size_t slot_size, uint32_t slot_num)
+{
+    if (!ring || !storage || !slot_size || !slot_num || (slot_num & (slot_num - 1))) {
+        return false;
+    }
+
+    memset(ring, 0, sizeof(csi_ring_t));
+    ring->storage     = storage;
+    ring->slot_stride = CSI_RING_SLOT_STRIDE(slot_size);
+    ring->slot_mask   = slot_num - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->overflow_count, 0);
+
+    return true;
+}
+
+void *csi_ring_acquire(csi_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail > ring->slot_mask) {
+        atomic_fetch_add_explicit(&ring->overflow_count, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    ring->acquired = 1;
+
+    return ring->storage + (size_t)(head & ring->slot_mask) * ring->slot_stride;
+}
+
+void csi_ring_commit(csi_ring_t *ring)
+{
+    if (!ring->acquired) {
+        return;
+    }
+
+    ring->acquired = 0;
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void *csi_ring_peek(csi_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) {
+        return NULL;
+    }
+
+    return ring->storage + (size_t)(tail & ring->slot_mask) * ring->slot_stride;
+}
+
+void csi_ring_release(csi_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) {
+        return;
+    }
+
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+uint32_t csi_ring_flush(csi_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    atomic_store_explicit(&ring->tail, head, memory_order_release);
+
+    return head - tail;
+}
+
+uint32_t csi_ring_count(csi_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    return head - tail;
+}
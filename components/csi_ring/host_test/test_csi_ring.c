@@ -0,0 +1,254 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host tests for csi_ring: single-threaded behaviour, then a producer and a consumer
+ *        thread running flat out. Every slot carries its sequence number repeated over the
+ *        whole slot, so a torn or reordered slot is detected by the consumer.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "csi_ring.h"
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define STRESS_SLOT_WORDS   64
+#define STRESS_SLOT_NUM     16
+#define STRESS_PACKETS      2000000  /**< Even */
+
+static void test_init(void)
+{
+    static max_align_t storage[64];
+    csi_ring_t ring;
+
+    CHECK(!csi_ring_init(&ring, storage, 8, 3));
+    CHECK(!csi_ring_init(&ring, storage, 8, 0));
+    CHECK(!csi_ring_init(&ring, storage, 0, 4));
+    CHECK(!csi_ring_init(&ring, NULL, 8, 4));
+    CHECK(csi_ring_init(&ring, storage, 8, 4));
+    CHECK(csi_ring_capacity(&ring) == 4);
+    CHECK(csi_ring_count(&ring) == 0);
+    CHECK(ring.slot_stride % sizeof(max_align_t) == 0);
+}
+
+static void test_fill_drain(void)
+{
+    static max_align_t storage[64];
+    csi_ring_t ring;
+    CHECK(csi_ring_init(&ring, storage, sizeof(uint32_t), 4));
+
+    CHECK(csi_ring_peek(&ring) == NULL);
+
+    /**
+     * @brief Acquiring twice without a commit hands out the same slot, committing twice publishes once
+     */
+    uint32_t *slot = csi_ring_acquire(&ring);
+    CHECK(slot && csi_ring_acquire(&ring) == slot);
+    *slot = 100;
+    csi_ring_commit(&ring);
+    csi_ring_commit(&ring);
+    CHECK(csi_ring_count(&ring) == 1);
+
+    for (uint32_t i = 1; i < 4; i++) {
+        slot = csi_ring_acquire(&ring);
+        CHECK(slot);
+        *slot = 100 + i;
+        csi_ring_commit(&ring);
+    }
+
+    CHECK(csi_ring_acquire(&ring) == NULL);
+    CHECK(csi_ring_acquire(&ring) == NULL);
+    CHECK(csi_ring_overflow_count(&ring) == 2);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        slot = csi_ring_peek(&ring);
+        CHECK(slot && *slot == 100 + i);
+        csi_ring_release(&ring);
+    }
+
+    CHECK(csi_ring_peek(&ring) == NULL);
+    csi_ring_release(&ring);
+    CHECK(csi_ring_count(&ring) == 0);
+}
+
+static void test_flush_and_wrap(void)
+{
+    static max_align_t storage[64];
+    csi_ring_t ring;
+    CHECK(csi_ring_init(&ring, storage, sizeof(uint32_t), 8));
+
+    /**
+     * @brief Start the free-running counters just below UINT32_MAX so they wrap during the test
+     */
+    atomic_store(&ring.head, UINT32_MAX - 5);
+    atomic_store(&ring.tail, UINT32_MAX - 5);
+
+    for (uint32_t round = 0; round < 4; round++) {
+        for (uint32_t i = 0; i < 8; i++) {
+            uint32_t *slot = csi_ring_acquire(&ring);
+            CHECK(slot);
+            *slot = round * 8 + i;
+            csi_ring_commit(&ring);
+        }
+
+        CHECK(csi_ring_acquire(&ring) == NULL);
+        CHECK(csi_ring_count(&ring) == 8);
+
+        uint32_t *slot = csi_ring_peek(&ring);
+        CHECK(slot && *slot == round * 8);
+        csi_ring_release(&ring);
+
+        CHECK(csi_ring_flush(&ring) == 7);
+        CHECK(csi_ring_count(&ring) == 0);
+        CHECK(csi_ring_peek(&ring) == NULL);
+    }
+
+    CHECK(csi_ring_overflow_count(&ring) == 4);
+}
+
+typedef struct {
+    csi_ring_t ring;
+    uint32_t produced;
+    uint32_t full;
+    uint32_t consumed;
+    uint32_t torn;
+    uint32_t reordered;
+} stress_ctx_t;
+
+static void *stress_producer(void *arg)
+{
+    stress_ctx_t *ctx = arg;
+
+    for (uint32_t seq = 0; seq < STRESS_PACKETS; seq++) {
+        uint32_t *slot = csi_ring_acquire(&ctx->ring);
+
+        /**
+         * @brief Even packets are dropped on a full ring like the CSI callbacks do, odd packets
+         *        wait for a slot so the two threads keep interleaving on a single core too
+         */
+        while (!slot) {
+            ctx->full++;
+
+            if (!(seq & 1)) {
+                break;
+            }
+
+            sched_yield();
+            slot = csi_ring_acquire(&ctx->ring);
+        }
+
+        if (!slot) {
+            continue;
+        }
+
+        for (int i = 0; i < STRESS_SLOT_WORDS; i++) {
+            slot[i] = seq;
+        }
+
+        csi_ring_commit(&ctx->ring);
+        ctx->produced++;
+    }
+
+    return NULL;
+}
+
+static void *stress_consumer(void *arg)
+{
+    stress_ctx_t *ctx = arg;
+    uint32_t last = 0;
+    bool first = true;
+
+    /**
+     * @brief The last packet is odd, so it is never dropped and ends the run
+     */
+    while (first || last != STRESS_PACKETS - 1) {
+        uint32_t *slot = csi_ring_peek(&ctx->ring);
+
+        if (!slot) {
+            sched_yield();
+            continue;
+        }
+
+        uint32_t seq = slot[0];
+
+        for (int i = 1; i < STRESS_SLOT_WORDS; i++) {
+            if (slot[i] != seq) {
+                ctx->torn++;
+                break;
+            }
+        }
+
+        if (!first && seq <= last) {
+            ctx->reordered++;
+        }
+
+        first = false;
+        last = seq;
+        ctx->consumed++;
+        csi_ring_release(&ctx->ring);
+    }
+
+    return NULL;
+}
+
+static void test_stress(void)
+{
+    stress_ctx_t ctx = {0};
+    void *storage = aligned_alloc(sizeof(max_align_t),
+                                  CSI_RING_STORAGE_SIZE(STRESS_SLOT_WORDS * sizeof(uint32_t), STRESS_SLOT_NUM));
+    CHECK(storage);
+    CHECK(csi_ring_init(&ctx.ring, storage, STRESS_SLOT_WORDS * sizeof(uint32_t), STRESS_SLOT_NUM));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t producer, consumer;
+    CHECK(!pthread_create(&consumer, NULL, stress_consumer, &ctx));
+    CHECK(!pthread_create(&producer, NULL, stress_producer, &ctx));
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("stress: %u packets, %u delivered, %u dropped on a full ring, %.1f M slots/s\n",
+           STRESS_PACKETS, ctx.consumed, STRESS_PACKETS - ctx.produced, ctx.consumed / seconds / 1e6);
+
+    CHECK(ctx.torn == 0);
+    CHECK(ctx.reordered == 0);
+    CHECK(ctx.consumed == ctx.produced);
+    CHECK(ctx.produced >= STRESS_PACKETS / 2);
+    CHECK(ctx.full == csi_ring_overflow_count(&ctx.ring));
+    CHECK(csi_ring_count(&ctx.ring) == 0);
+
+    free(storage);
+}
+
+int main(void)
+{
+    test_init();
+    test_fill_drain();
+    test_flush_and_wrap();
+    test_stress();
+
+    printf("csi_ring: all tests passed\n");
+
+    return 0;
+}
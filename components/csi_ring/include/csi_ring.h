@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Lock-free single-producer/single-consumer ring of fixed-size slots
+ *
+ * The producer (e.g. a Wi-Fi CSI callback) acquires a free slot, fills it in
+ * place and commits it; the consumer peeks the oldest committed slot, uses it
+ * in place and releases it. No copy through a queue and no heap allocation per
+ * packet. Exactly one producer and one consumer context may use a ring.
+ *
+ * Plain C11 with <stdatomic.h>, so it can be built and tested on a host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Slot stride for a given slot size, rounded up so every slot is aligned for any scalar type
+ */
+#define CSI_RING_SLOT_STRIDE(slot_size)           (((slot_size) + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1))
+
+/**
+ * @brief Bytes of storage needed by csi_ring_init()
+ */
+#define CSI_RING_STORAGE_SIZE(slot_size, slot_num) (CSI_RING_SLOT_STRIDE(slot_size) * (slot_num))
+
+typedef struct {
+    uint8_t *storage;
+    size_t   slot_stride;
+    uint32_t slot_mask;              /**< slot_num - 1, slot_num is a power of two */
+    atomic_uint_least32_t head;      /**< Slots committed, written by the producer only */
+    atomic_uint_least32_t tail;      /**< Slots released, written by the consumer only */
+    atomic_uint_least32_t overflow_count; /**< csi_ring_acquire() calls that found the ring full */
+    uint32_t acquired;               /**< Producer holds an acquired, uncommitted slot */
+} csi_ring_t;
+
+/**
+ * @brief Initialize a ring over caller-provided storage
+ *
+ * @param ring      Ring to initialize
+ * @param storage   At least CSI_RING_STORAGE_SIZE(slot_size, slot_num) bytes, aligned to max_align_t
+ * @param slot_size Usable bytes per slot
+ * @param slot_num  Number of slots, a power of two
+ *
+ * @return false if slot_num is not a power of two or an argument is NULL / zero
+ */
+bool csi_ring_init(csi_ring_t *ring, void *storage, size_t slot_size, uint32_t slot_num);
+
+/**
+ * @brief Producer: get the next free slot
+ *
+ * Calling it again before csi_ring_commit() returns the same slot.
+ *
+ * @return Pointer to slot_size writable bytes, or NULL if the ring is full (overflow_count is incremented)
+ */
+void *csi_ring_acquire(csi_ring_t *ring);
+
+/**
+ * @brief Producer: publish the slot returned by csi_ring_acquire() to the consumer
+ */
+void csi_ring_commit(csi_ring_t *ring);
+
+/**
+ * @brief Consumer: get the oldest committed slot without removing it
+ *
+ * @return Pointer to the slot, or NULL if the ring is empty
+ */
+void *csi_ring_peek(csi_ring_t *ring);
+
+/**
+ * @brief Consumer: return the slot returned by csi_ring_peek() to the producer
+ */
+void csi_ring_release(csi_ring_t *ring);
+
+/**
+ * @brief Consumer: release every committed slot, e.g. to drop packets that predate a resynchronization
+ *
+ * @return Number of slots released
+ */
+uint32_t csi_ring_flush(csi_ring_t *ring);
+
+/**
+ * @brief Number of committed slots not yet released. Exact from the consumer, a snapshot elsewhere
+ */
+uint32_t csi_ring_count(csi_ring_t *ring);
+
+/**
+ * @brief Number of slots the ring holds
+ */
+static inline uint32_t csi_ring_capacity(const csi_ring_t *ring)
+{
+    return ring->slot_mask + 1;
+}
+
+/**
+ * @brief Total number of csi_ring_acquire() calls that failed because the ring was full
+ */
+static inline uint32_t csi_ring_overflow_count(csi_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->overflow_count, memory_order_relaxed);
+}
+
+#ifdef __cplusplus
+}
+#endif
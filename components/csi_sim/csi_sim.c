@@ -0,0 +1,436 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "csi_sim.h"
+
+#define CSI_SIM_PI                  3.14159265358979f
+
+#define CSI_SIM_CSV_PREFIX          "CSI_DATA,"
+#define CSI_SIM_CSV_COLUMNS_MAX     24      /**< Columns before the data column, pre-C5/C6 layout */
+#define CSI_SIM_CSV_COLUMNS_HE      14      /**< ESP32-C5/C6/C61 layout */
+
+static const uint16_t s_layouts[] = {52, 106, 114, 128, 234, 256, 384, 490, 512};
+
+/**
+ * @brief xorshift32, uniform in [0, 1)
+ */
+static inline float csi_sim_rand(csi_sim_t *sim)
+{
+    sim->rng ^= sim->rng << 13;
+    sim->rng ^= sim->rng >> 17;
+    sim->rng ^= sim->rng << 5;
+
+    return (sim->rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float csi_sim_rand_symmetric(csi_sim_t *sim, float range)
+{
+    return (2 * csi_sim_rand(sim) - 1) * range;
+}
+
+/**
+ * @brief Standard normal sample, Box-Muller
+ */
+static inline float csi_sim_rand_normal(csi_sim_t *sim)
+{
+    float u = csi_sim_rand(sim);
+    float v = csi_sim_rand(sim);
+
+    return sqrtf(-2 * logf(1 - u)) * cosf(2 * CSI_SIM_PI * v);
+}
+
+static inline int8_t csi_sim_quantize(float value)
+{
+    value = roundf(value);
+    return value > 127 ? 127 : value < -128 ? -128 : (int8_t)value;
+}
+
+bool csi_sim_init(csi_sim_t *sim, const csi_sim_config_t *config)
+{
+    bool layout_valid = false;
+
+    for (size_t i = 0; i < sizeof(s_layouts) / sizeof(s_layouts[0]); i++) {
+        layout_valid |= config->subcarriers == s_layouts[i];
+    }
+
+    if (!layout_valid || !config->tap_count || config->tap_count > CSI_SIM_TAP_MAX || !(config->loss_rate < 1)) {
+        return false;
+    }
+
+    memset(sim, 0, sizeof(csi_sim_t));
+    sim->config   = *config;
+    sim->rng      = config->seed ? config->seed : 1;
+    sim->agc_gain = config->agc_gain;
+    sim->gain     = 1.0f;
+
+    return true;
+}
+
+/**
+ * @brief Advance seq, timestamp and the AGC state by one packet, delivered or not
+ */
+static void csi_sim_advance(csi_sim_t *sim)
+{
+    const csi_sim_config_t *config = &sim->config;
+
+    sim->seq++;
+    sim->timestamp += config->interval_us;
+
+    if (config->interval_jitter_us) {
+        sim->timestamp += (uint32_t)(csi_sim_rand(sim) * (config->interval_jitter_us + 1));
+    }
+
+    if (config->gain_step_interval && !(sim->seq % config->gain_step_interval)) {
+        bool stepped = (sim->seq / config->gain_step_interval) % 2;
+        int8_t step_db = stepped ? config->gain_step_db : 0;
+
+        sim->agc_gain = config->agc_gain + step_db;
+        sim->gain     = powf(10, step_db / 20.0f);
+    }
+}
+
+void csi_sim_next(csi_sim_t *sim, csi_sim_packet_t *packet)
+{
+    const csi_sim_config_t *config = &sim->config;
+
+    while (config->loss_rate > 0 && csi_sim_rand(sim) < config->loss_rate) {
+        sim->lost_count++;
+        csi_sim_advance(sim);
+    }
+
+    csi_frame_header_t *header = &packet->header;
+    memset(header, 0, sizeof(csi_frame_header_t));
+    header->sync[0]         = CSI_FRAME_SYNC0;
+    header->sync[1]         = CSI_FRAME_SYNC1;
+    header->version         = CSI_FRAME_VERSION;
+    header->type            = CSI_FRAME_TYPE_CSI;
+    header->payload_len     = config->subcarriers * 2;
+    header->length          = sizeof(csi_frame_header_t) + header->payload_len + CSI_FRAME_CRC_LEN;
+    header->seq             = sim->seq;
+    header->timestamp       = sim->timestamp;
+    header->rssi            = config->rssi;
+    header->noise_floor     = config->noise_floor;
+    header->channel         = config->channel;
+    header->agc_gain        = sim->agc_gain;
+    header->fft_gain        = config->fft_gain;
+    header->sig_len         = 64;
+    header->compensate_gain = 1 / sim->gain;
+    memcpy(header->mac, config->mac, sizeof(header->mac));
+
+    /**
+     * @brief H(k) = sum_l g_l * exp(j * (phi_l - 2 * pi * k * tau_l / N)), rotated by the common phase
+     *        and the timing offset of this packet. Each tap's phasor is advanced subcarrier by
+     *        subcarrier with one complex multiply instead of a sincos per subcarrier.
+     */
+    size_t n = config->subcarriers;
+    float tap_sum = 0;
+
+    for (int l = 0; l < config->tap_count; l++) {
+        tap_sum += fabsf(config->taps[l].gain);
+    }
+
+    float scale = tap_sum > 0 ? config->amplitude * sim->gain / tap_sum : 0;
+    float common_phase = config->phase_offset + csi_sim_rand_symmetric(sim, config->phase_jitter);
+    float common_delay = csi_sim_rand_symmetric(sim, config->delay_jitter);
+    float noise_std = config->snr_db > 0 ? config->amplitude * sim->gain * powf(10, -config->snr_db / 20) / sqrtf(2) : 0;
+
+    float tap_re[CSI_SIM_TAP_MAX], tap_im[CSI_SIM_TAP_MAX];
+    float step_re[CSI_SIM_TAP_MAX], step_im[CSI_SIM_TAP_MAX];
+
+    for (int l = 0; l < config->tap_count; l++) {
+        const csi_sim_tap_t *tap = &config->taps[l];
+        float step = -2 * CSI_SIM_PI * (tap->delay + common_delay) / n;
+
+        step_re[l] = cosf(step);
+        step_im[l] = sinf(step);
+        tap_re[l]  = tap->gain * scale * cosf(tap->phase + common_phase);
+        tap_im[l]  = tap->gain * scale * sinf(tap->phase + common_phase);
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        float re = 0;
+        float im = 0;
+
+        for (int l = 0; l < config->tap_count; l++) {
+            re += tap_re[l];
+            im += tap_im[l];
+
+            float next_re = tap_re[l] * step_re[l] - tap_im[l] * step_im[l];
+            tap_im[l] = tap_re[l] * step_im[l] + tap_im[l] * step_re[l];
+            tap_re[l] = next_re;
+        }
+
+        if (noise_std > 0) {
+            re += noise_std * csi_sim_rand_normal(sim);
+            im += noise_std * csi_sim_rand_normal(sim);
+        }
+
+        packet->buf[2 * k]     = csi_sim_quantize(im);
+        packet->buf[2 * k + 1] = csi_sim_quantize(re);
+    }
+
+    sim->packet_count++;
+    csi_sim_advance(sim);
+}
+
+/**
+ * @brief Decimal integer, optionally padded with spaces, ending at a ',', a ']' or at end;
+ *        *ptr is moved past the ','
+ */
+static bool csi_sim_parse_int(const char **ptr, const char *end, int64_t *value)
+{
+    const char *p = *ptr;
+    bool negative = false;
+    int64_t result = 0;
+
+    while (p < end && *p == ' ') {
+        p++;
+    }
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+
+    const char *digits = p;
+
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        if (result > INT32_MAX * 4LL) {
+            return false;
+        }
+
+        result = result * 10 + (*p - '0');
+    }
+
+    if (p == digits) {
+        return false;
+    }
+
+    while (p < end && *p == ' ') {
+        p++;
+    }
+
+    if (p < end && *p != ',' && *p != ']') {
+        return false;
+    }
+
+    *value = negative ? -result : result;
+    *ptr = p < end && *p == ',' ? p + 1 : p;
+    return true;
+}
+
+bool csi_sim_parse_csv_line(const char *line, size_t len, csi_sim_packet_t *packet)
+{
+    const char *end = line + len;
+    const char *columns[CSI_SIM_CSV_COLUMNS_MAX];
+    size_t column_count = 0;
+
+    if (len && end[-1] == '\r') {
+        end--;
+    }
+
+    /**
+     * @brief Skip anything before the prefix and split the columns before the quoted data column
+     */
+    const char *p = line;
+
+    for (; p + sizeof(CSI_SIM_CSV_PREFIX) - 1 <= end; p++) {
+        if (!memcmp(p, CSI_SIM_CSV_PREFIX, sizeof(CSI_SIM_CSV_PREFIX) - 1)) {
+            break;
+        }
+    }
+
+    if (p + sizeof(CSI_SIM_CSV_PREFIX) - 1 > end) {
+        return false;
+    }
+
+    while (p < end && *p != '"') {
+        if (column_count == CSI_SIM_CSV_COLUMNS_MAX) {
+            return false;
+        }
+
+        columns[column_count++] = p;
+
+        while (p < end && *p != ',') {
+            p++;
+        }
+
+        if (p < end) {
+            p++;
+        }
+    }
+
+    if (p + 2 > end || p[1] != '[' || (column_count != CSI_SIM_CSV_COLUMNS_MAX && column_count != CSI_SIM_CSV_COLUMNS_HE)) {
+        return false;
+    }
+
+    bool he_layout = column_count == CSI_SIM_CSV_COLUMNS_HE;
+    csi_frame_header_t *header = &packet->header;
+    memset(header, 0, sizeof(csi_frame_header_t));
+    header->sync[0]         = CSI_FRAME_SYNC0;
+    header->sync[1]         = CSI_FRAME_SYNC1;
+    header->version         = CSI_FRAME_VERSION;
+    header->type            = CSI_FRAME_TYPE_CSI;
+    header->compensate_gain = 1.0f;
+
+    /**
+     * @brief Numeric columns of both layouts: index into columns, destination and width
+     */
+    static const struct {
+        uint8_t column_he;
+        uint8_t column;
+        uint8_t offset;
+        uint8_t size;
+        bool    is_signed;
+    } fields[] = {
+        {1,  1,  offsetof(csi_frame_header_t, seq),               4, false},
+        {3,  3,  offsetof(csi_frame_header_t, rssi),              1, true},
+        {4,  4,  offsetof(csi_frame_header_t, rate),              1, false},
+        {0,  5,  offsetof(csi_frame_header_t, sig_mode),          1, false},
+        {0,  6,  offsetof(csi_frame_header_t, mcs),               1, false},
+        {0,  7,  offsetof(csi_frame_header_t, cwb),               1, false},
+        {0,  11, offsetof(csi_frame_header_t, stbc),              1, false},
+        {0,  13, offsetof(csi_frame_header_t, sgi),               1, false},
+        {5,  14, offsetof(csi_frame_header_t, noise_floor),       1, true},
+        {0,  15, offsetof(csi_frame_header_t, ampdu_cnt),         1, false},
+        {8,  16, offsetof(csi_frame_header_t, channel),           1, false},
+        {0,  17, offsetof(csi_frame_header_t, secondary_channel), 1, false},
+        {9,  18, offsetof(csi_frame_header_t, timestamp),         4, false},
+        {10, 20, offsetof(csi_frame_header_t, sig_len),           2, false},
+        {11, 21, offsetof(csi_frame_header_t, rx_state),          1, false},
+        {6,  0,  offsetof(csi_frame_header_t, fft_gain),          1, true},
+        {7,  0,  offsetof(csi_frame_header_t, agc_gain),          1, false},
+    };
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        uint8_t column = he_layout ? fields[i].column_he : fields[i].column;
+        const char *q = columns[column];
+        int64_t value;
+
+        if (!column) {
+            continue;
+        } else if (!csi_sim_parse_int(&q, end, &value)) {
+            return false;
+        }
+
+        uint8_t *dst = (uint8_t *)header + fields[i].offset;
+
+        if (fields[i].size == 4) {
+            uint32_t v = (uint32_t)value;
+            memcpy(dst, &v, 4);
+        } else if (fields[i].size == 2) {
+            uint16_t v = (uint16_t)value;
+            memcpy(dst, &v, 2);
+        } else {
+            *dst = fields[i].is_signed ? (uint8_t)(int8_t)value : (uint8_t)value;
+        }
+    }
+
+    unsigned int mac[6];
+    const char *mac_column = columns[2];
+
+    for (int i = 0; i < 6; i++, mac_column += 3) {
+        if (mac_column + 2 > end) {
+            return false;
+        }
+
+        mac[i] = 0;
+
+        for (int j = 0; j < 2; j++) {
+            char c = mac_column[j];
+            unsigned int nibble = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+                                  c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16;
+
+            if (nibble > 15) {
+                return false;
+            }
+
+            mac[i] = mac[i] << 4 | nibble;
+        }
+
+        header->mac[i] = mac[i];
+    }
+
+    int64_t first_word_invalid;
+    const char *q = columns[column_count - 1];
+
+    if (!csi_sim_parse_int(&q, end, &first_word_invalid)) {
+        return false;
+    }
+
+    header->flags = first_word_invalid ? CSI_FRAME_FLAG_FIRST_WORD_INVALID : 0;
+
+    /**
+     * @brief Data column, "[v0,v1,...]" with values possibly beyond int8 after gain compensation
+     */
+    size_t count = 0;
+    p += 2;
+
+    while (p < end && *p != ']') {
+        int64_t value;
+
+        if (count == CSI_FRAME_MAX_PAYLOAD_LEN || !csi_sim_parse_int(&p, end, &value)) {
+            return false;
+        }
+
+        packet->buf[count++] = value > 127 ? 127 : value < -128 ? -128 : (int8_t)value;
+    }
+
+    if (p == end) {
+        return false;
+    }
+
+    header->payload_len = count;
+    header->length      = sizeof(csi_frame_header_t) + count + CSI_FRAME_CRC_LEN;
+
+    return true;
+}
+
+bool csi_sim_from_frame(const csi_frame_header_t *header, const uint8_t *payload, csi_sim_packet_t *packet)
+{
+    if (header->type != CSI_FRAME_TYPE_CSI || header->payload_len > CSI_FRAME_MAX_PAYLOAD_LEN) {
+        return false;
+    }
+
+    packet->header = *header;
+    memcpy(packet->buf, payload, header->payload_len);
+
+    return true;
+}
+
+void csi_sim_pacer_init(csi_sim_pacer_t *pacer, float speed)
+{
+    memset(pacer, 0, sizeof(csi_sim_pacer_t));
+    pacer->speed = speed;
+}
+
+int64_t csi_sim_pacer_delay_us(csi_sim_pacer_t *pacer, uint32_t timestamp, int64_t now_us)
+{
+    uint32_t delta = timestamp - pacer->last_timestamp;
+
+    /**
+     * @brief Start over on the first packet and when the timestamp goes backwards
+     */
+    if (!pacer->started || delta > UINT32_MAX / 2) {
+        pacer->started     = true;
+        pacer->recorded_us = 0;
+        pacer->start_us    = now_us;
+        delta              = 0;
+    }
+
+    pacer->last_timestamp = timestamp;
+    pacer->recorded_us += delta;
+
+    if (!(pacer->speed > 0)) {
+        return 0;
+    }
+
+    int64_t due_us = pacer->start_us + (int64_t)(pacer->recorded_us / pacer->speed);
+
+    return due_us > now_us ? due_us - now_us : 0;
+}
@@ -0,0 +1,308 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "esp_wifi.h"
+#include "esp_csi_gain_ctrl.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "rom/ets_sys.h"
+
+#include "csi_sim_wifi.h"
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t handled;
+    QueueHandle_t queue;
+    FILE *out;
+    wifi_csi_cb_t cb;
+    void *ctx;
+    bool initialized;
+    bool started;
+    bool csi_enabled;
+    uint8_t mac[6];
+    csi_sim_wifi_stats_t stats;
+} s_wifi = {
+    .lock    = PTHREAD_MUTEX_INITIALIZER,
+    .handled = PTHREAD_COND_INITIALIZER,
+};
+
+static struct {
+    uint32_t count;
+    int64_t agc_sum;
+    int64_t fft_sum;
+    uint8_t agc_baseline;
+    int8_t fft_baseline;
+} s_gain;
+
+int ets_printf(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    int ret = vfprintf(s_wifi.out ? s_wifi.out : stdout, fmt, args);
+    va_end(args);
+
+    return ret;
+}
+
+void csi_sim_wifi_set_output(FILE *out)
+{
+    s_wifi.out = out;
+}
+
+/**
+ * @brief The info the driver hands to the CSI callback, built from a frame header
+ */
+static void csi_sim_wifi_info(const csi_sim_packet_t *packet, wifi_csi_info_t *info, uint8_t *payload)
+{
+    const csi_frame_header_t *header = &packet->header;
+    wifi_pkt_rx_ctrl_t *rx_ctrl = &info->rx_ctrl;
+
+    memset(info, 0, sizeof(wifi_csi_info_t));
+    rx_ctrl->rssi              = header->rssi;
+    rx_ctrl->rate              = header->rate;
+    rx_ctrl->sig_mode          = header->sig_mode;
+    rx_ctrl->mcs               = header->mcs;
+    rx_ctrl->cwb               = header->cwb;
+    rx_ctrl->stbc              = header->stbc;
+    rx_ctrl->sgi               = header->sgi;
+    rx_ctrl->noise_floor       = header->noise_floor;
+    rx_ctrl->ampdu_cnt         = header->ampdu_cnt;
+    rx_ctrl->channel           = header->channel;
+    rx_ctrl->secondary_channel = header->secondary_channel;
+    rx_ctrl->timestamp         = header->timestamp;
+    rx_ctrl->sig_len           = header->sig_len;
+    rx_ctrl->rx_state          = header->rx_state;
+    rx_ctrl->agc_gain          = header->agc_gain;
+    rx_ctrl->fft_gain          = header->fft_gain;
+
+    memcpy(info->mac, header->mac, sizeof(info->mac));
+    memcpy(info->dmac, s_wifi.mac, sizeof(info->dmac));
+    info->first_word_invalid = header->flags & CSI_FRAME_FLAG_FIRST_WORD_INVALID;
+    info->buf                = (int8_t *)packet->buf;
+    info->len                = header->payload_len;
+
+    memset(payload, 0, CSI_SIM_WIFI_PAYLOAD_LEN);
+    memcpy(payload + CSI_SIM_WIFI_SEQ_OFFSET, &header->seq, sizeof(header->seq));
+    info->payload     = payload;
+    info->payload_len = CSI_SIM_WIFI_PAYLOAD_LEN;
+    info->rx_seq      = (uint16_t)(header->seq & 0xfff);
+}
+
+static void csi_sim_wifi_task(void *arg)
+{
+    static csi_sim_packet_t packet;
+    uint8_t payload[CSI_SIM_WIFI_PAYLOAD_LEN];
+    wifi_csi_info_t info;
+
+    (void)arg;
+
+    for (;;) {
+        xQueueReceive(s_wifi.queue, &packet, portMAX_DELAY);
+
+        pthread_mutex_lock(&s_wifi.lock);
+        wifi_csi_cb_t cb = s_wifi.csi_enabled ? s_wifi.cb : NULL;
+        void *ctx = s_wifi.ctx;
+        pthread_mutex_unlock(&s_wifi.lock);
+
+        if (cb) {
+            csi_sim_wifi_info(&packet, &info, payload);
+            cb(ctx, &info);
+        }
+
+        pthread_mutex_lock(&s_wifi.lock);
+        if (cb) {
+            s_wifi.stats.delivered++;
+        } else {
+            s_wifi.stats.dropped++;
+        }
+        pthread_cond_broadcast(&s_wifi.handled);
+        pthread_mutex_unlock(&s_wifi.lock);
+    }
+}
+
+esp_err_t csi_sim_wifi_receive(const csi_sim_packet_t *packet, TickType_t wait)
+{
+    if (!s_wifi.started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /**
+     * @brief Counted before it is queued, so the Wi-Fi task never handles more than were received
+     */
+    pthread_mutex_lock(&s_wifi.lock);
+    s_wifi.stats.received++;
+    pthread_mutex_unlock(&s_wifi.lock);
+
+    if (xQueueSend(s_wifi.queue, packet, wait) != pdPASS) {
+        pthread_mutex_lock(&s_wifi.lock);
+        s_wifi.stats.received--;
+        pthread_mutex_unlock(&s_wifi.lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+void csi_sim_wifi_flush(void)
+{
+    pthread_mutex_lock(&s_wifi.lock);
+    while (s_wifi.stats.delivered + s_wifi.stats.dropped != s_wifi.stats.received) {
+        pthread_cond_wait(&s_wifi.handled, &s_wifi.lock);
+    }
+    pthread_mutex_unlock(&s_wifi.lock);
+
+    fflush(s_wifi.out ? s_wifi.out : stdout);
+}
+
+void csi_sim_wifi_get_stats(csi_sim_wifi_stats_t *stats)
+{
+    pthread_mutex_lock(&s_wifi.lock);
+    *stats = s_wifi.stats;
+    pthread_mutex_unlock(&s_wifi.lock);
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config)
+{
+    if (!config) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_wifi.initialized = true;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+    return s_wifi.initialized && mode <= WIFI_MODE_APSTA ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage)
+{
+    return s_wifi.initialized && storage <= WIFI_STORAGE_RAM ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_wifi_set_bandwidth(wifi_interface_t ifx, wifi_bandwidth_t bw)
+{
+    return s_wifi.initialized && ifx == WIFI_IF_STA && (bw == WIFI_BW_HT20 || bw == WIFI_BW_HT40)
+           ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+    if (!s_wifi.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    } else if (s_wifi.started) {
+        return ESP_OK;
+    }
+
+    s_wifi.queue = xQueueCreate(CSI_SIM_WIFI_QUEUE_LEN, sizeof(csi_sim_packet_t));
+
+    if (!s_wifi.queue || xTaskCreate(csi_sim_wifi_task, "wifi", 4096, NULL, 23, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_wifi.started = true;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type)
+{
+    return type <= WIFI_PS_MAX_MODEM ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_wifi_set_channel(uint8_t primary, wifi_second_chan_t second)
+{
+    return primary >= 1 && primary <= 14 && second <= WIFI_SECOND_CHAN_BELOW ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_wifi_set_mac(wifi_interface_t ifx, const uint8_t mac[6])
+{
+    if (ifx != WIFI_IF_STA || !mac) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(s_wifi.mac, mac, sizeof(s_wifi.mac));
+
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_promiscuous(bool enable)
+{
+    (void)enable;
+    return s_wifi.initialized ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_wifi_set_csi_config(const wifi_csi_config_t *config)
+{
+    return config ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_wifi_set_csi_rx_cb(wifi_csi_cb_t cb, void *ctx)
+{
+    pthread_mutex_lock(&s_wifi.lock);
+    s_wifi.cb  = cb;
+    s_wifi.ctx = ctx;
+    pthread_mutex_unlock(&s_wifi.lock);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_csi(bool enable)
+{
+    pthread_mutex_lock(&s_wifi.lock);
+    s_wifi.csi_enabled = enable;
+    pthread_mutex_unlock(&s_wifi.lock);
+
+    return ESP_OK;
+}
+
+void esp_csi_gain_ctrl_get_rx_gain(const wifi_pkt_rx_ctrl_t *rx_ctrl, uint8_t *agc_gain, int8_t *fft_gain)
+{
+    *agc_gain = rx_ctrl->agc_gain;
+    *fft_gain = rx_ctrl->fft_gain;
+}
+
+void esp_csi_gain_ctrl_record_rx_gain(uint8_t agc_gain, int8_t fft_gain)
+{
+    s_gain.count++;
+    s_gain.agc_sum += agc_gain;
+    s_gain.fft_sum += fft_gain;
+    s_gain.agc_baseline = (uint8_t)lround((double)s_gain.agc_sum / s_gain.count);
+    s_gain.fft_baseline = (int8_t)lround((double)s_gain.fft_sum / s_gain.count);
+}
+
+void esp_csi_gain_ctrl_get_rx_gain_baseline(uint8_t *agc_gain, int8_t *fft_gain)
+{
+    *agc_gain = s_gain.agc_baseline;
+    *fft_gain = s_gain.fft_baseline;
+}
+
+void esp_csi_gain_ctrl_set_rx_force_gain(uint8_t agc_gain, int8_t fft_gain)
+{
+    (void)agc_gain;
+    (void)fft_gain;
+}
+
+esp_err_t esp_csi_gain_ctrl_get_gain_compensation(float *compensate_gain, uint8_t agc_gain, int8_t fft_gain)
+{
+    if (!s_gain.count) {
+        *compensate_gain = 1.0f;
+        return ESP_OK;
+    }
+
+    int db = (agc_gain - s_gain.agc_baseline) + (fft_gain - s_gain.fft_baseline);
+    *compensate_gain = powf(10, -db / 20.0f);
+
+    return ESP_OK;
+}
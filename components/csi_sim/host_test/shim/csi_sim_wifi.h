@@ -0,0 +1,59 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Radio side of the host Wi-Fi shim: feeds csi_sim packets to the CSI callback a receiver
+ *        registered with esp_wifi_set_csi_rx_cb(), from a Wi-Fi task as the driver does
+ *
+ * A receiver's app_main.c is compiled unchanged against the headers of this directory, its
+ * app_main() brings up the shimmed Wi-Fi, and each packet handed to csi_sim_wifi_receive() is
+ * turned into a wifi_csi_info_t: rx_ctrl from the frame header, buf and len from the payload,
+ * and an ESP-NOW payload carrying header.seq at byte 15, where csi_send puts its counter.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "csi_sim.h"
+
+#define CSI_SIM_WIFI_QUEUE_LEN      16
+#define CSI_SIM_WIFI_PAYLOAD_LEN    32      /**< ESP-NOW payload of csi_send, the counter at byte 15 */
+#define CSI_SIM_WIFI_SEQ_OFFSET     15
+
+typedef struct {
+    uint32_t received;              /**< Packets passed to csi_sim_wifi_receive() */
+    uint32_t delivered;             /**< Packets the CSI callback was called for */
+    uint32_t dropped;               /**< Received while CSI was off or no callback was set */
+} csi_sim_wifi_stats_t;
+
+/**
+ * @brief Stream ets_printf() writes to, stdout until set
+ */
+void csi_sim_wifi_set_output(FILE *out);
+
+/**
+ * @brief Queue one packet for the Wi-Fi task
+ *
+ * @param wait Ticks to wait for room in the queue, like the driver's RX queue
+ *
+ * @return
+ *    - ESP_OK
+ *    - ESP_ERR_INVALID_STATE: esp_wifi_start() was not called
+ *    - ESP_ERR_NO_MEM: The queue stayed full for `wait` ticks
+ */
+esp_err_t csi_sim_wifi_receive(const csi_sim_packet_t *packet, TickType_t wait);
+
+/**
+ * @brief Wait until the Wi-Fi task has handled every packet received so far
+ */
+void csi_sim_wifi_flush(void);
+
+void csi_sim_wifi_get_stats(csi_sim_wifi_stats_t *stats);
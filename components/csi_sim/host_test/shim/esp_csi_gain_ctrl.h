@@ -0,0 +1,27 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the esp_csi_gain_ctrl component, implemented by csi_sim_wifi.c
+ *
+ * It models the gains the way csi_sim generates them: the CSI amplitude follows agc_gain + fft_gain
+ * in dB, so the compensation of a packet is 10^(-(gain - baseline) / 20), with the baseline the
+ * mean of the recorded gains. The real component uses calibrated per-chip tables instead.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_wifi_types.h"
+
+void esp_csi_gain_ctrl_get_rx_gain(const wifi_pkt_rx_ctrl_t *rx_ctrl, uint8_t *agc_gain, int8_t *fft_gain);
+void esp_csi_gain_ctrl_record_rx_gain(uint8_t agc_gain, int8_t fft_gain);
+void esp_csi_gain_ctrl_get_rx_gain_baseline(uint8_t *agc_gain, int8_t *fft_gain);
+void esp_csi_gain_ctrl_set_rx_force_gain(uint8_t agc_gain, int8_t fft_gain);
+esp_err_t esp_csi_gain_ctrl_get_gain_compensation(float *compensate_gain, uint8_t agc_gain, int8_t fft_gain);
@@ -0,0 +1,21 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the ESP-IDF header at log level WARN: errors and warnings go to stderr,
+ *        the per-packet info and debug lines of the receivers are compiled out
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...)     fprintf(stderr, "E (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)     fprintf(stderr, "W (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)     do { (void)(tag); } while (0)
+#define ESP_LOGD(tag, fmt, ...)     do { (void)(tag); } while (0)
+#define ESP_LOGV(tag, fmt, ...)     do { (void)(tag); } while (0)
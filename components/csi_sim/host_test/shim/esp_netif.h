@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the ESP-IDF header: no network stack, initialization always succeeds
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+static inline esp_err_t esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+static inline esp_err_t esp_event_loop_create_default(void)
+{
+    return ESP_OK;
+}
@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the ESP-NOW API: peers and rates are accepted and ignored
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "esp_wifi_types.h"
+
+typedef struct {
+    uint8_t peer_addr[6];
+    uint8_t lmk[16];
+    uint8_t channel;
+    wifi_interface_t ifidx;
+    bool    encrypt;
+    void   *priv;
+} esp_now_peer_info_t;
+
+typedef struct {
+    wifi_phy_mode_t phymode;
+    wifi_phy_rate_t rate;
+    bool ersu;
+    bool dcm;
+} esp_now_rate_config_t;
+
+static inline esp_err_t esp_now_init(void)
+{
+    return ESP_OK;
+}
+
+static inline esp_err_t esp_now_set_pmk(const uint8_t *pmk)
+{
+    return pmk ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+static inline esp_err_t esp_now_add_peer(const esp_now_peer_info_t *peer)
+{
+    return peer ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+static inline esp_err_t esp_now_set_peer_rate_config(const uint8_t *peer_addr, esp_now_rate_config_t *config)
+{
+    return peer_addr && config ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the ESP-IDF Wi-Fi types of an ESP32/ESP32-S3 class target
+ *
+ * The fields are plain integers instead of bitfields. agc_gain and fft_gain are not public
+ * fields on those chips, esp_csi_gain_ctrl extracts them from reserved bits; here they are
+ * spelled out so the shim of esp_csi_gain_ctrl can read them.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    int8_t   rssi;
+    uint8_t  rate;
+    uint8_t  sig_mode;
+    uint8_t  mcs;
+    uint8_t  cwb;
+    uint8_t  smoothing;
+    uint8_t  not_sounding;
+    uint8_t  aggregation;
+    uint8_t  stbc;
+    uint8_t  fec_coding;
+    uint8_t  sgi;
+    int8_t   noise_floor;
+    uint8_t  ampdu_cnt;
+    uint8_t  channel;
+    uint8_t  secondary_channel;
+    uint32_t timestamp;
+    uint8_t  ant;
+    uint16_t sig_len;
+    uint8_t  rx_state;
+    uint8_t  agc_gain;          /**< Host only, see the file comment */
+    int8_t   fft_gain;          /**< Host only, see the file comment */
+} wifi_pkt_rx_ctrl_t;
+
+typedef struct {
+    wifi_pkt_rx_ctrl_t rx_ctrl;
+    uint8_t  mac[6];
+    uint8_t  dmac[6];
+    bool     first_word_invalid;
+    int8_t  *buf;
+    uint16_t len;
+    uint8_t *hdr;
+    uint8_t *payload;
+    uint16_t payload_len;
+    uint16_t rx_seq;
+} wifi_csi_info_t;
+
+typedef struct {
+    bool    lltf_en;
+    bool    htltf_en;
+    bool    stbc_htltf2_en;
+    bool    ltf_merge_en;
+    bool    channel_filter_en;
+    bool    manu_scale;
+    uint8_t shift;
+    bool    dump_ack_en;
+} wifi_csi_config_t;
+
+typedef void (*wifi_csi_cb_t)(void *ctx, wifi_csi_info_t *info);
+
+typedef enum {
+    WIFI_MODE_NULL,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+} wifi_mode_t;
+
+typedef enum {
+    WIFI_IF_STA,
+    WIFI_IF_AP,
+} wifi_interface_t;
+
+typedef enum {
+    WIFI_STORAGE_FLASH,
+    WIFI_STORAGE_RAM,
+} wifi_storage_t;
+
+typedef enum {
+    WIFI_PS_NONE,
+    WIFI_PS_MIN_MODEM,
+    WIFI_PS_MAX_MODEM,
+} wifi_ps_type_t;
+
+typedef enum {
+    WIFI_BW_HT20 = 1,
+    WIFI_BW_HT40 = 2,
+} wifi_bandwidth_t;
+
+typedef enum {
+    WIFI_SECOND_CHAN_NONE,
+    WIFI_SECOND_CHAN_ABOVE,
+    WIFI_SECOND_CHAN_BELOW,
+} wifi_second_chan_t;
+
+typedef enum {
+    WIFI_PHY_MODE_LR,
+    WIFI_PHY_MODE_11B,
+    WIFI_PHY_MODE_11G,
+    WIFI_PHY_MODE_HT20,
+    WIFI_PHY_MODE_HT40,
+    WIFI_PHY_MODE_HE20,
+} wifi_phy_mode_t;
+
+typedef enum {
+    WIFI_PHY_RATE_1M_L   = 0x00,
+    WIFI_PHY_RATE_MCS0_LGI = 0x10,
+    WIFI_PHY_RATE_MCS0_SGI = 0x18,
+} wifi_phy_rate_t;
@@ -0,0 +1,34 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the FreeRTOS queue API: a fixed-size ring of copied items behind a mutex
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct csi_sim_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+
+void vQueueDelete(QueueHandle_t queue);
+
+/**
+ * @return pdPASS, or errQUEUE_FULL once `wait` ticks passed without room
+ */
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait);
+
+/**
+ * @return pdPASS, or pdFALSE once `wait` ticks passed without an item
+ */
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait);
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#define errQUEUE_FULL           ((BaseType_t)0)
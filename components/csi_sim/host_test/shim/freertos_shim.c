@@ -0,0 +1,212 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+struct csi_sim_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t items[];
+};
+
+typedef struct {
+    TaskFunction_t fn;
+    void *arg;
+} task_start_t;
+
+static void *task_entry(void *arg)
+{
+    task_start_t start = *(task_start_t *)arg;
+
+    free(arg);
+    start.fn(start.arg);
+
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle)
+{
+    task_start_t *start = malloc(sizeof(task_start_t));
+    pthread_t thread;
+
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+
+    if (!start) {
+        return pdFAIL;
+    }
+
+    start->fn  = fn;
+    start->arg = arg;
+
+    if (pthread_create(&thread, NULL, task_entry, start)) {
+        free(start);
+        return pdFAIL;
+    }
+
+    pthread_detach(thread);
+
+    if (handle) {
+        *handle = (TaskHandle_t)thread;
+    }
+
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (!task) {
+        pthread_exit(NULL);
+    }
+
+    abort();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {
+        .tv_sec  = ticks / 1000,
+        .tv_nsec = (long)(ticks % 1000) * 1000000,
+    };
+
+    while (nanosleep(&ts, &ts) && errno == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t queue = calloc(1, sizeof(struct csi_sim_queue) + (size_t)length * item_size);
+
+    if (!queue) {
+        return NULL;
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&queue->changed, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&queue->lock, NULL);
+    queue->length    = length;
+    queue->item_size = item_size;
+
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if (queue) {
+        pthread_cond_destroy(&queue->changed);
+        pthread_mutex_destroy(&queue->lock);
+        free(queue);
+    }
+}
+
+/**
+ * @brief Wait under the queue lock until ready() or `wait` ticks have passed
+ */
+static bool queue_wait(QueueHandle_t queue, bool (*ready)(QueueHandle_t), TickType_t wait)
+{
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec  += wait / 1000;
+    deadline.tv_nsec += (long)(wait % 1000) * 1000000;
+
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    while (!ready(queue)) {
+        if (!wait) {
+            return false;
+        } else if (wait == portMAX_DELAY) {
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        } else if (pthread_cond_timedwait(&queue->changed, &queue->lock, &deadline) == ETIMEDOUT) {
+            return ready(queue);
+        }
+    }
+
+    return true;
+}
+
+static bool queue_has_room(QueueHandle_t queue)
+{
+    return queue->count < queue->length;
+}
+
+static bool queue_has_item(QueueHandle_t queue)
+{
+    return queue->count > 0;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait)
+{
+    pthread_mutex_lock(&queue->lock);
+
+    if (!queue_wait(queue, queue_has_room, wait)) {
+        pthread_mutex_unlock(&queue->lock);
+        return errQUEUE_FULL;
+    }
+
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->items + (size_t)tail * queue->item_size, item, queue->item_size);
+    queue->count++;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait)
+{
+    pthread_mutex_lock(&queue->lock);
+
+    if (!queue_wait(queue, queue_has_item, wait)) {
+        pthread_mutex_unlock(&queue->lock);
+        return pdFALSE;
+    }
+
+    memcpy(item, queue->items + (size_t)queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+
+    return count;
+}
@@ -0,0 +1,14 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host stand-in for the ROM printf, writing to the stream set with csi_sim_wifi_set_output()
+ */
+
+#pragma once
+
+int ets_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
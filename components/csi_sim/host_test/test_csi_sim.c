@@ -0,0 +1,393 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief csi_sim on its own, then a recorded capture replayed through the csi_recv receive path:
+ *
+ * - The generator: every subcarrier layout, same seed same stream, loss leaving gaps in seq,
+ *   AGC steps reported through compensate_gain, and the phase slope of a delayed path.
+ * - CSV parsing of malformed lines and the pacer across the timestamp rollover and a restart.
+ * - A binary capture of generated frames, with packets of another sender and of a layout longer
+ *   than csi_recv prints, written to a file and read back in chunks. It is decoded with
+ *   csi_frame_decoder_feed(), paced with csi_sim_pacer_t and handed to the Wi-Fi shim, whose
+ *   Wi-Fi task calls the unmodified wifi_csi_rx_cb() of examples/get-started/csi_recv. Every
+ *   printed CSI_DATA line is parsed back and compared with the gain-compensated packet.
+ * - End-to-end replay throughput, packets per second through decode, callback and CSV printing.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "csi_sim.h"
+#include "csi_dsp.h"
+#include "csi_sim_wifi.h"
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define REPLAY_PACKETS      2000
+#define BENCH_PACKETS       5000
+#define CSI_RECV_MAX_LEN    612     /**< CSI_SCALED_MAX_LEN of csi_recv */
+#define OTHER_SENDER_EVERY  37
+#define LONG_LAYOUT_EVERY   50
+
+void app_main(void);
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int64_t now_us(void)
+{
+    return (int64_t)(now() * 1e6);
+}
+
+static void test_generator(void)
+{
+    static const uint16_t s_layouts[] = {52, 106, 114, 128, 234, 256, 384, 490, 512};
+    static csi_sim_packet_t a, b;
+    csi_sim_config_t config = CSI_SIM_CONFIG_DEFAULT();
+    csi_sim_t sim, other;
+
+    for (size_t i = 0; i < sizeof(s_layouts) / sizeof(s_layouts[0]); i++) {
+        config.subcarriers = s_layouts[i];
+        CHECK(csi_sim_init(&sim, &config) && csi_sim_init(&other, &config));
+
+        for (int n = 0; n < 20; n++) {
+            csi_sim_next(&sim, &a);
+            csi_sim_next(&other, &b);
+            CHECK(a.header.payload_len == 2 * s_layouts[i] && a.header.type == CSI_FRAME_TYPE_CSI);
+            CHECK(!memcmp(&a.header, &b.header, sizeof(a.header)) && !memcmp(a.buf, b.buf, a.header.payload_len));
+        }
+
+        config.seed = 2;
+        CHECK(csi_sim_init(&other, &config));
+        csi_sim_next(&other, &b);
+        CHECK(memcmp(a.buf, b.buf, a.header.payload_len));
+        config.seed = 1;
+    }
+
+    config.subcarriers = 100;
+    CHECK(!csi_sim_init(&sim, &config));
+    config = (csi_sim_config_t)CSI_SIM_CONFIG_DEFAULT();
+    config.tap_count = 0;
+    CHECK(!csi_sim_init(&sim, &config));
+    config = (csi_sim_config_t)CSI_SIM_CONFIG_DEFAULT();
+    config.loss_rate = 1;
+    CHECK(!csi_sim_init(&sim, &config));
+
+    /**
+     * @brief Lost packets leave gaps in seq and timestamp, the AGC steps by 6 dB every 100 packets
+     */
+    config = (csi_sim_config_t)CSI_SIM_CONFIG_DEFAULT();
+    config.loss_rate = 0.2f;
+    config.gain_step_interval = 100;
+    config.gain_step_db = 6;
+    CHECK(csi_sim_init(&sim, &config));
+
+    uint32_t last_seq = 0;
+
+    for (int n = 0; n < 2000; n++) {
+        csi_sim_next(&sim, &a);
+        CHECK(n == 0 || a.header.seq > last_seq);
+        CHECK(a.header.timestamp == a.header.seq * config.interval_us);
+
+        bool stepped = (a.header.seq / 100) % 2;
+        CHECK(a.header.agc_gain == config.agc_gain + (stepped ? 6 : 0));
+        CHECK(fabsf(a.header.compensate_gain - (stepped ? 0.501187f : 1.0f)) < 1e-4f);
+        last_seq = a.header.seq;
+    }
+
+    CHECK(sim.packet_count == 2000 && sim.packet_count + sim.lost_count == sim.seq);
+    CHECK(sim.lost_count > 400 && sim.lost_count < 600);
+
+    /**
+     * @brief One path delayed by 2 samples, no noise: constant amplitude, phase falling 2 * pi * 2 / N
+     *        per subcarrier
+     */
+    config = (csi_sim_config_t)CSI_SIM_CONFIG_DEFAULT();
+    config.tap_count = 1;
+    config.taps[0] = (csi_sim_tap_t){.gain = 1, .delay = 2};
+    config.snr_db = 0;
+    CHECK(csi_sim_init(&sim, &config));
+    csi_sim_next(&sim, &a);
+
+    for (int k = 0; k < config.subcarriers; k++) {
+        float im = a.buf[2 * k], re = a.buf[2 * k + 1];
+        float expected = -2 * (float)M_PI * 2 * k / config.subcarriers;
+        float error = remainderf(atan2f(im, re) - expected, 2 * (float)M_PI);
+
+        CHECK(fabsf(hypotf(re, im) - config.amplitude) < 1);
+        CHECK(fabsf(error) < 0.03f);
+    }
+}
+
+static bool parse(const char *line, csi_sim_packet_t *packet)
+{
+    return csi_sim_parse_csv_line(line, strlen(line), packet);
+}
+
+static void test_parse_malformed(void)
+{
+    static csi_sim_packet_t packet;
+    static const char *s_he = "CSI_DATA,7,1a:00:00:00:00:00,-40,11,-95,0,32,11,1000,64,0,4,0,\"[1,-2,3,-4]\"";
+
+    CHECK(parse(s_he, &packet) && packet.header.seq == 7 && packet.header.payload_len == 4);
+    CHECK(packet.buf[1] == -2 && packet.header.agc_gain == 32 && packet.header.timestamp == 1000);
+    CHECK(parse("AC:67:B2:01:02:03,CSI_DATA,7,1a:00:00:00:00:00,-40,11,-95,0,32,11,1000,64,0,4,0,\"[1, 300 ,3,-4]\"", &packet));
+    CHECK(packet.buf[1] == 127);
+
+    static const char *s_bad[] = {
+        "CSI_DATA,7x,1a:00:00:00:00:00,-40,11,-95,0,32,11,1000,64,0,4,0,\"[1,-2,3,-4]\"",
+        "CSI_DATA,7 5,1a:00:00:00:00:00,-40,11,-95,0,32,11,1000,64,0,4,0,\"[1,-2,3,-4]\"",
+        "CSI_DATA,7,1a:00:00:00:00:00,-40,11,-95,0,32,11,1000,64,0,4,0,\"[1,-2z,3,-4]\"",
+        "CSI_DATA,7,1a:00:00:00:00:00,-40,11,-95,0,32,11,1000,64,0,4,0,\"[1,-2,3,-4",
+        "CSI_DATA,7,1a:00:00:00:0g:00,-40,11,-95,0,32,11,1000,64,0,4,0,\"[1,-2,3,-4]\"",
+        "CSI_DATA,7,1a:00:00:00:00:00,-40,11,-95,0,32,11,1000,64,0,\"[1,-2,3,-4]\"",
+        "CSI_DAT,7,1a:00:00:00:00:00,-40,11,-95,0,32,11,1000,64,0,4,0,\"[1,-2,3,-4]\"",
+    };
+
+    for (size_t i = 0; i < sizeof(s_bad) / sizeof(s_bad[0]); i++) {
+        CHECK(!parse(s_bad[i], &packet));
+    }
+}
+
+static void test_pacer(void)
+{
+    csi_sim_pacer_t pacer;
+
+    csi_sim_pacer_init(&pacer, 2);
+    CHECK(csi_sim_pacer_delay_us(&pacer, UINT32_MAX - 1000, 5000) == 0);
+    CHECK(csi_sim_pacer_delay_us(&pacer, 1000, 5000) == 1000);             /**< 2001 us recorded across the rollover, due at 6000 */
+    CHECK(csi_sim_pacer_delay_us(&pacer, 5001, 6000) == 2001);
+    CHECK(csi_sim_pacer_delay_us(&pacer, 5001, 9000) == 0);                 /**< Late: due already */
+    CHECK(csi_sim_pacer_delay_us(&pacer, 10, 20000) == 0);                  /**< Backwards: restart */
+    CHECK(csi_sim_pacer_delay_us(&pacer, 4010, 20000) == 2000);
+
+    csi_sim_pacer_init(&pacer, 0);
+    CHECK(csi_sim_pacer_delay_us(&pacer, 0, 0) == 0 && csi_sim_pacer_delay_us(&pacer, 1000000, 0) == 0);
+}
+
+typedef struct {
+    csi_sim_pacer_t pacer;
+    uint32_t frames;
+} replay_t;
+
+static void replay_cb(const csi_frame_header_t *header, const uint8_t *payload, void *ctx)
+{
+    static csi_sim_packet_t packet;
+    replay_t *replay = ctx;
+    int64_t delay = csi_sim_pacer_delay_us(&replay->pacer, header->timestamp, now_us());
+
+    CHECK(csi_sim_from_frame(header, payload, &packet));
+
+    if (delay > 0) {
+        struct timespec ts = {.tv_sec = delay / 1000000, .tv_nsec = (delay % 1000000) * 1000};
+        nanosleep(&ts, NULL);
+    }
+
+    CHECK(csi_sim_wifi_receive(&packet, portMAX_DELAY) == ESP_OK);
+    replay->frames++;
+}
+
+/**
+ * @brief Replay a capture file in 4 KB reads, as a log would be streamed from disk or a serial port
+ */
+static uint32_t replay_capture(FILE *capture, float speed)
+{
+    static csi_frame_decoder_t decoder;
+    uint8_t chunk[4096];
+    replay_t replay = {0};
+    size_t len;
+
+    csi_frame_decoder_init(&decoder);
+    csi_sim_pacer_init(&replay.pacer, speed);
+    rewind(capture);
+
+    while ((len = fread(chunk, 1, sizeof(chunk), capture)) > 0) {
+        csi_frame_decoder_feed(&decoder, chunk, len, replay_cb, &replay);
+    }
+
+    CHECK(decoder.error_count == 0 && decoder.skipped_bytes == 0);
+    csi_sim_wifi_flush();
+
+    return replay.frames;
+}
+
+/**
+ * @brief A capture of `count` frames: mostly the configured sender, some from another MAC, and
+ *        some of a layout longer than csi_recv prints. Returns the frames csi_recv will print.
+ */
+static FILE *capture_create(uint32_t count, csi_sim_packet_t *printed, uint32_t *printed_count)
+{
+    static uint8_t frame[CSI_FRAME_MAX_SIZE];
+    static csi_sim_packet_t packet;
+    csi_sim_config_t config = CSI_SIM_CONFIG_DEFAULT();
+    csi_sim_config_t long_config = CSI_SIM_CONFIG_DEFAULT();
+    csi_sim_t sim, long_sim;
+    FILE *capture = tmpfile();
+
+    config.subcarriers = 234;
+    config.loss_rate = 0.05f;
+    config.phase_jitter = 0.3f;
+    config.gain_step_interval = 300;    /**< After the 100-packet baseline */
+    config.gain_step_db = 6;
+    long_config.subcarriers = 384;
+    long_config.seed = 7;
+
+    CHECK(capture && csi_sim_init(&sim, &config) && csi_sim_init(&long_sim, &long_config));
+    *printed_count = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        bool other_sender = i % OTHER_SENDER_EVERY == OTHER_SENDER_EVERY - 1;
+
+        if (i % LONG_LAYOUT_EVERY == LONG_LAYOUT_EVERY - 1) {
+            csi_sim_next(&long_sim, &packet);
+            packet.header.seq = 1000000 + i;
+        } else {
+            csi_sim_next(&sim, &packet);
+        }
+
+        if (other_sender) {
+            packet.header.mac[5] = 0x42;
+        } else if (printed) {
+            printed[(*printed_count)++] = packet;
+        }
+
+        size_t len = csi_frame_encode(&packet.header, packet.buf, packet.header.payload_len, frame, sizeof(frame));
+        CHECK(len && fwrite(frame, 1, len, capture) == len);
+    }
+
+    fflush(capture);
+
+    return capture;
+}
+
+/**
+ * @brief The CSI_DATA lines of out against the packets csi_recv should have printed, in order
+ */
+static void check_printed(char *out, size_t out_len, const csi_sim_packet_t *expected, uint32_t count)
+{
+    static csi_sim_packet_t parsed;
+    uint32_t lines = 0;
+    bool header_line = false;
+
+    for (char *line = out, *next; line < out + out_len; line = next + 1) {
+        next = memchr(line, '\n', out + out_len - line);
+        CHECK(next);
+
+        if (!strncmp(line, "type,id,mac,", 12)) {
+            header_line = true;
+            continue;
+        }
+
+        CHECK(lines < count && csi_sim_parse_csv_line(line, next - line, &parsed));
+
+        const csi_frame_header_t *header = &expected[lines].header;
+        const int8_t *buf = expected[lines].buf;
+        int len = header->payload_len < CSI_RECV_MAX_LEN ? header->payload_len : CSI_RECV_MAX_LEN;
+
+        CHECK(parsed.header.seq == header->seq && !memcmp(parsed.header.mac, header->mac, 6));
+        CHECK(parsed.header.rssi == header->rssi && parsed.header.noise_floor == header->noise_floor);
+        CHECK(parsed.header.channel == header->channel && parsed.header.timestamp == header->timestamp);
+        CHECK(parsed.header.sig_len == header->sig_len && parsed.header.payload_len == len);
+
+        /**
+         * @brief The shim's gain model undoes the AGC steps of the generator: 10^(-(agc - baseline) / 20)
+         */
+        float compensate = powf(10, -(header->agc_gain - 32 + header->fft_gain) / 20.0f);
+        int32_t gain_q15 = csi_dsp_gain_to_q15(compensate);
+
+        for (int i = 0; i < len; i++) {
+            int32_t value = gain_q15 * buf[i] / 32768;
+            value = value > 127 ? 127 : value < -128 ? -128 : value;
+            CHECK(parsed.buf[i] == value);
+        }
+
+        lines++;
+    }
+
+    CHECK(header_line && lines == count);
+}
+
+static void test_replay_csi_recv(void)
+{
+    static csi_sim_packet_t expected[REPLAY_PACKETS];
+    csi_sim_wifi_stats_t stats;
+    uint32_t expected_count;
+    char *out = NULL;
+    size_t out_len = 0;
+    FILE *out_stream = open_memstream(&out, &out_len);
+
+    CHECK(out_stream);
+    csi_sim_wifi_set_output(out_stream);
+
+    app_main();
+
+    FILE *capture = capture_create(REPLAY_PACKETS, expected, &expected_count);
+    CHECK(replay_capture(capture, 0) == REPLAY_PACKETS);
+
+    csi_sim_wifi_get_stats(&stats);
+    CHECK(stats.received == REPLAY_PACKETS && stats.delivered == REPLAY_PACKETS && stats.dropped == 0);
+
+    fclose(out_stream);
+    check_printed(out, out_len, expected, expected_count);
+    free(out);
+    fclose(capture);
+
+    /**
+     * @brief Real-time pacing: 40 frames recorded 10 ms apart, replayed at 4x, take about 100 ms
+     */
+    capture = capture_create(40, NULL, &expected_count);
+    out_stream = fopen("/dev/null", "w");
+    CHECK(out_stream);
+    csi_sim_wifi_set_output(out_stream);
+
+    double start = now();
+    CHECK(replay_capture(capture, 4) == 40);
+    double elapsed = now() - start;
+
+    fclose(capture);
+    printf("replay of %d ms at 4x: %.0f ms\n", 39 * 10, elapsed * 1e3);
+    CHECK(elapsed > 0.09 && elapsed < 1);
+
+    /**
+     * @brief Unpaced throughput, CSV printing into /dev/null
+     */
+    capture = capture_create(BENCH_PACKETS, NULL, &expected_count);
+    start = now();
+    CHECK(replay_capture(capture, 0) == BENCH_PACKETS);
+    elapsed = now() - start;
+    printf("csi_recv replay: %.0f packets/s end to end (decode, Wi-Fi task, wifi_csi_rx_cb, CSV)\n",
+           BENCH_PACKETS / elapsed);
+
+    fclose(capture);
+    fclose(out_stream);
+    csi_sim_wifi_set_output(NULL);
+}
+
+int main(void)
+{
+    test_generator();
+    test_parse_malformed();
+    test_pacer();
+    test_replay_csi_recv();
+
+    printf("test_csi_sim: all tests passed\n");
+
+    return 0;
+}
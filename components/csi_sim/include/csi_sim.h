@@ -0,0 +1,163 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Deterministic CSI packet source for exercising receivers without radios
+ *
+ * Packets are a csi_frame_header_t with the I/Q payload behind it, the same
+ * record the receivers write with csi_frame_print(), and come from either
+ *
+ * - the generator, which synthesizes a multipath channel on one of the CSI
+ *   subcarrier layouts, with noise, phase offsets, AGC steps and packet loss,
+ *   from a seed so that a run can be reproduced exactly, or
+ * - recorded logs: the CSV lines printed by csi_recv / csi_recv_router, or
+ *   binary csi_frame streams decoded with csi_frame_decoder_feed().
+ *
+ * csi_sim_pacer_t spaces packets out by their recorded `timestamp` so a
+ * replay runs with the original timing, scaled or as fast as possible.
+ *
+ * No ESP-IDF dependency beyond csi_frame, everything builds on a host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "csi_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSI_SIM_TAP_MAX             8
+
+/**
+ * @brief One path of the simulated channel
+ */
+typedef struct {
+    float gain;                     /**< Linear amplitude relative to the other taps */
+    float delay;                    /**< Delay in samples of the subcarrier grid, may be fractional */
+    float phase;                    /**< Phase of the path, radians */
+} csi_sim_tap_t;
+
+typedef struct {
+    uint16_t subcarriers;           /**< 52, 106, 114, 128, 234, 256, 384, 490 or 512; two payload bytes each */
+    uint32_t seed;                  /**< Same seed and configuration, same packet stream */
+    uint32_t interval_us;           /**< Nominal spacing of packets */
+    uint32_t interval_jitter_us;    /**< Uniform extra spacing in [0, interval_jitter_us] */
+    uint8_t  tap_count;             /**< 1 ~ CSI_SIM_TAP_MAX */
+    csi_sim_tap_t taps[CSI_SIM_TAP_MAX];
+    float    amplitude;             /**< I/Q magnitude where all taps add in phase, before noise, int8 units */
+    float    snr_db;                /**< Per-subcarrier SNR of the added Gaussian noise, 0 for none */
+    float    phase_offset;          /**< Common phase of every packet, radians */
+    float    phase_jitter;          /**< Random common phase per packet, uniform in [-phase_jitter, phase_jitter] */
+    float    delay_jitter;          /**< Random timing offset per packet in samples, uniform in [-delay_jitter, delay_jitter] */
+    float    loss_rate;             /**< Probability that a packet is dropped, 0 ~ 1 exclusive */
+    uint32_t gain_step_interval;    /**< Packets between AGC steps, 0 for none */
+    int8_t   gain_step_db;          /**< agc_gain change of a step, up and down alternately; the amplitude follows */
+    uint8_t  mac[6];
+    int8_t   rssi;
+    int8_t   noise_floor;
+    uint8_t  channel;
+    uint8_t  agc_gain;
+    int8_t   fft_gain;
+} csi_sim_config_t;
+
+/**
+ * @brief 128 subcarriers at 100 Hz: two paths, 30 dB SNR, no loss or gain steps
+ */
+#define CSI_SIM_CONFIG_DEFAULT() { \
+    .subcarriers  = 128, \
+    .seed         = 1, \
+    .interval_us  = 10 * 1000, \
+    .tap_count    = 2, \
+    .taps         = {{.gain = 1.0f, .delay = 0.0f}, {.gain = 0.4f, .delay = 3.5f, .phase = 1.0f}}, \
+    .amplitude    = 40.0f, \
+    .snr_db       = 30.0f, \
+    .mac          = {0x1a, 0x00, 0x00, 0x00, 0x00, 0x00}, \
+    .rssi         = -40, \
+    .noise_floor  = -95, \
+    .channel      = 11, \
+    .agc_gain     = 32, \
+}
+
+typedef struct {
+    csi_frame_header_t header;      /**< type CSI_FRAME_TYPE_CSI, payload_len bytes of buf are valid */
+    int8_t buf[CSI_FRAME_MAX_PAYLOAD_LEN];
+} csi_sim_packet_t;
+
+typedef struct {
+    csi_sim_config_t config;
+    uint32_t rng;
+    uint32_t seq;                   /**< Sequence id of the next packet, lost ones included */
+    uint32_t timestamp;             /**< Timestamp of the next packet, microseconds */
+    uint32_t packet_count;          /**< Packets delivered */
+    uint32_t lost_count;            /**< Packets dropped by loss_rate */
+    uint8_t  agc_gain;              /**< Current AGC gain, moved by the gain steps */
+    float    gain;                  /**< Current linear amplitude factor of the gain steps */
+} csi_sim_t;
+
+/**
+ * @return false if the subcarrier layout, tap_count or loss_rate is not supported
+ */
+bool csi_sim_init(csi_sim_t *sim, const csi_sim_config_t *config);
+
+/**
+ * @brief Generate the next delivered packet; lost packets only advance seq and timestamp
+ */
+void csi_sim_next(csi_sim_t *sim, csi_sim_packet_t *packet);
+
+/**
+ * @brief Parse one CSV line printed by csi_recv or csi_recv_router, either column layout
+ *
+ * The recorded values are gain-compensated and are clipped to int8. Text before
+ * "CSI_DATA", such as the station MAC of the UDP stream, is ignored.
+ *
+ * @param line Line without the trailing newline, not necessarily NUL-terminated
+ *
+ * @return false if the line is not a complete CSI_DATA line
+ */
+bool csi_sim_parse_csv_line(const char *line, size_t len, csi_sim_packet_t *packet);
+
+/**
+ * @brief Copy a CSI_FRAME_TYPE_CSI frame, e.g. from a csi_frame_decoder_feed() callback
+ *
+ * @return false for other frame types
+ */
+bool csi_sim_from_frame(const csi_frame_header_t *header, const uint8_t *payload, csi_sim_packet_t *packet);
+
+/**
+ * @brief Replays packets at the pace of their recorded timestamps
+ *
+ * Timestamps are unwrapped across the 32-bit rollover. A timestamp that goes
+ * backwards, e.g. where logs of two boots are concatenated, restarts the pacing.
+ */
+typedef struct {
+    float    speed;                 /**< 1 replays in real time, 2 twice as fast, 0 without waiting */
+    bool     started;
+    uint32_t last_timestamp;
+    int64_t  recorded_us;           /**< Unwrapped recording time since the first packet */
+    int64_t  start_us;              /**< Clock value the first packet was due at */
+} csi_sim_pacer_t;
+
+void csi_sim_pacer_init(csi_sim_pacer_t *pacer, float speed);
+
+/**
+ * @brief Time to wait before delivering a packet
+ *
+ * @param timestamp Recorded `timestamp` of the packet, microseconds
+ * @param now_us    Current time of any monotonic microsecond clock
+ *
+ * @return Microseconds until the packet is due, 0 if it is due already
+ */
+int64_t csi_sim_pacer_delay_us(csi_sim_pacer_t *pacer, uint32_t timestamp, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
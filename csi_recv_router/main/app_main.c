@@ -2,6 +2,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <sys/param.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -15,6 +16,7 @@
 #include "esp_wifi.h"
 #include "esp_netif.h"
 #include "esp_now.h"
+#include "esp_timer.h"
 
 #include "lwip/inet.h"
 #include "lwip/netdb.h"
@@ -23,12 +25,22 @@
 
 #include "protocol_examples_common.h"
 #include "esp_csi_gain_ctrl.h"
+#include "csi_frame.h"
+#include "csi_ring.h"
+#include "csi_dsp.h"
+#include "csi_dsp_gain_ctrl.h"
+#include "csi_metrics.h"
 
 #define CONFIG_SEND_FREQUENCY     1    /* CSI/ping rate in Hz */
 #if CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61
 #define CSI_FORCE_LLTF                      0
 #endif
 #define CONFIG_FORCE_GAIN                   0
+#define CONFIG_CSI_OUTPUT_BINARY            0   // 1: compact binary frames (components/csi_frame), 0: CSV text
+#define CONFIG_UDP_BATCH_ENABLE             1   // 1: pack several CSI records per UDP datagram, 0: one datagram per record
+#define CONFIG_UDP_BATCH_MTU                1400    // largest datagram payload in bytes, keep below the path MTU
+#define CONFIG_UDP_BATCH_DEADLINE_MS        20      // flush a partial batch once its oldest record is this old
+#define CONFIG_METRICS_INTERVAL_MS          5000    // period of the CSI_METRICS record in the UDP stream, 0 to disable
 
 #if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32C3 || CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32C61
 #define CONFIG_GAIN_CONTROL                 1
@@ -44,60 +56,297 @@ static const char *TAG = "csi_recv_router";
 #define UDP_SERVER_PORT         5001              /* Change to your UDP server port */
 #define UDP_MAX_CSI_PACKET_SIZE 1024
 
+#define UDP_BUF_POOL_NUM        16
+
+/**
+ * @brief Pooled UDP record buffer. Ownership moves by index through s_csi_udp_free_queue
+ *        (formatter takes it) and s_csi_udp_queue (sender takes it and gives it back).
+ */
+typedef struct {
+    size_t  len;
+    int64_t t0;                 /**< Driver callback time of the CSI packet, 0 for a CSI_METRICS record */
+    char    data[UDP_MAX_CSI_PACKET_SIZE];
+} csi_udp_buf_t;
+
+#define CSI_UDP_BATCH_MAGIC0    'C'
+#define CSI_UDP_BATCH_MAGIC1    'B'
+#define CSI_UDP_BATCH_VERSION   1
+
+/**
+ * @brief Header of a batched datagram, followed by `record_count` CSV lines each terminated by '\n'
+ */
 typedef struct {
-    size_t len;
-    char   data[UDP_MAX_CSI_PACKET_SIZE];
-} csi_udp_msg_t;
+    uint8_t  magic[2];          /**< CSI_UDP_BATCH_MAGIC0, CSI_UDP_BATCH_MAGIC1 */
+    uint8_t  version;           /**< CSI_UDP_BATCH_VERSION */
+    uint8_t  record_count;      /**< Number of CSV records in the datagram */
+    uint8_t  mac[6];            /**< STA MAC of the sender */
+    uint32_t seq;               /**< Datagram sequence number, little-endian, gaps mean lost datagrams */
+} __attribute__((packed)) csi_udp_batch_header_t;
+
+#if CONFIG_UDP_BATCH_ENABLE
+_Static_assert(CONFIG_UDP_BATCH_MTU >= sizeof(csi_udp_batch_header_t) + UDP_MAX_CSI_PACKET_SIZE,
+               "CONFIG_UDP_BATCH_MTU must hold the header and one full CSI record");
+#endif
 
+static csi_udp_buf_t s_udp_buf_pool[UDP_BUF_POOL_NUM];
+static QueueHandle_t s_csi_udp_free_queue = NULL;
 static QueueHandle_t s_csi_udp_queue = NULL;
 static int s_udp_sock = -1;
 static struct sockaddr_in s_udp_dest_addr;
 static uint8_t s_sta_mac[6] = {0};
 
+/**
+ * @brief Latency from the Wi-Fi callback to the end of each stage, in microseconds
+ */
+enum {
+    CSI_STAGE_QUEUE,            /**< Waiting in the slot ring for csi_format_task */
+    CSI_STAGE_FORMAT,           /**< Compensated, printed and queued for the UDP sender */
+    CSI_STAGE_SEND,             /**< Handed to the UDP stack */
+};
+
+enum {
+    CSI_DROP_OVERSIZE,          /**< Larger than a ring slot */
+    CSI_DROP_RING_FULL,         /**< csi_format_task fell behind */
+    CSI_DROP_UDP_BUF,           /**< UDP pool exhausted, the sender fell behind */
+    CSI_DROP_UDP_SEND,          /**< Records in datagrams sendmsg() failed on */
+};
+
+static csi_metrics_stage_t s_csi_stages[] = {
+    [CSI_STAGE_QUEUE]  = {.name = "queue"},
+    [CSI_STAGE_FORMAT] = {.name = "format"},
+    [CSI_STAGE_SEND]   = {.name = "send"},
+};
+
+static csi_metrics_counter_t s_csi_drops[] = {
+    [CSI_DROP_OVERSIZE]  = {.name = "oversize"},
+    [CSI_DROP_RING_FULL] = {.name = "ring_full"},
+    [CSI_DROP_UDP_BUF]   = {.name = "udp_buf"},
+    [CSI_DROP_UDP_SEND]  = {.name = "udp_send"},
+};
+
+static csi_metrics_t s_csi_metrics = CSI_METRICS_INIT(s_csi_stages, s_csi_drops);
+
+static inline void csi_stage_done(int stage, int64_t t0)
+{
+    csi_metrics_hist_record(&s_csi_stages[stage].latency, (uint32_t)(esp_timer_get_time() - t0));
+}
+
+/**
+ * @brief Take a free buffer from the UDP pool, without blocking
+ *
+ * @return Pool index, or -1 if every buffer is queued or being sent
+ */
+static int csi_udp_buf_take(void)
+{
+    uint8_t index = 0;
+
+    if (!s_csi_udp_free_queue || xQueueReceive(s_csi_udp_free_queue, &index, 0) != pdTRUE) {
+        return -1;
+    }
+
+    return index;
+}
+
+static void csi_udp_buf_give(uint8_t index)
+{
+    xQueueSend(s_csi_udp_free_queue, &index, 0);
+}
+
+/**
+ * @brief Send one datagram gathered from iov, retrying briefly on transient ENOMEM from the UDP stack
+ */
+static int csi_udp_send(struct iovec *iov, int iovcnt)
+{
+    if (s_udp_sock < 0) {
+        s_udp_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+        if (s_udp_sock < 0) {
+            ESP_LOGE(TAG, "Unable to create UDP socket: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            return -1;
+        }
+    }
+
+    struct msghdr msg = {
+        .msg_name    = &s_udp_dest_addr,
+        .msg_namelen = sizeof(s_udp_dest_addr),
+        .msg_iov     = iov,
+        .msg_iovlen  = iovcnt,
+    };
+
+    int retries = 3;
+    int err = -1;
+    while (retries-- > 0) {
+        err = sendmsg(s_udp_sock, &msg, 0);
+        if (err >= 0) {
+            ESP_LOGD(TAG, "CSI UDP packet sent (%d bytes)", err);
+            break;
+        }
+
+        if (errno == ENOMEM) {
+            /* Transient out-of-memory in UDP stack, back off briefly and retry */
+            vTaskDelay(pdMS_TO_TICKS(5));
+        } else {
+            ESP_LOGE(TAG, "UDP send failed: errno %d", errno);
+            break;
+        }
+    }
+
+    if (err < 0 && errno == ENOMEM) {
+        static uint32_t s_udp_enomem_count = 0;
+        s_udp_enomem_count++;
+        if ((s_udp_enomem_count % 100) == 0) {
+            ESP_LOGW(TAG, "UDP ENOMEM occurred %u times (dropping packets)", (unsigned int)s_udp_enomem_count);
+        }
+    }
+
+    return err;
+}
+
+#if CONFIG_UDP_BATCH_ENABLE
+/**
+ * @brief Records of the pending datagram stay in their pool buffers until it is sent;
+ *        sendmsg() gathers them behind the header straight into the pbuf.
+ */
+static csi_udp_batch_header_t s_udp_batch_header;
+static uint8_t s_udp_batch_index[UDP_BUF_POOL_NUM];
+static size_t s_udp_batch_len = 0;
+static uint32_t s_udp_batch_seq = 0;
+
+static void csi_udp_batch_flush(void)
+{
+    struct iovec iov[UDP_BUF_POOL_NUM + 1];
+    uint8_t count = s_udp_batch_header.record_count;
+
+    if (!count) {
+        return;
+    }
+
+    s_udp_batch_header.seq = s_udp_batch_seq++;
+    iov[0].iov_base = &s_udp_batch_header;
+    iov[0].iov_len  = sizeof(s_udp_batch_header);
+
+    for (int i = 0; i < count; i++) {
+        csi_udp_buf_t *buf = &s_udp_buf_pool[s_udp_batch_index[i]];
+        iov[i + 1].iov_base = buf->data;
+        iov[i + 1].iov_len  = buf->len;
+    }
+
+    int err = csi_udp_send(iov, count + 1);
+
+    for (int i = 0; i < count; i++) {
+        csi_udp_buf_t *buf = &s_udp_buf_pool[s_udp_batch_index[i]];
+
+        if (err < 0) {
+            csi_metrics_counter_add(&s_csi_drops[CSI_DROP_UDP_SEND], 1);
+        } else if (buf->t0) {
+            csi_stage_done(CSI_STAGE_SEND, buf->t0);
+        }
+
+        csi_udp_buf_give(s_udp_batch_index[i]);
+    }
+
+    s_udp_batch_header.record_count = 0;
+    s_udp_batch_len = sizeof(s_udp_batch_header);
+}
+
 static void csi_udp_sender_task(void *arg)
 {
+    const TickType_t deadline_ticks = pdMS_TO_TICKS(CONFIG_UDP_BATCH_DEADLINE_MS);
+    TickType_t batch_start = 0;
+
+    s_udp_batch_header.magic[0] = CSI_UDP_BATCH_MAGIC0;
+    s_udp_batch_header.magic[1] = CSI_UDP_BATCH_MAGIC1;
+    s_udp_batch_header.version  = CSI_UDP_BATCH_VERSION;
+    memcpy(s_udp_batch_header.mac, s_sta_mac, sizeof(s_udp_batch_header.mac));
+    s_udp_batch_len = sizeof(s_udp_batch_header);
+
     for (;;) {
-        csi_udp_msg_t msg;
-        if (xQueueReceive(s_csi_udp_queue, &msg, portMAX_DELAY) == pdTRUE) {
-            if (s_udp_sock < 0) {
-                s_udp_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
-                if (s_udp_sock < 0) {
-                    ESP_LOGE(TAG, "Unable to create UDP socket: errno %d", errno);
-                    vTaskDelay(pdMS_TO_TICKS(100));
-                    continue;
-                }
+        uint8_t index = 0;
+        TickType_t wait = portMAX_DELAY;
+
+        if (s_udp_batch_header.record_count) {
+            TickType_t elapsed = xTaskGetTickCount() - batch_start;
+            wait = elapsed < deadline_ticks ? deadline_ticks - elapsed : 0;
+        }
+
+        if (xQueueReceive(s_csi_udp_queue, &index, wait) == pdTRUE) {
+            csi_udp_buf_t *buf = &s_udp_buf_pool[index];
+
+            /* A record truncated by the formatter has lost its '\n', put it back as the separator */
+            if (buf->len && buf->data[buf->len - 1] != '\n') {
+                buf->data[buf->len++] = '\n';
             }
 
-            int retries = 3;
-            int err = -1;
-            while (retries-- > 0) {
-                err = sendto(s_udp_sock, msg.data, msg.len, 0,
-                             (struct sockaddr *)&s_udp_dest_addr,
-                             sizeof(s_udp_dest_addr));
-                if (err >= 0) {
-                    ESP_LOGI(TAG, "CSI UDP packet sent (%d bytes)", err);
-                    break;
-                }
-
-                if (errno == ENOMEM) {
-                    /* Transient out-of-memory in UDP stack, back off briefly and retry */
-                    vTaskDelay(pdMS_TO_TICKS(5));
-                } else {
-                    ESP_LOGE(TAG, "UDP send failed: errno %d", errno);
-                    break;
-                }
+            if (s_udp_batch_len + buf->len > CONFIG_UDP_BATCH_MTU) {
+                csi_udp_batch_flush();
             }
 
-            if (err < 0 && errno == ENOMEM) {
-                static uint32_t s_udp_enomem_count = 0;
-                s_udp_enomem_count++;
-                if ((s_udp_enomem_count % 100) == 0) {
-                    ESP_LOGW(TAG, "UDP ENOMEM occurred %u times (dropping packets)", (unsigned int)s_udp_enomem_count);
-                }
+            if (!s_udp_batch_header.record_count) {
+                batch_start = xTaskGetTickCount();
             }
+
+            s_udp_batch_index[s_udp_batch_header.record_count++] = index;
+            s_udp_batch_len += buf->len;
+        }
+
+        if (s_udp_batch_header.record_count && xTaskGetTickCount() - batch_start >= deadline_ticks) {
+            csi_udp_batch_flush();
         }
     }
 }
+#else
+static void csi_udp_sender_task(void *arg)
+{
+    for (;;) {
+        uint8_t index = 0;
+        if (xQueueReceive(s_csi_udp_queue, &index, portMAX_DELAY) == pdTRUE) {
+            struct iovec iov = {
+                .iov_base = s_udp_buf_pool[index].data,
+                .iov_len  = s_udp_buf_pool[index].len,
+            };
+            int err = csi_udp_send(&iov, 1);
+
+            if (err < 0) {
+                csi_metrics_counter_add(&s_csi_drops[CSI_DROP_UDP_SEND], 1);
+            } else if (s_udp_buf_pool[index].t0) {
+                csi_stage_done(CSI_STAGE_SEND, s_udp_buf_pool[index].t0);
+            }
+
+            csi_udp_buf_give(index);
+        }
+    }
+}
+#endif
+
+#if CONFIG_METRICS_INTERVAL_MS
+/**
+ * @brief Runs in the esp_timer task: queues "<STA MAC>,CSI_METRICS,<uptime ms>,<csi_metrics_format()>"
+ *        to the UDP sender like a CSI record, so it shares the batching and the datagram sequence
+ */
+static void csi_metrics_timer_cb(void *arg)
+{
+    int udp_index = csi_udp_buf_take();
+
+    if (udp_index < 0) {
+        return;
+    }
+
+    csi_udp_buf_t *buf = &s_udp_buf_pool[udp_index];
+    int len = snprintf(buf->data, sizeof(buf->data), "%02X:%02X:%02X:%02X:%02X:%02X,CSI_METRICS,%u,",
+                       s_sta_mac[0], s_sta_mac[1], s_sta_mac[2], s_sta_mac[3], s_sta_mac[4], s_sta_mac[5],
+                       (unsigned int)(esp_timer_get_time() / 1000));
+    len += csi_metrics_format(&s_csi_metrics, buf->data + len, sizeof(buf->data) - len - 1);
+    buf->data[len++] = '\n';
+    buf->len = len;
+    buf->t0  = 0;
+
+    uint8_t index = (uint8_t)udp_index;
+
+    if (xQueueSend(s_csi_udp_queue, &index, 0) != pdPASS) {
+        csi_udp_buf_give(index);
+    }
+}
+#endif
 
 static void udp_sender_init(void)
 {
@@ -105,10 +354,19 @@ static void udp_sender_init(void)
         return;
     }
 
-    s_csi_udp_queue = xQueueCreate(32, sizeof(csi_udp_msg_t));
-    if (!s_csi_udp_queue) {
+    /**
+     * @brief Both queues carry pool indices; together they always hold every buffer
+     *        not owned by the formatter or the sender, so neither can overflow.
+     */
+    s_csi_udp_free_queue = xQueueCreate(UDP_BUF_POOL_NUM, sizeof(uint8_t));
+    s_csi_udp_queue      = xQueueCreate(UDP_BUF_POOL_NUM, sizeof(uint8_t));
+    if (!s_csi_udp_free_queue || !s_csi_udp_queue) {
         ESP_LOGE(TAG, "Failed to create CSI UDP queue");
-        return;
+        goto CLEAN_UP;
+    }
+
+    for (uint8_t i = 0; i < UDP_BUF_POOL_NUM; i++) {
+        csi_udp_buf_give(i);
     }
 
     memset(&s_udp_dest_addr, 0, sizeof(s_udp_dest_addr));
@@ -128,44 +386,97 @@ static void udp_sender_init(void)
 
     if (ok != pdPASS) {
         ESP_LOGE(TAG, "Failed to create CSI UDP sender task");
+        goto CLEAN_UP;
+    }
+
+#if CONFIG_METRICS_INTERVAL_MS
+    const esp_timer_create_args_t metrics_timer_args = {
+        .callback = csi_metrics_timer_cb,
+        .name     = "csi_metrics",
+    };
+    esp_timer_handle_t metrics_timer = NULL;
+
+    if (esp_timer_create(&metrics_timer_args, &metrics_timer) != ESP_OK
+            || esp_timer_start_periodic(metrics_timer, CONFIG_METRICS_INTERVAL_MS * 1000ULL) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start the CSI metrics timer");
+    }
+#endif
+
+    return;
+
+CLEAN_UP:
+    if (s_csi_udp_free_queue) {
+        vQueueDelete(s_csi_udp_free_queue);
+        s_csi_udp_free_queue = NULL;
+    }
+
+    if (s_csi_udp_queue) {
         vQueueDelete(s_csi_udp_queue);
         s_csi_udp_queue = NULL;
     }
 }
 
-static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
-{
-    if (!info || !info->buf) {
-        ESP_LOGW(TAG, "<%s> wifi_csi_cb", esp_err_to_name(ESP_ERR_INVALID_ARG));
-        return;
-    }
+#define CSI_SLOT_NUM            16      /**< Power of two */
+#define CSI_SLOT_BUF_SIZE       640
 
-    if (memcmp(info->mac, ctx, 6)) {
-        return;
-    }
+/**
+ * @brief A preallocated copy of one CSI packet, filled by the Wi-Fi callback
+ *        and consumed by csi_format_task. `info.buf` points at `buf`.
+ */
+typedef struct {
+    int64_t t0;                 /**< esp_timer_get_time() when the driver handed the packet over */
+    wifi_csi_info_t info;
+    int8_t buf[CSI_SLOT_BUF_SIZE];
+} csi_slot_t;
+
+static csi_ring_t s_csi_ring;
+static TaskHandle_t s_csi_format_task = NULL;
+
+static csi_dsp_gain_ctrl_t s_gain_ctrl;
 
+/**
+ * @brief Compensate, serialize and output one CSI packet. Runs in csi_format_task,
+ *        never in the Wi-Fi driver callback.
+ */
+static void csi_format_slot(const csi_slot_t *slot)
+{
+    const wifi_csi_info_t *info = &slot->info;
     const wifi_pkt_rx_ctrl_t *rx_ctrl = &info->rx_ctrl;
     static int s_count = 0;
-    float compensate_gain = 1.0f;
+    const csi_dsp_gain_t *gain = &csi_dsp_gain_unity;
+
+    csi_stage_done(CSI_STAGE_QUEUE, slot->t0);
+
     static uint8_t agc_gain = 0;
     static int8_t fft_gain = 0;
 #if CONFIG_GAIN_CONTROL
-    static uint8_t agc_gain_baseline = 0;
-    static int8_t fft_gain_baseline = 0;
-    esp_csi_gain_ctrl_get_rx_gain(rx_ctrl, &agc_gain, &fft_gain);
-    if (s_count < 100) {
-        esp_csi_gain_ctrl_record_rx_gain(agc_gain, fft_gain);
-    } else if (s_count == 100) {
-        esp_csi_gain_ctrl_get_rx_gain_baseline(&agc_gain_baseline, &fft_gain_baseline);
-#if CONFIG_FORCE_GAIN
-        esp_csi_gain_ctrl_set_rx_force_gain(agc_gain_baseline, fft_gain_baseline);
-        ESP_LOGI(TAG, "fft_force %d, agc_force %d", fft_gain_baseline, agc_gain_baseline);
+    gain = csi_dsp_gain_ctrl_update(&s_gain_ctrl, rx_ctrl, &agc_gain, &fft_gain);
+    ESP_LOGD(TAG, "compensate_gain %f, agc_gain %d, fft_gain %d", gain->gain, agc_gain, fft_gain);
 #endif
-    }
-    esp_csi_gain_ctrl_get_gain_compensation(&compensate_gain, agc_gain, fft_gain);
-    ESP_LOGD(TAG, "compensate_gain %f, agc_gain %d, fft_gain %d", compensate_gain, agc_gain, fft_gain);
+
+    /**
+     * @brief Gain compensation of the whole buffer in one integer pass, shared by the serial and UDP output
+     */
+    static int16_t s_csi_scaled[CSI_SLOT_BUF_SIZE];
+#if (CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61) && CSI_FORCE_LLTF
+    int csi_len = MIN((info->len - 2) / 2, CSI_SLOT_BUF_SIZE);
+    csi_dsp_scale_i12_i16_q15((const uint8_t *)info->buf, s_csi_scaled, csi_len, gain->gain_q15);
+#else
+    int csi_len = MIN(info->len, CSI_SLOT_BUF_SIZE);
+    csi_dsp_scale_i8_i16_q15(info->buf, s_csi_scaled, csi_len, gain->gain_q15);
 #endif
 
+#if CONFIG_CSI_OUTPUT_BINARY
+    if (!s_count) {
+        ESP_LOGI(TAG, "================ CSI RECV (binary) ================");
+    }
+
+#if (CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61) && CSI_FORCE_LLTF
+    csi_frame_print(info, s_count, agc_gain, fft_gain, gain->gain, CSI_FRAME_FLAG_PAYLOAD_INT12);
+#else
+    csi_frame_print(info, s_count, agc_gain, fft_gain, gain->gain, 0);
+#endif
+#else
 #if CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32C61
     if (!s_count) {
         ESP_LOGI(TAG, "================ CSI RECV ================");
@@ -189,28 +500,36 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
 #endif
 
 #if (CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61) && CSI_FORCE_LLTF
-
-    int16_t csi = ((int16_t)(((((uint16_t)info->buf[1]) << 8) | info->buf[0]) << 4) >> 4);
-    ets_printf(",%d,%d,\"[%d", (info->len - 2) / 2, info->first_word_invalid, (int16_t)(compensate_gain * csi));
-    for (int i = 2; i < (info->len - 2); i += 2) {
-        csi = ((int16_t)(((((uint16_t)info->buf[i + 1]) << 8) | info->buf[i]) << 4) >> 4);
-        ets_printf(",%d", (int16_t)(compensate_gain * csi));
-    }
-
+    ets_printf(",%d,%d,\"[%d", (info->len - 2) / 2, info->first_word_invalid, s_csi_scaled[0]);
 #else
-    ets_printf(",%d,%d,\"[%d", info->len, info->first_word_invalid, (int16_t)(compensate_gain * info->buf[0]));
-    for (int i = 1; i < info->len; i++) {
-        ets_printf(",%d", (int16_t)(compensate_gain * info->buf[i]));
-    }
+    ets_printf(",%d,%d,\"[%d", info->len, info->first_word_invalid, s_csi_scaled[0]);
 #endif
+    for (int i = 1; i < csi_len; i++) {
+        ets_printf(",%d", s_csi_scaled[i]);
+    }
     ets_printf("]\"\n");
+#endif
+
+    /* Build the same CSV line directly in a pooled buffer and hand its index to the UDP sender */
+    int udp_index = csi_udp_buf_take();
 
-    /* Build the same CSV line into a buffer and enqueue for UDP send in a task */
-    char udp_buf[UDP_MAX_CSI_PACKET_SIZE];
+    if (udp_index < 0) {
+        csi_metrics_counter_add(&s_csi_drops[CSI_DROP_UDP_BUF], 1);
+        uint32_t drop_count = csi_metrics_counter_get(&s_csi_drops[CSI_DROP_UDP_BUF]);
+        if ((drop_count % 100) == 0) {
+            ESP_LOGW(TAG, "CSI UDP buffers exhausted, dropped %u messages", (unsigned int)drop_count);
+        }
+        csi_stage_done(CSI_STAGE_FORMAT, slot->t0);
+        s_count++;
+        return;
+    }
+
+    char *udp_buf = s_udp_buf_pool[udp_index].data;
+    const int udp_buf_size = sizeof(s_udp_buf_pool[udp_index].data);
     int len = 0;
 
 #if CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32C61
-    len = snprintf(udp_buf, sizeof(udp_buf),
+    len = snprintf(udp_buf, udp_buf_size,
                    "%02X:%02X:%02X:%02X:%02X:%02X,CSI_DATA,%d," MACSTR ",%d,%d,%d,%d,%d,%d,%d,%d,%d",
                    s_sta_mac[0], s_sta_mac[1], s_sta_mac[2],
                    s_sta_mac[3], s_sta_mac[4], s_sta_mac[5],
@@ -218,7 +537,7 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
                    rx_ctrl->noise_floor, fft_gain, agc_gain, rx_ctrl->channel,
                    rx_ctrl->timestamp, rx_ctrl->sig_len, rx_ctrl->rx_state);
 #else
-    len = snprintf(udp_buf, sizeof(udp_buf),
+    len = snprintf(udp_buf, udp_buf_size,
                    "%02X:%02X:%02X:%02X:%02X:%02X,CSI_DATA,%d," MACSTR ",%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d",
                    s_sta_mac[0], s_sta_mac[1], s_sta_mac[2],
                    s_sta_mac[3], s_sta_mac[4], s_sta_mac[5],
@@ -229,51 +548,123 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
                    rx_ctrl->timestamp, rx_ctrl->ant, rx_ctrl->sig_len, rx_ctrl->rx_state);
 #endif
 
-    if (len > 0 && len < (int)sizeof(udp_buf)) {
+    if (len > 0 && len < udp_buf_size) {
 #if (CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61) && CSI_FORCE_LLTF
-        int16_t csi_udp = ((int16_t)(((((uint16_t)info->buf[1]) << 8) | info->buf[0]) << 4) >> 4);
-        len += snprintf(udp_buf + len, sizeof(udp_buf) - len, ",%d,%d,\"[%d",
-                        (info->len - 2) / 2, info->first_word_invalid,
-                        (int16_t)(compensate_gain * csi_udp));
-        for (int i = 2; i < (info->len - 2) && len < (int)sizeof(udp_buf); i += 2) {
-            csi_udp = ((int16_t)(((((uint16_t)info->buf[i + 1]) << 8) | info->buf[i]) << 4) >> 4);
-            len += snprintf(udp_buf + len, sizeof(udp_buf) - len, ",%d",
-                            (int16_t)(compensate_gain * csi_udp));
-        }
+        len += snprintf(udp_buf + len, udp_buf_size - len, ",%d,%d,\"[%d",
+                        (info->len - 2) / 2, info->first_word_invalid, s_csi_scaled[0]);
 #else
-        len += snprintf(udp_buf + len, sizeof(udp_buf) - len, ",%d,%d,\"[%d",
-                        info->len, info->first_word_invalid,
-                        (int16_t)(compensate_gain * info->buf[0]));
-        for (int i = 1; i < info->len && len < (int)sizeof(udp_buf); i++) {
-            len += snprintf(udp_buf + len, sizeof(udp_buf) - len, ",%d",
-                            (int16_t)(compensate_gain * info->buf[i]));
-        }
+        len += snprintf(udp_buf + len, udp_buf_size - len, ",%d,%d,\"[%d",
+                        info->len, info->first_word_invalid, s_csi_scaled[0]);
 #endif
-        if (len < (int)sizeof(udp_buf)) {
-            len += snprintf(udp_buf + len, sizeof(udp_buf) - len, "]\"\n");
+        for (int i = 1; i < csi_len && len < udp_buf_size; i++) {
+            len += snprintf(udp_buf + len, udp_buf_size - len, ",%d", s_csi_scaled[i]);
+        }
+        if (len < udp_buf_size) {
+            len += snprintf(udp_buf + len, udp_buf_size - len, "]\"\n");
         }
 
-        if (len > 0 && s_csi_udp_queue) {
-            csi_udp_msg_t msg = { 0 };
-            msg.len = (size_t)len;
-            if (msg.len >= UDP_MAX_CSI_PACKET_SIZE) {
-                msg.len = UDP_MAX_CSI_PACKET_SIZE - 1;
-            }
-            memcpy(msg.data, udp_buf, msg.len);
-            msg.data[msg.len] = '\0';
-            if (xQueueSend(s_csi_udp_queue, &msg, 0) != pdPASS) {
-                static uint32_t s_udp_drop_count = 0;
-                s_udp_drop_count++;
-                if ((s_udp_drop_count % 100) == 0) {
-                    ESP_LOGW(TAG, "CSI UDP queue full, dropped %u messages", (unsigned int)s_udp_drop_count);
-                }
-            }
+        if (len >= udp_buf_size) {
+            len = udp_buf_size - 1;
         }
+
+        uint8_t index = (uint8_t)udp_index;
+        s_udp_buf_pool[index].len = (size_t)len;
+        s_udp_buf_pool[index].t0  = slot->t0;
+
+        if (xQueueSend(s_csi_udp_queue, &index, 0) == pdPASS) {
+            udp_index = -1;
+        }
+    }
+
+    if (udp_index >= 0) {
+        csi_udp_buf_give(udp_index);
     }
 
+    csi_stage_done(CSI_STAGE_FORMAT, slot->t0);
     s_count++;
 }
 
+static void csi_format_task(void *arg)
+{
+    uint32_t drop_count_last = 0;
+
+    for (;;) {
+        csi_slot_t *slot = csi_ring_peek(&s_csi_ring);
+
+        if (!slot) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        csi_format_slot(slot);
+        csi_ring_release(&s_csi_ring);
+
+        if (csi_ring_overflow_count(&s_csi_ring) - drop_count_last >= 100) {
+            drop_count_last = csi_ring_overflow_count(&s_csi_ring);
+            ESP_LOGW(TAG, "CSI slots exhausted, dropped %u packets", (unsigned int)drop_count_last);
+        }
+    }
+}
+
+/**
+ * @brief Runs in the Wi-Fi driver task: only copies the packet into a free slot,
+ *        all compensation and formatting is deferred to csi_format_task.
+ */
+static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
+{
+    if (!info || !info->buf) {
+        return;
+    }
+
+    if (memcmp(info->mac, ctx, 6)) {
+        return;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+
+    if (info->len > CSI_SLOT_BUF_SIZE) {
+        csi_metrics_counter_add(&s_csi_drops[CSI_DROP_OVERSIZE], 1);
+        return;
+    }
+
+    csi_slot_t *slot = csi_ring_acquire(&s_csi_ring);
+
+    if (!slot) {
+        csi_metrics_counter_add(&s_csi_drops[CSI_DROP_RING_FULL], 1);
+        return;
+    }
+
+    slot->t0                      = t0;
+    slot->info.buf                = slot->buf;
+    slot->info.rx_ctrl            = info->rx_ctrl;
+    slot->info.first_word_invalid = info->first_word_invalid;
+    slot->info.len                = info->len;
+    memcpy(slot->info.mac, info->mac, sizeof(slot->info.mac));
+    memcpy(slot->buf, info->buf, info->len);
+
+    csi_ring_commit(&s_csi_ring);
+    xTaskNotifyGive(s_csi_format_task);
+}
+
+static void csi_format_init(void)
+{
+    void *storage = malloc(CSI_RING_STORAGE_SIZE(sizeof(csi_slot_t), CSI_SLOT_NUM));
+    ESP_ERROR_CHECK(storage ? ESP_OK : ESP_ERR_NO_MEM);
+    csi_ring_init(&s_csi_ring, storage, sizeof(csi_slot_t), CSI_SLOT_NUM);
+    csi_dsp_gain_ctrl_init(&s_gain_ctrl, CONFIG_FORCE_GAIN);
+
+    BaseType_t ok = xTaskCreatePinnedToCore(
+        csi_format_task,
+        "csi_format",
+        4096,
+        NULL,
+        tskIDLE_PRIORITY + 2,
+        &s_csi_format_task,
+        tskNO_AFFINITY
+    );
+    ESP_ERROR_CHECK(ok == pdPASS ? ESP_OK : ESP_ERR_NO_MEM);
+}
+
 static void wifi_csi_init()
 {
     /**
@@ -369,6 +760,10 @@ void app_main()
     ESP_LOGI(TAG, "STA MAC: " MACSTR, MAC2STR(s_sta_mac));
 
     udp_sender_init();
+    csi_format_init();
+#if CONFIG_CSI_OUTPUT_BINARY
+    ESP_ERROR_CHECK(csi_frame_print_init());
+#endif
     wifi_csi_init();
     wifi_ping_router_start();
 }
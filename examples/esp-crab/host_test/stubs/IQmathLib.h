@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief The Q16 subset of espressif/iqmath used by app_ifft.c, in plain C for the host tests.
+ *        Multiplication truncates like the library; the transcendental functions round a
+ *        double-precision result, which is at least as accurate as the library.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+typedef int32_t _iq16;
+
+#define _IQ16(A)            ((_iq16)((A) * 65536.0))
+
+static inline _iq16 _IQ16mpy(_iq16 a, _iq16 b)
+{
+    return (_iq16)(((int64_t)a * b) >> 16);
+}
+
+static inline _iq16 _IQ16div(_iq16 a, _iq16 b)
+{
+    return (_iq16)(((int64_t)a * 65536) / b);
+}
+
+static inline float _IQ16toF(_iq16 a)
+{
+    return a / 65536.0f;
+}
+
+static inline _iq16 _IQ16sin(_iq16 a)
+{
+    return (_iq16)lround(sin(a / 65536.0) * 65536.0);
+}
+
+static inline _iq16 _IQ16cos(_iq16 a)
+{
+    return (_iq16)lround(cos(a / 65536.0) * 65536.0);
+}
+
+static inline _iq16 _IQ16mag(_iq16 a, _iq16 b)
+{
+    return (_iq16)llround(hypot(a, b));
+}
+
+static inline _iq16 _IQ16atan2(_iq16 y, _iq16 x)
+{
+    return (_iq16)lround(atan2(y, x) * 65536.0);
+}
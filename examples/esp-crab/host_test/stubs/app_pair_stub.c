@@ -0,0 +1,39 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "../../master_recv/main/app/app_pair.h"
+#include "app_pair_stub.h"
+
+cir_pair_table_t csi_pair_table;
+
+static csi_data_t s_samples[APP_PAIR_STUB_MAX_SAMPLES];
+static size_t s_sample_count;
+
+void app_pair_stub_reset(void)
+{
+    s_sample_count = 0;
+}
+
+size_t app_pair_stub_samples(const csi_data_t **samples)
+{
+    *samples = s_samples;
+    return s_sample_count;
+}
+
+bool cir_pair_table_put(cir_pair_table_t *table, cir_pair_side_t side, const csi_data_t *data)
+{
+    if (table != &csi_pair_table || side != CIR_PAIR_SLAVE) {
+        return false;
+    }
+
+    if (s_sample_count < APP_PAIR_STUB_MAX_SAMPLES) {
+        s_samples[s_sample_count] = *data;
+    }
+
+    s_sample_count++;
+
+    return false;
+}
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Stands in for app_pair.c: cir_pair_table_put() keeps the slave samples it is given, in order
+ *
+ * Include after an app_uart.h, the master_recv and slave_recv copies define the same csi_data_t.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#define APP_PAIR_STUB_MAX_SAMPLES   64
+
+void app_pair_stub_reset(void);
+
+/**
+ * @return Number of slave samples put since the last reset, at most APP_PAIR_STUB_MAX_SAMPLES are kept
+ */
+size_t app_pair_stub_samples(const csi_data_t **samples);
@@ -0,0 +1,17 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief The esp-crab board pins used by master_recv's app_uart.c
+ */
+
+#pragma once
+
+#include "driver/gpio.h"
+
+#define BSP_CNT_3             (GPIO_NUM_26)
+#define BSP_CNT_4             (GPIO_NUM_27)
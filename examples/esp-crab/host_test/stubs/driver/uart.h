@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief The UART driver API used by app_uart.c. Configuration calls succeed and do nothing,
+ *        uart_write_bytes() is left to the test, which captures what the app sends.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "driver/gpio.h"
+
+#define UART_PIN_NO_CHANGE  (-1)
+
+typedef enum {
+    UART_NUM_0,
+    UART_NUM_1,
+} uart_port_t;
+
+typedef enum {
+    UART_DATA_8_BITS = 3,
+} uart_word_length_t;
+
+typedef enum {
+    UART_PARITY_DISABLE = 0,
+} uart_parity_t;
+
+typedef enum {
+    UART_STOP_BITS_1 = 1,
+} uart_stop_bits_t;
+
+typedef enum {
+    UART_HW_FLOWCTRL_DISABLE = 0,
+} uart_hw_flowcontrol_t;
+
+typedef enum {
+    UART_SCLK_DEFAULT = 0,
+} uart_sclk_t;
+
+typedef struct {
+    int baud_rate;
+    uart_word_length_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uart_sclk_t source_clk;
+} uart_config_t;
+
+typedef enum {
+    UART_DATA,
+    UART_BREAK,
+    UART_BUFFER_FULL,
+    UART_FIFO_OVF,
+    UART_FRAME_ERR,
+    UART_PARITY_ERR,
+} uart_event_type_t;
+
+typedef struct {
+    uart_event_type_t type;
+    size_t size;
+    bool timeout_flag;
+} uart_event_t;
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size);
+
+static inline esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                                            int queue_size, QueueHandle_t *uart_queue, int intr_alloc_flags)
+{
+    (void)uart_num, (void)rx_buffer_size, (void)tx_buffer_size, (void)queue_size, (void)intr_alloc_flags;
+
+    if (uart_queue) {
+        *uart_queue = NULL;
+    }
+
+    return ESP_OK;
+}
+
+static inline esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *config)
+{
+    (void)uart_num, (void)config;
+    return ESP_OK;
+}
+
+static inline esp_err_t uart_set_pin(uart_port_t uart_num, int tx, int rx, int rts, int cts)
+{
+    (void)uart_num, (void)tx, (void)rx, (void)rts, (void)cts;
+    return ESP_OK;
+}
+
+static inline int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t wait)
+{
+    (void)uart_num, (void)buf, (void)length, (void)wait;
+    return 0;
+}
+
+static inline esp_err_t uart_flush_input(uart_port_t uart_num)
+{
+    (void)uart_num;
+    return ESP_OK;
+}
@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Queue calls of the esp-crab app sources on a host: every queue is empty
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+static inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait)
+{
+    (void)queue, (void)item, (void)wait;
+    return pdFALSE;
+}
+
+static inline BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    (void)queue;
+    return pdPASS;
+}
@@ -0,0 +1,30 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Task creation for the esp-crab app sources on a host: no task is started, the tests call
+ *        the functions under test directly
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+static inline BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth, void *arg,
+                                     UBaseType_t priority, TaskHandle_t *handle)
+{
+    (void)task, (void)name, (void)stack_depth, (void)arg, (void)priority, (void)handle;
+    return pdFAIL;
+}
+
+static inline void vTaskDelete(TaskHandle_t task)
+{
+    (void)task;
+}
@@ -0,0 +1,216 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief cir_iq_batch_eval() against the per-frame path it replaced in process_csi_data_task and
+ *        uart_send_task (a 64-point inverse fft_iq() per half, then the requested bin), and against
+ *        a double-precision inverse DFT, then both paths timed over the same frames.
+ *
+ * The frames model an HT20 capture: three delayed paths with noise, null DC and guard subcarriers,
+ * int8 I/Q pairs as wifi_csi_info_t delivers them.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "test_util.h"
+#include "app_ifft.h"
+
+#define FRAME_LEN           (CIR_IQ_HALVES * CIR_IQ_SUBCARRIERS * 2)
+#define FRAME_NUM           512
+#define BENCH_ROUNDS        200
+
+static int8_t s_frames[FRAME_NUM][FRAME_LEN];
+
+static void frames_generate(void)
+{
+    uint32_t seed = 2026;
+
+    for (int f = 0; f < FRAME_NUM; f++) {
+        double delay[3], gain[3], phase[3];
+
+        for (int p = 0; p < 3; p++) {
+            delay[p] = (test_rand(&seed) % 800) / 100.0;
+            gain[p] = 30.0 / (p + 1) + test_rand(&seed) % 20;
+            phase[p] = (test_rand(&seed) % 6283) / 1000.0;
+        }
+
+        for (int h = 0; h < CIR_IQ_HALVES; h++) {
+            for (int i = 0; i < CIR_IQ_SUBCARRIERS; i++) {
+                int8_t *iq = &s_frames[f][(h * CIR_IQ_SUBCARRIERS + i) * 2];
+                int k = i < 32 ? i : i - 64;
+
+                if (k == 0 || k > 26 || k < -26) {
+                    iq[0] = iq[1] = 0;
+                    continue;
+                }
+
+                double real = test_rand_i8(&seed, 2), imag = test_rand_i8(&seed, 2);
+
+                for (int p = 0; p < 3; p++) {
+                    double angle = phase[p] - 2 * M_PI * k * delay[p] / 64;
+                    real += gain[p] * cos(angle);
+                    imag += gain[p] * sin(angle);
+                }
+
+                iq[0] = (int8_t)fmax(-128, fmin(127, lround(real)));
+                iq[1] = (int8_t)fmax(-128, fmin(127, lround(imag)));
+            }
+        }
+    }
+}
+
+/**
+ * @brief One half of a frame through the per-frame path: 64-point inverse fft_iq(), then bin tap
+ */
+static void per_frame_tap(const int8_t *frame, int h, int tap, float *magnitude, float *phase)
+{
+    Complex_Iq x[CIR_IQ_SUBCARRIERS];
+
+    for (int i = 0; i < CIR_IQ_SUBCARRIERS; i++) {
+        x[i].real = _IQ16(frame[(h * CIR_IQ_SUBCARRIERS + i) * 2]);
+        x[i].imag = _IQ16(frame[(h * CIR_IQ_SUBCARRIERS + i) * 2 + 1]);
+    }
+
+    fft_iq(x, 1);
+    *magnitude = complex_magnitude_iq(x[tap]);
+    *phase = complex_phase_iq(x[tap]);
+}
+
+static void reference_tap(const int8_t *frame, int h, int tap, double *magnitude, double *phase)
+{
+    double real = 0, imag = 0;
+
+    for (int i = 0; i < CIR_IQ_SUBCARRIERS; i++) {
+        double angle = 2 * M_PI * i * tap / CIR_IQ_SUBCARRIERS;
+        double xr = frame[(h * CIR_IQ_SUBCARRIERS + i) * 2];
+        double xi = frame[(h * CIR_IQ_SUBCARRIERS + i) * 2 + 1];
+        real += xr * cos(angle) - xi * sin(angle);
+        imag += xr * sin(angle) + xi * cos(angle);
+    }
+
+    *magnitude = hypot(real, imag) / CIR_IQ_SUBCARRIERS;
+    *phase = atan2(imag, real);
+}
+
+static double phase_diff(double a, double b)
+{
+    return fabs(remainder(a - b, 2 * M_PI));
+}
+
+static void test_batch_add(void)
+{
+    cir_iq_batch_t batch;
+    cir_iq_batch_reset(&batch);
+
+    for (int f = 0; f < CIR_IQ_BATCH_MAX; f++) {
+        CHECK(cir_iq_batch_add(&batch, s_frames[f]) == f);
+    }
+
+    CHECK(cir_iq_batch_add(&batch, s_frames[0]) == -1);
+    CHECK(batch.count == CIR_IQ_BATCH_MAX);
+    CHECK(batch.real[1][5][3] == s_frames[3][(CIR_IQ_SUBCARRIERS + 5) * 2]);
+    CHECK(batch.imag[0][7][2] == s_frames[2][7 * 2 + 1]);
+}
+
+/**
+ * @brief Every tap and every batch fill level, including the worst-case all -128 frame for tap 0
+ */
+static void test_batch_matches_per_frame(void)
+{
+    static cir_iq_batch_t batch;
+    float magnitude[CIR_IQ_BATCH_MAX][CIR_IQ_HALVES], phase[CIR_IQ_BATCH_MAX][CIR_IQ_HALVES];
+    double worst_batch = 0, worst_per_frame = 0, worst_phase = 0;
+
+    memset(s_frames[FRAME_NUM - 1], 0x80, FRAME_LEN);
+
+    for (int tap = 0; tap < CIR_IQ_SUBCARRIERS; tap++) {
+        for (int start = 0; start < FRAME_NUM; start += CIR_IQ_BATCH_MAX) {
+            int count = 1 + (start / CIR_IQ_BATCH_MAX + tap) % CIR_IQ_BATCH_MAX;
+
+            cir_iq_batch_reset(&batch);
+            for (int f = 0; f < count; f++) {
+                cir_iq_batch_add(&batch, s_frames[start + f]);
+            }
+            if (start + CIR_IQ_BATCH_MAX >= FRAME_NUM) {
+                cir_iq_batch_add(&batch, s_frames[FRAME_NUM - 1]);
+            }
+
+            cir_iq_batch_eval(&batch, tap, magnitude, phase);
+
+            for (int f = 0; f < batch.count; f++) {
+                const int8_t *frame = f < count ? s_frames[start + f] : s_frames[FRAME_NUM - 1];
+
+                for (int h = 0; h < CIR_IQ_HALVES; h++) {
+                    float old_magnitude, old_phase;
+                    double ref_magnitude, ref_phase;
+                    per_frame_tap(frame, h, tap, &old_magnitude, &old_phase);
+                    reference_tap(frame, h, tap, &ref_magnitude, &ref_phase);
+
+                    worst_batch = fmax(worst_batch, fabs(magnitude[f][h] - ref_magnitude));
+                    worst_per_frame = fmax(worst_per_frame, fabs(old_magnitude - ref_magnitude));
+
+                    if (ref_magnitude > 0.5) {
+                        worst_phase = fmax(worst_phase, phase_diff(phase[f][h], ref_phase));
+                    }
+                }
+            }
+        }
+    }
+
+    printf("magnitude: worst error batch %.5f, per frame %.5f; phase: worst error batch %.5f rad\n",
+           worst_batch, worst_per_frame, worst_phase);
+    CHECK(worst_batch <= fmax(worst_per_frame, 0.002));
+    CHECK(worst_phase < 0.01);
+}
+
+static void test_benchmark(void)
+{
+    static cir_iq_batch_t batch;
+    float magnitude[CIR_IQ_BATCH_MAX][CIR_IQ_HALVES], phase[CIR_IQ_BATCH_MAX][CIR_IQ_HALVES];
+    volatile float sink = 0;
+
+    double start = test_now();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int f = 0; f < FRAME_NUM; f++) {
+            for (int h = 0; h < CIR_IQ_HALVES; h++) {
+                per_frame_tap(s_frames[f], h, 0, &magnitude[0][h], &phase[0][h]);
+            }
+            sink += magnitude[0][0];
+        }
+    }
+    double per_frame = (test_now() - start) / BENCH_ROUNDS / FRAME_NUM * 1e9;
+
+    start = test_now();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int f = 0; f < FRAME_NUM; f += CIR_IQ_BATCH_MAX) {
+            cir_iq_batch_reset(&batch);
+            for (int i = 0; i < CIR_IQ_BATCH_MAX; i++) {
+                cir_iq_batch_add(&batch, s_frames[f + i]);
+            }
+            cir_iq_batch_eval(&batch, 0, magnitude, phase);
+            sink += magnitude[0][0];
+        }
+    }
+    double batched = (test_now() - start) / BENCH_ROUNDS / FRAME_NUM * 1e9;
+
+    (void)sink;
+    printf("tap 0 of both halves: per frame %.0f ns/frame, batch of %d %.0f ns/frame\n",
+           per_frame, CIR_IQ_BATCH_MAX, batched);
+}
+
+int main(void)
+{
+    frames_generate();
+    test_batch_add();
+    test_benchmark();
+    test_batch_matches_per_frame();
+
+    printf("test_cir_batch: all tests passed\n");
+
+    return 0;
+}
@@ -0,0 +1,315 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief The float fft() and fft_real() against a double-precision FFT and against the former
+ *        fft() (per-call allocation, bitReverse() per element, recurrence twiddles) for every size
+ *        from 2 to FFT_PLAN_MAX_N, plus throughput against the former fft(). There are more sizes
+ *        than FFT_PLAN_CACHE_SIZE, so the sizes past the cache run on per-call plans. The cache is
+ *        first filled by threads racing to plan the same sizes.
+ */
+
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "test_util.h"
+#include "app_ifft.h"
+
+#define BENCH_SAMPLES       (1 << 20)   /**< Points transformed per measurement */
+#define RACE_THREADS        4
+#define RACE_ROUNDS         50
+
+/**
+ * @brief fft() as it was before the plan cache
+ */
+static void fft_baseline(Complex *X, int N, int inverse)
+{
+    int log2N = log2(N);
+    Complex *temp = malloc(N * sizeof(Complex));
+
+    for (int i = 0; i < N; i++) {
+        unsigned int r = 0;
+        for (int b = 0, x = i; b < log2N; b++, x >>= 1) {
+            r = (r << 1) | (x & 1);
+        }
+        temp[i] = X[r];
+    }
+    memcpy(X, temp, N * sizeof(Complex));
+
+    for (int s = 1; s <= log2N; ++s) {
+        int m = 1 << s;
+        int m2 = m >> 1;
+        Complex w = {1.0f, 0.0f};
+        Complex wm = {cosf(-2.0f * (float)M_PI / m), sinf(-2.0f * (float)M_PI / m)};
+        if (inverse) {
+            wm.imag = -wm.imag;
+        }
+
+        for (int j = 0; j < m2; ++j) {
+            for (int k = j; k < N; k += m) {
+                Complex t, u = X[k];
+                t.real = w.real * X[k + m2].real - w.imag * X[k + m2].imag;
+                t.imag = w.real * X[k + m2].imag + w.imag * X[k + m2].real;
+                X[k].real = u.real + t.real;
+                X[k].imag = u.imag + t.imag;
+                X[k + m2].real = u.real - t.real;
+                X[k + m2].imag = u.imag - t.imag;
+            }
+            float real = w.real * wm.real - w.imag * wm.imag;
+            w.imag = w.real * wm.imag + w.imag * wm.real;
+            w.real = real;
+        }
+    }
+
+    if (inverse) {
+        for (int i = 0; i < N; i++) {
+            X[i].real /= N;
+            X[i].imag /= N;
+        }
+    }
+
+    free(temp);
+}
+
+/**
+ * @brief O(N log N) double reference through a table of exact twiddles; the naive DFT is too slow at 4096
+ */
+static void fft_reference(const Complex *x, int n, int inverse, double *out_real, double *out_imag)
+{
+    int log2n = __builtin_ctz(n);
+
+    for (int i = 0; i < n; i++) {
+        unsigned int r = 0;
+        for (int b = 0, v = i; b < log2n; b++, v >>= 1) {
+            r = (r << 1) | (v & 1);
+        }
+        out_real[r] = x[i].real;
+        out_imag[r] = x[i].imag;
+    }
+
+    for (int m = 2; m <= n; m <<= 1) {
+        for (int j = 0; j < m / 2; j++) {
+            double angle = (inverse ? 2.0 : -2.0) * M_PI * j / m;
+            double wr = cos(angle), wi = sin(angle);
+
+            for (int k = j; k < n; k += m) {
+                int l = k + m / 2;
+                double tr = wr * out_real[l] - wi * out_imag[l];
+                double ti = wr * out_imag[l] + wi * out_real[l];
+                out_real[l] = out_real[k] - tr;
+                out_imag[l] = out_imag[k] - ti;
+                out_real[k] += tr;
+                out_imag[k] += ti;
+            }
+        }
+    }
+
+    if (inverse) {
+        for (int i = 0; i < n; i++) {
+            out_real[i] /= n;
+            out_imag[i] /= n;
+        }
+    }
+}
+
+static double max_error(const Complex *X, const double *ref_real, const double *ref_imag, int n)
+{
+    double worst = 0;
+
+    for (int k = 0; k < n; k++) {
+        worst = fmax(worst, fmax(fabs(X[k].real - ref_real[k]), fabs(X[k].imag - ref_imag[k])));
+    }
+
+    return worst;
+}
+
+static void random_signal(Complex *x, int n, uint32_t *seed)
+{
+    for (int i = 0; i < n; i++) {
+        x[i].real = test_rand_i8(seed, 127);
+        x[i].imag = test_rand_i8(seed, 127);
+    }
+}
+
+static void test_invalid_sizes(void)
+{
+    Complex X[8] = {{1, 2}};
+    float x[8] = {0};
+
+    CHECK(fft(X, 0, 0) == ESP_ERR_INVALID_ARG);
+    CHECK(fft(X, 6, 0) == ESP_ERR_INVALID_ARG);
+    CHECK(fft(X, 2 * FFT_PLAN_MAX_N, 0) == ESP_ERR_INVALID_ARG);
+    CHECK(X[0].real == 1 && X[0].imag == 2);
+    CHECK(fft_real(x, X, 2) == ESP_ERR_INVALID_ARG);
+    CHECK(fft_real(x, X, 12) == ESP_ERR_INVALID_ARG);
+    CHECK(fft_plan_get(3) == NULL);
+}
+
+/**
+ * @brief Every size, forward and inverse, new and former fft() against the double reference.
+ *        Sizes past the first FFT_PLAN_CACHE_SIZE must still be transformed.
+ */
+static void test_fft_all_sizes(void)
+{
+    static Complex x[FFT_PLAN_MAX_N], a[FFT_PLAN_MAX_N], b[FFT_PLAN_MAX_N];
+    static double ref_real[FFT_PLAN_MAX_N], ref_imag[FFT_PLAN_MAX_N];
+    uint32_t seed = 99;
+    int cached = 0;
+
+    for (int n = 2; n <= FFT_PLAN_MAX_N; n <<= 1) {
+        for (int inverse = 0; inverse <= 1; inverse++) {
+            random_signal(x, n, &seed);
+            memcpy(a, x, n * sizeof(Complex));
+            memcpy(b, x, n * sizeof(Complex));
+
+            CHECK(fft(a, n, inverse) == ESP_OK);
+            fft_baseline(b, n, inverse);
+            fft_reference(x, n, inverse, ref_real, ref_imag);
+
+            /**
+             * @brief Errors grow with the output magnitude, about 127 * sqrt(N) forward
+             */
+            double scale = inverse ? 127.0 / sqrt(n) : 127.0 * sqrt(n);
+            double err_new = max_error(a, ref_real, ref_imag, n) / scale;
+            double err_old = max_error(b, ref_real, ref_imag, n) / scale;
+
+            printf("N=%4d %s: relative error fft %.2e, previous fft %.2e\n", n,
+                   inverse ? "inverse" : "forward", err_new, err_old);
+            CHECK(err_new < 1e-5);
+            CHECK(err_new <= err_old * 1.5 + 1e-7);
+        }
+
+        cached += fft_plan_get(n) != NULL;
+    }
+
+    CHECK(cached == FFT_PLAN_CACHE_SIZE);
+}
+
+static void test_fft_real(void)
+{
+    static float x[FFT_PLAN_MAX_N];
+    static Complex X[FFT_PLAN_MAX_N / 2 + 1], full[FFT_PLAN_MAX_N];
+    static double ref_real[FFT_PLAN_MAX_N], ref_imag[FFT_PLAN_MAX_N];
+    uint32_t seed = 5;
+
+    for (int n = 4; n <= FFT_PLAN_MAX_N; n <<= 1) {
+        for (int i = 0; i < n; i++) {
+            x[i] = test_rand_i8(&seed, 127);
+            full[i].real = x[i];
+            full[i].imag = 0;
+        }
+
+        CHECK(fft_real(x, X, n) == ESP_OK);
+        fft_reference(full, n, 0, ref_real, ref_imag);
+
+        double err = max_error(X, ref_real, ref_imag, n / 2 + 1) / (127.0 * sqrt(n));
+        CHECK(err < 1e-5);
+    }
+}
+
+static const int s_race_sizes[FFT_PLAN_CACHE_SIZE] = {64, 256, 1024, 4096};
+
+/**
+ * @brief Forward and inverse transforms of the race sizes, each thread starting at a different size
+ */
+static void *race_thread(void *arg)
+{
+    static __thread Complex x[FFT_PLAN_MAX_N], y[FFT_PLAN_MAX_N];
+    int id = (int)(intptr_t)arg;
+    uint32_t seed = 17 + id;
+
+    for (int round = 0; round < RACE_ROUNDS; round++) {
+        int n = s_race_sizes[(round + id) % FFT_PLAN_CACHE_SIZE];
+
+        random_signal(x, n, &seed);
+        memcpy(y, x, n * sizeof(Complex));
+        CHECK(fft(y, n, 0) == ESP_OK);
+        CHECK(fft(y, n, 1) == ESP_OK);
+
+        for (int i = 0; i < n; i++) {
+            CHECK(fabsf(y[i].real - x[i].real) < 1e-3f && fabsf(y[i].imag - x[i].imag) < 1e-3f);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Threads plan the same sizes at once: each size takes exactly one cache slot
+ */
+static void test_fft_concurrent_first_use(void)
+{
+    pthread_t threads[RACE_THREADS];
+    const fft_plan_t *plans[FFT_PLAN_CACHE_SIZE];
+
+    for (int t = 0; t < RACE_THREADS; t++) {
+        CHECK(pthread_create(&threads[t], NULL, race_thread, (void *)(intptr_t)t) == 0);
+    }
+
+    for (int t = 0; t < RACE_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    for (int i = 0; i < FFT_PLAN_CACHE_SIZE; i++) {
+        plans[i] = fft_plan_get(s_race_sizes[i]);
+        CHECK(plans[i] && plans[i]->n == s_race_sizes[i] && plans[i] == fft_plan_get(s_race_sizes[i]));
+
+        for (int j = 0; j < i; j++) {
+            CHECK(plans[i] != plans[j]);
+        }
+    }
+}
+
+static double bench(void (*fn)(Complex *, int, int), int n)
+{
+    static Complex x[FFT_PLAN_MAX_N], y[FFT_PLAN_MAX_N];
+    uint32_t seed = 1;
+    int rounds = BENCH_SAMPLES / n;
+    volatile float sink = 0;
+
+    random_signal(x, n, &seed);
+
+    double start = test_now();
+    for (int round = 0; round < rounds; round++) {
+        memcpy(y, x, n * sizeof(Complex));
+        fn(y, n, 0);
+        sink += y[round & (n - 1)].real;
+    }
+    (void)sink;
+
+    return (test_now() - start) / rounds * 1e9;
+}
+
+static void fft_void(Complex *X, int N, int inverse)
+{
+    fft(X, N, inverse);
+}
+
+int main(void)
+{
+    test_invalid_sizes();
+    test_fft_concurrent_first_use();
+
+    /**
+     * @brief The race sizes, which hold the cache entries
+     */
+    for (int n = 64; n <= FFT_PLAN_MAX_N; n <<= 2) {
+        printf("N=%4d: fft %.0f ns, previous fft %.0f ns\n", n, bench(fft_void, n), bench(fft_baseline, n));
+    }
+
+    test_fft_all_sizes();
+    test_fft_real();
+
+    CHECK(fft_plan_get(512) == NULL);
+    printf("N= 512: fft %.0f ns with the cache full (per-call plan), previous fft %.0f ns\n",
+           bench(fft_void, 512), bench(fft_baseline, 512));
+
+    printf("test_fft: all tests passed\n");
+
+    return 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief fft_iq_plan_execute() against a double-precision DFT for every supported size, and the
+ *        64-point fft_iq() timed against the former implementation, which allocated a temporary
+ *        buffer and rebuilt its twiddles with _IQ16cos/_IQ16sin on every call.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "test_util.h"
+#include "app_ifft.h"
+
+#define ACCURACY_ROUNDS     200
+#define BENCH_ROUNDS        200000
+
+static void dft_reference(const Complex_Iq *x, int n, int inverse, double *out_real, double *out_imag)
+{
+    const double sign = inverse ? 1.0 : -1.0;
+
+    for (int k = 0; k < n; k++) {
+        double real = 0, imag = 0;
+
+        for (int i = 0; i < n; i++) {
+            double angle = sign * 2.0 * M_PI * (double)i * k / n;
+            double xr = x[i].real / 65536.0, xi = x[i].imag / 65536.0;
+            real += xr * cos(angle) - xi * sin(angle);
+            imag += xr * sin(angle) + xi * cos(angle);
+        }
+
+        out_real[k] = inverse ? real / n : real;
+        out_imag[k] = inverse ? imag / n : imag;
+    }
+}
+
+static const int s_baseline_bitrev[64] = {
+    0, 32, 16, 48, 8, 40, 24, 56, 4, 36, 20, 52, 12, 44, 28, 60,
+    2, 34, 18, 50, 10, 42, 26, 58, 6, 38, 22, 54, 14, 46, 30, 62,
+    1, 33, 17, 49, 9, 41, 25, 57, 5, 37, 21, 53, 13, 45, 29, 61,
+    3, 35, 19, 51, 11, 43, 27, 59, 7, 39, 23, 55, 15, 47, 31, 63,
+};
+
+/**
+ * @brief The 64-point fft_iq() as it was before the plan and the constant tables. The stage angle is
+ *        divided as a plain integer here; the original passed m to _IQ16div() as if it were Q16.
+ */
+static void fft_iq_baseline(Complex_Iq *X, int inverse)
+{
+    Complex_Iq *temp = malloc(64 * sizeof(Complex_Iq));
+
+    for (int i = 0; i < 64; i++) {
+        temp[i] = X[s_baseline_bitrev[i]];
+    }
+    memcpy(X, temp, 64 * sizeof(Complex_Iq));
+
+    for (int s = 1; s <= 6; ++s) {
+        int m = 1 << s;
+        int m2 = m >> 1;
+        Complex_Iq w = {_IQ16(1.0), 0};
+        Complex_Iq wm;
+        _iq16 angle = _IQ16(-6.28318530717958647692) / m;
+        wm.real = _IQ16cos(angle);
+        wm.imag = _IQ16sin(angle);
+        if (inverse) {
+            wm.imag = -wm.imag;
+        }
+
+        for (int j = 0; j < m2; ++j) {
+            for (int k = j; k < 64; k += m) {
+                Complex_Iq t, u = X[k];
+                t.real = _IQ16mpy(w.real, X[k + m2].real) - _IQ16mpy(w.imag, X[k + m2].imag);
+                t.imag = _IQ16mpy(w.real, X[k + m2].imag) + _IQ16mpy(w.imag, X[k + m2].real);
+                X[k].real = u.real + t.real;
+                X[k].imag = u.imag + t.imag;
+                X[k + m2].real = u.real - t.real;
+                X[k + m2].imag = u.imag - t.imag;
+            }
+            _iq16 real = _IQ16mpy(w.real, wm.real) - _IQ16mpy(w.imag, wm.imag);
+            w.imag = _IQ16mpy(w.real, wm.imag) + _IQ16mpy(w.imag, wm.real);
+            w.real = real;
+        }
+    }
+
+    if (inverse) {
+        for (int i = 0; i < 64; i++) {
+            X[i].real >>= 6;
+            X[i].imag >>= 6;
+        }
+    }
+
+    free(temp);
+}
+
+static void test_plan_init(void)
+{
+    fft_iq_plan_t plan;
+
+    CHECK(fft_iq_plan_init(&plan, 32) == ESP_ERR_NOT_SUPPORTED);
+    CHECK(fft_iq_plan_init(&plan, 512) == ESP_ERR_NOT_SUPPORTED);
+    CHECK(fft_iq_plan_init(NULL, 64) == ESP_ERR_INVALID_ARG);
+    CHECK(fft_iq_plan_init(&plan, 128) == ESP_OK && plan.n == 128 && plan.log2n == 7);
+}
+
+/**
+ * @brief Worst absolute error over random int8 I/Q inputs, in units of one int8 step
+ */
+static double accuracy(int n, int inverse, int limit)
+{
+    static Complex_Iq x[FFT_IQ_MAX_N], y[FFT_IQ_MAX_N];
+    static double ref_real[FFT_IQ_MAX_N], ref_imag[FFT_IQ_MAX_N];
+    fft_iq_plan_t plan;
+    uint32_t seed = 0x1234567 + n + inverse;
+    double worst = 0;
+
+    CHECK(fft_iq_plan_init(&plan, n) == ESP_OK);
+
+    for (int round = 0; round < ACCURACY_ROUNDS; round++) {
+        for (int i = 0; i < n; i++) {
+            x[i].real = test_rand_i8(&seed, limit) << 16;
+            x[i].imag = test_rand_i8(&seed, limit) << 16;
+        }
+
+        memcpy(y, x, n * sizeof(Complex_Iq));
+        fft_iq_plan_execute(&plan, y, inverse);
+        dft_reference(x, n, inverse, ref_real, ref_imag);
+
+        for (int k = 0; k < n; k++) {
+            worst = fmax(worst, fabs(y[k].real / 65536.0 - ref_real[k]));
+            worst = fmax(worst, fabs(y[k].imag / 65536.0 - ref_imag[k]));
+        }
+    }
+
+    return worst;
+}
+
+static void test_accuracy(void)
+{
+    /**
+     * @brief Inputs stay inside the documented Q16 headroom: full int8 range up to N = 128
+     */
+    static const struct {
+        int n;
+        int limit;
+    } cases[] = {{64, 127}, {128, 127}, {256, 63}};
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (int inverse = 0; inverse <= 1; inverse++) {
+            double worst = accuracy(cases[c].n, inverse, cases[c].limit);
+            printf("fft_iq_plan_execute N=%d %s: worst error %.5f\n", cases[c].n,
+                   inverse ? "inverse" : "forward", worst);
+            CHECK(worst < (inverse ? 0.001 : 0.05));
+        }
+    }
+}
+
+static void test_fft_iq_matches_baseline(void)
+{
+    Complex_Iq x[64], a[64], b[64];
+    double ref_real[64], ref_imag[64];
+    uint32_t seed = 42;
+
+    for (int inverse = 0; inverse <= 1; inverse++) {
+        double worst_new = 0, worst_old = 0;
+
+        for (int round = 0; round < ACCURACY_ROUNDS; round++) {
+            for (int i = 0; i < 64; i++) {
+                x[i].real = test_rand_i8(&seed, 127) << 16;
+                x[i].imag = test_rand_i8(&seed, 127) << 16;
+            }
+
+            memcpy(a, x, sizeof(x));
+            memcpy(b, x, sizeof(x));
+            fft_iq(a, inverse);
+            fft_iq_baseline(b, inverse);
+            dft_reference(x, 64, inverse, ref_real, ref_imag);
+
+            for (int k = 0; k < 64; k++) {
+                worst_new = fmax(worst_new, fmax(fabs(a[k].real / 65536.0 - ref_real[k]),
+                                                 fabs(a[k].imag / 65536.0 - ref_imag[k])));
+                worst_old = fmax(worst_old, fmax(fabs(b[k].real / 65536.0 - ref_real[k]),
+                                                 fabs(b[k].imag / 65536.0 - ref_imag[k])));
+            }
+        }
+
+        /**
+         * @brief Table twiddles are exact where the old recurrence drifted from stage to stage
+         */
+        printf("64-point %s: worst error fft_iq %.5f, previous fft_iq %.5f\n",
+               inverse ? "inverse" : "forward", worst_new, worst_old);
+        CHECK(worst_new <= worst_old);
+    }
+}
+
+static double bench(void (*fn)(Complex_Iq *, int), int inverse)
+{
+    static Complex_Iq x[64], y[64];
+    uint32_t seed = 7;
+    volatile _iq16 sink = 0;
+
+    for (int i = 0; i < 64; i++) {
+        x[i].real = test_rand_i8(&seed, 127) << 16;
+        x[i].imag = test_rand_i8(&seed, 127) << 16;
+    }
+
+    double start = test_now();
+
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        memcpy(y, x, sizeof(x));
+        fn(y, inverse);
+        sink += y[round & 63].real;
+    }
+
+    (void)sink;
+
+    return (test_now() - start) / BENCH_ROUNDS * 1e9;
+}
+
+int main(void)
+{
+    test_plan_init();
+    test_accuracy();
+    test_fft_iq_matches_baseline();
+
+    for (int inverse = 0; inverse <= 1; inverse++) {
+        printf("64-point %s: fft_iq %.0f ns, previous fft_iq %.0f ns\n", inverse ? "inverse" : "forward",
+               bench(fft_iq, inverse), bench(fft_iq_baseline, inverse));
+    }
+
+    printf("test_fft_iq: all tests passed\n");
+
+    return 0;
+}
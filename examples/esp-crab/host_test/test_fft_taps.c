@@ -0,0 +1,168 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief fft_iq_plan_taps() against the full fft_iq_plan_execute() output for every supported size,
+ *        both directions and three kinds of tap set:
+ *
+ * - {0}: the DC sum, bit-exact with the full transform.
+ * - Sparse taps, evaluated as a partial DFT without touching scratch.
+ * - At least N/2 taps, which take the full-transform path in scratch and match it bit for bit,
+ *   or without scratch are still evaluated directly and agree within the transform's rounding.
+ *
+ * Then each path is timed against the 64-point fft_iq() it replaces.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "test_util.h"
+#include "app_ifft.h"
+
+#define ROUNDS              200
+#define BENCH_ROUNDS        200000
+
+static const Complex_Iq s_sentinel = {0x5a5a5a5a, -0x5a5a5a5a};
+
+static void random_input(Complex_Iq *x, int n, int limit, uint32_t *seed)
+{
+    for (int i = 0; i < n; i++) {
+        x[i].real = test_rand_i8(seed, limit) << 16;
+        x[i].imag = test_rand_i8(seed, limit) << 16;
+    }
+}
+
+/**
+ * @brief Worst difference between taps and the matching bins of full, in int8 steps
+ */
+static double tap_error(const Complex_Iq *full, int n, const uint16_t *taps, int tap_count, const Complex_Iq *out)
+{
+    double worst = 0;
+
+    for (int t = 0; t < tap_count; t++) {
+        const Complex_Iq *ref = &full[taps[t] % n];
+        worst = fmax(worst, fabs((double)out[t].real - ref->real) / 65536.0);
+        worst = fmax(worst, fabs((double)out[t].imag - ref->imag) / 65536.0);
+    }
+
+    return worst;
+}
+
+static void check_taps(int n, int limit)
+{
+    static Complex_Iq x[FFT_IQ_MAX_N], full[FFT_IQ_MAX_N], scratch[FFT_IQ_MAX_N], out[FFT_IQ_MAX_N + 8];
+    static uint16_t dense[FFT_IQ_MAX_N / 2 + 8];
+    const uint16_t dc[] = {0};
+    const uint16_t sparse[] = {1, 0, (uint16_t)(n / 2 - 3), (uint16_t)(n - 1)};
+    fft_iq_plan_t plan;
+    uint32_t seed = 0xc1a0 + n;
+    int dense_count = 0;
+
+    CHECK(fft_iq_plan_init(&plan, n) == ESP_OK);
+
+    /**
+     * @brief N/2 + 1 taps spread over the spectrum, then repeats and indices past N that wrap
+     */
+    for (int k = 0; k <= n / 2; k++) {
+        dense[dense_count++] = (uint16_t)(k * 2 % n + (k & 1));
+    }
+    dense[dense_count++] = 3;
+    dense[dense_count++] = (uint16_t)(n + 5);
+    dense[dense_count++] = (uint16_t)(2 * n);
+
+    for (int inverse = 0; inverse <= 1; inverse++) {
+        double worst_sparse = 0, worst_direct = 0;
+
+        for (int round = 0; round < ROUNDS; round++) {
+            random_input(x, n, limit, &seed);
+            memcpy(full, x, n * sizeof(Complex_Iq));
+            fft_iq_plan_execute(&plan, full, inverse);
+
+            // DC fast path: the plain sum, exactly what the transform computes for bin 0
+            fft_iq_plan_taps(&plan, x, inverse, dc, 1, out, scratch);
+            CHECK(out[0].real == full[0].real && out[0].imag == full[0].imag);
+
+            // Sparse: a partial DFT that leaves scratch alone
+            for (int i = 0; i < n; i++) {
+                scratch[i] = s_sentinel;
+            }
+
+            fft_iq_plan_taps(&plan, x, inverse, sparse, 4, out, scratch);
+            worst_sparse = fmax(worst_sparse, tap_error(full, n, sparse, 4, out));
+            CHECK(out[1].real == full[0].real && out[1].imag == full[0].imag);
+
+            for (int i = 0; i < n; i++) {
+                CHECK(scratch[i].real == s_sentinel.real && scratch[i].imag == s_sentinel.imag);
+            }
+
+            // Dense with scratch: the full transform, bit for bit
+            fft_iq_plan_taps(&plan, x, inverse, dense, dense_count, out, scratch);
+            CHECK(tap_error(full, n, dense, dense_count, out) == 0);
+
+            // Dense without scratch: every tap direct
+            fft_iq_plan_taps(&plan, x, inverse, dense, dense_count, out, NULL);
+            worst_direct = fmax(worst_direct, tap_error(full, n, dense, dense_count, out));
+        }
+
+        printf("fft_iq_plan_taps N=%d %s: worst difference from the full transform %.5f sparse, %.5f direct\n",
+               n, inverse ? "inverse" : "forward", worst_sparse, worst_direct);
+
+        // The bounds test_fft_iq holds the full transform to against an exact DFT
+        CHECK(worst_sparse < (inverse ? 0.002 : 0.1));
+        CHECK(worst_direct < (inverse ? 0.002 : 0.1));
+    }
+}
+
+static double bench(const uint16_t *taps, int tap_count)
+{
+    static Complex_Iq x[64], out[64], scratch[64];
+    fft_iq_plan_t plan;
+    uint32_t seed = 7;
+    volatile _iq16 sink = 0;
+
+    CHECK(fft_iq_plan_init(&plan, 64) == ESP_OK);
+    random_input(x, 64, 127, &seed);
+
+    double start = test_now();
+
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        if (taps) {
+            fft_iq_plan_taps(&plan, x, 1, taps, tap_count, out, scratch);
+        } else {
+            memcpy(out, x, sizeof(x));
+            fft_iq(out, 1);
+        }
+        sink += out[0].real;
+    }
+
+    (void)sink;
+
+    return (test_now() - start) / BENCH_ROUNDS * 1e9;
+}
+
+int main(void)
+{
+    /**
+     * @brief Inputs stay inside the documented Q16 headroom: full int8 range up to N = 128
+     */
+    check_taps(64, 127);
+    check_taps(128, 127);
+    check_taps(256, 63);
+
+    uint16_t taps[64];
+
+    for (int k = 0; k < 64; k++) {
+        taps[k] = (uint16_t)k;
+    }
+
+    printf("64-point inverse: fft_iq %.0f ns, taps {0} %.0f ns, {0..2} %.0f ns, {0..3} %.0f ns, all %.0f ns\n",
+           bench(NULL, 0), bench(taps, 1), bench(taps, 3), bench(taps, 4), bench(taps, 64));
+
+    printf("test_fft_taps: all tests passed\n");
+
+    return 0;
+}
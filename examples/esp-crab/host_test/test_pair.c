@@ -0,0 +1,354 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief cir_pair_table_t, single-threaded for late, duplicate, restart, flush and torn-read handling,
+ *        then under load: a master and a slave thread put the same sender runs (ids restarting from 0,
+ *        as after a slave_send reboot) with drops and resends, optionally with a third thread flushing
+ *        as the GPIO sync does. Every delivered pair must be a matching, untorn master/slave sample of
+ *        one run, no pair may be delivered twice, and outside flushes and restarts none may be missed.
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "test_util.h"
+#include "app_pair.h"
+
+#define STRESS_DEPTH        128
+#define STRESS_RUNS         6
+#define STRESS_RUN_LEN      40000
+#define STRESS_WINDOW       (STRESS_DEPTH / 4)      /**< How far one side may run ahead of the other */
+
+typedef struct {
+    cir_pair_table_t table;
+    atomic_uint_least8_t (*delivered)[STRESS_RUN_LEN];
+    atomic_uint pairs;
+} pair_ctx_t;
+
+/**
+ * @brief Every field derived from (run, id, side), so a half mixed from two writes is detected
+ */
+static csi_data_t sample(uint32_t run, uint32_t id, cir_pair_side_t side)
+{
+    csi_data_t data = {
+        .start = {0xAA, 0x55},
+        .id = id,
+        .time_delta = (int64_t)run << 32 | id,
+        .cir = {(float)id, (float)run, (float)side, (float)(id ^ (run * 7919))},
+        .end = {0x55, 0xAA},
+    };
+
+    return data;
+}
+
+static uint32_t sample_check(const csi_data_t *data, cir_pair_side_t side)
+{
+    uint32_t run = (uint32_t)(data->time_delta >> 32);
+    csi_data_t expected = sample(run, data->id, side);
+
+    CHECK(!memcmp(data, &expected, sizeof(csi_data_t)));
+
+    return run;
+}
+
+static void pair_cb(const csi_data_t *master, const csi_data_t *slave, void *arg)
+{
+    pair_ctx_t *ctx = arg;
+    uint32_t run = sample_check(master, CIR_PAIR_MASTER);
+
+    CHECK(sample_check(slave, CIR_PAIR_SLAVE) == run && master->id == slave->id);
+
+    if (ctx->delivered) {
+        CHECK(run < STRESS_RUNS && master->id < STRESS_RUN_LEN);
+        CHECK(atomic_fetch_add(&ctx->delivered[run][master->id], 1) == 0);
+    }
+
+    atomic_fetch_add(&ctx->pairs, 1);
+}
+
+static bool put(pair_ctx_t *ctx, uint32_t run, uint32_t id, cir_pair_side_t side)
+{
+    csi_data_t data = sample(run, id, side);
+    return cir_pair_table_put(&ctx->table, side, &data);
+}
+
+static void table_init(pair_ctx_t *ctx, void *storage, uint32_t depth)
+{
+    memset(ctx, 0, sizeof(pair_ctx_t));
+    CHECK(cir_pair_table_init(&ctx->table, storage, depth, pair_cb, ctx));
+}
+
+static void test_init(void)
+{
+    static cir_pair_slot_t storage[8];
+    cir_pair_table_t table;
+
+    CHECK(!cir_pair_table_init(&table, storage, 0, pair_cb, NULL));
+    CHECK(!cir_pair_table_init(&table, storage, 6, pair_cb, NULL));
+    CHECK(!cir_pair_table_init(&table, NULL, 8, pair_cb, NULL));
+    CHECK(!cir_pair_table_init(&table, storage, 8, NULL, NULL));
+}
+
+static void test_sequential(void)
+{
+    static cir_pair_slot_t storage[8];
+    static pair_ctx_t ctx;
+
+    table_init(&ctx, storage, 8);
+
+    /**
+     * @brief Id 0 of a fresh table is a real sample, not the zeroed slot
+     */
+    CHECK(!put(&ctx, 0, 0, CIR_PAIR_SLAVE));
+    CHECK(put(&ctx, 0, 0, CIR_PAIR_MASTER));
+
+    CHECK(!put(&ctx, 0, 3, CIR_PAIR_MASTER));
+    CHECK(put(&ctx, 0, 3, CIR_PAIR_SLAVE));
+    CHECK(!put(&ctx, 0, 3, CIR_PAIR_MASTER) && ctx.table.stats.duplicate == 1);
+    CHECK(!put(&ctx, 0, 3, CIR_PAIR_SLAVE) && ctx.table.stats.duplicate == 2);
+
+    /**
+     * @brief One lap behind is late, the slot keeps the newer id
+     */
+    CHECK(!put(&ctx, 0, 11, CIR_PAIR_SLAVE));
+    CHECK(!put(&ctx, 0, 3, CIR_PAIR_SLAVE) && ctx.table.stats.late == 1);
+    CHECK(put(&ctx, 0, 11, CIR_PAIR_MASTER));
+
+    CHECK(ctx.pairs == 3 && ctx.table.stats.pairs == 3);
+    CHECK(ctx.table.stats.puts[CIR_PAIR_MASTER] == 3 && ctx.table.stats.puts[CIR_PAIR_SLAVE] == 3);
+}
+
+/**
+ * @brief slave_send restarting its ids: the second run must pair from its first id
+ */
+static void test_restart(void)
+{
+    static cir_pair_slot_t storage[8];
+    static pair_ctx_t ctx;
+
+    table_init(&ctx, storage, 8);
+
+    for (uint32_t run = 0; run < 3; run++) {
+        for (uint32_t id = 0; id < 100; id++) {
+            put(&ctx, run, id, CIR_PAIR_MASTER);
+            CHECK(put(&ctx, run, id, CIR_PAIR_SLAVE));
+        }
+    }
+
+    CHECK(ctx.pairs == 300 && ctx.table.stats.restart == 2 && ctx.table.stats.late == 0);
+
+    /**
+     * @brief After a run shorter than two laps its last ids are within one lap of the new ones,
+     *        so the new run only pairs once its ids pass them
+     */
+    table_init(&ctx, storage, 8);
+
+    for (uint32_t id = 0; id < 10; id++) {
+        put(&ctx, 0, id, CIR_PAIR_MASTER);
+        put(&ctx, 0, id, CIR_PAIR_SLAVE);
+    }
+
+    for (uint32_t id = 0; id < 100; id++) {
+        put(&ctx, 1, id, CIR_PAIR_MASTER);
+        CHECK(put(&ctx, 1, id, CIR_PAIR_SLAVE) == (id >= 10));
+    }
+}
+
+static void test_flush(void)
+{
+    static cir_pair_slot_t storage[8];
+    static pair_ctx_t ctx;
+
+    table_init(&ctx, storage, 8);
+
+    CHECK(!put(&ctx, 0, 5, CIR_PAIR_MASTER));
+    cir_pair_table_flush(&ctx.table);
+    CHECK(!put(&ctx, 0, 5, CIR_PAIR_SLAVE));
+
+    /**
+     * @brief The flushed half is gone, so the same id is neither late nor a duplicate
+     */
+    CHECK(put(&ctx, 0, 5, CIR_PAIR_MASTER));
+    CHECK(ctx.table.stats.duplicate == 0 && ctx.table.stats.late == 0 && ctx.pairs == 1);
+
+    CHECK(!put(&ctx, 0, 6, CIR_PAIR_SLAVE));
+    cir_pair_table_flush(&ctx.table);
+    cir_pair_table_flush(&ctx.table);
+    CHECK(!put(&ctx, 0, 6, CIR_PAIR_MASTER));
+    CHECK(put(&ctx, 0, 6, CIR_PAIR_SLAVE) && ctx.pairs == 2);
+}
+
+/**
+ * @brief A half that stays mid-write is absent, and the read counts once however often it retried
+ */
+static void test_torn(void)
+{
+    static cir_pair_slot_t storage[8];
+    static pair_ctx_t ctx;
+
+    table_init(&ctx, storage, 8);
+
+    CHECK(!put(&ctx, 0, 2, CIR_PAIR_MASTER));
+    atomic_fetch_add(&storage[2].half[CIR_PAIR_MASTER].seq, 1);
+    CHECK(!put(&ctx, 0, 2, CIR_PAIR_SLAVE));
+    CHECK(ctx.table.stats.torn == 1);
+
+    atomic_fetch_add(&storage[2].half[CIR_PAIR_MASTER].seq, 1);
+    CHECK(put(&ctx, 0, 10, CIR_PAIR_SLAVE) == false);
+    CHECK(ctx.table.stats.torn == 1 && ctx.pairs == 0);
+}
+
+typedef struct {
+    pair_ctx_t *ctx;
+    cir_pair_side_t side;
+    atomic_uint *progress;          /**< Samples handled per side, both runs counted */
+    atomic_bool *stop;
+    bool resend;
+    uint32_t seed;
+    bool (*sent)[STRESS_RUN_LEN];   /**< Samples this side put */
+} side_arg_t;
+
+static void *side_task(void *arg)
+{
+    side_arg_t *side = arg;
+    atomic_uint *own = &side->progress[side->side], *other = &side->progress[!side->side];
+
+    for (uint32_t run = 0; run < STRESS_RUNS; run++) {
+        for (uint32_t id = 0; id < STRESS_RUN_LEN; id++) {
+            while (atomic_load(own) > atomic_load(other) + STRESS_WINDOW) {
+                sched_yield();
+            }
+
+            /**
+             * @brief 1 in 16 lost, 1 in 64 sent twice. Resends are off while flushing: a sample both
+             *        sides resend across a flush is a new pair to the table.
+             */
+            uint32_t r = test_rand(&side->seed);
+
+            if (r % 16) {
+                put(side->ctx, run, id, side->side);
+                side->sent[run][id] = true;
+
+                if (side->resend && r % 64 == 1) {
+                    put(side->ctx, run, id, side->side);
+                }
+            }
+
+            atomic_fetch_add(own, 1);
+        }
+    }
+
+    atomic_fetch_add(own, STRESS_WINDOW * 2);
+    return NULL;
+}
+
+static void *flush_task(void *arg)
+{
+    side_arg_t *flush = arg;
+
+    while (!atomic_load(flush->stop)) {
+        cir_pair_table_flush(&flush->ctx->table);
+
+        for (uint32_t i = test_rand(&flush->seed) % 2000; i; i--) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static void stress(bool flush)
+{
+    static bool sent[2][STRESS_RUNS][STRESS_RUN_LEN];
+    static atomic_uint_least8_t delivered[STRESS_RUNS][STRESS_RUN_LEN];
+    static cir_pair_slot_t storage[STRESS_DEPTH];
+    static pair_ctx_t ctx;
+    atomic_uint progress[2] = {0};
+    atomic_bool stop = false;
+    pthread_t threads[3];
+    side_arg_t args[3];
+
+    memset(sent, 0, sizeof(sent));
+    memset(delivered, 0, sizeof(delivered));
+    table_init(&ctx, storage, STRESS_DEPTH);
+    ctx.delivered = delivered;
+
+    for (int i = 0; i < 3; i++) {
+        args[i] = (side_arg_t) {
+            .ctx = &ctx, .side = (cir_pair_side_t)(i & 1), .progress = progress, .stop = &stop,
+            .resend = !flush, .seed = 17 + i, .sent = sent[i & 1],
+        };
+    }
+
+    double start = test_now();
+    CHECK(pthread_create(&threads[0], NULL, side_task, &args[0]) == 0);
+    CHECK(pthread_create(&threads[1], NULL, side_task, &args[1]) == 0);
+    if (flush) {
+        CHECK(pthread_create(&threads[2], NULL, flush_task, &args[2]) == 0);
+    }
+
+    CHECK(pthread_join(threads[0], NULL) == 0);
+    CHECK(pthread_join(threads[1], NULL) == 0);
+    atomic_store(&stop, true);
+    if (flush) {
+        CHECK(pthread_join(threads[2], NULL) == 0);
+    }
+    double elapsed = test_now() - start;
+
+    uint32_t expected = 0, missed = 0;
+
+    for (uint32_t run = 0; run < STRESS_RUNS; run++) {
+        for (uint32_t id = 0; id < STRESS_RUN_LEN; id++) {
+            bool both = sent[CIR_PAIR_MASTER][run][id] && sent[CIR_PAIR_SLAVE][run][id];
+
+            CHECK(both || !delivered[run][id]);
+            expected += both;
+            missed += both && !delivered[run][id];
+        }
+    }
+
+    const cir_pair_stats_t *stats = &ctx.table.stats;
+    uint32_t puts = stats->puts[CIR_PAIR_MASTER] + stats->puts[CIR_PAIR_SLAVE];
+
+    printf("%s: %u of %u pairs in %.0f ms, missed %u, restart %u, late %u, duplicate %u, torn %u of %u reads\n",
+           flush ? "with flushes" : "restarts only", (unsigned int)ctx.pairs, (unsigned int)expected,
+           elapsed * 1e3, (unsigned int)missed, (unsigned int)stats->restart, (unsigned int)stats->late,
+           (unsigned int)stats->duplicate, (unsigned int)stats->torn, (unsigned int)puts);
+
+    CHECK(ctx.pairs == stats->pairs && ctx.pairs == expected - missed);
+    CHECK(stats->torn <= puts);
+
+    /**
+     * @brief A restart, detected by either side, cancels the halves of the other side's run still in
+     *        flight: at most one window per side and restart
+     */
+    if (!flush) {
+        CHECK(stats->restart >= STRESS_RUNS - 1 && stats->restart <= 2 * (STRESS_RUNS - 1));
+        CHECK(missed <= stats->restart * 2 * (STRESS_WINDOW + 1));
+    } else {
+        CHECK(ctx.pairs > expected / 2);
+    }
+}
+
+int main(void)
+{
+    test_init();
+    test_sequential();
+    test_restart();
+    test_flush();
+    test_torn();
+
+    stress(false);
+    stress(true);
+
+    printf("test_pair: all tests passed\n");
+
+    return 0;
+}
@@ -0,0 +1,359 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief The CRAB_LINK_TYPE_CIR_BATCH codec: slave_recv's uart_cir_batch_add() against master_recv's
+ *        uart_cir_batch_decode(), both app_uart.c files linked into one program:
+ *
+ * - Round trips of full batches through uart_send_cir_batch() and a csi_link decoder fed in
+ *   random chunks, with ids wrapping past UINT32_MAX, senders restarting from id 0, negative
+ *   and extreme time deltas, and the largest possible batch, which has to fit one frame.
+ * - Every truncation of a batch decodes exactly the samples that are complete, and a count
+ *   byte larger than the samples present or than CRAB_LINK_BATCH_MAX does not read further.
+ * - Varints: non-canonical encodings are accepted, one running past 10 bytes ends the batch.
+ *
+ * Then encode and decode are timed per sample.
+ */
+
+#include <string.h>
+
+#include "test_util.h"
+#include "app_uart.h"
+#include "csi_link.h"
+#include "driver/uart.h"
+#include "app_pair_stub.h"
+
+#define ROUNDS          2000
+#define BENCH_ROUNDS    200000
+
+int uart_cir_batch_decode(const uint8_t *payload, size_t payload_len);     /**< master_recv's app_uart.h */
+
+static uint8_t s_wire[4 * CSI_LINK_MAX_FRAME_SIZE];
+static size_t s_wire_len;
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size)
+{
+    (void)uart_num;
+    CHECK(s_wire_len + size <= sizeof(s_wire));
+    memcpy(s_wire + s_wire_len, src, size);
+    s_wire_len += size;
+
+    return (int)size;
+}
+
+static void sample(csi_data_t *data, uint32_t id, int64_t time_delta, uint32_t *seed)
+{
+    memset(data, 0, sizeof(*data));
+    data->start[0] = 0xAA;
+    data->start[1] = 0x55;
+    data->id = id;
+    data->time_delta = time_delta;
+    data->end[0] = 0x55;
+    data->end[1] = 0xAA;
+
+    for (int i = 0; i < 4; i++) {
+        uint32_t bits = test_rand(seed);
+        memcpy(&data->cir[i], &bits, sizeof(bits));     /**< Any bit pattern, NaNs included, goes through */
+    }
+}
+
+static void check_samples(const csi_data_t *expected, size_t count)
+{
+    const csi_data_t *decoded;
+
+    CHECK(app_pair_stub_samples(&decoded) == count);
+
+    for (size_t i = 0; i < count; i++) {
+        CHECK(!memcmp(&decoded[i], &expected[i], sizeof(csi_data_t)));
+    }
+}
+
+static void link_frame_cb(uint8_t type, const uint8_t *payload, size_t payload_len, void *ctx)
+{
+    int *decoded = ctx;
+
+    CHECK(type == CRAB_LINK_TYPE_CIR_BATCH);
+    *decoded += uart_cir_batch_decode(payload, payload_len);
+}
+
+/**
+ * @brief Batch, send and receive `count` samples, the wire split into random chunks
+ */
+static void round_trip(const csi_data_t *samples, size_t count, uint32_t *seed)
+{
+    static uart_cir_batch_t batch;
+    static csi_link_decoder_t decoder;
+    int decoded = 0;
+
+    uart_cir_batch_reset(&batch);
+    app_pair_stub_reset();
+    s_wire_len = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        CHECK(uart_cir_batch_add(&batch, &samples[i]) == (int)(i % CRAB_LINK_BATCH_MAX) + 1);
+        CHECK(batch.len <= sizeof(batch.buf));
+
+        if (batch.count == CRAB_LINK_BATCH_MAX) {
+            CHECK(uart_send_cir_batch(&batch) > 0);
+            CHECK(batch.count == 0 && batch.len == 1);
+        }
+    }
+
+    uart_send_cir_batch(&batch);
+    CHECK(uart_send_cir_batch(&batch) == 0);       /**< An empty batch sends nothing */
+
+    csi_link_decoder_init(&decoder);
+
+    for (size_t offset = 0; offset < s_wire_len;) {
+        size_t len = 1 + test_rand(seed) % 64;
+        len = len < s_wire_len - offset ? len : s_wire_len - offset;
+        csi_link_decoder_feed(&decoder, s_wire + offset, len, link_frame_cb, &decoded);
+        offset += len;
+    }
+
+    CHECK(decoder.error_count == 0 && decoded == (int)count);
+    check_samples(samples, count);
+}
+
+static void test_round_trip(void)
+{
+    static csi_data_t samples[3 * CRAB_LINK_BATCH_MAX + 3];
+    uint32_t seed = 0xb47c;
+
+    /**
+     * @brief Ids across the wrap-around, then a sender restart, with time deltas that go negative
+     */
+    uint32_t id = UINT32_MAX - 5;
+    int64_t time_delta = 3;
+
+    for (size_t i = 0; i < 3 * CRAB_LINK_BATCH_MAX + 3; i++) {
+        if (i == 2 * CRAB_LINK_BATCH_MAX) {
+            id = 0;
+        }
+
+        sample(&samples[i], id++, time_delta, &seed);
+        time_delta -= 1500 + (int64_t)(test_rand(&seed) % 1000);
+    }
+
+    round_trip(samples, 3 * CRAB_LINK_BATCH_MAX + 3, &seed);
+
+    /**
+     * @brief Random steps of every size, including the int32 and int64 extremes
+     */
+    static const int64_t s_extremes[] = {INT64_MIN, INT64_MAX, -1, 0, 1, INT64_MIN + 1};
+
+    for (int round = 0; round < ROUNDS; round++) {
+        size_t count = 1 + test_rand(&seed) % (3 * CRAB_LINK_BATCH_MAX);
+
+        for (size_t i = 0; i < count; i++) {
+            uint32_t r = test_rand(&seed);
+            uint64_t t = (uint64_t)test_rand(&seed) << 32 | test_rand(&seed);
+            uint64_t step = t >> (r >> 26);
+
+            id = (r & 3) ? id + (r >> 28) - 4 : test_rand(&seed);
+
+            if (r & 0x30) {
+                time_delta = (int64_t)((r & 0x80) ? (uint64_t)time_delta - step : (uint64_t)time_delta + step);
+            } else {
+                time_delta = (r & 0x40) ? (int64_t)t : s_extremes[(r >> 8) % 6];
+            }
+
+            sample(&samples[i], id, time_delta, &seed);
+        }
+
+        round_trip(samples, count, &seed);
+    }
+}
+
+/**
+ * @brief The largest batch: every id step INT32_MIN and every time step 2^63, the longest varints
+ */
+static void test_full_batch(void)
+{
+    static uart_cir_batch_t batch;
+    csi_data_t samples[CRAB_LINK_BATCH_MAX];
+    uint32_t seed = 0xf011;
+
+    uart_cir_batch_reset(&batch);
+
+    for (int i = 0; i < CRAB_LINK_BATCH_MAX; i++) {
+        sample(&samples[i], i & 1 ? 0 : 0x80000000u, i & 1 ? 0 : INT64_MIN, &seed);
+        uart_cir_batch_add(&batch, &samples[i]);
+        CHECK(batch.len == 1 + (size_t)(i + 1) * CRAB_LINK_BATCH_SAMPLE_MAX);
+    }
+
+    CHECK(batch.len == sizeof(batch.buf) && batch.len <= CSI_LINK_MAX_PAYLOAD_LEN);
+    CHECK(batch.buf[0] == CRAB_LINK_BATCH_MAX);
+
+    app_pair_stub_reset();
+    CHECK(uart_cir_batch_decode(batch.buf, batch.len) == CRAB_LINK_BATCH_MAX);
+    check_samples(samples, CRAB_LINK_BATCH_MAX);
+
+    /**
+     * @brief Consecutive ids 2 ms apart cost 1 + 2 + 16 bytes a sample
+     */
+    uart_cir_batch_reset(&batch);
+
+    for (int i = 0; i < CRAB_LINK_BATCH_MAX; i++) {
+        sample(&samples[i], (uint32_t)i + 1, 2000 * (i + 1), &seed);
+        uart_cir_batch_add(&batch, &samples[i]);
+    }
+
+    CHECK(batch.len == 1 + CRAB_LINK_BATCH_MAX * (1 + 2 + 16));
+}
+
+/**
+ * @brief Every prefix of a batch decodes the samples that are complete in it, nothing more
+ */
+static void test_truncated(void)
+{
+    static uart_cir_batch_t batch;
+    csi_data_t samples[CRAB_LINK_BATCH_MAX];
+    size_t sample_end[CRAB_LINK_BATCH_MAX];
+    uint8_t payload[sizeof(batch.buf) + 32];
+    uint32_t seed = 0x7c07;
+
+    uart_cir_batch_reset(&batch);
+
+    for (int i = 0; i < CRAB_LINK_BATCH_MAX; i++) {
+        sample(&samples[i], 0xfffffff0u + (uint32_t)i * 7, -(int64_t)(test_rand(&seed) >> (i * 4)), &seed);
+        uart_cir_batch_add(&batch, &samples[i]);
+        sample_end[i] = batch.len;
+    }
+
+    for (size_t len = 0; len <= batch.len; len++) {
+        int complete = 0;
+
+        while (complete < CRAB_LINK_BATCH_MAX && sample_end[complete] <= len) {
+            complete++;
+        }
+
+        app_pair_stub_reset();
+        CHECK(uart_cir_batch_decode(batch.buf, len) == complete);
+        check_samples(samples, complete);
+    }
+
+    /**
+     * @brief A count past the samples present, or past CRAB_LINK_BATCH_MAX with more bytes behind
+     */
+    memcpy(payload, batch.buf, batch.len);
+    memset(payload + batch.len, 0, sizeof(payload) - batch.len);
+
+    for (int count = CRAB_LINK_BATCH_MAX; count <= 255; count++) {
+        payload[0] = (uint8_t)count;
+        app_pair_stub_reset();
+        CHECK(uart_cir_batch_decode(payload, sizeof(payload)) == CRAB_LINK_BATCH_MAX);
+        check_samples(samples, CRAB_LINK_BATCH_MAX);
+    }
+
+    payload[0] = 3;
+    app_pair_stub_reset();
+    CHECK(uart_cir_batch_decode(payload, batch.len) == 3);
+    check_samples(samples, 3);
+}
+
+static void test_varint(void)
+{
+    uint8_t payload[64];
+    const csi_data_t *decoded;
+    size_t len;
+
+    /**
+     * @brief Zero padded (0x82 0x80 0x00 for 2) is accepted: id +1, time -2
+     */
+    len = 0;
+    payload[len++] = 1;
+    payload[len++] = 0x82;
+    payload[len++] = 0x80;
+    payload[len++] = 0x00;
+    payload[len++] = 0x03;
+    memset(payload + len, 0x11, 16);
+    len += 16;
+
+    app_pair_stub_reset();
+    CHECK(uart_cir_batch_decode(payload, len) == 1);
+    CHECK(app_pair_stub_samples(&decoded) == 1 && decoded[0].id == 1 && decoded[0].time_delta == -2);
+
+    /**
+     * @brief A 10-byte varint is the longest, an 11th byte ends the batch before its sample
+     */
+    for (int overlong = 0; overlong <= 1; overlong++) {
+        len = 0;
+        payload[len++] = 2;
+        payload[len++] = 0x02;
+        payload[len++] = 0x02;
+        memset(payload + len, 0x22, 16);
+        len += 16;
+        payload[len++] = 0x04;
+
+        for (int i = 0; i < 9 + overlong; i++) {
+            payload[len++] = 0x80;
+        }
+
+        payload[len++] = 0x00;
+        memset(payload + len, 0x33, 16);
+        len += 16;
+
+        app_pair_stub_reset();
+        CHECK(uart_cir_batch_decode(payload, len) == 2 - overlong);
+        CHECK(app_pair_stub_samples(&decoded) == (size_t)(2 - overlong));
+        CHECK(decoded[0].id == 1 && decoded[0].time_delta == 1);
+        CHECK(overlong || (decoded[1].id == 3 && decoded[1].time_delta == 1));
+    }
+
+    /**
+     * @brief An id varint that never ends
+     */
+    payload[0] = 1;
+    memset(payload + 1, 0xff, sizeof(payload) - 1);
+    app_pair_stub_reset();
+    CHECK(uart_cir_batch_decode(payload, sizeof(payload)) == 0);
+    CHECK(uart_cir_batch_decode(payload, 0) == 0);
+}
+
+static void bench(void)
+{
+    static uart_cir_batch_t batch;
+    csi_data_t samples[CRAB_LINK_BATCH_MAX];
+    uint32_t seed = 0xbe4c;
+    double encode = 0, decode = 0;
+
+    for (int round = 0; round < BENCH_ROUNDS / CRAB_LINK_BATCH_MAX; round++) {
+        for (int i = 0; i < CRAB_LINK_BATCH_MAX; i++) {
+            sample(&samples[i], (uint32_t)(round * CRAB_LINK_BATCH_MAX + i), 1000 * round + 100 * i, &seed);
+        }
+
+        double start = test_now();
+        uart_cir_batch_reset(&batch);
+
+        for (int i = 0; i < CRAB_LINK_BATCH_MAX; i++) {
+            uart_cir_batch_add(&batch, &samples[i]);
+        }
+
+        double mid = test_now();
+        app_pair_stub_reset();
+        CHECK(uart_cir_batch_decode(batch.buf, batch.len) == CRAB_LINK_BATCH_MAX);
+        decode += test_now() - mid;
+        encode += mid - start;
+    }
+
+    printf("CIR batch codec: encode %.1f ns, decode %.1f ns per sample, %d bytes per %d samples\n",
+           encode / BENCH_ROUNDS * 1e9, decode / BENCH_ROUNDS * 1e9, (int)batch.len, CRAB_LINK_BATCH_MAX);
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_full_batch();
+    test_truncated();
+    test_varint();
+    bench();
+
+    printf("test_uart_batch: all tests passed\n");
+
+    return 0;
+}
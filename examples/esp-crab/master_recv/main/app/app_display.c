@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "app_display.h"
+
+#define DISPLAY_WINDOW_MASK (DISPLAY_WINDOW_MAX - 1)
+
+static inline uint32_t display_window_clamp(uint32_t window)
+{
+    return window < 1 ? 1 : window > DISPLAY_WINDOW_MAX ? DISPLAY_WINDOW_MAX : window;
+}
+
+void display_minmax_init(display_minmax_t *minmax, uint32_t window)
+{
+    memset(minmax, 0, sizeof(display_minmax_t));
+    minmax->window = display_window_clamp(window);
+}
+
+/**
+ * @brief Append to a monotonic deque, dropping the entries the new value dominates and
+ *        the ones that left the window. Holds at most `window` entries.
+ *
+ * @param sign 1 keeps the maximum at the head, -1 the minimum
+ */
+static inline void display_deque_push(display_deque_t *deque, float value, uint32_t seq, uint32_t window, float sign)
+{
+    while (deque->tail != deque->head && sign * deque->value[(deque->tail - 1) & DISPLAY_WINDOW_MASK] <= sign * value) {
+        deque->tail--;
+    }
+
+    deque->value[deque->tail & DISPLAY_WINDOW_MASK] = value;
+    deque->seq[deque->tail & DISPLAY_WINDOW_MASK] = seq;
+    deque->tail++;
+
+    while (seq - deque->seq[deque->head & DISPLAY_WINDOW_MASK] >= window) {
+        deque->head++;
+    }
+}
+
+void display_minmax_push(display_minmax_t *minmax, float low, float high)
+{
+    display_deque_push(&minmax->min, low, minmax->seq, minmax->window, -1.0f);
+    display_deque_push(&minmax->max, high, minmax->seq, minmax->window, 1.0f);
+    minmax->seq++;
+}
+
+float display_minmax_min(const display_minmax_t *minmax)
+{
+    return minmax->seq ? minmax->min.value[minmax->min.head & DISPLAY_WINDOW_MASK] : 0;
+}
+
+float display_minmax_max(const display_minmax_t *minmax)
+{
+    return minmax->seq ? minmax->max.value[minmax->max.head & DISPLAY_WINDOW_MASK] : 0;
+}
+
+void display_circ_mean_init(display_circ_mean_t *mean, uint32_t window)
+{
+    memset(mean, 0, sizeof(display_circ_mean_t));
+    mean->window = display_window_clamp(window);
+}
+
+float display_circ_mean_push(display_circ_mean_t *mean, float angle)
+{
+    float s = sinf(angle);
+    float c = cosf(angle);
+
+    if (mean->count == mean->window) {
+        mean->sum_sin -= mean->sin[mean->next];
+        mean->sum_cos -= mean->cos[mean->next];
+    } else {
+        mean->count++;
+    }
+
+    mean->sin[mean->next] = s;
+    mean->cos[mean->next] = c;
+    mean->sum_sin += s;
+    mean->sum_cos += c;
+
+    /**
+     * @brief Re-add the window once per pass, so the rounding errors of the running sums cannot accumulate
+     */
+    if (++mean->next == mean->window) {
+        mean->next = 0;
+        mean->sum_sin = 0;
+        mean->sum_cos = 0;
+
+        for (uint32_t i = 0; i < mean->count; i++) {
+            mean->sum_sin += mean->sin[i];
+            mean->sum_cos += mean->cos[i];
+        }
+    }
+
+    return atan2f(mean->sum_sin, mean->sum_cos);
+}
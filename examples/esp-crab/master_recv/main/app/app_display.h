@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Incremental statistics behind the CSI charts
+ *
+ * Every update is O(1) (amortized), so the display task can absorb samples at
+ * the packet rate and only touch LVGL at its own frame rate:
+ * - display_minmax_t keeps the minimum and maximum of the last `window` points
+ *   with a monotonic deque each.
+ * - display_circ_mean_t keeps the circular mean of the last `window` angles as
+ *   running sums of their sines and cosines.
+ *
+ * No LVGL or FreeRTOS dependency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Largest window of both models, a power of two
+ */
+#define DISPLAY_WINDOW_MAX  64
+
+typedef struct {
+    float value[DISPLAY_WINDOW_MAX];
+    uint32_t seq[DISPLAY_WINDOW_MAX];   /**< Point number each value was pushed with */
+    uint32_t head;                      /**< Oldest entry, the current extreme */
+    uint32_t tail;
+} display_deque_t;
+
+typedef struct {
+    display_deque_t min;                /**< Increasing values */
+    display_deque_t max;                /**< Decreasing values */
+    uint32_t window;
+    uint32_t seq;                       /**< Points pushed so far */
+} display_minmax_t;
+
+typedef struct {
+    float sin[DISPLAY_WINDOW_MAX];
+    float cos[DISPLAY_WINDOW_MAX];
+    float sum_sin;
+    float sum_cos;
+    uint32_t window;
+    uint32_t count;                     /**< Angles in the window, up to `window` */
+    uint32_t next;                      /**< Slot of the next angle */
+} display_circ_mean_t;
+
+/**
+ * @param window Points the extremes are taken over, 1 to DISPLAY_WINDOW_MAX
+ */
+void display_minmax_init(display_minmax_t *minmax, uint32_t window);
+
+/**
+ * @brief Add a point spanning [low, high], e.g. the values of all series at one x position
+ */
+void display_minmax_push(display_minmax_t *minmax, float low, float high);
+
+/**
+ * @brief Extremes of the last `window` points, 0 before the first point
+ */
+float display_minmax_min(const display_minmax_t *minmax);
+float display_minmax_max(const display_minmax_t *minmax);
+
+/**
+ * @param window Angles averaged, 1 to DISPLAY_WINDOW_MAX
+ */
+void display_circ_mean_init(display_circ_mean_t *mean, uint32_t window);
+
+/**
+ * @brief Add an angle in radians
+ *
+ * @return Circular mean of the last `window` angles, in [-pi, pi]
+ */
+float display_circ_mean_push(display_circ_mean_t *mean, float angle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -10,11 +10,11 @@
 #define GPIO_INPUT_PIN_SEL  (1ULL << GPIO_INPUT_IO)
 extern int64_t time_zero;
 static const char *TAG = "GPIO";
-extern QueueHandle_t csi_recv_queue;
+extern volatile bool csi_recv_flush;
 
 static void IRAM_ATTR gpio_isr_handler(void *arg) 
 {
-    xQueueReset(csi_recv_queue);
+    csi_recv_flush = true;
     time_zero = esp_timer_get_time();
     uint32_t gpio_num = (uint32_t)arg;
 }
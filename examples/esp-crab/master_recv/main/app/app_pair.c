@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "app_pair.h"
+
+/**
+ * @brief Attempts to read a half that is being written before treating it as absent
+ */
+#define CIR_PAIR_READ_RETRIES   4
+
+bool cir_pair_table_init(cir_pair_table_t *table, void *storage, uint32_t depth, cir_pair_cb_t cb, void *ctx)
+{
+    if (!table || !storage || !cb || !depth || (depth & (depth - 1))) {
+        return false;
+    }
+
+    memset(table, 0, sizeof(cir_pair_table_t));
+    memset(storage, 0, CIR_PAIR_TABLE_STORAGE_SIZE(depth));
+    table->slots = (cir_pair_slot_t *)storage;
+    table->mask  = depth - 1;
+    table->cb    = cb;
+    table->ctx   = ctx;
+    atomic_init(&table->epoch, 1);
+
+    return true;
+}
+
+/**
+ * @brief Seqlock read of the half written by the other side. A read that raced with the writer
+ *        counts once in `torn`, however many attempts it took.
+ *
+ * @return false if the half kept changing during CIR_PAIR_READ_RETRIES attempts
+ */
+static bool cir_pair_half_read(cir_pair_table_t *table, const cir_pair_half_t *half,
+                               uint32_t *seq, uint32_t *epoch, uint32_t *id, csi_data_t *data)
+{
+    bool done = false;
+    int i;
+
+    for (i = 0; i < CIR_PAIR_READ_RETRIES && !done; i++) {
+        uint32_t begin = atomic_load_explicit(&half->seq, memory_order_acquire);
+
+        if (!(begin & 1)) {
+            *epoch = half->epoch;
+            *id    = half->id;
+            *data  = half->data;
+            atomic_thread_fence(memory_order_acquire);
+
+            if (atomic_load_explicit(&half->seq, memory_order_relaxed) == begin) {
+                *seq = begin;
+                done = true;
+            }
+        }
+    }
+
+    if (i > 1 || !done) {
+        atomic_fetch_add_explicit(&table->stats.torn, 1, memory_order_relaxed);
+    }
+
+    return done;
+}
+
+void cir_pair_table_flush(cir_pair_table_t *table)
+{
+    atomic_fetch_add_explicit(&table->epoch, 1, memory_order_relaxed);
+}
+
+bool cir_pair_table_put(cir_pair_table_t *table, cir_pair_side_t side, const csi_data_t *data)
+{
+    uint32_t id = data->id;
+    cir_pair_slot_t *slot = &table->slots[id & table->mask];
+    cir_pair_half_t *own = &slot->half[side];
+    uint32_t epoch = atomic_load_explicit(&table->epoch, memory_order_relaxed);
+    uint32_t seq = atomic_load_explicit(&own->seq, memory_order_relaxed);
+
+    /**
+     * @brief Only this side writes `own`, so it can be read without the seqlock. A sample in the same
+     *        slot is a multiple of the depth older: one lap is a late sample, more is the sender's
+     *        ids starting over, which would otherwise be dropped until they pass the old ones.
+     */
+    if (own->epoch == epoch) {
+        int32_t age = (int32_t)(id - own->id);
+
+        if (age < 0 && own->id - id <= table->mask + 1) {
+            atomic_fetch_add_explicit(&table->stats.late, 1, memory_order_relaxed);
+            return false;
+        }
+
+        if (age < 0) {
+            atomic_fetch_add_explicit(&table->stats.restart, 1, memory_order_relaxed);
+            epoch = atomic_fetch_add_explicit(&table->epoch, 1, memory_order_relaxed) + 1;
+        } else if (!age) {
+            atomic_fetch_add_explicit(&table->stats.duplicate, 1, memory_order_relaxed);
+            return false;
+        }
+    }
+
+    atomic_store_explicit(&own->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    own->epoch = epoch;
+    own->id    = id;
+    own->data  = *data;
+    atomic_store_explicit(&own->seq, seq + 2, memory_order_release);
+    atomic_fetch_add_explicit(&table->stats.puts[side], 1, memory_order_relaxed);
+
+    /**
+     * @brief Order the write above before the read below. If both sides write the same slot at
+     *        once, at least one of them then sees the other's half.
+     */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    csi_data_t other;
+    uint32_t other_seq = 0;
+    uint32_t other_id = 0;
+    uint32_t other_epoch = 0;
+
+    if (!cir_pair_half_read(table, &slot->half[!side], &other_seq, &other_epoch, &other_id, &other)
+            || other_epoch != epoch || other_id != id) {
+        return false;
+    }
+
+    /**
+     * @brief Both sides may see the complete pair; the master write's seq identifies it, so the CAS
+     *        lets exactly one of them deliver it
+     */
+    uint32_t master_seq = side == CIR_PAIR_MASTER ? seq + 2 : other_seq;
+    uint32_t claimed = atomic_load_explicit(&slot->claimed, memory_order_relaxed);
+
+    do {
+        if (claimed == master_seq) {
+            return false;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&slot->claimed, &claimed, master_seq,
+                                                    memory_order_relaxed, memory_order_relaxed));
+
+    atomic_fetch_add_explicit(&table->stats.pairs, 1, memory_order_relaxed);
+
+    if (side == CIR_PAIR_MASTER) {
+        table->cb(data, &other, table->ctx);
+    } else {
+        table->cb(&other, data, table->ctx);
+    }
+
+    return true;
+}
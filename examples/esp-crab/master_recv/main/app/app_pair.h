@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Lock-free correlation of master and slave CIR samples by frame id
+ *
+ * Each side (the master's own CSI task, the UART task receiving the slave's
+ * samples) writes its half of slot `id & (depth - 1)` under a per-half seqlock,
+ * then reads the other half. Whichever side completes a pair claims it with a
+ * CAS and calls the pair callback, exactly once per master sample. Halves may
+ * arrive in any order, as long as they are less than `depth` ids apart.
+ *
+ * A reader never waits for a writer: a half that is being written is treated
+ * as absent, and its writer finds the pair itself when it is done.
+ *
+ * Every half carries the table epoch it was written in, halves of an older
+ * epoch count as absent. cir_pair_table_flush() bumps the epoch for the GPIO
+ * sync. Ids restart from 0 when the sender reboots, so a sample more than one
+ * table lap older than the one in its slot is taken as such a restart and
+ * flushes the table as well.
+ *
+ * Plain C11 with <stdatomic.h>, so it can be built and tested on a host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "app_uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    CIR_PAIR_MASTER = 0,
+    CIR_PAIR_SLAVE,
+} cir_pair_side_t;
+
+typedef struct {
+    atomic_uint_least32_t seq;       /**< Odd while the writer of this side updates the half */
+    uint32_t epoch;                  /**< Table epoch the half was written in */
+    uint32_t id;
+    csi_data_t data;
+} cir_pair_half_t;
+
+typedef struct {
+    cir_pair_half_t half[2];
+    atomic_uint_least32_t claimed;   /**< Master `seq` of the last pair delivered from this slot */
+} cir_pair_slot_t;
+
+/**
+ * @brief Bytes of storage needed by cir_pair_table_init()
+ */
+#define CIR_PAIR_TABLE_STORAGE_SIZE(depth)  (sizeof(cir_pair_slot_t) * (depth))
+
+/**
+ * @brief Both halves of a pair, e.g. for passing it through a queue from the pair callback
+ */
+typedef struct {
+    csi_data_t master;
+    csi_data_t slave;
+} cir_pair_t;
+
+typedef void (*cir_pair_cb_t)(const csi_data_t *master, const csi_data_t *slave, void *ctx);
+
+typedef struct {
+    atomic_uint_least32_t puts[2];   /**< Samples written per side */
+    atomic_uint_least32_t pairs;     /**< Pairs delivered to the callback */
+    atomic_uint_least32_t late;      /**< Samples dropped, their slot holds the id one table lap newer of the same side */
+    atomic_uint_least32_t duplicate; /**< Samples dropped, their id was already written by the same side */
+    atomic_uint_least32_t restart;   /**< Samples older than one table lap, taken as a restart of the sender's ids */
+    atomic_uint_least32_t torn;      /**< Reads of the other half that raced with its writer, once per read */
+} cir_pair_stats_t;
+
+typedef struct {
+    cir_pair_slot_t *slots;
+    uint32_t mask;                   /**< depth - 1, depth is a power of two */
+    cir_pair_cb_t cb;
+    void *ctx;
+    atomic_uint_least32_t epoch;     /**< Bumped by every flush, starts at 1 so zeroed halves are absent */
+    cir_pair_stats_t stats;
+} cir_pair_table_t;
+
+/**
+ * @brief Initialize a table over caller-provided storage
+ *
+ * @param storage At least CIR_PAIR_TABLE_STORAGE_SIZE(depth) bytes, aligned for cir_pair_slot_t
+ * @param depth   Ids kept per side, a power of two; a half is matched if its partner arrives
+ *                before `depth` newer ids of the partner's side
+ * @param cb      Called with both halves of every pair, from the task of the side that completed it
+ *
+ * @return false if depth is not a power of two or an argument is NULL
+ */
+bool cir_pair_table_init(cir_pair_table_t *table, void *storage, uint32_t depth, cir_pair_cb_t cb, void *ctx);
+
+/**
+ * @brief Forget every sample, e.g. when the boards are synchronized
+ *
+ * Safe from any task or ISR. A put that runs concurrently with the flush may lose its pair,
+ * and a sample both sides put again after the flush is paired again.
+ */
+void cir_pair_table_flush(cir_pair_table_t *table);
+
+/**
+ * @brief Write one side's sample and deliver the pair if the other half is present
+ *
+ * Each side must be written by a single task.
+ *
+ * @return true if this call delivered a pair
+ */
+bool cir_pair_table_put(cir_pair_table_t *table, cir_pair_side_t side, const csi_data_t *data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/uart.h"
@@ -6,6 +7,8 @@
 #include "sdkconfig.h"
 #include "esp_log.h"
 #include "app_uart.h"
+#include "csi_link.h"
+#include "app_pair.h"
 #include "bsp_C5_dual_antenna.h"
 #define UART_PORT_NUM      UART_NUM_1
 #define UART_BAUD_RATE     2000000
@@ -13,39 +16,132 @@
 #define RXD_PIN            (BSP_CNT_3)
 #define BUF_SIZE           4096
 static const char *TAG = "UART";
-QueueHandle_t uart_recv_queue;
+extern cir_pair_table_t csi_pair_table;
 static QueueHandle_t uart0_queue;
+
+static size_t uart_get_varint(const uint8_t *buf, size_t len, uint64_t *value)
+{
+    *value = 0;
+
+    for (size_t i = 0; i < len && i < 10; i++) {
+        *value |= (uint64_t)(buf[i] & 0x7f) << (7 * i);
+
+        if (!(buf[i] & 0x80)) {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+int uart_cir_batch_decode(const uint8_t *payload, size_t payload_len)
+{
+    size_t offset = 1;
+    uint32_t id = 0;
+    int64_t time_delta = 0;
+    int count = payload_len ? payload[0] : 0;
+    int i = 0;
+
+    for (; i < count && i < CRAB_LINK_BATCH_MAX; i++) {
+        uint64_t id_step = 0;
+        uint64_t time_step = 0;
+        size_t len = uart_get_varint(payload + offset, payload_len - offset, &id_step);
+
+        if (!len) {
+            break;
+        }
+
+        offset += len;
+        len = uart_get_varint(payload + offset, payload_len - offset, &time_step);
+
+        if (!len || payload_len - offset - len < 4 * sizeof(float)) {
+            break;
+        }
+
+        offset += len;
+        id += (uint32_t)((id_step >> 1) ^ (0 - (id_step & 1)));
+        time_delta = (int64_t)((uint64_t)time_delta + ((time_step >> 1) ^ (0 - (time_step & 1))));
+
+        csi_data_t csi_data = {
+            .start = {0xAA, 0x55},
+            .id = id,
+            .time_delta = time_delta,
+            .end = {0x55, 0xAA},
+        };
+        memcpy((uint8_t *)&csi_data + offsetof(csi_data_t, cir), payload + offset, sizeof(csi_data.cir));
+        offset += sizeof(csi_data.cir);
+        cir_pair_table_put(&csi_pair_table, CIR_PAIR_SLAVE, &csi_data);
+    }
+
+    if (i != count) {
+        ESP_LOGD(TAG, "malformed batch, %d of %d samples decoded", i, count);
+    }
+
+    return i;
+}
+
+/**
+ * @brief Called by csi_link_decoder_feed() for every frame that passed the CRC check
+ */
+static void uart_link_frame_cb(uint8_t type, const uint8_t *payload, size_t payload_len, void *ctx)
+{
+    if (type == CRAB_LINK_TYPE_CIR_BATCH) {
+        uart_cir_batch_decode(payload, payload_len);
+        return;
+    }
+
+    if (type != CRAB_LINK_TYPE_CIR || payload_len != CRAB_LINK_CIR_LEN) {
+        ESP_LOGD(TAG, "unexpected frame type %d, len %d", type, (int)payload_len);
+        return;
+    }
+
+    csi_data_t csi_data = {
+        .start = {0xAA, 0x55},
+        .end = {0x55, 0xAA},
+    };
+    memcpy((uint8_t *)&csi_data + CRAB_LINK_CIR_OFFSET, payload, payload_len);
+    cir_pair_table_put(&csi_pair_table, CIR_PAIR_SLAVE, &csi_data);
+    ESP_LOGD(TAG, "%ld,%lld,%.2f", csi_data.id, csi_data.time_delta, csi_data.cir[0]);
+}
+
 static void uart_event_task(void *pvParameters)
 {
     uart_event_t event;
     uint8_t* dtmp = (uint8_t*) malloc(2 * BUF_SIZE);
-    csi_data_t* csi_data;
-    uint16_t table_row_last=0;
+    /**
+     * @brief Keeps the unfinished frame between UART_DATA events, so frames split across reads are not lost
+     */
+    static csi_link_decoder_t link_decoder;
+    uint32_t error_count = 0;
+    csi_link_decoder_init(&link_decoder);
     for (;;) {
         if (xQueueReceive(uart0_queue, (void *)&event, (TickType_t)portMAX_DELAY)) {
             switch (event.type) {
-            case UART_DATA:
-                UBaseType_t queue_size = uxQueueMessagesWaiting(uart0_queue);
-                uart_read_bytes(UART_PORT_NUM, dtmp, event.size, portMAX_DELAY);
-                // ESP_LOGI(TAG, "[UART DATA]: %d %u", event.size,queue_size);
-                    for (int i = 0; i <= (int)event.size - 32; i++) {
-                        if (dtmp[i] == 0xAA && dtmp[i + 1] == 0x55 && dtmp[i + 30] == 0x55 && dtmp[i + 31] == 0xAA) {
-                            xQueueSend(uart_recv_queue,(csi_data_t*)&dtmp[i], 0);
-                            csi_data = (csi_data_t *)&dtmp[i];
-                            ESP_LOGD(TAG,"%d,%lld,%.2f",csi_data->start[0],csi_data->time_delta,csi_data->cir[0]);
-                            i = i + 24-1;
-                        }
-                    }         
+            case UART_DATA: {
+                int len = uart_read_bytes(UART_PORT_NUM, dtmp, event.size, portMAX_DELAY);
+                if (len > 0) {
+                    csi_link_decoder_feed(&link_decoder, dtmp, len, uart_link_frame_cb, NULL);
+                }
+                if (link_decoder.error_count != error_count) {
+                    error_count = link_decoder.error_count;
+                    ESP_LOGW(TAG, "%u corrupted frames, %u bytes skipped in total",
+                             (unsigned int)error_count, (unsigned int)link_decoder.skipped_bytes);
+                }
                 break;
+            }
             case UART_FIFO_OVF:
                 ESP_LOGW(TAG, "hw fifo overflow");
                 uart_flush_input(UART_PORT_NUM);
                 xQueueReset(uart0_queue);
+                csi_link_decoder_init(&link_decoder);
+                error_count = 0;
                 break;
             case UART_BUFFER_FULL:
                 ESP_LOGW(TAG, "ring buffer full");
                 uart_flush_input(UART_PORT_NUM);
                 xQueueReset(uart0_queue);
+                csi_link_decoder_init(&link_decoder);
+                error_count = 0;
                 break;
             case UART_BREAK:
                 ESP_LOGD(TAG, "uart rx break");
@@ -85,7 +181,6 @@ void init_uart() {
     ESP_ERROR_CHECK(uart_param_config(UART_PORT_NUM, &uart_config));
     ESP_ERROR_CHECK(uart_set_pin(UART_PORT_NUM, TXD_PIN, RXD_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
         ESP_LOGI("UART", "UART initialized");
-    uart_recv_queue = xQueueCreate(20, sizeof(csi_data_t));
     xTaskCreate(uart_event_task, "uart_event_task", 4096, NULL, 9, NULL); // 核心 1
 
 }
@@ -1,5 +1,6 @@
 
 #pragma once
+#include <stddef.h>
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -12,10 +13,34 @@ typedef struct {
     uint8_t end[2];        
 } __attribute__((packed)) csi_data_t;
 
-#define DATA_TABLE_SIZE                     100
+/**
+ * @brief csi_link record types between the slave and the master board
+ */
+#define CRAB_LINK_TYPE_CIR      1       /**< csi_data_t from `id` up to `end`, the start/end markers are not sent */
+#define CRAB_LINK_CIR_OFFSET    offsetof(csi_data_t, id)
+#define CRAB_LINK_CIR_LEN       (offsetof(csi_data_t, end) - offsetof(csi_data_t, id))
+#define CRAB_LINK_TYPE_CIR_BATCH 2      /**< Up to CRAB_LINK_BATCH_MAX samples, delta encoded */
+
+/**
+ * @brief A CRAB_LINK_TYPE_CIR_BATCH payload is the sample count, then for every sample the zigzag varint
+ *        differences of `id` and `time_delta` from the previous sample (from 0 for the first one) and
+ *        the four `cir` floats. At most 1 + 8 * (5 + 10 + 16) = 249 bytes, so a batch fits one frame.
+ */
+#define CRAB_LINK_BATCH_MAX         8
+#define CRAB_LINK_BATCH_SAMPLE_MAX  (5 + 10 + 4 * sizeof(float))
+
 void init_uart(void);
 int uart_send_data(const char *data, uint8_t len);
 
+/**
+ * @brief Undo the delta encoding of a CRAB_LINK_TYPE_CIR_BATCH payload, passing every sample to the pair table
+ *
+ * Decoding stops at the first sample that is cut short or whose varint runs past 10 bytes.
+ *
+ * @return Number of samples decoded
+ */
+int uart_cir_batch_decode(const uint8_t *payload, size_t payload_len);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
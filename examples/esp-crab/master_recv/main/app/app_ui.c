@@ -7,16 +7,21 @@
 #include "freertos/task.h"
 #include "bsp_C5_dual_antenna.h"
 #include "app_uart.h"
+#include "app_pair.h"
+#include "app_display.h"
 #include <math.h>
+#include <sys/param.h>
 
-#define DISPLAY_SAMPLE_STEP 3 
+#define DISPLAY_SAMPLE_STEP 3       // samples averaged into one chart point
+#define DISPLAY_FRAME_MS    40      // chart redraw period
+#define DISPLAY_PHASE_WINDOW 20     // samples in the circular mean of the phase
+#define DISPLAY_Y_SPAN_MIN  100
 #define LVGL_CHART_POINTS   (100 / DISPLAY_SAMPLE_STEP)
 #define PI 3.14159265
 #define SAMPLE_RATE LVGL_CHART_POINTS
 
-extern QueueHandle_t uart_recv_queue;
 extern  QueueHandle_t csi_display_queue;
-extern csi_data_t master_data[DATA_TABLE_SIZE];
+extern QueueHandle_t csi_pair_queue;
 lv_chart_series_t * ser[6];
 int16_t sine_wave[LVGL_CHART_POINTS*3];
 float angle = 0;
@@ -73,152 +78,121 @@ void app_ui_init(void)
     generate_sine_wave(sine_wave);
 }
 
-float circular_difference(float angle1, float angle2) 
+/**
+ * @brief Draw the points that arrived since the last frame, under a single LVGL lock
+ *
+ * Only the newest LVGL_CHART_POINTS points can be visible, older pending ones are skipped.
+ */
+static void csi_display_frame(uint16_t points[][2], uint32_t point_count, const display_minmax_t *y_minmax, float phase)
 {
-    float diff = fmod(angle2 - angle1 + PI, 2 * PI);
-    if (diff < 0) {
-        diff += 2 * PI;
+    uint16_t y_range[2] = {(uint16_t)display_minmax_min(y_minmax), (uint16_t)display_minmax_max(y_minmax)};
+
+    if (y_range[1] - y_range[0] < DISPLAY_Y_SPAN_MIN) {
+        uint16_t pad = (DISPLAY_Y_SPAN_MIN - (y_range[1] - y_range[0])) / 2;
+        y_range[0] -= MIN(pad, y_range[0]);
+        y_range[1] += pad;
     }
-    return diff - PI;
+
+    uint32_t first = point_count > LVGL_CHART_POINTS ? point_count - LVGL_CHART_POINTS : 0;
+
+    lvgl_port_lock(0);
+
+    for (uint32_t i = first; i < point_count; i++) {
+        lv_chart_set_next_value(ui_ScreenW_Chart, ser[0], points[i % LVGL_CHART_POINTS][0]);
+        lv_chart_set_next_value(ui_ScreenW_Chart, ser[1], points[i % LVGL_CHART_POINTS][1]);
+    }
+
+    lv_chart_set_ext_y_array(ui_ScreenWP_Chart, ser[2], sine_wave + get_sine_wave_index(phase));
+    lv_chart_set_range(ui_ScreenW_Chart, LV_CHART_AXIS_PRIMARY_Y, y_range[0], y_range[1]);
+
+    lvgl_port_unlock();
 }
 
 void csi_data_display_task(void *arg)         
 {
     app_ui_init();
-    static uint16_t y_range[2] ={0};
-    uint8_t count=0;
-    csi_data_t csi_display_data;
-
-    uint8_t sine_offest[2];
-    uint8_t cnt=0;
-    float range[4][LVGL_CHART_POINTS] = {};
     uint8_t csi_mode = *((bool *)arg);
     if (csi_mode){
         ESP_LOGI(TAG,"Self_Transmit_and_Receive_Mode");
     } else {
         ESP_LOGI(TAG,"Single_Transmit_and_Dual_Receive_Mode");
     }
-    if (csi_mode){
-        while (xQueueReceive(csi_display_queue, &csi_display_data, portMAX_DELAY) == pdTRUE) {
-            cnt++;
-            UBaseType_t queueLength = uxQueueMessagesWaiting(csi_display_queue);
-            if (queueLength>10){
-                ESP_LOGI(TAG, "ui queueLength:%d", queueLength);
-            }           
-            range[0][count] = csi_display_data.cir[0]*5;
-            range[1][count] = csi_display_data.cir[1]*5;
-            range[2][count] = csi_display_data.cir[2];
-            range[3][count] = csi_display_data.cir[3];
-
-            y_range[0] = 500;
-            y_range[1] = 0;
-            for (int i=0;i<LVGL_CHART_POINTS;i++){
-                if (y_range[0]>range[0][i]){
-                    y_range[0] = range[0][i];
-                }
-                if (y_range[0]>range[1][i]){
-                    y_range[0] = range[1][i];
-                }
-                if (y_range[1]<range[0][i]){
-                    y_range[1] = range[0][i];
-                }
-                if (y_range[1]<range[1][i]){
-                    y_range[1] = range[1][i];
-                }
-            }
-            if  ( (y_range[1]-y_range[0])<100){
-                y_range[1] += (100-y_range[1]+y_range[0])/2;
-                y_range[0] -= (100-y_range[1]+y_range[0])/2;
+
+    /**
+     * @brief Samples are folded into the models as they arrive; every DISPLAY_SAMPLE_STEP of them
+     *        make one chart point, and the chart is redrawn every DISPLAY_FRAME_MS at most
+     */
+    QueueHandle_t queue = csi_mode ? csi_display_queue : csi_pair_queue;
+    static display_minmax_t y_minmax;
+    static display_circ_mean_t phase_mean;
+    static uint16_t points[LVGL_CHART_POINTS][2];
+    uint32_t point_count = 0;
+    float amplitude_sum[2] = {0};
+    uint8_t step = 0;
+    float phase = 0;
+    const TickType_t frame_ticks = MAX(pdMS_TO_TICKS(DISPLAY_FRAME_MS), 1);
+    TickType_t next_frame = xTaskGetTickCount() + frame_ticks;
+
+    display_minmax_init(&y_minmax, LVGL_CHART_POINTS);
+    display_circ_mean_init(&phase_mean, DISPLAY_PHASE_WINDOW);
+
+    for (;;) {
+        union {
+            csi_data_t data;
+            cir_pair_t pair;
+        } item;
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = (int32_t)(next_frame - now) > 0 ? next_frame - now : 0;
+
+        if (xQueueReceive(queue, &item, wait) == pdTRUE) {
+            float amplitude[2];
+            float phase_sample;
+
+            if (csi_mode) {
+                amplitude[0] = item.data.cir[0] * 5;
+                amplitude[1] = item.data.cir[1] * 5;
+                phase_sample = item.data.cir[2];
+            } else {
+                amplitude[0] = item.pair.slave.cir[0] * 5;
+                amplitude[1] = item.pair.master.cir[1] * 5;
+                phase_sample = item.pair.master.cir[2] - item.pair.slave.cir[2];
             }
-            lvgl_port_lock(0);
-            lv_chart_set_next_value(ui_ScreenW_Chart, ser[0], (uint16_t)(range[0][count]));
-            lv_chart_set_next_value(ui_ScreenW_Chart, ser[1], (uint16_t)(range[1][count]));
-
-            float sum[2]={0};
-            for (int i=count;i>count-20;i--){
-                uint8_t index = (i+LVGL_CHART_POINTS)%LVGL_CHART_POINTS;
-                sum[0] += circular_difference(range[2][count], range[2][index]);
-                sum[1] += circular_difference(range[3][count], range[3][index]);
+
+            phase = display_circ_mean_push(&phase_mean, phase_sample);
+            amplitude_sum[0] += amplitude[0];
+            amplitude_sum[1] += amplitude[1];
+
+            if (++step == DISPLAY_SAMPLE_STEP) {
+                uint16_t *point = points[point_count++ % LVGL_CHART_POINTS];
+                point[0] = (uint16_t)(amplitude_sum[0] / DISPLAY_SAMPLE_STEP);
+                point[1] = (uint16_t)(amplitude_sum[1] / DISPLAY_SAMPLE_STEP);
+                display_minmax_push(&y_minmax, MIN(point[0], point[1]), MAX(point[0], point[1]));
+                amplitude_sum[0] = 0;
+                amplitude_sum[1] = 0;
+                step = 0;
             }
-            sum[0] = fmod(sum[0]/20 + range[2][count] + 2 * PI, 2 * PI) - PI;
-            sum[1] = fmod(sum[1]/20 + range[3][count] + 2 * PI, 2 * PI) - PI;
+        }
 
-            sine_offest[0] = get_sine_wave_index(sum[0]);
-            sine_offest[1] = get_sine_wave_index(sum[1]);
-            lv_chart_set_ext_y_array(ui_ScreenWP_Chart, ser[2], sine_wave+sine_offest[0]);
-            lv_chart_set_range(ui_ScreenW_Chart, LV_CHART_AXIS_PRIMARY_Y, y_range[0], y_range[1]);
+        now = xTaskGetTickCount();
 
-            lvgl_port_unlock();
+        if ((int32_t)(now - next_frame) < 0) {
+            continue;
+        }
 
-            count++;
-            if (count == LVGL_CHART_POINTS) {
-                count = 0;
-            }
+        next_frame += frame_ticks;
+
+        if ((int32_t)(now - next_frame) >= 0) {
+            next_frame = now + frame_ticks;
         }
-    }else {
-        static csi_data_t csi_display_data_new = {0};
-        while (xQueueReceive(uart_recv_queue, &csi_display_data_new, portMAX_DELAY) == pdTRUE) {
-            cnt++;
-            if (csi_display_data.start[0] == 0){
-                goto NEXT;
-            }
-            
-            csi_data_t csi_master_data  = master_data[csi_display_data.id % DATA_TABLE_SIZE];
-            if (csi_master_data.id != csi_display_data.id){
-                ESP_LOGE(TAG, "%ld id_master  %ld csi_display_data.id %ld",csi_display_data.id % DATA_TABLE_SIZE,csi_master_data.id,csi_display_data.id);
-                goto NEXT;
-            }
-            range[0][count] = csi_display_data.cir[0]*5;
-            range[1][count] = csi_master_data.cir[1]*5;
-            range[2][count] = csi_master_data.cir[2] - csi_display_data.cir[2];
-            range[3][count] = csi_display_data.cir[3];
-
-            y_range[0] = 500;
-            y_range[1] = 0;
-            for (int i=0;i<LVGL_CHART_POINTS;i++){
-                if (y_range[0]>range[0][i]){
-                    y_range[0] = range[0][i];
-                }
-                if (y_range[0]>range[1][i]){
-                    y_range[0] = range[1][i];
-                }
-                if (y_range[1]<range[0][i]){
-                    y_range[1] = range[0][i];
-                }
-                if (y_range[1]<range[1][i]){
-                    y_range[1] = range[1][i];
-                }
-            }
-            if  ( (y_range[1]-y_range[0])<100){
-                y_range[1] += (100-y_range[1]+y_range[0])/2;
-                y_range[0] -= (100-y_range[1]+y_range[0])/2;
-            }
-            lvgl_port_lock(0);
-            lv_chart_set_next_value(ui_ScreenW_Chart, ser[0], (uint16_t)(range[0][count]));
-            lv_chart_set_next_value(ui_ScreenW_Chart, ser[1], (uint16_t)(range[1][count]));
-
-            float sum[2]={0};
-            for (int i=count;i>count-20;i--){
-                uint8_t index = (i+LVGL_CHART_POINTS)%LVGL_CHART_POINTS;
-                sum[0] += circular_difference(range[2][count], range[2][index]);
-                sum[1] += circular_difference(range[3][count], range[3][index]);
-            }
-            sum[0] = fmod(sum[0]/20 + range[2][count] + 2 * PI, 2 * PI) - PI;
-            sum[1] = fmod(sum[1]/20 + range[3][count] + 2 * PI, 2 * PI) - PI;
-            
-            sine_offest[0] = get_sine_wave_index(sum[0]);
-            sine_offest[1] = get_sine_wave_index(sum[1]);
-            lv_chart_set_ext_y_array(ui_ScreenWP_Chart, ser[2], sine_wave+sine_offest[0]);
-            lv_chart_set_range(ui_ScreenW_Chart, LV_CHART_AXIS_PRIMARY_Y, y_range[0], y_range[1]);
-
-            lvgl_port_unlock();
-
-            count++;
-            if (count == LVGL_CHART_POINTS) {
-                count = 0;
-            }
-NEXT:
-            csi_display_data = csi_display_data_new;
+
+        UBaseType_t queueLength = uxQueueMessagesWaiting(queue);
+        if (queueLength>10){
+            ESP_LOGI(TAG, "ui queueLength:%d", queueLength);
+        }
+
+        if (point_count) {
+            csi_display_frame(points, point_count, &y_minmax, phase);
+            point_count = 0;
         }
     }
-}
\ No newline at end of file
+}
@@ -15,6 +15,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <sys/param.h>
 #include "nvs_flash.h"
 #include "esp_mac.h"
 #include "rom/ets_sys.h"
@@ -31,6 +32,8 @@
 #include "ui.h"
 #include "app_ui.h"
 #include "esp_csi_gain_ctrl.h"
+#include "csi_ring.h"
+#include "app_pair.h"
 
 #define CONFIG_LESS_INTERFERENCE_CHANNEL    40
 #define CONFIG_WIFI_BAND_MODE               WIFI_BAND_MODE_5G_ONLY
@@ -42,9 +45,11 @@
 #define CONFIG_GAIN_CONTROL                 1   // 1:enable gain control, 0:disable gain control
 #define CONFIG_FORCE_GAIN                   0   // 1:force gain control, 0:automatic gain control
 #define CONFIG_PRINT_CSI_DATA               0
+#define CSI_RING_SLOT_NUM                   32  // slots between wifi_csi_rx_cb and the processing task, power of two
 #define CONFIG_CRAB_MODE                    Self_Transmit_and_Receive_Mode
+#define CONFIG_PAIR_TABLE_DEPTH             128 // ids the master and slave samples of a pair may be apart, power of two
+#define CONFIG_PAIR_STATS_INTERVAL_MS       10000
 
-csi_data_t master_data[DATA_TABLE_SIZE];
 int64_t time_zero = 0;
 typedef struct {
     uint32_t id;
@@ -54,8 +59,12 @@ typedef struct {
     int8_t buf[256];
 } csi_recv_queue_t;
 uint32_t recv_cnt = 0;
-QueueHandle_t csi_recv_queue;
+static csi_ring_t csi_recv_ring;
+static TaskHandle_t csi_recv_task = NULL;
+volatile bool csi_recv_flush = false;
 QueueHandle_t csi_display_queue;
+QueueHandle_t csi_pair_queue;
+cir_pair_table_t csi_pair_table;
 static const uint8_t CONFIG_CSI_SEND_MAC[] = {0x1a, 0x00, 0x00, 0x00, 0x00, 0x00};
 static const char *TAG = "csi_recv";
 
@@ -139,16 +148,26 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
     }
 #endif
 
-    csi_recv_queue_t *csi_send_queuedata = (csi_recv_queue_t *)calloc(1, sizeof(csi_recv_queue_t));
-    memcpy(&(csi_send_queuedata->id), info->payload + 15, sizeof(uint32_t));
+    uint32_t id = 0;
+    memcpy(&id, info->payload + 15, sizeof(uint32_t));
 
-    csi_send_queuedata->time = info->rx_ctrl.timestamp;
-    csi_send_queuedata->agc_gain = agc_gain;
-    csi_send_queuedata->fft_gain = fft_gain;
+    /**
+     * @brief A full ring drops the packet for processing only, it is still printed below
+     */
+    csi_recv_queue_t *csi_send_queuedata = csi_ring_acquire(&csi_recv_ring);
+    if (csi_send_queuedata) {
+        csi_send_queuedata->id = id;
+        csi_send_queuedata->time = info->rx_ctrl.timestamp;
+        csi_send_queuedata->agc_gain = agc_gain;
+        csi_send_queuedata->fft_gain = fft_gain;
 
-    memset(csi_send_queuedata->buf, 0, 256);
-    memcpy(csi_send_queuedata->buf + 8, info->buf, info->len);
-    xQueueSend(csi_recv_queue, &csi_send_queuedata, 0);
+        memset(csi_send_queuedata->buf, 0, sizeof(csi_send_queuedata->buf));
+        memcpy(csi_send_queuedata->buf + 8, info->buf, MIN(info->len, sizeof(csi_send_queuedata->buf) - 8));
+        csi_ring_commit(&csi_recv_ring);
+        if (csi_recv_task) {
+            xTaskNotifyGive(csi_recv_task);
+        }
+    }
 
 #if CONFIG_PRINT_CSI_DATA
     if (!s_count) {
@@ -157,7 +176,7 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
     }
 
     ets_printf("CSI_DATA,%d," MACSTR ",%d,%d,%d,%d,%d,%d,%d,%d,%d",
-               csi_send_queuedata->id, MAC2STR(info->mac), rx_ctrl->rssi, rx_ctrl->rate,
+               id, MAC2STR(info->mac), rx_ctrl->rssi, rx_ctrl->rate,
                rx_ctrl->noise_floor, fft_gain, agc_gain, rx_ctrl->channel,
                rx_ctrl->timestamp, rx_ctrl->sig_len, rx_ctrl->rx_state);
 
@@ -173,10 +192,48 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
     recv_cnt++;
 }
 
+/**
+ * @brief Called by cir_pair_table_put() from process_csi_data_task or the UART task
+ */
+static void csi_pair_cb(const csi_data_t *master, const csi_data_t *slave, void *ctx)
+{
+    cir_pair_t pair = {
+        .master = *master,
+        .slave = *slave,
+    };
+    xQueueSend(csi_pair_queue, &pair, 0);
+}
+
+static void csi_pair_init()
+{
+    void *csi_pair_storage = malloc(CIR_PAIR_TABLE_STORAGE_SIZE(CONFIG_PAIR_TABLE_DEPTH));
+    ESP_ERROR_CHECK(csi_pair_storage ? ESP_OK : ESP_ERR_NO_MEM);
+    ESP_ERROR_CHECK(cir_pair_table_init(&csi_pair_table, csi_pair_storage, CONFIG_PAIR_TABLE_DEPTH, csi_pair_cb, NULL) ? ESP_OK : ESP_ERR_INVALID_ARG);
+    csi_pair_queue = xQueueCreate(20, sizeof(cir_pair_t));
+}
+
+static void csi_pair_stats_print()
+{
+    const cir_pair_stats_t *stats = &csi_pair_table.stats;
+    uint32_t master = atomic_load_explicit(&stats->puts[CIR_PAIR_MASTER], memory_order_relaxed);
+    uint32_t slave = atomic_load_explicit(&stats->puts[CIR_PAIR_SLAVE], memory_order_relaxed);
+    uint32_t pairs = atomic_load_explicit(&stats->pairs, memory_order_relaxed);
+
+    ESP_LOGI(TAG, "pairs %u of %u master and %u slave samples (%u%%), late %u, duplicate %u, restart %u, torn %u",
+             (unsigned int)pairs, (unsigned int)master, (unsigned int)slave,
+             (unsigned int)(master ? (uint64_t)pairs * 100 / master : 0),
+             (unsigned int)atomic_load_explicit(&stats->late, memory_order_relaxed),
+             (unsigned int)atomic_load_explicit(&stats->duplicate, memory_order_relaxed),
+             (unsigned int)atomic_load_explicit(&stats->restart, memory_order_relaxed),
+             (unsigned int)atomic_load_explicit(&stats->torn, memory_order_relaxed));
+}
+
 static void wifi_csi_init()
 {
     ESP_ERROR_CHECK(esp_wifi_set_promiscuous(true));
-    csi_recv_queue = xQueueCreate(20, sizeof(csi_recv_queue_t *));
+    void *csi_recv_storage = malloc(CSI_RING_STORAGE_SIZE(sizeof(csi_recv_queue_t), CSI_RING_SLOT_NUM));
+    ESP_ERROR_CHECK(csi_recv_storage ? ESP_OK : ESP_ERR_NO_MEM);
+    csi_ring_init(&csi_recv_ring, csi_recv_storage, sizeof(csi_recv_queue_t), CSI_RING_SLOT_NUM);
     csi_display_queue = xQueueCreate(20, sizeof(csi_data_t));
     wifi_csi_config_t csi_config = {
         .enable                   = true,
@@ -203,47 +260,66 @@ static void wifi_csi_init()
 static void process_csi_data_task(void *pvParameter)
 {
     static int s_count = 0;
+    static cir_iq_batch_t cir_batch;
     csi_recv_queue_t *csi_recv_queue_data = NULL;
-    Complex_Iq x_iq[64];
-    float cir[2] = {};
-    float pha[2] = {};
-    while (xQueueReceive(csi_recv_queue, &csi_recv_queue_data, portMAX_DELAY) == pdTRUE) {
-        UBaseType_t queueLength = uxQueueMessagesWaiting(csi_recv_queue);
-        if (queueLength > 10) {
-            ESP_LOGW(TAG, "csi queueLength:%d", queueLength);
+    struct {
+        uint32_t id;
+        uint32_t time;
+        float scaling_factor;
+    } frame_info[CIR_IQ_BATCH_MAX];
+    float cir[CIR_IQ_BATCH_MAX][CIR_IQ_HALVES];
+    float pha[CIR_IQ_BATCH_MAX][CIR_IQ_HALVES];
+    uint32_t overflow_count = 0;
+    csi_recv_task = xTaskGetCurrentTaskHandle();
+    while (1) {
+        if (csi_recv_flush) {
+            csi_recv_flush = false;
+            csi_ring_flush(&csi_recv_ring);
+            cir_pair_table_flush(&csi_pair_table);
+        }
+        uint32_t ring_count = csi_ring_count(&csi_recv_ring);
+        if (!ring_count) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        if (ring_count > CSI_RING_SLOT_NUM / 2) {
+            ESP_LOGW(TAG, "csi ring count:%u", (unsigned int)ring_count);
         }
+        if (csi_ring_overflow_count(&csi_recv_ring) != overflow_count) {
+            overflow_count = csi_ring_overflow_count(&csi_recv_ring);
+            ESP_LOGW(TAG, "csi ring full, dropped %u packets in total", (unsigned int)overflow_count);
+        }
+
+        /**
+         * @brief Drain up to CIR_IQ_BATCH_MAX frames at once, slots are released as soon as
+         *        their samples are de-interleaved into the batch
+         */
+        cir_iq_batch_reset(&cir_batch);
+        while (cir_batch.count < CIR_IQ_BATCH_MAX && (csi_recv_queue_data = csi_ring_peek(&csi_recv_ring)) != NULL) {
+            int f = cir_iq_batch_add(&cir_batch, csi_recv_queue_data->buf);
+            frame_info[f].id = csi_recv_queue_data->id;
+            frame_info[f].time = csi_recv_queue_data->time;
 #if !CONFIG_FORCE_GAIN && CONFIG_GAIN_CONTROL
-        float scaling_factor = 0;
-        esp_csi_gain_ctrl_get_gain_compensation(&scaling_factor, csi_recv_queue_data->agc_gain, csi_recv_queue_data->fft_gain);
+            esp_csi_gain_ctrl_get_gain_compensation(&frame_info[f].scaling_factor, csi_recv_queue_data->agc_gain, csi_recv_queue_data->fft_gain);
 #else
-        float scaling_factor = 1.0f;
+            frame_info[f].scaling_factor = 1.0f;
 #endif
-
-        for (int i = 0; i < 64; i++) {
-            x_iq[i].real = _IQ16(csi_recv_queue_data->buf[2 * i]);
-            x_iq[i].imag = _IQ16(csi_recv_queue_data->buf[2 * i + 1]);
+            csi_ring_release(&csi_recv_ring);
         }
-        fft_iq(x_iq, 1);
-        cir[0] = complex_magnitude_iq(x_iq[0]) * scaling_factor;
-        pha[0] = complex_phase_iq(x_iq[0]);
-        for (int i = 64; i < 128; i++) {
-            x_iq[i - 64].real = _IQ16(csi_recv_queue_data->buf[2 * i]);
-            x_iq[i - 64].imag = _IQ16(csi_recv_queue_data->buf[2 * i + 1]);
+
+        cir_iq_batch_eval(&cir_batch, 0, cir, pha);
+
+        for (int f = 0; f < cir_batch.count; f++) {
+            csi_data_t data = {
+                .start = {0xAA, 0x55},
+                .id = frame_info[f].id,
+                .time_delta = frame_info[f].time - time_zero,
+                .cir = {cir[f][0] * frame_info[f].scaling_factor, cir[f][1] * frame_info[f].scaling_factor, pha[f][0], pha[f][1]},
+                .end = {0x55, 0xAA},
+            };
+            cir_pair_table_put(&csi_pair_table, CIR_PAIR_MASTER, &data);
+            xQueueSend(csi_display_queue, &data, 0);
         }
-        fft_iq(x_iq, 1);
-        cir[1] = complex_magnitude_iq(x_iq[0]) * scaling_factor;
-        pha[1] = complex_phase_iq(x_iq[0]);
-
-        csi_data_t data = {
-            .start = {0xAA, 0x55},
-            .id = csi_recv_queue_data->id,
-            .time_delta = csi_recv_queue_data->time - time_zero,
-            .cir = {cir[0], cir[1], pha[0], pha[1]},
-            .end = {0x55, 0xAA},
-        };
-        master_data[csi_recv_queue_data->id % DATA_TABLE_SIZE] = data;
-        xQueueSend(csi_display_queue, &data, 0);
-        free(csi_recv_queue_data);
     }
 }
 
@@ -285,6 +361,7 @@ void app_main()
 #endif
     init_gpio();
 
+    csi_pair_init();
     wifi_csi_init();
     vTaskDelay(100 / portTICK_PERIOD_MS);
     init_uart();
@@ -292,9 +369,14 @@ void app_main()
 
     xTaskCreate(process_csi_data_task, "process_csi_data_task", 4096, NULL, 6, NULL);
     bool arg = CONFIG_CRAB_MODE;
-    xTaskCreate(csi_data_display_task, "csi_data_display_task", 4096, &arg, 6, NULL);
+    xTaskCreate(csi_data_display_task, "csi_data_display_task", 4096, &arg, 5, NULL); // below process_csi_data_task
     uint32_t recv_cnt_prv = 0;
+    int64_t pair_stats_time = esp_timer_get_time();
     while (1) {
+        if (CONFIG_CRAB_MODE != Self_Transmit_and_Receive_Mode && esp_timer_get_time() - pair_stats_time >= CONFIG_PAIR_STATS_INTERVAL_MS * 1000LL) {
+            pair_stats_time = esp_timer_get_time();
+            csi_pair_stats_print();
+        }
         static bool level = 1;
         static uint8_t time = 100;
         if ((recv_cnt -  recv_cnt_prv) >= 20) {
@@ -11,10 +11,10 @@
 #define GPIO_INPUT_PIN_SEL  (1ULL << GPIO_INPUT_IO) // GPIO 位掩码
 extern int64_t time_zero;
 static const char *TAG = "GPIO";
-extern QueueHandle_t csi_send_queue;
+extern volatile bool csi_send_flush;
 // 中断服务回调函数
 static void IRAM_ATTR gpio_isr_handler(void *arg) {
-    xQueueReset(csi_send_queue);
+    csi_send_flush = true;
     time_zero = esp_timer_get_time(); 
     uint32_t gpio_num = (uint32_t)arg; // 获取中断的 GPIO 引脚编号
     // ets_printf("GPIO %ld triggered! time: %lld", gpio_num,time_since_boot);
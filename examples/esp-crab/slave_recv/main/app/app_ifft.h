@@ -3,8 +3,13 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+#include "esp_err.h"
+#include "esp_attr.h"
 #include "IQmathLib.h"
 
+#define FFT_IQ_MAX_LOG2N    8
+#define FFT_IQ_MAX_N        (1 << FFT_IQ_MAX_LOG2N)
+
 typedef struct {
     float real;
     float imag;
@@ -13,8 +18,139 @@ typedef struct {
     _iq16 real;
     _iq16 imag;
 } Complex_Iq;
+
+/**
+ * @brief Fixed-point FFT plan. Twiddle and bit-reverse tables are shared constants,
+ *        so a plan holds no memory and execution never allocates.
+ */
+typedef struct {
+    int n;          /**< FFT size: 64, 128 or 256 */
+    int log2n;
+} fft_iq_plan_t;
+
+/**
+ * @brief Prepare a plan for an N-point fixed-point FFT
+ *
+ * @return ESP_ERR_NOT_SUPPORTED for N other than 64, 128 or 256
+ */
+esp_err_t fft_iq_plan_init(fft_iq_plan_t *plan, int n);
+
+/**
+ * @brief In-place Q16 FFT (inverse scaled by 1/N)
+ *
+ * Nothing is scaled between stages, so the sum of the input magnitudes must stay below
+ * 32768 / sqrt(2) to avoid Q16 overflow; int8 I/Q samples are safe up to N = 128.
+ */
+void IRAM_ATTR fft_iq_plan_execute(const fft_iq_plan_t *plan, Complex_Iq *X, int inverse);
+
+/**
+ * @brief Evaluate only the requested output bins (CIR taps for the inverse) of an N-point FFT
+ *
+ * Tap 0 is a plain sum, other taps are computed as a direct partial DFT. When enough taps are
+ * requested that a full transform is cheaper, it runs fft_iq_plan_execute() in scratch instead.
+ *
+ * @param plan      Plan from fft_iq_plan_init()
+ * @param X         N input samples, not modified
+ * @param inverse   1 for the inverse transform (scaled by 1/N), 0 for the forward
+ * @param taps      Output indices, taken modulo N
+ * @param tap_count Number of entries in taps and out
+ * @param out       Value of each requested bin
+ * @param scratch   N entries for the full-transform path, or NULL to always evaluate taps directly
+ */
+void IRAM_ATTR fft_iq_plan_taps(const fft_iq_plan_t *plan, const Complex_Iq *X, int inverse,
+                                const uint16_t *taps, int tap_count, Complex_Iq *out, Complex_Iq *scratch);
+
+#define CIR_IQ_BATCH_MAX        8
+#define CIR_IQ_HALVES           2   /**< Two 64-subcarrier halves per CSI buffer */
+#define CIR_IQ_SUBCARRIERS      64
+
+/**
+ * @brief Frames de-interleaved into structure-of-arrays form: for each half and subcarrier,
+ *        the samples of every frame are contiguous, so one twiddle serves the whole batch.
+ */
+typedef struct {
+    int count;
+    int8_t real[CIR_IQ_HALVES][CIR_IQ_SUBCARRIERS][CIR_IQ_BATCH_MAX];
+    int8_t imag[CIR_IQ_HALVES][CIR_IQ_SUBCARRIERS][CIR_IQ_BATCH_MAX];
+} cir_iq_batch_t;
+
+void cir_iq_batch_reset(cir_iq_batch_t *batch);
+
+/**
+ * @brief Add one frame of 2 * 64 interleaved int8 I/Q pairs (256 bytes)
+ *
+ * @return Index of the frame in the batch, or -1 if the batch is full
+ */
+int cir_iq_batch_add(cir_iq_batch_t *batch, const int8_t *buf);
+
+/**
+ * @brief Magnitude and phase of one CIR tap (64-point inverse FFT bin) of both halves of every frame
+ *
+ * @param magnitude magnitude[frame][half]
+ * @param phase     phase[frame][half], radians
+ */
+void IRAM_ATTR cir_iq_batch_eval(const cir_iq_batch_t *batch, uint16_t tap,
+                                 float magnitude[][CIR_IQ_HALVES], float phase[][CIR_IQ_HALVES]);
+
+/**
+ * @brief 64-point fft_iq_plan_execute()
+ */
 void IRAM_ATTR fft_iq(Complex_Iq *X,  int inverse) ;
-void IRAM_ATTR fft(Complex *X, int N, int inverse);
+
+#define FFT_PLAN_MAX_N          4096
+#ifndef FFT_PLAN_CACHE_SIZE
+#define FFT_PLAN_CACHE_SIZE     4   /**< Number of distinct sizes that can be planned */
+#endif
+
+/**
+ * @brief Cached float FFT plan: twiddles W_N^k for k < N and the bit-reversal permutation
+ */
+typedef struct {
+    int n;
+    int log2n;
+    Complex *twiddle;
+    uint16_t *bitrev;
+} fft_plan_t;
+
+/**
+ * @brief Get the plan for an N-point float FFT, building and caching it on first use
+ *
+ * fft() and fft_real() do not need a cache entry: once the cache is full they build a
+ * temporary plan per call.
+ *
+ * @return NULL if N is not a power of two in [2, FFT_PLAN_MAX_N], the cache is full, another task
+ *         is still building the plan for N, or out of memory
+ */
+const fft_plan_t *fft_plan_get(int n);
+
+/**
+ * @brief In-place radix-4 float FFT with a radix-2 stage for odd log2(N); the inverse is scaled by 1/N
+ */
+void IRAM_ATTR fft_plan_execute(const fft_plan_t *plan, Complex *X, int inverse);
+
+/**
+ * @brief Forward FFT of N real samples through an N/2-point complex FFT
+ *
+ * @param x N real samples, N a power of two in [4, FFT_PLAN_MAX_N]
+ * @param X Output, N/2 + 1 bins (0..N/2); the rest follow from X[N-k] = conj(X[k]).
+ *          Must hold N/2 + 1 entries and may not alias x.
+ *
+ * @return
+ *    - ESP_OK
+ *    - ESP_ERR_INVALID_ARG: N is not a power of two in [4, FFT_PLAN_MAX_N]
+ *    - ESP_ERR_NO_MEM: No cached plan and none could be built, X is not written
+ */
+esp_err_t fft_real(const float *x, Complex *X, int N);
+
+/**
+ * @brief In-place N-point float FFT (inverse scaled by 1/N) with the cached plan for N
+ *
+ * @return
+ *    - ESP_OK
+ *    - ESP_ERR_INVALID_ARG: N is not a power of two in [2, FFT_PLAN_MAX_N]
+ *    - ESP_ERR_NO_MEM: No cached plan and none could be built, X is left unchanged
+ */
+esp_err_t IRAM_ATTR fft(Complex *X, int N, int inverse);
 
 float complex_magnitude_iq(Complex_Iq z);
 float complex_phase_iq(Complex_Iq z);
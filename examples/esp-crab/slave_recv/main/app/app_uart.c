@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/uart.h"
@@ -6,9 +7,13 @@
 #include "sdkconfig.h"
 #include "esp_log.h"
 #include "app_uart.h"
+#include "csi_link.h"
 
 static const char *TAG = "UART";
 
+_Static_assert(sizeof(((uart_cir_batch_t *)0)->buf) <= CSI_LINK_MAX_PAYLOAD_LEN,
+               "a full CIR batch must fit one csi_link frame");
+
 void init_uart() {
     uart_config_t uart_config = {
         .baud_rate = UART_BAUD_RATE,
@@ -33,6 +38,75 @@ int uart_send_data(const char *data, uint8_t len) {
     return uart_write_bytes(UART_PORT_NUM, data, len);
 }
 
+int uart_send_cir(const csi_data_t *data)
+{
+    uint8_t frame[CSI_LINK_FRAME_SIZE(CRAB_LINK_CIR_LEN)];
+    size_t len = csi_link_encode(CRAB_LINK_TYPE_CIR, (const uint8_t *)data + CRAB_LINK_CIR_OFFSET,
+                                 CRAB_LINK_CIR_LEN, frame, sizeof(frame));
+
+    return uart_write_bytes(UART_PORT_NUM, frame, len);
+}
+
+static size_t uart_put_varint(uint8_t *buf, uint64_t value)
+{
+    size_t len = 0;
+
+    while (value >= 0x80) {
+        buf[len++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+
+    buf[len++] = (uint8_t)value;
+
+    return len;
+}
+
+void uart_cir_batch_reset(uart_cir_batch_t *batch)
+{
+    batch->buf[0]          = 0;
+    batch->len             = 1;
+    batch->count           = 0;
+    batch->last_id         = 0;
+    batch->last_time_delta = 0;
+}
+
+int uart_cir_batch_add(uart_cir_batch_t *batch, const csi_data_t *data)
+{
+    /**
+     * @brief Consecutive samples differ by a small id step and a few milliseconds, zigzag keeps
+     *        the rare backward step (sender reboot, id wrap) small too. Both differences wrap
+     *        around like the ids, so any two values are one step apart.
+     */
+    int32_t id_step   = (int32_t)(data->id - batch->last_id);
+    int64_t time_step = (int64_t)((uint64_t)data->time_delta - (uint64_t)batch->last_time_delta);
+
+    batch->len += uart_put_varint(batch->buf + batch->len, ((uint32_t)id_step << 1) ^ (uint32_t)(id_step >> 31));
+    batch->len += uart_put_varint(batch->buf + batch->len, ((uint64_t)time_step << 1) ^ (uint64_t)(time_step >> 63));
+    memcpy(batch->buf + batch->len, (const uint8_t *)data + offsetof(csi_data_t, cir), sizeof(data->cir));
+    batch->len += sizeof(data->cir);
+
+    batch->last_id         = data->id;
+    batch->last_time_delta = data->time_delta;
+    batch->buf[0]          = ++batch->count;
+
+    return batch->count;
+}
+
+int uart_send_cir_batch(uart_cir_batch_t *batch)
+{
+    int ret = 0;
+
+    if (batch->count) {
+        uint8_t frame[CSI_LINK_MAX_FRAME_SIZE];
+        size_t len = csi_link_encode(CRAB_LINK_TYPE_CIR_BATCH, batch->buf, batch->len, frame, sizeof(frame));
+        ret = uart_write_bytes(UART_PORT_NUM, frame, len);
+    }
+
+    uart_cir_batch_reset(batch);
+
+    return ret;
+}
+
 // void uart_receive_data() {
 //     uint8_t data[BUF_SIZE];
 //     int length = uart_read_bytes(UART_PORT_NUM, data, BUF_SIZE, 20 / portTICK_RATE_MS);
@@ -1,5 +1,6 @@
 
 #pragma once
+#include <stddef.h>
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -18,9 +19,55 @@ typedef struct {
     uint8_t end[2];        
 } __attribute__((packed)) csi_data_t;
 
+/**
+ * @brief csi_link record types between the slave and the master board
+ */
+#define CRAB_LINK_TYPE_CIR      1       /**< csi_data_t from `id` up to `end`, the start/end markers are not sent */
+#define CRAB_LINK_CIR_OFFSET    offsetof(csi_data_t, id)
+#define CRAB_LINK_CIR_LEN       (offsetof(csi_data_t, end) - offsetof(csi_data_t, id))
+#define CRAB_LINK_TYPE_CIR_BATCH 2      /**< Up to CRAB_LINK_BATCH_MAX samples, delta encoded */
+
+/**
+ * @brief A CRAB_LINK_TYPE_CIR_BATCH payload is the sample count, then for every sample the zigzag varint
+ *        differences of `id` and `time_delta` from the previous sample (from 0 for the first one) and
+ *        the four `cir` floats. At most 1 + 8 * (5 + 10 + 16) = 249 bytes, so a batch fits one frame.
+ */
+#define CRAB_LINK_BATCH_MAX         8
+#define CRAB_LINK_BATCH_SAMPLE_MAX  (5 + 10 + 4 * sizeof(float))
+
 void init_uart(void);
 int uart_send_data(const char *data, uint8_t len);
 
+/**
+ * @brief Send the CIR sample of a frame to the master board as one CRAB_LINK_TYPE_CIR csi_link frame
+ */
+int uart_send_cir(const csi_data_t *data);
+
+/**
+ * @brief Samples collected for one CRAB_LINK_TYPE_CIR_BATCH frame
+ */
+typedef struct {
+    uint8_t  buf[1 + CRAB_LINK_BATCH_MAX * CRAB_LINK_BATCH_SAMPLE_MAX];
+    size_t   len;
+    uint8_t  count;
+    uint32_t last_id;
+    int64_t  last_time_delta;
+} uart_cir_batch_t;
+
+void uart_cir_batch_reset(uart_cir_batch_t *batch);
+
+/**
+ * @brief Append a sample, the batch must hold fewer than CRAB_LINK_BATCH_MAX
+ *
+ * @return Number of samples in the batch
+ */
+int uart_cir_batch_add(uart_cir_batch_t *batch, const csi_data_t *data);
+
+/**
+ * @brief Send the batch to the master board as one csi_link frame, if it is not empty, and reset it
+ */
+int uart_send_cir_batch(uart_cir_batch_t *batch);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <sys/param.h>
 #include "nvs_flash.h"
 #include "esp_mac.h"
 #include "rom/ets_sys.h"
@@ -29,6 +30,7 @@
 #include "IQmathLib.h"
 #include "bsp_C5_dual_antenna.h"
 #include "esp_csi_gain_ctrl.h"
+#include "csi_ring.h"
 
 #define CONFIG_LESS_INTERFERENCE_CHANNEL    40
 #define CONFIG_WIFI_BAND_MODE               WIFI_BAND_MODE_5G_ONLY
@@ -40,6 +42,12 @@
 #define CONFIG_GAIN_CONTROL                 1   // 1:enable gain control, 0:disable gain control
 #define CONFIG_FORCE_GAIN                   0   // 1:force gain control, 0:automatic gain control
 #define CONFIG_PRINT_CSI_DATA               1
+#define CSI_RING_SLOT_NUM                   32  // slots between wifi_csi_rx_cb and the processing task, power of two
+#define CONFIG_UART_BATCH_ENABLE            1   // 1: pack up to CONFIG_UART_BATCH_MAX samples per UART frame, 0: one frame per sample
+#define CONFIG_UART_BATCH_MAX               CRAB_LINK_BATCH_MAX
+#define CONFIG_UART_BATCH_DEADLINE_MS       20  // send a partial batch once its oldest sample is this old
+
+_Static_assert(CONFIG_UART_BATCH_MAX <= CRAB_LINK_BATCH_MAX, "a batch frame holds at most CRAB_LINK_BATCH_MAX samples");
 
 int64_t time_zero = 0;
 typedef struct {
@@ -50,7 +58,9 @@ typedef struct {
     int8_t buf[256];
 } csi_send_queue_t;
 uint32_t recv_cnt = 0;
-QueueHandle_t csi_send_queue;
+static csi_ring_t csi_send_ring;
+static TaskHandle_t csi_send_task = NULL;
+volatile bool csi_send_flush = false;
 static const uint8_t CONFIG_CSI_SEND_MAC[] = {0x1a, 0x00, 0x00, 0x00, 0x00, 0x00};
 static const char *TAG = "csi_recv";
 
@@ -135,16 +145,26 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
     }
 #endif
 
-    csi_send_queue_t *csi_send_queuedata = (csi_send_queue_t *)calloc(1, sizeof(csi_send_queue_t));
-    memcpy(&(csi_send_queuedata->id), info->payload + 15, sizeof(uint32_t));
-
-    csi_send_queuedata->time = info->rx_ctrl.timestamp;
-    csi_send_queuedata->agc_gain = agc_gain;
-    csi_send_queuedata->fft_gain = fft_gain;
+    uint32_t id = 0;
+    memcpy(&id, info->payload + 15, sizeof(uint32_t));
 
-    memset(csi_send_queuedata->buf, 0, 256);
-    memcpy(csi_send_queuedata->buf + 8, info->buf, info->len);
-    xQueueSend(csi_send_queue, &csi_send_queuedata, 0);
+    /**
+     * @brief A full ring drops the packet for processing only, it is still printed below
+     */
+    csi_send_queue_t *csi_send_queuedata = csi_ring_acquire(&csi_send_ring);
+    if (csi_send_queuedata) {
+        csi_send_queuedata->id = id;
+        csi_send_queuedata->time = info->rx_ctrl.timestamp;
+        csi_send_queuedata->agc_gain = agc_gain;
+        csi_send_queuedata->fft_gain = fft_gain;
+
+        memset(csi_send_queuedata->buf, 0, sizeof(csi_send_queuedata->buf));
+        memcpy(csi_send_queuedata->buf + 8, info->buf, MIN(info->len, sizeof(csi_send_queuedata->buf) - 8));
+        csi_ring_commit(&csi_send_ring);
+        if (csi_send_task) {
+            xTaskNotifyGive(csi_send_task);
+        }
+    }
 
 #if CONFIG_PRINT_CSI_DATA
     if (!s_count) {
@@ -153,7 +173,7 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
     }
 
     ets_printf("CSI_DATA,%d," MACSTR ",%d,%d,%d,%d,%d,%d,%d,%d,%d",
-               csi_send_queuedata->id, MAC2STR(info->mac), rx_ctrl->rssi, rx_ctrl->rate,
+               id, MAC2STR(info->mac), rx_ctrl->rssi, rx_ctrl->rate,
                rx_ctrl->noise_floor, fft_gain, agc_gain, rx_ctrl->channel,
                rx_ctrl->timestamp, rx_ctrl->sig_len, rx_ctrl->rx_state);
 
@@ -172,7 +192,9 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
 static void wifi_csi_init()
 {
     ESP_ERROR_CHECK(esp_wifi_set_promiscuous(true));
-    csi_send_queue = xQueueCreate(20, sizeof(csi_send_queue_t *));
+    void *csi_send_storage = malloc(CSI_RING_STORAGE_SIZE(sizeof(csi_send_queue_t), CSI_RING_SLOT_NUM));
+    ESP_ERROR_CHECK(csi_send_storage ? ESP_OK : ESP_ERR_NO_MEM);
+    csi_ring_init(&csi_send_ring, csi_send_storage, sizeof(csi_send_queue_t), CSI_RING_SLOT_NUM);
     wifi_csi_config_t csi_config = {
         .enable                   = true,
         .acquire_csi_legacy       = false,
@@ -199,46 +221,97 @@ static void wifi_csi_init()
 static void uart_send_task(void *pvParameter)
 {
     static int s_count = 0;
+    static cir_iq_batch_t cir_batch;
     csi_send_queue_t *csi_send_queue_data = NULL;
-    Complex_Iq x_iq[64];
-    float cir[2] = {};
-    float pha[2] = {};
-    while (xQueueReceive(csi_send_queue, &csi_send_queue_data, portMAX_DELAY) == pdTRUE) {
-        UBaseType_t queueLength = uxQueueMessagesWaiting(csi_send_queue);
-        if (queueLength > 10) {
-            ESP_LOGW(TAG, "csi queueLength:%d", queueLength);
+    struct {
+        uint32_t id;
+        uint32_t time;
+        float scaling_factor;
+    } frame_info[CIR_IQ_BATCH_MAX];
+    float cir[CIR_IQ_BATCH_MAX][CIR_IQ_HALVES];
+    float pha[CIR_IQ_BATCH_MAX][CIR_IQ_HALVES];
+    uint32_t overflow_count = 0;
+#if CONFIG_UART_BATCH_ENABLE
+    static uart_cir_batch_t uart_batch;
+    const TickType_t batch_deadline = MAX(pdMS_TO_TICKS(CONFIG_UART_BATCH_DEADLINE_MS), 1);
+    TickType_t batch_start = 0;
+    uart_cir_batch_reset(&uart_batch);
+#endif
+    csi_send_task = xTaskGetCurrentTaskHandle();
+    while (1) {
+        if (csi_send_flush) {
+            csi_send_flush = false;
+            csi_ring_flush(&csi_send_ring);
+        }
+        uint32_t ring_count = csi_ring_count(&csi_send_ring);
+        if (!ring_count) {
+#if CONFIG_UART_BATCH_ENABLE
+            /**
+             * @brief Wait for more samples no longer than the deadline of the pending batch
+             */
+            if (uart_batch.count) {
+                TickType_t elapsed = xTaskGetTickCount() - batch_start;
+                if (elapsed >= batch_deadline) {
+                    uart_send_cir_batch(&uart_batch);
+                } else {
+                    ulTaskNotifyTake(pdTRUE, batch_deadline - elapsed);
+                }
+                continue;
+            }
+#endif
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        if (ring_count > CSI_RING_SLOT_NUM / 2) {
+            ESP_LOGW(TAG, "csi ring count:%u", (unsigned int)ring_count);
+        }
+        if (csi_ring_overflow_count(&csi_send_ring) != overflow_count) {
+            overflow_count = csi_ring_overflow_count(&csi_send_ring);
+            ESP_LOGW(TAG, "csi ring full, dropped %u packets in total", (unsigned int)overflow_count);
         }
+
+        /**
+         * @brief Drain up to CIR_IQ_BATCH_MAX frames at once, slots are released as soon as
+         *        their samples are de-interleaved into the batch
+         */
+        cir_iq_batch_reset(&cir_batch);
+        while (cir_batch.count < CIR_IQ_BATCH_MAX && (csi_send_queue_data = csi_ring_peek(&csi_send_ring)) != NULL) {
+            int f = cir_iq_batch_add(&cir_batch, csi_send_queue_data->buf);
+            frame_info[f].id = csi_send_queue_data->id;
+            frame_info[f].time = csi_send_queue_data->time;
 #if !CONFIG_FORCE_GAIN && CONFIG_GAIN_CONTROL
-        float scaling_factor = 0;
-        esp_csi_gain_ctrl_get_gain_compensation(&scaling_factor, csi_send_queue_data->agc_gain, csi_send_queue_data->fft_gain);
+            esp_csi_gain_ctrl_get_gain_compensation(&frame_info[f].scaling_factor, csi_send_queue_data->agc_gain, csi_send_queue_data->fft_gain);
 #else
-        float scaling_factor = 1.0f;
+            frame_info[f].scaling_factor = 1.0f;
 #endif
+            csi_ring_release(&csi_send_ring);
+        }
 
-        for (int i = 0; i < 64; i++) {
-            x_iq[i].real = _IQ16(csi_send_queue_data->buf[2 * i]);
-            x_iq[i].imag = _IQ16(csi_send_queue_data->buf[2 * i + 1]);
+        cir_iq_batch_eval(&cir_batch, 0, cir, pha);
+
+        for (int f = 0; f < cir_batch.count; f++) {
+            csi_data_t data = {
+                .id = frame_info[f].id,
+                .time_delta = frame_info[f].time - time_zero,
+                .cir = {cir[f][0] * frame_info[f].scaling_factor, cir[f][1] * frame_info[f].scaling_factor, pha[f][0], pha[f][1]},
+            };
+#if CONFIG_UART_BATCH_ENABLE
+            if (!uart_batch.count) {
+                batch_start = xTaskGetTickCount();
+            }
+            if (uart_cir_batch_add(&uart_batch, &data) >= CONFIG_UART_BATCH_MAX) {
+                uart_send_cir_batch(&uart_batch);
+            }
+#else
+            uart_send_cir(&data);
+#endif
         }
-        fft_iq(x_iq, 1);
-        cir[0] = complex_magnitude_iq(x_iq[0]) * scaling_factor;
-        pha[0] = complex_phase_iq(x_iq[0]);
-        for (int i = 64; i < 128; i++) {
-            x_iq[i - 64].real = _IQ16(csi_send_queue_data->buf[2 * i]);
-            x_iq[i - 64].imag = _IQ16(csi_send_queue_data->buf[2 * i + 1]);
+
+#if CONFIG_UART_BATCH_ENABLE
+        if (uart_batch.count && xTaskGetTickCount() - batch_start >= batch_deadline) {
+            uart_send_cir_batch(&uart_batch);
         }
-        fft_iq(x_iq, 1);
-        cir[1] = complex_magnitude_iq(x_iq[0]) * scaling_factor;
-        pha[1] = complex_phase_iq(x_iq[0]);
-
-        csi_data_t data = {
-            .start = {0xAA, 0x55},
-            .id = csi_send_queue_data->id,
-            .time_delta = csi_send_queue_data->time - time_zero,
-            .cir = {cir[0], cir[1], pha[0], pha[1]},
-            .end = {0x55, 0xAA},
-        };
-        uart_send_data((const char *)&data, sizeof(data));
-        free(csi_send_queue_data);
+#endif
     }
 }
 
@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Generated CSI_DATA replay lines shared by the parser and receive path tests
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "test_util.h"
+
+#define PAYLOAD_MAX_LEN     1024
+
+static const char s_test_base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static inline size_t test_base64_encode(const uint8_t *in, size_t len, char *out)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = in[i] << 16 | (i + 1 < len ? in[i + 1] << 8 : 0) | (i + 2 < len ? in[i + 2] : 0);
+        out[n++] = s_test_base64_alphabet[v >> 18 & 63];
+        out[n++] = s_test_base64_alphabet[v >> 12 & 63];
+        out[n++] = i + 1 < len ? s_test_base64_alphabet[v >> 6 & 63] : '=';
+        out[n++] = i + 2 < len ? s_test_base64_alphabet[v & 63] : '=';
+    }
+
+    return n;
+}
+
+/**
+ * @brief One CSI_DATA line as esp_csi_tool.py records it, 30 columns with agc_gain/fft_gain or the older 28
+ */
+static inline size_t test_csi_line_generate(char *line, uint32_t *seed, bool gain_columns, size_t payload_len)
+{
+    uint8_t payload[PAYLOAD_MAX_LEN];
+    size_t len;
+
+    for (size_t i = 0; i < payload_len; i++) {
+        payload[i] = test_rand(seed);
+    }
+
+    len = sprintf(line, "CSI_DATA,%u,2026-10-16 14:%02u:%02u.%06u,%u,%s,%02x:%02x:%02x:%02x:%02x:%02x,%d,%u,1,%u,1,0,0,0,%u,0,%u,%d,0,%u,1,%u,0,%u,%u,",
+                  test_rand(seed), test_rand(seed) % 60, test_rand(seed) % 60, test_rand(seed) % 1000000,
+                  test_rand(seed) % 100, test_rand(seed) & 1 ? "move" : "none",
+                  test_rand(seed) & 0xff, test_rand(seed) & 0xff, test_rand(seed) & 0xff, 0x12, 0x34, 0x56,
+                  test_rand_i8(seed, 127), test_rand(seed) % 32, test_rand(seed) % 8, test_rand(seed) & 1, test_rand(seed) & 1,
+                  test_rand_i8(seed, 100), test_rand(seed) % 14, test_rand(seed), test_rand(seed) & 0xffff,
+                  test_rand(seed) & 0xff);
+
+    if (gain_columns) {
+        len += sprintf(line + len, "%u,%d,", test_rand(seed) & 0xff, test_rand_i8(seed, 127));
+    }
+
+    len += sprintf(line + len, "%u,%u,", (unsigned int)payload_len, test_rand(seed) & 1);
+
+    bool quoted = test_rand(seed) & 1;
+
+    if (quoted) {
+        line[len++] = '"';
+    }
+
+    len += test_base64_encode(payload, payload_len, line + len);
+
+    if (quoted) {
+        line[len++] = '"';
+    }
+
+    line[len] = '\0';
+    return len;
+}
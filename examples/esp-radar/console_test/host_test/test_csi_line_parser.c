@@ -0,0 +1,535 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief csi_line_parse() and csi_line_reader_t against independent reference implementations:
+ *
+ * - Recorded-style streams in both column layouts are parsed and compared field by field.
+ * - Mutated lines (replaced, inserted and deleted bytes, truncation) must give the same status and
+ *   record as the reference and never write past the payload buffer.
+ * - A stream fed in random chunks, with CRLF, empty and over-long lines, must be split exactly like
+ *   a plain newline split.
+ * - Lines/s of csi_line_parse() against the strtok/malloc path it replaced in radar_evaluate.c.
+ */
+
+#define _GNU_SOURCE     // memmem()
+#include <string.h>
+
+#include "test_util.h"
+#include "test_csi_line.h"
+#include "csi_line_parser.h"
+
+#define LINE_MAX_LEN        4096
+#define GUARD_LEN           16
+#define FUZZ_ROUNDS         200000
+#define STREAM_LINES        20000
+#define BENCH_LINES         20000
+
+typedef struct {
+    const char *ptr;
+    size_t len;
+} span_t;
+
+/**
+ * @brief Reference integer rule: optional sign, digits, an optional "." with zeros only.
+ *        The parser stops accumulating past INT32_MAX * 4, so longer values are malformed.
+ */
+static bool ref_parse_int(span_t s, int64_t *value)
+{
+    size_t i = 0, digits = 0;
+    bool negative = false;
+    int64_t v = 0;
+
+    if (i < s.len && (s.ptr[i] == '-' || s.ptr[i] == '+')) {
+        negative = s.ptr[i++] == '-';
+    }
+
+    for (; i < s.len && s.ptr[i] >= '0' && s.ptr[i] <= '9'; i++, digits++) {
+        if (v / 10 > INT32_MAX * 4LL) {
+            return false;
+        }
+
+        v = v * 10 + (s.ptr[i] - '0');
+    }
+
+    if (!digits || v / 10 > INT32_MAX * 4LL) {
+        return false;
+    }
+
+    if (i < s.len && s.ptr[i] == '.') {
+        for (i++; i < s.len && s.ptr[i] == '0'; i++) {
+        }
+    }
+
+    *value = negative ? -v : v;
+    return i == s.len;
+}
+
+/**
+ * @brief Reference base64 through a bit accumulator; as in the parser, the length is checked before the characters
+ */
+static csi_line_status_t ref_base64(span_t s, uint8_t *out, size_t size, size_t *out_len)
+{
+    size_t len = s.len, bits = 0;
+    uint32_t acc = 0;
+
+    while (len && s.ptr[len - 1] == '=') {
+        len--;
+    }
+
+    if (s.len - len > 2 || len % 4 == 1) {
+        return CSI_LINE_INVALID;
+    }
+
+    *out_len = len * 6 / 8;
+
+    if (*out_len > size) {
+        return CSI_LINE_NO_MEM;
+    }
+
+    for (size_t i = 0, n = 0; i < len; i++) {
+        const char *c = s.ptr[i] ? strchr(s_test_base64_alphabet, s.ptr[i]) : NULL;
+
+        if (!c) {
+            return CSI_LINE_INVALID;
+        }
+
+        acc = acc << 6 | (uint32_t)(c - s_test_base64_alphabet);
+        bits += 6;
+
+        if (bits >= 8) {
+            bits -= 8;
+            out[n++] = acc >> bits;
+        }
+    }
+
+    return CSI_LINE_OK;
+}
+
+static csi_line_status_t ref_parse(const char *line, size_t len, csi_line_record_t *record,
+                                   uint8_t *payload, size_t payload_size)
+{
+    span_t column[64];
+    size_t count = 0;
+
+    if (len && line[len - 1] == '\r') {
+        len--;
+    }
+
+    const char *begin = memmem(line, len, "CSI_DATA,", 9);
+
+    if (!begin) {
+        return CSI_LINE_SKIP;
+    }
+
+    for (const char *p = begin, *end = line + len; count < 64; count++) {
+        const char *comma = memchr(p, ',', end - p);
+        column[count] = (span_t) {p, (comma ? comma : end) - p};
+
+        if (!comma) {
+            count++;
+            break;
+        }
+
+        p = comma + 1;
+    }
+
+    if (count != 28 && count != 30) {
+        return CSI_LINE_INVALID;
+    }
+
+    static const struct {
+        int column;
+        int64_t min;
+        int64_t max;
+    } s_columns[] = {
+        {1, 0, UINT32_MAX}, {6, -128, 127}, {7, 0, 255}, {17, -128, 127},
+        {19, 0, 255}, {21, 0, UINT32_MAX}, {23, 0, UINT16_MAX}, {24, 0, 255},
+    };
+    int64_t v[8], csi_len, first_word_invalid, agc_gain = 0, fft_gain = 0;
+
+    for (int i = 0; i < 8; i++) {
+        if (!ref_parse_int(column[s_columns[i].column], &v[i]) || v[i] < s_columns[i].min || v[i] > s_columns[i].max) {
+            return CSI_LINE_INVALID;
+        }
+    }
+
+    if (!ref_parse_int(column[count - 3], &csi_len) || csi_len < 0 || csi_len > UINT16_MAX
+            || !ref_parse_int(column[count - 2], &first_word_invalid)) {
+        return CSI_LINE_INVALID;
+    }
+
+    if (count == 30 && (!ref_parse_int(column[25], &agc_gain) || agc_gain < 0 || agc_gain > 255
+                        || !ref_parse_int(column[26], &fft_gain) || fft_gain < -128 || fft_gain > 127)) {
+        return CSI_LINE_INVALID;
+    }
+
+    span_t data = column[count - 1];
+
+    if (data.len >= 2 && data.ptr[0] == '"' && data.ptr[data.len - 1] == '"') {
+        data.ptr++;
+        data.len -= 2;
+    }
+
+    size_t payload_len;
+    csi_line_status_t ret = ref_base64(data, payload, payload_size, &payload_len);
+
+    if (ret != CSI_LINE_OK) {
+        return ret;
+    }
+
+    memset(record, 0, sizeof(*record));
+    record->seq = v[0];
+    record->rssi = v[1];
+    record->rate = v[2];
+    record->noise_floor = v[3];
+    record->channel = v[4];
+    record->local_timestamp = v[5];
+    record->sig_len = v[6];
+    record->rx_state = v[7];
+    record->agc_gain = agc_gain;
+    record->fft_gain = fft_gain;
+    record->len = csi_len;
+    record->first_word_invalid = first_word_invalid != 0;
+    record->payload_len = payload_len;
+    memcpy(record->timestamp, column[2].ptr, column[2].len < sizeof(record->timestamp) ? column[2].len : sizeof(record->timestamp) - 1);
+
+    return CSI_LINE_OK;
+}
+
+/**
+ * @brief Parser and reference must agree on the status, the record and the payload;
+ *        the parser must not write past payload_size
+ */
+static csi_line_status_t check_against_reference(const char *line, size_t len, size_t payload_size)
+{
+    static uint8_t payload[PAYLOAD_MAX_LEN + GUARD_LEN], ref_payload[PAYLOAD_MAX_LEN];
+    csi_line_record_t record, ref_record;
+
+    memset(payload + payload_size, 0xa5, GUARD_LEN);
+
+    csi_line_status_t ret = csi_line_parse(line, len, &record, payload, payload_size);
+    csi_line_status_t ref_ret = ref_parse(line, len, &ref_record, ref_payload, payload_size);
+
+    if (ret != ref_ret) {
+        fprintf(stderr, "status %d, reference %d: %.*s\n", ret, ref_ret, (int)len, line);
+    }
+
+    CHECK(ret == ref_ret);
+
+    for (int i = 0; i < GUARD_LEN; i++) {
+        CHECK(payload[payload_size + i] == 0xa5);
+    }
+
+    if (ret == CSI_LINE_OK) {
+        CHECK(!memcmp(&record, &ref_record, sizeof(record)));
+        CHECK(!memcmp(payload, ref_payload, record.payload_len));
+    }
+
+    return ret;
+}
+
+static void test_layouts(void)
+{
+    static char line[LINE_MAX_LEN];
+    static uint8_t payload[PAYLOAD_MAX_LEN];
+    csi_line_record_t record;
+    uint32_t seed = 11;
+
+    for (int i = 0; i < 2000; i++) {
+        bool gain_columns = i & 1;
+        size_t payload_len = i % 3 ? 128 : test_rand(&seed) % (PAYLOAD_MAX_LEN + 1);
+        size_t len = test_csi_line_generate(line, &seed, gain_columns, payload_len);
+
+        CHECK(check_against_reference(line, len, PAYLOAD_MAX_LEN) == CSI_LINE_OK);
+        CHECK(csi_line_parse(line, len, &record, payload, PAYLOAD_MAX_LEN) == CSI_LINE_OK);
+        CHECK(record.payload_len == payload_len && record.len == payload_len);
+
+        /**
+         * @brief Log text in front of the record, CRLF, and a payload buffer one byte short
+         */
+        char prefixed[LINE_MAX_LEN + 32];
+        int prefixed_len = sprintf(prefixed, "I (1234) CSI: CSI,x CSI_DATA%s\r", line + 8);
+        CHECK(check_against_reference(prefixed, prefixed_len, PAYLOAD_MAX_LEN) == CSI_LINE_OK);
+
+        if (payload_len) {
+            CHECK(check_against_reference(line, len, payload_len - 1) == CSI_LINE_NO_MEM);
+        }
+    }
+
+    static const char *s_skip[] = {"", "type,seq,timestamp", "CSI_DATA", "I (100) wifi: connected", "CSI_DATA\r"};
+
+    for (size_t i = 0; i < sizeof(s_skip) / sizeof(s_skip[0]); i++) {
+        CHECK(check_against_reference(s_skip[i], strlen(s_skip[i]), PAYLOAD_MAX_LEN) == CSI_LINE_SKIP);
+    }
+}
+
+static size_t mutate(char *line, size_t len, uint32_t *seed)
+{
+    static const char s_interesting[] = ",-+.0=\"\r9A/";
+
+    for (int ops = 1 + test_rand(seed) % 4; ops; ops--) {
+        size_t pos = len ? test_rand(seed) % len : 0;
+        char c = test_rand(seed) & 1 ? s_interesting[test_rand(seed) % (sizeof(s_interesting) - 1)] : (char)test_rand(seed);
+
+        switch (test_rand(seed) % 5) {
+        case 0:
+            if (len) {
+                line[pos] = c;
+            }
+            break;
+
+        case 1:
+            if (len + 1 < LINE_MAX_LEN) {
+                memmove(line + pos + 1, line + pos, len - pos);
+                line[pos] = c;
+                len++;
+            }
+            break;
+
+        case 2:
+            if (len) {
+                memmove(line + pos, line + pos + 1, len - pos - 1);
+                len--;
+            }
+            break;
+
+        case 3:
+            len = pos;
+            break;
+
+        default: {
+            // Repeat a few bytes, e.g. a digit run or a comma
+            size_t n = 1 + test_rand(seed) % 8;
+
+            if (pos + n <= len && len + n < LINE_MAX_LEN) {
+                memmove(line + pos + n, line + pos, len - pos);
+                len += n;
+            }
+            break;
+        }
+        }
+    }
+
+    return len;
+}
+
+static void test_fuzz(void)
+{
+    static char line[LINE_MAX_LEN];
+    uint32_t seed = 0xf022;
+    uint32_t status_count[4] = {0};
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++) {
+        size_t len = test_csi_line_generate(line, &seed, test_rand(&seed) & 1, test_rand(&seed) % 400);
+        size_t payload_size = test_rand(&seed) & 3 ? PAYLOAD_MAX_LEN : test_rand(&seed) % 400;
+
+        len = mutate(line, len, &seed);
+        status_count[check_against_reference(line, len, payload_size)]++;
+    }
+
+    printf("fuzz: %d mutated lines, ok %u, skip %u, invalid %u, no_mem %u\n", FUZZ_ROUNDS,
+           status_count[CSI_LINE_OK], status_count[CSI_LINE_SKIP], status_count[CSI_LINE_INVALID],
+           status_count[CSI_LINE_NO_MEM]);
+
+    for (int i = 0; i < 4; i++) {
+        CHECK(status_count[i]);
+    }
+}
+
+typedef struct {
+    const char *expected;           /**< The stream, lines are matched in order */
+    size_t offset;                  /**< Start of the next expected line */
+    size_t ring_size;
+    uint32_t delivered;
+    uint32_t dropped;
+} stream_ctx_t;
+
+/**
+ * @brief Advance past the over-long lines the reader must drop, then match the delivered one
+ */
+static void stream_line_cb(const char *line, size_t len, void *arg)
+{
+    stream_ctx_t *ctx = arg;
+
+    for (;;) {
+        const char *newline = strchr(ctx->expected + ctx->offset, '\n');
+        size_t expected_len = newline - (ctx->expected + ctx->offset);
+
+        CHECK(newline);
+
+        if (expected_len >= ctx->ring_size) {
+            ctx->offset += expected_len + 1;
+            ctx->dropped++;
+            continue;
+        }
+
+        CHECK(len == expected_len && !memcmp(line, ctx->expected + ctx->offset, len));
+        ctx->offset += len + 1;
+        ctx->delivered++;
+        return;
+    }
+}
+
+static void test_reader_stream(void)
+{
+    const size_t ring_size = 1024;
+    static char storage[CSI_LINE_READER_STORAGE_SIZE(1024)];
+    size_t stream_size = STREAM_LINES * 256, stream_len = 0;
+    char *stream = malloc(stream_size);
+    uint32_t seed = 77, expected_lines = 0, expected_dropped = 0;
+    csi_line_reader_t reader;
+
+    CHECK(stream);
+    CHECK(!csi_line_reader_init(&reader, storage, 1000));
+
+    while (stream_len + 4 * ring_size < stream_size) {
+        size_t len;
+        uint32_t kind = test_rand(&seed) % 16;
+
+        if (kind == 0) {
+            len = 0;
+        } else if (kind == 1) {
+            // Around the longest deliverable line of ring_size - 1 bytes, or far past it
+            len = test_rand(&seed) & 1 ? ring_size - 1 + test_rand(&seed) % 3 : ring_size + test_rand(&seed) % (2 * ring_size);
+            memset(stream + stream_len, 'x', len);
+        } else {
+            len = test_csi_line_generate(stream + stream_len, &seed, kind & 1, test_rand(&seed) % 600);
+
+            if (kind == 2) {
+                stream[stream_len + len++] = '\r';
+            }
+        }
+
+        if (len < ring_size) {
+            expected_lines++;
+        } else {
+            expected_dropped++;
+        }
+
+        stream_len += len;
+        stream[stream_len++] = '\n';
+    }
+
+    stream[stream_len] = '\0';
+
+    /**
+     * @brief Once through csi_line_reader_feed() in random chunks, once through write_ptr/commit
+     *        with partial writes as recv() returns them
+     */
+    for (int pass = 0; pass < 2; pass++) {
+        stream_ctx_t ctx = {.expected = stream, .ring_size = ring_size};
+
+        CHECK(csi_line_reader_init(&reader, storage, ring_size));
+
+        for (size_t offset = 0; offset < stream_len;) {
+            size_t n = 1 + test_rand(&seed) % (test_rand(&seed) & 7 ? 64 : 3000);
+            n = n < stream_len - offset ? n : stream_len - offset;
+
+            if (pass == 0) {
+                csi_line_reader_feed(&reader, stream + offset, n, stream_line_cb, &ctx);
+            } else {
+                size_t free_len;
+                char *ptr = csi_line_reader_write_ptr(&reader, &free_len);
+
+                CHECK(free_len > 0);
+                n = n < free_len ? n : free_len;
+                memcpy(ptr, stream + offset, n);
+                csi_line_reader_commit(&reader, n, stream_line_cb, &ctx);
+            }
+
+            offset += n;
+        }
+
+        CHECK(reader.line_count == expected_lines && ctx.delivered == expected_lines);
+        CHECK(reader.overflow_count == expected_dropped);
+    }
+
+    printf("reader: %u lines delivered, %u over-long lines dropped\n", expected_lines, expected_dropped);
+    free(stream);
+}
+
+/**
+ * @brief csi_info_analysis() as it was: column table and payload malloc'd per line, strtok, atoi;
+ *        the data column is taken from the end so both layouts decode
+ */
+static void strtok_parse(char *data, uint8_t *decoded, uint32_t *timestamp)
+{
+    const char *column[32];
+    uint8_t count = 0;
+    const char **columns = malloc(sizeof(column));
+
+    for (char *token = strtok(data, ","); token && count < 32; token = strtok(NULL, ",")) {
+        columns[count++] = token;
+    }
+
+    uint8_t *payload = malloc(PAYLOAD_MAX_LEN);
+    size_t len;
+    ref_base64((span_t) {columns[count - 1], strlen(columns[count - 1])}, payload, PAYLOAD_MAX_LEN, &len);
+    *timestamp = atoi(columns[21]);
+    memcpy(decoded, payload, len);
+
+    free(payload);
+    free(columns);
+}
+
+static void benchmark(void)
+{
+    char *lines = malloc(BENCH_LINES * 512), *copy = malloc(512);
+    size_t *offset = malloc((BENCH_LINES + 1) * sizeof(size_t));
+    static uint8_t payload[PAYLOAD_MAX_LEN];
+    csi_line_record_t record;
+    uint32_t seed = 3;
+    volatile uint32_t sink = 0;
+
+    CHECK(lines && copy && offset);
+    offset[0] = 0;
+
+    for (int i = 0; i < BENCH_LINES; i++) {
+        size_t len = test_csi_line_generate(lines + offset[i], &seed, true, 128);   // HT20 LLTF + HT-LTF
+        offset[i + 1] = offset[i] + len + 1;
+    }
+
+    double start = test_now();
+    for (int i = 0; i < BENCH_LINES; i++) {
+        CHECK(csi_line_parse(lines + offset[i], offset[i + 1] - offset[i] - 1, &record, payload, sizeof(payload)) == CSI_LINE_OK);
+        sink += record.local_timestamp + payload[5];
+    }
+    double parse = test_now() - start;
+
+    start = test_now();
+    for (int i = 0; i < BENCH_LINES; i++) {
+        size_t len = offset[i + 1] - offset[i] - 1;
+        uint32_t timestamp;
+
+        memcpy(copy, lines + offset[i], len);   // strtok writes into the line
+        copy[len] = '\0';
+        strtok_parse(copy, payload, &timestamp);
+        sink += timestamp + payload[5];
+    }
+    double baseline = test_now() - start;
+
+    (void)sink;
+    printf("30-column lines with 128-byte payloads: csi_line_parse %.0f lines/s, strtok path %.0f lines/s\n",
+           BENCH_LINES / parse, BENCH_LINES / baseline);
+
+    free(lines);
+    free(copy);
+    free(offset);
+}
+
+int main(void)
+{
+    test_layouts();
+    test_fuzz();
+    test_reader_stream();
+    benchmark();
+
+    printf("test_csi_line_parser: all tests passed\n");
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Lines/s of the radar_evaluate receive path. The replay is generated, cut into TCP-segment-sized
+ *        pieces and every line is parsed with csi_line_parse(), once from memory, which measures
+ *        the receive path alone, and once over a socketpair with a writer thread, select() and
+ *        recv() as in tcp_server_task.
+ *
+ * The ring (csi_line_reader_write_ptr/commit, as in radar_evaluate_client_recv()) is compared with the
+ * former loop, which strstr'd the 1460-byte buffer for "CSI_DATA" and "\n" per line and shifted the
+ * rest down (memmove here, the original memcpy'd overlapping bytes). Both must deliver every line.
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "test_util.h"
+#include "test_csi_line.h"
+#include "csi_line_parser.h"
+
+#define RING_SIZE           2048        /**< RADAR_EVALUATE_RING_SIZE */
+#define RX_BUFFER_SIZE      1460        /**< Former receive buffer */
+#define SEGMENT_LEN         1460
+#define STREAM_LINES        100000
+
+typedef struct {
+    int sock;
+    const char *data;
+    size_t len;
+} writer_ctx_t;
+
+typedef struct {
+    int sock;                       /**< -1: read from data instead */
+    const char *data;
+    size_t len;
+    size_t offset;
+} source_t;
+
+typedef struct {
+    uint8_t payload[PAYLOAD_MAX_LEN];
+    uint32_t parsed;
+} parse_ctx_t;
+
+static void *writer_task(void *arg)
+{
+    writer_ctx_t *ctx = arg;
+
+    for (size_t offset = 0; offset < ctx->len;) {
+        size_t n = ctx->len - offset < SEGMENT_LEN ? ctx->len - offset : SEGMENT_LEN;
+        ssize_t ret = send(ctx->sock, ctx->data + offset, n, 0);
+
+        CHECK(ret > 0);
+        offset += ret;
+    }
+
+    close(ctx->sock);
+    return NULL;
+}
+
+static void line_cb(const char *line, size_t len, void *arg)
+{
+    parse_ctx_t *ctx = arg;
+    csi_line_record_t record;
+
+    if (csi_line_parse(line, len, &record, ctx->payload, sizeof(ctx->payload)) == CSI_LINE_OK) {
+        ctx->parsed++;
+    }
+}
+
+static ssize_t source_recv(source_t *source, char *buf, size_t len)
+{
+    if (source->sock < 0) {
+        size_t n = source->len - source->offset;
+
+        n = n < len ? n : len;
+        n = n < SEGMENT_LEN ? n : SEGMENT_LEN;
+        memcpy(buf, source->data + source->offset, n);
+        source->offset += n;
+
+        return n;
+    }
+
+    fd_set read_fds;
+
+    FD_ZERO(&read_fds);
+    FD_SET(source->sock, &read_fds);
+    CHECK(select(source->sock + 1, &read_fds, NULL, NULL, NULL) == 1);
+
+    return recv(source->sock, buf, len, 0);
+}
+
+static void receive_ring(source_t *source, parse_ctx_t *ctx)
+{
+    static char storage[CSI_LINE_READER_STORAGE_SIZE(RING_SIZE)];
+    csi_line_reader_t reader;
+    ssize_t len;
+
+    CHECK(csi_line_reader_init(&reader, storage, RING_SIZE));
+
+    do {
+        size_t free_len;
+        char *ptr = csi_line_reader_write_ptr(&reader, &free_len);
+
+        len = source_recv(source, ptr, free_len);
+
+        if (len > 0) {
+            csi_line_reader_commit(&reader, len, line_cb, ctx);
+        }
+    } while (len > 0);
+}
+
+static void receive_compact(source_t *source, parse_ctx_t *ctx)
+{
+    static char rx_buffer[RX_BUFFER_SIZE];
+    size_t buf_size = 0;
+    ssize_t len;
+
+    do {
+        len = source_recv(source, rx_buffer + buf_size, RX_BUFFER_SIZE - buf_size - 1);
+
+        if (len <= 0) {
+            break;
+        }
+
+        buf_size += len;
+        rx_buffer[buf_size] = 0;
+
+        while (buf_size > 250) {
+            char *begin = strstr(rx_buffer, "CSI_DATA");
+            char *end   = strstr(rx_buffer, "\n");
+            ssize_t size  = end - begin;
+
+            if (begin && end && size > 250) {
+                begin[size] = '\0';
+                line_cb(begin, size, ctx);
+            }
+
+            if (end) {
+                buf_size -= (end + 1 - rx_buffer);
+                memmove(rx_buffer, end + 1, buf_size);
+                memset(rx_buffer + buf_size, 0, end + 1 - rx_buffer);
+            }
+
+            if (begin && !end) {
+                break;
+            }
+        }
+    } while (len > 0);
+}
+
+static double run(void (*receive)(source_t *, parse_ctx_t *), const char *stream, size_t stream_len,
+                  bool use_socket, uint32_t *parsed)
+{
+    static parse_ctx_t ctx;
+    source_t source = {.sock = -1, .data = stream, .len = stream_len};
+    writer_ctx_t writer_ctx = {.data = stream, .len = stream_len};
+    int socks[2];
+    pthread_t writer;
+
+    ctx.parsed = 0;
+
+    if (use_socket) {
+        CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+        source.sock = socks[0];
+        writer_ctx.sock = socks[1];
+    }
+
+    double start = test_now();
+
+    if (use_socket) {
+        CHECK(pthread_create(&writer, NULL, writer_task, &writer_ctx) == 0);
+    }
+
+    receive(&source, &ctx);
+
+    if (use_socket) {
+        CHECK(pthread_join(writer, NULL) == 0);
+        close(socks[0]);
+    }
+
+    double elapsed = test_now() - start;
+    *parsed = ctx.parsed;
+
+    return ctx.parsed / elapsed;
+}
+
+int main(void)
+{
+    char *stream = malloc(STREAM_LINES * 512);
+    size_t stream_len = 0;
+    uint32_t seed = 12, ring_parsed, compact_parsed;
+
+    CHECK(stream);
+
+    for (int i = 0; i < STREAM_LINES; i++) {
+        stream_len += test_csi_line_generate(stream + stream_len, &seed, true, 128);    // HT20 LLTF + HT-LTF
+        stream[stream_len++] = '\n';
+    }
+
+    for (int use_socket = 0; use_socket <= 1; use_socket++) {
+        double ring = run(receive_ring, stream, stream_len, use_socket, &ring_parsed);
+        double compact = run(receive_compact, stream, stream_len, use_socket, &compact_parsed);
+
+        printf("%d lines of %zu bytes, %s: ring %.0f lines/s, former strstr/memcpy loop %.0f lines/s\n",
+               STREAM_LINES, stream_len / STREAM_LINES, use_socket ? "socketpair" : "from memory", ring, compact);
+        CHECK(ring_parsed == STREAM_LINES && compact_parsed == STREAM_LINES);
+    }
+
+    free(stream);
+    printf("test_radar_evaluate_recv: all tests passed\n");
+
+    return 0;
+}
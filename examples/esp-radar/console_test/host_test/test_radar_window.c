@@ -0,0 +1,352 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief radar_window_t against a brute-force window that keeps the last values in arrival order and
+ *        qsorts a copy per query, the way esp-radar's trimmean() and median() worked:
+ *
+ * - Every rank, the median and the trimmed mean after every push, for several capacities, with
+ *   distinct values, heavy duplicates and the zero-filled start wifi_radar_cb() uses.
+ * - The trimmed mean of the 25-value window at 0.5 that wifi_radar_cb() uses, against values
+ *   worked out by hand from the trimmean() rule.
+ * - The treap invariants (key order, heap order, subtree counts) after every push.
+ * - Cost per radar frame (push, median, trimmean) against the brute-force version.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "test_util.h"
+#include "radar_window.h"
+
+#define CHECK_PUSHES        5000
+#define BENCH_FRAMES        20000
+
+typedef struct {
+    float *values;                  /**< Ring in arrival order */
+    float *sorted;
+    size_t capacity;
+    size_t count;
+    size_t next;
+} brute_window_t;
+
+static int float_cmp(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static void brute_push(brute_window_t *w, float value)
+{
+    w->values[w->next] = value;
+    w->next = (w->next + 1) % w->capacity;
+    w->count += w->count < w->capacity;
+}
+
+static void brute_sort(brute_window_t *w)
+{
+    memcpy(w->sorted, w->values, w->count * sizeof(float));
+    qsort(w->sorted, w->count, sizeof(float), float_cmp);
+}
+
+static float brute_median(brute_window_t *w)
+{
+    brute_sort(w);
+
+    if (!w->count) {
+        return 0;
+    } else if (w->count % 2) {
+        return w->sorted[w->count / 2];
+    }
+
+    return (w->sorted[w->count / 2 - 1] + w->sorted[w->count / 2]) / 2;
+}
+
+/**
+ * @brief esp-radar's trimmean() as the library writes it, float bounds and divisor, summed in double.
+ *        A negative percent is taken as 0 and the divide-by-zero range falls back to the median,
+ *        as radar_window_trimmean() does; the library reads out of bounds or returns inf there.
+ */
+static double brute_trimmean(brute_window_t *w, float percent)
+{
+    size_t len = w->count;
+    double trimmean_data = 0;
+
+    if (!(percent > 0)) {
+        percent = 0;
+    }
+
+    if (!len) {
+        return 0;
+    } else if (!(len * (1 - percent) > 0)) {
+        return brute_median(w);
+    }
+
+    brute_sort(w);
+
+    for (int i = len * percent / 2; i < len * (1 - percent / 2); ++i) {
+        trimmean_data += w->sorted[i];
+    }
+
+    return trimmean_data / (len * (1 - percent));
+}
+
+/**
+ * @brief Walk the treap, checking order, priorities, counts and sums; returns the subtree size.
+ *        Float subtree sums are checked against the sum of magnitudes, the bound of their rounding error.
+ */
+static size_t check_subtree(const radar_window_t *window, uint16_t t, const radar_window_node_t *low,
+                            const radar_window_node_t *high, double *sum, double *abs_sum)
+{
+    if (t == 0xffff) {
+        *sum = *abs_sum = 0;
+        return 0;
+    }
+
+    const radar_window_node_t *node = &window->nodes[t];
+    double left_sum, right_sum, left_abs, right_abs;
+
+    CHECK(!low || low->value <= node->value);
+    CHECK(!high || node->value <= high->value);
+
+    CHECK(node->left == 0xffff || window->nodes[node->left].priority <= node->priority);
+    CHECK(node->right == 0xffff || window->nodes[node->right].priority <= node->priority);
+
+    size_t count = check_subtree(window, node->left, low, node, &left_sum, &left_abs)
+                   + 1 + check_subtree(window, node->right, node, high, &right_sum, &right_abs);
+
+    *sum = left_sum + node->value + right_sum;
+    *abs_sum = left_abs + fabs(node->value) + right_abs;
+    CHECK(node->count == count);
+    CHECK(fabs(node->sum - *sum) <= 1e-6 * count * *abs_sum);
+
+    return count;
+}
+
+typedef float (*value_gen_t)(uint32_t *seed);
+
+static float gen_distinct(uint32_t *seed)
+{
+    return (test_rand(seed) % 2000000) / 1000.0f - 1000.0f;
+}
+
+static float gen_duplicates(uint32_t *seed)
+{
+    return (float)(test_rand(seed) % 5);
+}
+
+/**
+ * @brief Slowly rising values with outliers, like waveform_wander while someone walks in
+ */
+static float gen_drift(uint32_t *seed)
+{
+    static uint32_t step;
+    return (step++ % 3000) * 0.001f + (test_rand(seed) % 50 ? 0 : 5.0f);
+}
+
+static void check_window(size_t capacity, value_gen_t gen, bool zero_fill)
+{
+    static const float s_percents[] = {0, 0.1f, 0.25f, 0.5f, 0.9f, 1.0f, -1.0f};
+    radar_window_node_t *nodes = malloc(capacity * sizeof(radar_window_node_t));
+    brute_window_t brute = {
+        .values = malloc(capacity * sizeof(float)),
+        .sorted = malloc(capacity * sizeof(float)),
+        .capacity = capacity,
+    };
+    radar_window_t window;
+    uint32_t seed = 1 + capacity;
+
+    CHECK(nodes && brute.values && brute.sorted);
+    CHECK(radar_window_init(&window, nodes, capacity));
+    CHECK(radar_window_median(&window) == 0 && radar_window_trimmean(&window, 0.5f) == 0);
+
+    if (zero_fill) {
+        for (size_t i = 0; i < capacity; i++) {
+            radar_window_push(&window, 0);
+            brute_push(&brute, 0);
+        }
+    }
+
+    for (int push = 0; push < CHECK_PUSHES; push++) {
+        float value = gen(&seed);
+
+        radar_window_push(&window, value);
+        brute_push(&brute, value);
+
+        CHECK(window.count == brute.count);
+
+        /**
+         * @brief Ranks and medians are selections of pushed values, so they must match exactly
+         */
+        if (capacity <= 64 || push % 97 == 0) {
+            double sum, abs_sum;
+
+            CHECK(check_subtree(&window, window.root, NULL, NULL, &sum, &abs_sum) == window.count);
+            brute_sort(&brute);
+
+            for (size_t i = 0; i < brute.count; i++) {
+                CHECK(radar_window_select(&window, i) == brute.sorted[i]);
+            }
+        }
+
+        CHECK(radar_window_median(&window) == brute_median(&brute));
+
+        for (size_t i = 0; i < sizeof(s_percents) / sizeof(s_percents[0]); i++) {
+            double expected = brute_trimmean(&brute, s_percents[i]);
+            double scale = fabs(brute.sorted[0]) + fabs(brute.sorted[brute.count - 1]) + 1;
+
+            CHECK(fabs(radar_window_trimmean(&window, s_percents[i]) - expected) <= 1e-5 * scale);
+        }
+    }
+
+    free(nodes);
+    free(brute.values);
+    free(brute.sorted);
+}
+
+static void test_init(void)
+{
+    radar_window_node_t nodes[1];
+    radar_window_t window;
+
+    CHECK(!radar_window_init(&window, nodes, 0));
+    CHECK(!radar_window_init(&window, nodes, RADAR_WINDOW_MAX_CAPACITY + 1));
+    CHECK(radar_window_init(&window, nodes, 1));
+
+    radar_window_push(&window, 3);
+    radar_window_push(&window, -2);
+    CHECK(window.count == 1 && radar_window_median(&window) == -2);
+
+    // trimmean()'s divisor: the one value over 1 * (1 - 0.5)
+    CHECK(radar_window_trimmean(&window, 0.5f) == -4);
+}
+
+static float trimmean_of(radar_window_t *window, const float *values, size_t count, float percent)
+{
+    for (size_t i = 0; i < count; i++) {
+        radar_window_push(window, values[i]);
+    }
+
+    return radar_window_trimmean(window, percent);
+}
+
+/**
+ * @brief 25 values at 0.5: sorted indices 6 to 18 (6.25 rounded down, up to 18.75), divided by 12.5
+ */
+static void test_trimmean_rule(void)
+{
+    radar_window_node_t nodes[25];
+    radar_window_t window;
+    float values[25];
+
+    // 1..25 in scrambled order: (7 + ... + 19) / 12.5 = 169 / 12.5
+    for (int i = 0; i < 25; i++) {
+        values[i] = (float)(i * 7 % 25 + 1);
+    }
+    radar_window_init(&window, nodes, 25);
+    CHECK(fabsf(trimmean_of(&window, values, 25, 0.5f) - 13.52f) < 1e-5f);
+
+    // The 13 kept values are untouched by the outliers at both ends
+    for (int i = 0; i < 25; i++) {
+        values[i] = values[i] == 1 ? -1000 : values[i] == 25 ? 1000 : values[i];
+    }
+    radar_window_init(&window, nodes, 25);
+    CHECK(fabsf(trimmean_of(&window, values, 25, 0.5f) - 13.52f) < 1e-5f);
+
+    // Then 26..50 evict all of them: (32 + ... + 44) / 12.5 = 494 / 12.5
+    for (int i = 0; i < 25; i++) {
+        values[i] = (float)(50 - i);
+    }
+    CHECK(fabsf(trimmean_of(&window, values, 25, 0.5f) - 39.52f) < 1e-5f);
+
+    // A constant window reads 13 / 12.5 of its value, as trimmean() did
+    for (int i = 0; i < 25; i++) {
+        values[i] = 2;
+    }
+    radar_window_init(&window, nodes, 25);
+    CHECK(fabsf(trimmean_of(&window, values, 25, 0.5f) - 2.08f) < 1e-6f);
+
+    // Nothing trimmed: the plain mean, 50 / 25
+    CHECK(fabsf(radar_window_trimmean(&window, 0) - 2) < 1e-6f);
+
+    // The zero-filled start with one frame in: indices 6 to 18 are still zeros
+    for (int i = 0; i < 25; i++) {
+        values[i] = i == 24 ? 100 : 0;
+    }
+    radar_window_init(&window, nodes, 25);
+    CHECK(trimmean_of(&window, values, 25, 0.5f) == 0);
+
+    // An even count trims whole values: {1, 2, 3, 10} keeps (2 + 3) / 2
+    static const float s_four[] = {10, 1, 3, 2};
+    radar_window_init(&window, nodes, 4);
+    CHECK(trimmean_of(&window, s_four, 4, 0.5f) == 2.5f);
+}
+
+static void benchmark(size_t capacity)
+{
+    radar_window_node_t *nodes = malloc(capacity * sizeof(radar_window_node_t));
+    brute_window_t brute = {
+        .values = calloc(capacity, sizeof(float)),
+        .sorted = malloc(capacity * sizeof(float)),
+        .capacity = capacity,
+        .count = capacity,
+    };
+    radar_window_t window;
+    uint32_t seed = 5;
+    volatile float sink = 0;
+    int frames = capacity > 100 ? BENCH_FRAMES / 10 : BENCH_FRAMES;
+
+    CHECK(nodes && brute.values && brute.sorted);
+    radar_window_init(&window, nodes, capacity);
+
+    for (size_t i = 0; i < capacity; i++) {
+        radar_window_push(&window, 0);
+    }
+
+    double start = test_now();
+    for (int frame = 0; frame < frames; frame++) {
+        radar_window_push(&window, gen_distinct(&seed));
+        sink += radar_window_trimmean(&window, 0.5f) + radar_window_median(&window);
+    }
+    double treap = (test_now() - start) / frames * 1e9;
+
+    start = test_now();
+    for (int frame = 0; frame < frames; frame++) {
+        brute_push(&brute, gen_distinct(&seed));
+        sink += brute_trimmean(&brute, 0.5f) + brute_median(&brute);
+    }
+    double sorted = (test_now() - start) / frames * 1e9;
+
+    (void)sink;
+    printf("window of %4zu: push + trimmean + median %.0f ns/frame, qsort per query %.0f ns/frame\n",
+           capacity, treap, sorted);
+
+    free(nodes);
+    free(brute.values);
+    free(brute.sorted);
+}
+
+int main(void)
+{
+    static const size_t s_capacities[] = {1, 2, 3, 25, 100, 1000};
+
+    test_init();
+    test_trimmean_rule();
+
+    for (size_t i = 0; i < sizeof(s_capacities) / sizeof(s_capacities[0]); i++) {
+        check_window(s_capacities[i], gen_distinct, false);
+        check_window(s_capacities[i], gen_duplicates, true);
+        check_window(s_capacities[i], gen_drift, true);
+    }
+
+    benchmark(25);
+    benchmark(1000);
+
+    printf("test_radar_window: all tests passed\n");
+
+    return 0;
+}
@@ -25,6 +25,7 @@
 
 #include "esp_mac.h"
 #include "esp_wifi.h"
+#include "esp_timer.h"
 #include "lwip/inet.h"
 #include "lwip/netdb.h"
 #include "lwip/sockets.h"
@@ -35,6 +36,9 @@
 #include "led_strip.h"
 #include "esp_radar.h"
 #include "csi_commands.h"
+#include "csi_ring.h"
+#include "csi_metrics.h"
+#include "radar_window.h"
 
 extern esp_ping_handle_t g_ping_handle;
 static led_strip_handle_t led_strip;
@@ -56,13 +60,58 @@ static led_strip_handle_t led_strip;
 #define CONFIG_SEND_DATA_FREQUENCY          100
 
 #define RADAR_EVALUATE_SERVER_PORT          3232
+/**
+ * @brief Frames covered by the wander trimmed mean and the jitter median, up to RADAR_WINDOW_MAX_CAPACITY;
+ *        the per-frame cost grows with log(RADAR_BUFF_MAX_LEN)
+ */
+#ifndef RADAR_BUFF_MAX_LEN
 #define RADAR_BUFF_MAX_LEN                  25
+#endif
+
+/**
+ * @brief Slots are preallocated at CSI_INFO_SLOT_SIZE each, so the 64 entries of the former pointer queue
+ *        would pin about 70 KB; 16 slots (about 17 KB) still cover 160 ms of packets at 100 Hz
+ */
+#define CSI_INFO_RING_SLOT_NUM              16      /**< Power of two */
+#define CSI_INFO_DATA_MAX_LEN               1024    /**< Largest valid_len kept, longer packets are dropped */
+#define CSI_INFO_SLOT_SIZE                  (sizeof(csi_info_slot_t) + CSI_INFO_DATA_MAX_LEN)
+
+typedef struct {
+    int64_t t0;                             /**< esp_timer_get_time() when wifi_csi_raw_cb got the packet */
+    wifi_csi_filtered_info_t info;          /**< Followed by CSI_INFO_DATA_MAX_LEN bytes of valid_data */
+} csi_info_slot_t;
 
-static QueueHandle_t g_csi_info_queue    = NULL;
+static csi_ring_t g_csi_info_ring;
+static TaskHandle_t g_csi_print_task      = NULL;
 static bool g_wifi_connect_status        = false;
 static uint32_t g_send_data_interval     = 1000 / CONFIG_SEND_DATA_FREQUENCY;
 static const char *TAG                   = "app_main";
 
+/**
+ * @brief Latency from wifi_csi_raw_cb to the end of each stage, in microseconds, shown by the `stats` command
+ */
+enum {
+    CSI_STAGE_QUEUE,                        /**< Waiting in g_csi_info_ring for csi_data_print_task */
+    CSI_STAGE_PRINT,                        /**< Formatted and written to the console */
+};
+
+enum {
+    CSI_DROP_OVERSIZE,                      /**< valid_len above CSI_INFO_DATA_MAX_LEN */
+    CSI_DROP_RING_FULL,                     /**< csi_data_print_task fell behind */
+};
+
+static csi_metrics_stage_t g_csi_stages[] = {
+    [CSI_STAGE_QUEUE] = {.name = "queue"},
+    [CSI_STAGE_PRINT] = {.name = "print"},
+};
+
+static csi_metrics_counter_t g_csi_drops[] = {
+    [CSI_DROP_OVERSIZE]  = {.name = "oversize"},
+    [CSI_DROP_RING_FULL] = {.name = "ring_full"},
+};
+
+static csi_metrics_t g_csi_metrics = CSI_METRICS_INIT(g_csi_stages, g_csi_drops);
+
 static struct {
     struct arg_lit *train_start;
     struct arg_lit *train_stop;
@@ -114,14 +163,33 @@ static TimerHandle_t g_collect_timer_handele = NULL;
 
 void wifi_csi_raw_cb(void *ctx, const wifi_csi_filtered_info_t *info)
 {
-    wifi_csi_filtered_info_t *q_data = malloc(sizeof(wifi_csi_filtered_info_t) + info->valid_len);
-    *q_data = *info;
-    memcpy(q_data->valid_data, info->valid_data, info->valid_len);
+    if (!g_csi_print_task) {
+        return;
+    }
 
-    if (!g_csi_info_queue || xQueueSend(g_csi_info_queue, &q_data, 0) == pdFALSE) {
-        ESP_LOGW(TAG, "g_csi_info_queue full");
-        free(q_data);
+    int64_t t0 = esp_timer_get_time();
+
+    if (info->valid_len > CSI_INFO_DATA_MAX_LEN) {
+        csi_metrics_counter_add(&g_csi_drops[CSI_DROP_OVERSIZE], 1);
+        return;
+    }
+
+    /**
+     * @brief Copy straight into a preallocated ring slot, a full ring drops the packet
+     *        and is reported by csi_data_print_task
+     */
+    csi_info_slot_t *slot = csi_ring_acquire(&g_csi_info_ring);
+
+    if (!slot) {
+        csi_metrics_counter_add(&g_csi_drops[CSI_DROP_RING_FULL], 1);
+        return;
     }
+
+    slot->t0   = t0;
+    slot->info = *info;
+    memcpy(slot->info.valid_data, info->valid_data, info->valid_len);
+    csi_ring_commit(&g_csi_info_ring);
+    xTaskNotifyGive(g_csi_print_task);
 }
 
 static void collect_timercb(TimerHandle_t timer)
@@ -334,13 +402,85 @@ void cmd_register_radar(void)
     ESP_ERROR_CHECK(esp_console_cmd_register(&radar_cmd));
 }
 
+static struct {
+    struct arg_lit *reset;
+    struct arg_end *end;
+} stats_args;
+
+static int cmd_stats(int argc, char **argv)
+{
+    if (arg_parse(argc, argv, (void **) &stats_args) != ESP_OK) {
+        arg_print_errors(stderr, stats_args.end, argv[0]);
+        return ESP_FAIL;
+    }
+
+    printf("%-10s %10s %10s %10s %10s %10s\n", "stage(us)", "count", "p50", "p90", "p99", "max");
+
+    for (size_t i = 0; i < g_csi_metrics.stage_count; i++) {
+        csi_metrics_summary_t summary;
+        csi_metrics_hist_summary(&g_csi_metrics.stages[i].latency, &summary);
+        printf("%-10s %10u %10u %10u %10u %10u\n", g_csi_metrics.stages[i].name, (unsigned int)summary.count,
+               (unsigned int)summary.p50, (unsigned int)summary.p90, (unsigned int)summary.p99, (unsigned int)summary.max);
+    }
+
+    for (size_t i = 0; i < g_csi_metrics.counter_count; i++) {
+        printf("%-10s %10u\n", g_csi_metrics.counters[i].name,
+               (unsigned int)csi_metrics_counter_get(&g_csi_metrics.counters[i]));
+    }
+
+    if (stats_args.reset->count) {
+        csi_metrics_reset(&g_csi_metrics);
+    }
+
+    return ESP_OK;
+}
+
+void cmd_register_stats(void)
+{
+    stats_args.reset = arg_lit0(NULL, "reset", "Clear the histograms and counters after printing them");
+    stats_args.end   = arg_end(1);
+
+    const esp_console_cmd_t stats_cmd = {
+        .command = "stats",
+        .help = "Per-stage latency of the CSI pipeline since the Wi-Fi callback, and dropped packets",
+        .hint = NULL,
+        .func = &cmd_stats,
+        .argtable = &stats_args
+    };
+
+    ESP_ERROR_CHECK(esp_console_cmd_register(&stats_cmd));
+}
+
 static void csi_data_print_task(void *arg)
 {
+    csi_info_slot_t *slot = NULL;
     wifi_csi_filtered_info_t *info = NULL;
     char *buffer = malloc(8 * 1024);
     static uint32_t count = 0;
+    uint32_t overflow_count = 0;
+    uint32_t oversize_count = 0;
+
+    for (;;) {
+        if (csi_ring_overflow_count(&g_csi_info_ring) != overflow_count) {
+            overflow_count = csi_ring_overflow_count(&g_csi_info_ring);
+            ESP_LOGW(TAG, "g_csi_info_ring full, dropped %u packets in total", (unsigned int)overflow_count);
+        }
+
+        if (csi_metrics_counter_get(&g_csi_drops[CSI_DROP_OVERSIZE]) != oversize_count) {
+            oversize_count = csi_metrics_counter_get(&g_csi_drops[CSI_DROP_OVERSIZE]);
+            ESP_LOGW(TAG, "valid_len above %d, dropped %u packets in total", CSI_INFO_DATA_MAX_LEN, (unsigned int)oversize_count);
+        }
+
+        slot = csi_ring_peek(&g_csi_info_ring);
+
+        if (!slot) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        info = &slot->info;
+        csi_metrics_hist_record(&g_csi_stages[CSI_STAGE_QUEUE].latency, (uint32_t)(esp_timer_get_time() - slot->t0));
 
-    while (xQueueReceive(g_csi_info_queue, &info, portMAX_DELAY)) {
         size_t len = 0;
         esp_radar_rx_ctrl_info_t *rx_ctrl = &info->rx_ctrl_info;
 
@@ -392,16 +532,15 @@ static void csi_data_print_task(void *arg)
         }
 
         printf("%s", buffer);
-        free(info);
+        csi_metrics_hist_record(&g_csi_stages[CSI_STAGE_PRINT].latency, (uint32_t)(esp_timer_get_time() - slot->t0));
+        csi_ring_release(&g_csi_info_ring);
     }
-
-    free(buffer);
-    vTaskDelete(NULL);
 }
 
 static void wifi_radar_cb(void *ctx, const wifi_radar_info_t *info)
 {
-    static float *s_buff_wander  = NULL;
+    static radar_window_t s_window_wander;
+    static radar_window_t s_window_jitter;
     static float *s_buff_jitter  = NULL;
     static uint32_t s_buff_count = 0;
     uint32_t buff_max_size       = g_console_input_config.predict_buff_size;
@@ -411,15 +550,25 @@ static void wifi_radar_cb(void *ctx, const wifi_radar_info_t *info)
     bool room_status             = false;
     bool human_status            = false;
 
-    if (!s_buff_wander) {
-        s_buff_wander = calloc(RADAR_BUFF_MAX_LEN, sizeof(float));
-    }
-
     if (!s_buff_jitter) {
+        static radar_window_node_t s_nodes_wander[RADAR_BUFF_MAX_LEN];
+        static radar_window_node_t s_nodes_jitter[RADAR_BUFF_MAX_LEN];
+
         s_buff_jitter = calloc(RADAR_BUFF_MAX_LEN, sizeof(float));
+        radar_window_init(&s_window_wander, s_nodes_wander, RADAR_BUFF_MAX_LEN);
+        radar_window_init(&s_window_jitter, s_nodes_jitter, RADAR_BUFF_MAX_LEN);
+
+        /**
+         * @brief The statistics have always covered the whole buffer, zero-filled until it wraps
+         */
+        for (int i = 0; i < RADAR_BUFF_MAX_LEN; i++) {
+            radar_window_push(&s_window_wander, 0);
+            radar_window_push(&s_window_jitter, 0);
+        }
     }
 
-    s_buff_wander[s_buff_count % RADAR_BUFF_MAX_LEN] = info->waveform_wander;
+    radar_window_push(&s_window_wander, info->waveform_wander);
+    radar_window_push(&s_window_jitter, info->waveform_jitter);
     s_buff_jitter[s_buff_count % RADAR_BUFF_MAX_LEN] = info->waveform_jitter;
     s_buff_count++;
 
@@ -427,11 +576,8 @@ static void wifi_radar_cb(void *ctx, const wifi_radar_info_t *info)
         return;
     }
 
-    extern float trimmean(const float * array, size_t len, float percent);
-    extern float median(const float * a, size_t len);
-
-    float wander_average = trimmean(s_buff_wander, RADAR_BUFF_MAX_LEN, 0.5);
-    float jitter_midean = median(s_buff_jitter, RADAR_BUFF_MAX_LEN);
+    float wander_average = radar_window_trimmean(&s_window_wander, 0.5);
+    float jitter_midean = radar_window_median(&s_window_jitter);
 
     for (int i = 0; i < buff_max_size; i++) {
         uint32_t index = (s_buff_count - 1 - i) % RADAR_BUFF_MAX_LEN;
@@ -725,6 +871,7 @@ void app_main(void)
     cmd_register_wifi_config();
     cmd_register_wifi_scan();
     cmd_register_radar();
+    cmd_register_stats();
     ESP_ERROR_CHECK(esp_console_start_repl(repl));
 
     /**
@@ -735,6 +882,8 @@ void app_main(void)
     /**
      * @brief Initialize CSI serial port printing task, Use tasks to avoid blocking wifi_csi_raw_cb
      */
-    g_csi_info_queue = xQueueCreate(64, sizeof(void *));
-    xTaskCreate(csi_data_print_task, "csi_data_print", 4 * 1024, NULL, 0, NULL);
+    void *csi_info_storage = malloc(CSI_RING_STORAGE_SIZE(CSI_INFO_SLOT_SIZE, CSI_INFO_RING_SLOT_NUM));
+    ESP_ERROR_CHECK(csi_info_storage ? ESP_OK : ESP_ERR_NO_MEM);
+    csi_ring_init(&g_csi_info_ring, csi_info_storage, CSI_INFO_SLOT_SIZE, CSI_INFO_RING_SLOT_NUM);
+    xTaskCreate(csi_data_print_task, "csi_data_print", 4 * 1024, NULL, 0, &g_csi_print_task);
 }
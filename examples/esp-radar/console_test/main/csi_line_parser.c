@@ -0,0 +1,374 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "csi_line_parser.h"
+
+#define CSI_LINE_PREFIX             "CSI_DATA,"
+#define CSI_LINE_PREFIX_LEN         (sizeof(CSI_LINE_PREFIX) - 1)
+#define CSI_LINE_COLUMNS            28      /**< Without agc_gain and fft_gain */
+#define CSI_LINE_COLUMNS_GAIN       30
+
+/**
+ * @brief Column indexes shared by both layouts, len/first_word_invalid/data are counted from the end
+ */
+enum {
+    CSI_LINE_COL_SEQ             = 1,
+    CSI_LINE_COL_TIMESTAMP       = 2,
+    CSI_LINE_COL_RSSI            = 6,
+    CSI_LINE_COL_RATE            = 7,
+    CSI_LINE_COL_NOISE_FLOOR     = 17,
+    CSI_LINE_COL_CHANNEL         = 19,
+    CSI_LINE_COL_LOCAL_TIMESTAMP = 21,
+    CSI_LINE_COL_SIG_LEN         = 23,
+    CSI_LINE_COL_RX_STATE        = 24,
+    CSI_LINE_COL_AGC_GAIN        = 25,
+    CSI_LINE_COL_FFT_GAIN        = 26,
+};
+
+typedef struct {
+    const char *ptr;
+    size_t len;
+} csi_line_span_t;
+
+static const int8_t s_base64_table[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+/**
+ * @brief Decimal integer with an optional sign; a ".000" fraction is accepted because pandas
+ *        writes integer columns that contain a NaN as floats
+ */
+static bool csi_line_parse_int(csi_line_span_t span, int64_t *value)
+{
+    const char *p   = span.ptr;
+    const char *end = span.ptr + span.len;
+    bool negative   = false;
+    int64_t v       = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+
+    if (p == end || (unsigned)(*p - '0') > 9) {
+        return false;
+    }
+
+    for (; p < end && (unsigned)(*p - '0') <= 9; p++) {
+        if (v > INT32_MAX * 4LL) {
+            return false;
+        }
+
+        v = v * 10 + (*p - '0');
+    }
+
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p == '0'; p++) {
+        }
+    }
+
+    if (p != end) {
+        return false;
+    }
+
+    *value = negative ? -v : v;
+    return true;
+}
+
+static csi_line_status_t csi_line_base64_decode(csi_line_span_t span, uint8_t *out, size_t size, size_t *out_len)
+{
+    const uint8_t *p = (const uint8_t *)span.ptr;
+    size_t len = span.len;
+
+    while (len && p[len - 1] == '=') {
+        len--;
+    }
+
+    if (span.len - len > 2 || len % 4 == 1) {
+        return CSI_LINE_INVALID;
+    }
+
+    *out_len = len / 4 * 3 + (len % 4 ? len % 4 - 1 : 0);
+
+    if (*out_len > size) {
+        return CSI_LINE_NO_MEM;
+    }
+
+    size_t i = 0;
+
+    for (; i + 4 <= len; i += 4, out += 3) {
+        int a = s_base64_table[p[i]];
+        int b = s_base64_table[p[i + 1]];
+        int c = s_base64_table[p[i + 2]];
+        int d = s_base64_table[p[i + 3]];
+
+        if ((a | b | c | d) < 0) {
+            return CSI_LINE_INVALID;
+        }
+
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)d;
+        out[0] = v >> 16;
+        out[1] = v >> 8;
+        out[2] = v;
+    }
+
+    if (i < len) {
+        // 2 or 3 characters left, giving 1 or 2 bytes
+        int a = s_base64_table[p[i]];
+        int b = s_base64_table[p[i + 1]];
+        int c = len - i == 3 ? s_base64_table[p[i + 2]] : 0;
+
+        if ((a | b | c) < 0) {
+            return CSI_LINE_INVALID;
+        }
+
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6;
+        out[0] = v >> 16;
+
+        if (len - i == 3) {
+            out[1] = v >> 8;
+        }
+    }
+
+    return CSI_LINE_OK;
+}
+
+csi_line_status_t csi_line_parse(const char *line, size_t len, csi_line_record_t *record,
+                                 uint8_t *payload, size_t payload_size)
+{
+    csi_line_span_t column[CSI_LINE_COLUMNS_GAIN];
+    size_t column_count = 0;
+    const char *end = line + len;
+
+    if (len && end[-1] == '\r') {
+        end--;
+    }
+
+    /**
+     * @brief Serial captures may have log text in front of the record
+     */
+    const char *begin = line;
+
+    while (begin + CSI_LINE_PREFIX_LEN <= end && memcmp(begin, CSI_LINE_PREFIX, CSI_LINE_PREFIX_LEN)) {
+        begin = memchr(begin + 1, 'C', end - begin - 1);
+
+        if (!begin) {
+            return CSI_LINE_SKIP;
+        }
+    }
+
+    if (begin + CSI_LINE_PREFIX_LEN > end) {
+        return CSI_LINE_SKIP;
+    }
+
+    for (const char *p = begin;;) {
+        const char *comma = memchr(p, ',', end - p);
+        const char *field_end = comma ? comma : end;
+
+        if (column_count == CSI_LINE_COLUMNS_GAIN) {
+            return CSI_LINE_INVALID;
+        }
+
+        column[column_count].ptr = p;
+        column[column_count].len = field_end - p;
+        column_count++;
+
+        if (!comma) {
+            break;
+        }
+
+        p = comma + 1;
+    }
+
+    if (column_count != CSI_LINE_COLUMNS && column_count != CSI_LINE_COLUMNS_GAIN) {
+        return CSI_LINE_INVALID;
+    }
+
+    static const struct {
+        uint8_t column;
+        int64_t min;
+        int64_t max;
+    } s_number_columns[] = {
+        {CSI_LINE_COL_SEQ,             0,    UINT32_MAX},
+        {CSI_LINE_COL_RSSI,            -128, 127},
+        {CSI_LINE_COL_RATE,            0,    255},
+        {CSI_LINE_COL_NOISE_FLOOR,     -128, 127},
+        {CSI_LINE_COL_CHANNEL,         0,    255},
+        {CSI_LINE_COL_LOCAL_TIMESTAMP, 0,    UINT32_MAX},
+        {CSI_LINE_COL_SIG_LEN,         0,    UINT16_MAX},
+        {CSI_LINE_COL_RX_STATE,        0,    255},
+    };
+    int64_t number[sizeof(s_number_columns) / sizeof(s_number_columns[0])];
+
+    for (size_t i = 0; i < sizeof(s_number_columns) / sizeof(s_number_columns[0]); i++) {
+        if (!csi_line_parse_int(column[s_number_columns[i].column], &number[i])
+                || number[i] < s_number_columns[i].min || number[i] > s_number_columns[i].max) {
+            return CSI_LINE_INVALID;
+        }
+    }
+
+    int64_t csi_len, first_word_invalid, agc_gain = 0, fft_gain = 0;
+
+    if (!csi_line_parse_int(column[column_count - 3], &csi_len) || csi_len < 0 || csi_len > UINT16_MAX
+            || !csi_line_parse_int(column[column_count - 2], &first_word_invalid)) {
+        return CSI_LINE_INVALID;
+    }
+
+    if (column_count == CSI_LINE_COLUMNS_GAIN
+            && (!csi_line_parse_int(column[CSI_LINE_COL_AGC_GAIN], &agc_gain) || agc_gain < 0 || agc_gain > 255
+                || !csi_line_parse_int(column[CSI_LINE_COL_FFT_GAIN], &fft_gain) || fft_gain < -128 || fft_gain > 127)) {
+        return CSI_LINE_INVALID;
+    }
+
+    csi_line_span_t data = column[column_count - 1];
+
+    if (data.len >= 2 && data.ptr[0] == '"' && data.ptr[data.len - 1] == '"') {
+        data.ptr++;
+        data.len -= 2;
+    }
+
+    size_t payload_len = 0;
+    csi_line_status_t ret = csi_line_base64_decode(data, payload, payload_size, &payload_len);
+
+    if (ret != CSI_LINE_OK) {
+        return ret;
+    }
+
+    memset(record, 0, sizeof(csi_line_record_t));
+    record->seq                = number[0];
+    record->rssi               = number[1];
+    record->rate               = number[2];
+    record->noise_floor        = number[3];
+    record->channel            = number[4];
+    record->local_timestamp    = number[5];
+    record->sig_len            = number[6];
+    record->rx_state           = number[7];
+    record->agc_gain           = agc_gain;
+    record->fft_gain           = fft_gain;
+    record->len                = csi_len;
+    record->first_word_invalid = first_word_invalid != 0;
+    record->payload_len        = payload_len;
+
+    csi_line_span_t timestamp = column[CSI_LINE_COL_TIMESTAMP];
+    size_t timestamp_len = timestamp.len < CSI_LINE_TIMESTAMP_MAX_LEN ? timestamp.len : CSI_LINE_TIMESTAMP_MAX_LEN - 1;
+    memcpy(record->timestamp, timestamp.ptr, timestamp_len);
+
+    return CSI_LINE_OK;
+}
+
+bool csi_line_reader_init(csi_line_reader_t *reader, void *storage, size_t size)
+{
+    if (!size || (size & (size - 1))) {
+        return false;
+    }
+
+    reader->buf            = storage;
+    reader->size           = size;
+    reader->head           = 0;
+    reader->tail           = 0;
+    reader->scan           = 0;
+    reader->discard        = false;
+    reader->line_count     = 0;
+    reader->overflow_count = 0;
+
+    return true;
+}
+
+char *csi_line_reader_write_ptr(csi_line_reader_t *reader, size_t *len)
+{
+    size_t offset = reader->head & (reader->size - 1);
+    size_t free_len = reader->size - (reader->head - reader->tail);
+
+    *len = reader->size - offset < free_len ? reader->size - offset : free_len;
+    return reader->buf + offset;
+}
+
+size_t csi_line_reader_commit(csi_line_reader_t *reader, size_t len, csi_line_cb_t cb, void *ctx)
+{
+    const size_t mask = reader->size - 1;
+    size_t count = 0;
+
+    reader->head += len;
+
+    while (reader->scan != reader->head) {
+        size_t offset = reader->scan & mask;
+        size_t n = reader->size - offset < reader->head - reader->scan ? reader->size - offset : reader->head - reader->scan;
+        const char *newline = memchr(reader->buf + offset, '\n', n);
+
+        if (!newline) {
+            reader->scan += n;
+            continue;
+        }
+
+        size_t end = reader->scan + (newline - (reader->buf + offset));
+
+        if (!reader->discard) {
+            size_t start = reader->tail & mask;
+            size_t line_len = end - reader->tail;
+
+            if (start + line_len > reader->size) {
+                // Wrapped around: move the part at the start of the ring behind its end
+                memcpy(reader->buf + reader->size, reader->buf, start + line_len - reader->size);
+            }
+
+            cb(reader->buf + start, line_len, ctx);
+            count++;
+        }
+
+        reader->discard = false;
+        reader->tail = reader->scan = end + 1;
+    }
+
+    /**
+     * @brief A full ring without a newline holds a line that can never be delivered
+     */
+    if (!reader->discard && reader->head - reader->tail == reader->size) {
+        reader->discard = true;
+        reader->overflow_count++;
+    }
+
+    if (reader->discard) {
+        reader->tail = reader->head;
+    }
+
+    reader->line_count += count;
+    return count;
+}
+
+size_t csi_line_reader_feed(csi_line_reader_t *reader, const char *data, size_t len,
+                            csi_line_cb_t cb, void *ctx)
+{
+    size_t count = 0;
+
+    while (len) {
+        size_t n;
+        char *ptr = csi_line_reader_write_ptr(reader, &n);
+
+        n = n < len ? n : len;
+        memcpy(ptr, data, n);
+        count += csi_line_reader_commit(reader, n, cb, ctx);
+        data += n;
+        len -= n;
+    }
+
+    return count;
+}
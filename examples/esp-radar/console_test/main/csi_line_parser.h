@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Reentrant parser for the `CSI_DATA` CSV lines replayed by esp_csi_tool.py
+ *
+ * A line is `CSI_DATA,seq,timestamp,taget_seq,taget,mac,rssi,...,len,first_word_invalid,data`
+ * with the I/Q payload base64 encoded in the last column. Both the 28 column
+ * layout and the 30 column layout with `agc_gain,fft_gain` are accepted.
+ *
+ * Nothing is allocated: csi_line_reader_t splits a byte stream into lines in a
+ * caller-provided circular buffer and csi_line_parse() decodes one line into a
+ * caller-provided record and payload buffer. Neither depends on ESP-IDF, so
+ * both build on a host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSI_LINE_TIMESTAMP_MAX_LEN  32
+
+/**
+ * @brief Result of parsing a line
+ */
+typedef enum {
+    CSI_LINE_OK = 0,                /**< record and payload are filled in */
+    CSI_LINE_SKIP,                  /**< Not a CSI_DATA line, e.g. a CSV header or log output */
+    CSI_LINE_INVALID,               /**< Too few columns, a malformed number or malformed base64 */
+    CSI_LINE_NO_MEM,                /**< The payload does not fit in the buffer */
+} csi_line_status_t;
+
+/**
+ * @brief Fields of a CSI_DATA line; columns a layout does not have are zero
+ */
+typedef struct {
+    uint32_t seq;
+    char     timestamp[CSI_LINE_TIMESTAMP_MAX_LEN]; /**< Wall-clock text of the recording, truncated */
+    int8_t   rssi;
+    uint8_t  rate;
+    int8_t   noise_floor;
+    uint8_t  channel;
+    uint32_t local_timestamp;       /**< rx_ctrl timestamp of the recorded packet, in microseconds */
+    uint16_t sig_len;
+    uint8_t  rx_state;
+    uint8_t  agc_gain;
+    int8_t   fft_gain;
+    uint16_t len;                   /**< Length of the recorded CSI buffer, as written in the line */
+    bool     first_word_invalid;
+    uint16_t payload_len;           /**< Bytes decoded from the data column */
+} csi_line_record_t;
+
+/**
+ * @brief Parse one line
+ *
+ * @param line         Line without the trailing newline, not necessarily NUL-terminated;
+ *                     a trailing '\r' and text before "CSI_DATA" are ignored
+ * @param len          Length of line
+ * @param record       Output record
+ * @param payload      Output buffer for the decoded data column
+ * @param payload_size Size of payload
+ */
+csi_line_status_t csi_line_parse(const char *line, size_t len, csi_line_record_t *record,
+                                 uint8_t *payload, size_t payload_size);
+
+typedef void (*csi_line_cb_t)(const char *line, size_t len, void *ctx);
+
+/**
+ * @brief Storage for a reader with a ring of `size` bytes: the ring itself, followed by room
+ *        to unwrap a line that wraps around the end of the ring
+ */
+#define CSI_LINE_READER_STORAGE_SIZE(size)  (2 * (size))
+
+/**
+ * @brief Circular receive buffer that splits a byte stream into lines
+ *
+ * Bytes are received straight into the ring (csi_line_reader_write_ptr() and
+ * csi_line_reader_commit()), the newline search resumes where the previous one
+ * stopped and complete lines are handed out in place. Only a line that wraps
+ * around the end of the ring is made contiguous, by copying its wrapped part
+ * behind the ring. Lines up to `size - 1` bytes are delivered, longer ones are
+ * dropped and counted.
+ */
+typedef struct {
+    char    *buf;
+    size_t   size;                   /**< Ring size, a power of two */
+    size_t   head;                   /**< Free-running write index */
+    size_t   tail;                   /**< Free-running index of the first byte of the pending line */
+    size_t   scan;                   /**< Free-running index where the newline search resumes */
+    bool     discard;                /**< Dropping the remainder of an over-long line */
+    uint32_t line_count;             /**< Lines delivered */
+    uint32_t overflow_count;         /**< Lines dropped for not fitting in the ring */
+} csi_line_reader_t;
+
+/**
+ * @param storage CSI_LINE_READER_STORAGE_SIZE(size) bytes
+ * @param size    Ring size, a power of two
+ *
+ * @return false if size is not a power of two
+ */
+bool csi_line_reader_init(csi_line_reader_t *reader, void *storage, size_t size);
+
+/**
+ * @brief Contiguous free space of the ring, e.g. to recv() into
+ *
+ * @param len Set to the number of bytes that can be written, never 0
+ */
+char *csi_line_reader_write_ptr(csi_line_reader_t *reader, size_t *len);
+
+/**
+ * @brief Account for `len` bytes written at csi_line_reader_write_ptr() and call cb for every
+ *        complete line, without its newline
+ *
+ * @return Number of lines delivered by this call
+ */
+size_t csi_line_reader_commit(csi_line_reader_t *reader, size_t len, csi_line_cb_t cb, void *ctx);
+
+/**
+ * @brief Copy bytes into the ring and commit them
+ *
+ * @return Number of lines delivered by this call
+ */
+size_t csi_line_reader_feed(csi_line_reader_t *reader, const char *data, size_t len,
+                            csi_line_cb_t cb, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,6 +15,7 @@
 #include <errno.h>
 #include <string.h>
 #include <stdio.h>
+#include <sys/param.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
@@ -29,92 +30,239 @@
 #include "lwip/netdb.h"
 #include "lwip/sockets.h"
 
-#include "mbedtls/base64.h"
 #include "esp_radar.h"
-
-#define RX_BUFFER_SIZE              1460
+#include "csi_line_parser.h"
+#include "csi_frame.h"
+
+#define RADAR_EVALUATE_RING_SIZE        2048    /**< Per-client receive ring, a power of two; bounds the line length */
+#define RADAR_EVALUATE_PAYLOAD_MAX_LEN  1024    /**< Largest decoded data column */
+/**
+ * @brief esp-radar runs a single detector and wifi_radar_cb reads the replay timestamp from a single
+ *        g_wifi_radar_cb_ctx, so two interleaved replays would mix their CSI in one detection window.
+ *        Connections beyond this are accepted and closed right away.
+ */
+#define RADAR_EVALUATE_CLIENT_MAX       1
 #define KEEPALIVE_IDLE              1
 #define KEEPALIVE_INTERVAL          1
 #define KEEPALIVE_COUNT             3
-typedef union {
-    struct  {
-        const char *type;
-        const char *id;
-        const char *timestamp;
-        const char *action_id;
-        const char *action;
-        const char *mac;
-        const char *rssi;
-        const char *rate;
-        const char *sig_mode;
-        const char *mcs;
-        const char *bandwidth;
-        const char *smoothing;
-        const char *not_sounding;
-        const char *aggregation;
-        const char *stbc;
-        const char *fec_coding;
-        const char *sgi;
-        const char *noise_floor;
-        const char *ampdu_cnt;
-        const char *channel;
-        const char *secondary_channel;
-        const char *local_timestamp;
-        const char *ant;
-        const char *sig_len;
-        const char *rx_state;
-        const char *len;
-        const char *first_word;
-        const char *data;
-    };
-    const char *data_array[28];
-} csi_data_str_t;
-
 static char *TAG = "radar_evaluate";
-static char g_wifi_radar_cb_ctx[32] = {0};
+static char g_wifi_radar_cb_ctx[CSI_LINE_TIMESTAMP_MAX_LEN] = {0};
 static TaskHandle_t g_tcp_server_task_handle = NULL;
 
-static void csi_info_analysis(char *data, size_t size)
+/**
+ * @brief Replay formats, told apart by the first byte a client sends
+ */
+typedef enum {
+    RADAR_EVALUATE_FORMAT_UNKNOWN = 0,
+    RADAR_EVALUATE_FORMAT_TEXT,         /**< CSI_DATA CSV lines with base64 data, see csi_line_parser.h */
+    RADAR_EVALUATE_FORMAT_BINARY,       /**< CSI_FRAME_TYPE_REPLAY frames, starting with CSI_FRAME_SYNC0 */
+} radar_evaluate_format_t;
+
+/**
+ * @brief Per-connection state, a decoded text payload lands in `slot` before it is handed to esp-radar
+ */
+typedef struct {
+    int sock;
+    char addr_str[16];
+    radar_evaluate_format_t format;
+    union {
+        csi_line_reader_t reader;       /**< RADAR_EVALUATE_FORMAT_TEXT */
+        csi_frame_decoder_t decoder;    /**< RADAR_EVALUATE_FORMAT_BINARY */
+    };
+    char ring[CSI_LINE_READER_STORAGE_SIZE(RADAR_EVALUATE_RING_SIZE)];  /**< Text: the reader's ring, binary: receive buffer */
+    uint32_t invalid_count;
+    wifi_csi_filtered_info_t slot;      /**< Followed by RADAR_EVALUATE_PAYLOAD_MAX_LEN bytes of valid_data */
+} radar_evaluate_ctx_t;
+
+static void radar_evaluate_push(const char *timestamp, size_t timestamp_len, uint32_t local_timestamp,
+                                const void *data, size_t len)
 {
-    uint8_t column = 0;
-    const char *s = ",";
-    char *token   = NULL;
-    csi_data_str_t *csi_data = malloc(sizeof(csi_data_str_t));
+    /**
+     * @brief csi_data_push() takes ownership of the buffer and frees it once the radar task has consumed it,
+     *        so the record is copied into an allocation of the exact size
+     */
+    wifi_csi_filtered_info_t *filtered_info = malloc(sizeof(wifi_csi_filtered_info_t) + len);
+
+    if (!filtered_info) {
+        ESP_LOGW(TAG, "<%s> malloc filtered_info", esp_err_to_name(ESP_ERR_NO_MEM));
+        return;
+    }
+
+    memset(filtered_info, 0, sizeof(wifi_csi_filtered_info_t));
+    filtered_info->rx_ctrl_info.timestamp = local_timestamp;
+    filtered_info->valid_len = len;
+    memcpy(filtered_info->valid_data, data, len);
+
+    timestamp_len = MIN(strnlen(timestamp, timestamp_len), sizeof(g_wifi_radar_cb_ctx) - 1);
+    memcpy(g_wifi_radar_cb_ctx, timestamp, timestamp_len);
+    g_wifi_radar_cb_ctx[timestamp_len] = '\0';
+
+    extern esp_err_t csi_data_push(wifi_csi_filtered_info_t *info);
+    csi_data_push(filtered_info);
+}
 
-    token = strtok(data, s);
+static void csi_line_cb(const char *line, size_t len, void *arg)
+{
+    radar_evaluate_ctx_t *ctx = arg;
+    csi_line_record_t record;
+    csi_line_status_t ret = csi_line_parse(line, len, &record, (uint8_t *)ctx->slot.valid_data, RADAR_EVALUATE_PAYLOAD_MAX_LEN);
 
-    do {
-        csi_data->data_array[column++] = token;
-        token = strtok(NULL, s);
-    } while (token != NULL && column < 28);
+    if (ret == CSI_LINE_SKIP) {
+        return;
+    } else if (ret != CSI_LINE_OK) {
+        if (!(ctx->invalid_count++ % 100)) {
+            ESP_LOGW(TAG, "<%d> csi_line_parse, %u invalid lines", ret, (unsigned int)ctx->invalid_count);
+        }
 
-    if (token != NULL) {
-        ESP_LOGE(TAG, "data error, temp_data: %s", data);
+        return;
     }
 
-    wifi_csi_filtered_info_t *filtered_info = malloc(sizeof(wifi_csi_filtered_info_t) + 52 * 2);
-    mbedtls_base64_decode((uint8_t *)filtered_info->valid_data, 52 * 2, (size_t *)&filtered_info->valid_len, (uint8_t *)csi_data->data, strlen(csi_data->data));
-    filtered_info->rx_ctrl_info.timestamp = atoi(csi_data->local_timestamp);
-    strcpy(g_wifi_radar_cb_ctx, csi_data->timestamp);
-    // ESP_LOGI(TAG,"count: %s, timestamp: %d", csi_data->id, filtered_info->rx_ctrl.timestamp);
+    radar_evaluate_push(record.timestamp, sizeof(record.timestamp), record.local_timestamp,
+                        ctx->slot.valid_data, record.payload_len);
+}
 
-    extern esp_err_t csi_data_push(wifi_csi_filtered_info_t *info);
-    csi_data_push(filtered_info);
+static void csi_frame_cb(const csi_frame_header_t *header, const uint8_t *payload, void *arg)
+{
+    radar_evaluate_ctx_t *ctx = arg;
+
+    if (header->type != CSI_FRAME_TYPE_REPLAY || header->payload_len < CSI_FRAME_REPLAY_TIMESTAMP_LEN) {
+        if (!(ctx->invalid_count++ % 100)) {
+            ESP_LOGW(TAG, "Unexpected frame type %d, %u invalid frames", header->type, (unsigned int)ctx->invalid_count);
+        }
 
-    free(csi_data);
+        return;
+    }
+
+    radar_evaluate_push((const char *)payload, CSI_FRAME_REPLAY_TIMESTAMP_LEN, header->timestamp,
+                        payload + CSI_FRAME_REPLAY_TIMESTAMP_LEN, header->payload_len - CSI_FRAME_REPLAY_TIMESTAMP_LEN);
 }
 
-static void tcp_server_task(void *arg)
+static void radar_evaluate_set_cb_ctx(void *cb_ctx)
+{
+    esp_radar_config_t radar_config = {0};
+    esp_radar_get_config(&radar_config);
+    radar_config.dec_config.wifi_radar_cb_ctx = cb_ctx;
+    esp_radar_change_config(&radar_config);
+}
+
+static radar_evaluate_ctx_t *radar_evaluate_client_open(int listen_sock)
 {
-    char addr_str[128];
-    int addr_family = AF_INET;
-    int ip_protocol = 0;
     int keepAlive = 1;
     int keepIdle = KEEPALIVE_IDLE;
     int keepInterval = KEEPALIVE_INTERVAL;
     int keepCount = KEEPALIVE_COUNT;
+    struct sockaddr_storage source_addr; // Large enough for both IPv4 or IPv6
+    socklen_t addr_len = sizeof(source_addr);
+    int sock = accept(listen_sock, (struct sockaddr *)&source_addr, &addr_len);
+
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
+        return NULL;
+    }
+
+    radar_evaluate_ctx_t *ctx = malloc(sizeof(radar_evaluate_ctx_t) + RADAR_EVALUATE_PAYLOAD_MAX_LEN);
+
+    if (!ctx) {
+        ESP_LOGE(TAG, "<%s> malloc radar_evaluate_ctx_t", esp_err_to_name(ESP_ERR_NO_MEM));
+        close(sock);
+        return NULL;
+    }
+
+    // Set tcp keepalive option
+    setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(int));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &keepIdle, sizeof(int));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &keepInterval, sizeof(int));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &keepCount, sizeof(int));
+
+    ctx->sock = sock;
+    ctx->format = RADAR_EVALUATE_FORMAT_UNKNOWN;
+    ctx->invalid_count = 0;
+    ctx->addr_str[0] = '\0';
+
+    // Convert ip address to string
+    if (source_addr.ss_family == PF_INET) {
+        inet_ntoa_r(((struct sockaddr_in *)&source_addr)->sin_addr, ctx->addr_str, sizeof(ctx->addr_str) - 1);
+    }
+
+    ESP_LOGI(TAG, "Socket accepted ip address: %s", ctx->addr_str);
+
+    return ctx;
+}
+
+static void radar_evaluate_client_close(radar_evaluate_ctx_t *ctx)
+{
+    if (ctx->format == RADAR_EVALUATE_FORMAT_TEXT) {
+        ESP_LOGI(TAG, "lines: %u, invalid: %u, too long: %u", (unsigned int)ctx->reader.line_count,
+                 (unsigned int)ctx->invalid_count, (unsigned int)ctx->reader.overflow_count);
+    } else if (ctx->format == RADAR_EVALUATE_FORMAT_BINARY) {
+        ESP_LOGI(TAG, "frames: %u, invalid: %u, corrupted: %u", (unsigned int)ctx->decoder.frame_count,
+                 (unsigned int)ctx->invalid_count, (unsigned int)ctx->decoder.error_count);
+    }
+
+    ESP_LOGW(TAG, "Socket close: %s", ctx->addr_str);
+
+    shutdown(ctx->sock, 0);
+    close(ctx->sock);
+    free(ctx);
+}
+
+/**
+ * @brief Receive and parse, text in place in the client's ring, binary frames through the frame decoder
+ *
+ * @return false once the connection is closed or failed
+ */
+static bool radar_evaluate_client_recv(radar_evaluate_ctx_t *ctx)
+{
+    size_t free_len = RADAR_EVALUATE_RING_SIZE;
+    char *ptr = ctx->ring;
+
+    if (ctx->format == RADAR_EVALUATE_FORMAT_TEXT) {
+        ptr = csi_line_reader_write_ptr(&ctx->reader, &free_len);
+    }
+
+    int len = recv(ctx->sock, ptr, free_len, 0);
+
+    if (len < 0) {
+        ESP_LOGE(TAG, "Error occurred during receiving: errno %d", errno);
+        return false;
+    } else if (len == 0) {
+        ESP_LOGW(TAG, "Connection closed");
+        return false;
+    }
+
+    /**
+     * @brief The first bytes were received at the start of the ring, which is also where
+     *        a freshly initialized line reader expects them
+     */
+    if (ctx->format == RADAR_EVALUATE_FORMAT_UNKNOWN) {
+        if ((uint8_t)ptr[0] == CSI_FRAME_SYNC0) {
+            ctx->format = RADAR_EVALUATE_FORMAT_BINARY;
+            csi_frame_decoder_init(&ctx->decoder);
+        } else {
+            ctx->format = RADAR_EVALUATE_FORMAT_TEXT;
+            csi_line_reader_init(&ctx->reader, ctx->ring, RADAR_EVALUATE_RING_SIZE);
+        }
+
+        ESP_LOGI(TAG, "%s: %s replay", ctx->addr_str, ctx->format == RADAR_EVALUATE_FORMAT_BINARY ? "binary" : "text");
+    }
+
+    if (ctx->format == RADAR_EVALUATE_FORMAT_BINARY) {
+        csi_frame_decoder_feed(&ctx->decoder, (const uint8_t *)ptr, len, csi_frame_cb, ctx);
+    } else {
+        csi_line_reader_commit(&ctx->reader, len, csi_line_cb, ctx);
+    }
+
+    return true;
+}
+
+static void tcp_server_task(void *arg)
+{
+    int addr_family = AF_INET;
+    int ip_protocol = 0;
     struct sockaddr_storage dest_addr;
     uint32_t port = (uint32_t)arg;
+    radar_evaluate_ctx_t *clients[RADAR_EVALUATE_CLIENT_MAX] = {NULL};
+    int client_count = 0;
 
     if (addr_family == AF_INET) {
         struct sockaddr_in *dest_addr_ip4 = (struct sockaddr_in *)&dest_addr;
@@ -147,96 +295,80 @@ static void tcp_server_task(void *arg)
 
     ESP_LOGI(TAG, "Socket bound, port %d", port);
 
-    err = listen(listen_sock, 1);
+    err = listen(listen_sock, RADAR_EVALUATE_CLIENT_MAX);
 
     if (err != 0) {
         ESP_LOGE(TAG, "Error occurred during listen: errno %d", errno);
         goto CLEAN_UP;
     }
 
-    while (1) {
-        ESP_LOGI(TAG, "Socket listening");
-        struct sockaddr_storage source_addr; // Large enough for both IPv4 or IPv6
-        socklen_t addr_len = sizeof(source_addr);
-        int sock = accept(listen_sock, (struct sockaddr *)&source_addr, &addr_len);
+    ESP_LOGI(TAG, "Socket listening");
 
-        if (sock < 0) {
-            ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
-            break;
-        }
+    while (1) {
+        fd_set read_fds;
+        int max_fd = listen_sock;
 
-        // Set tcp keepalive option
-        setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(int));
-        setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &keepIdle, sizeof(int));
-        setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &keepInterval, sizeof(int));
-        setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &keepCount, sizeof(int));
+        FD_ZERO(&read_fds);
+        FD_SET(listen_sock, &read_fds);
 
-        // Convert ip address to string
-        if (source_addr.ss_family == PF_INET) {
-            inet_ntoa_r(((struct sockaddr_in *)&source_addr)->sin_addr, addr_str, sizeof(addr_str) - 1);
+        for (int i = 0; i < RADAR_EVALUATE_CLIENT_MAX; i++) {
+            if (clients[i]) {
+                FD_SET(clients[i]->sock, &read_fds);
+                max_fd = MAX(max_fd, clients[i]->sock);
+            }
         }
 
-        ESP_LOGI(TAG, "Socket accepted ip address: %s", addr_str);
-
-        int len;
-        char *rx_buffer = malloc(RX_BUFFER_SIZE);
-        size_t buf_size = 0;
-
-        esp_radar_config_t radar_config = {0};
-        esp_radar_get_config(&radar_config);
-        radar_config.dec_config.wifi_radar_cb_ctx = g_wifi_radar_cb_ctx;
-        esp_radar_change_config(&radar_config);
-
-        do {
-            len = recv(sock, rx_buffer + buf_size, RX_BUFFER_SIZE - buf_size - 1, 0);
-
-            // ESP_LOGW(TAG, "len: %d, rx_buffer: %s", len, rx_buffer);
-            if (len < 0) {
-                ESP_LOGE(TAG, "Error occurred during receiving: errno %d", errno);
-
-            } else if (len == 0) {
-                ESP_LOGW(TAG, "Connection closed");
-            } else {
-                buf_size += len;
-                rx_buffer[buf_size] = 0; // Null-terminate whatever is received and treat it like a string
-                // ESP_LOGI(TAG, "Received %d, buf_size: %d", len, buf_size);
+        if (select(max_fd + 1, &read_fds, NULL, NULL, NULL) < 0) {
+            ESP_LOGE(TAG, "Error occurred during select: errno %d", errno);
+            break;
+        }
 
-                while (buf_size > 250) {
-                    char *begin = strstr(rx_buffer, "CSI_DATA");
-                    char *end   = strstr(rx_buffer, "\n");
-                    ssize_t size  = end - begin;
+        for (int i = 0; i < RADAR_EVALUATE_CLIENT_MAX; i++) {
+            if (!clients[i] || !FD_ISSET(clients[i]->sock, &read_fds)) {
+                continue;
+            }
 
-                    // ESP_LOGW("TAG", "begin: %p, end: %p, size: %d", begin, end, size);
-                    // ESP_LOGW(TAG, "size: %d, received: %d, buf_size: %d", size, len, buf_size);
+            if (!radar_evaluate_client_recv(clients[i])) {
+                radar_evaluate_client_close(clients[i]);
+                clients[i] = NULL;
 
-                    if (begin && end && size > 250) {
-                        begin[size] = '\0';
-                        csi_info_analysis(begin, size);
-                    }
+                if (!--client_count) {
+                    // Let the radar task drain what was pushed before detaching the timestamp context
+                    vTaskDelay(pdMS_TO_TICKS(1000));
+                    radar_evaluate_set_cb_ctx(NULL);
+                }
+            }
+        }
 
-                    if (end) {
-                        buf_size -= (end + 1 - rx_buffer);
-                        memcpy(rx_buffer, end + 1, buf_size);
-                        memset(rx_buffer + buf_size, 0, end + 1 - rx_buffer);
-                    }
+        if (FD_ISSET(listen_sock, &read_fds)) {
+            radar_evaluate_ctx_t *ctx = radar_evaluate_client_open(listen_sock);
 
-                    if (begin && !end) {
+            if (ctx && client_count == RADAR_EVALUATE_CLIENT_MAX) {
+                ESP_LOGW(TAG, "%s: rejected, %d replay client(s) already connected", ctx->addr_str, client_count);
+                radar_evaluate_client_close(ctx);
+            } else if (ctx) {
+                for (int i = 0; i < RADAR_EVALUATE_CLIENT_MAX; i++) {
+                    if (!clients[i]) {
+                        clients[i] = ctx;
                         break;
                     }
                 }
-            }
-        } while (len > 0);
 
-        shutdown(sock, 0);
-        close(sock);
-        free(rx_buffer);
+                if (!client_count++) {
+                    radar_evaluate_set_cb_ctx(g_wifi_radar_cb_ctx);
+                }
+            }
+        }
+    }
 
-        ESP_LOGW(TAG, "Socket close: %s", addr_str);
+    for (int i = 0; i < RADAR_EVALUATE_CLIENT_MAX; i++) {
+        if (clients[i]) {
+            radar_evaluate_client_close(clients[i]);
+        }
+    }
 
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        esp_radar_get_config(&radar_config);
-        radar_config.dec_config.wifi_radar_cb_ctx = NULL;
-        esp_radar_change_config(&radar_config);
+    if (client_count) {
+        radar_evaluate_set_cb_ctx(NULL);
     }
 
 CLEAN_UP:
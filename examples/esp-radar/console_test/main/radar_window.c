@@ -0,0 +1,265 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "radar_window.h"
+
+#define RADAR_WINDOW_NIL            0xffff
+
+static inline uint16_t radar_window_count(const radar_window_t *window, uint16_t n)
+{
+    return n == RADAR_WINDOW_NIL ? 0 : window->nodes[n].count;
+}
+
+static inline float radar_window_sum(const radar_window_t *window, uint16_t n)
+{
+    return n == RADAR_WINDOW_NIL ? 0 : window->nodes[n].sum;
+}
+
+static inline void radar_window_update(radar_window_t *window, uint16_t n)
+{
+    radar_window_node_t *node = &window->nodes[n];
+
+    node->count = radar_window_count(window, node->left) + 1 + radar_window_count(window, node->right);
+    node->sum   = radar_window_sum(window, node->left) + node->value + radar_window_sum(window, node->right);
+}
+
+/**
+ * @brief Equal values are ordered by node index, so every node has a unique key and can be found again on eviction
+ */
+static inline bool radar_window_less(const radar_window_t *window, uint16_t a, uint16_t b)
+{
+    float value_a = window->nodes[a].value;
+    float value_b = window->nodes[b].value;
+
+    return value_a < value_b || (value_a == value_b && a < b);
+}
+
+/**
+ * @brief Split subtree t into the nodes ordered before key and the nodes ordered after it
+ */
+static void radar_window_split(radar_window_t *window, uint16_t t, uint16_t key, uint16_t *left, uint16_t *right)
+{
+    if (t == RADAR_WINDOW_NIL) {
+        *left  = RADAR_WINDOW_NIL;
+        *right = RADAR_WINDOW_NIL;
+        return;
+    }
+
+    radar_window_node_t *node = &window->nodes[t];
+
+    if (radar_window_less(window, t, key)) {
+        radar_window_split(window, node->right, key, &node->right, right);
+        *left = t;
+    } else {
+        radar_window_split(window, node->left, key, left, &node->left);
+        *right = t;
+    }
+
+    radar_window_update(window, t);
+}
+
+/**
+ * @brief Join two subtrees, every node of a is ordered before every node of b
+ */
+static uint16_t radar_window_merge(radar_window_t *window, uint16_t a, uint16_t b)
+{
+    if (a == RADAR_WINDOW_NIL) {
+        return b;
+    } else if (b == RADAR_WINDOW_NIL) {
+        return a;
+    }
+
+    if (window->nodes[a].priority > window->nodes[b].priority) {
+        window->nodes[a].right = radar_window_merge(window, window->nodes[a].right, b);
+        radar_window_update(window, a);
+        return a;
+    }
+
+    window->nodes[b].left = radar_window_merge(window, a, window->nodes[b].left);
+    radar_window_update(window, b);
+    return b;
+}
+
+static uint16_t radar_window_insert(radar_window_t *window, uint16_t t, uint16_t n)
+{
+    if (t == RADAR_WINDOW_NIL) {
+        return n;
+    }
+
+    radar_window_node_t *node = &window->nodes[t];
+
+    if (window->nodes[n].priority > node->priority) {
+        radar_window_split(window, t, n, &window->nodes[n].left, &window->nodes[n].right);
+        radar_window_update(window, n);
+        return n;
+    }
+
+    if (radar_window_less(window, n, t)) {
+        node->left = radar_window_insert(window, node->left, n);
+    } else {
+        node->right = radar_window_insert(window, node->right, n);
+    }
+
+    radar_window_update(window, t);
+    return t;
+}
+
+static uint16_t radar_window_erase(radar_window_t *window, uint16_t t, uint16_t n)
+{
+    radar_window_node_t *node = &window->nodes[t];
+
+    if (t == n) {
+        return radar_window_merge(window, node->left, node->right);
+    }
+
+    if (radar_window_less(window, n, t)) {
+        node->left = radar_window_erase(window, node->left, n);
+    } else {
+        node->right = radar_window_erase(window, node->right, n);
+    }
+
+    radar_window_update(window, t);
+    return t;
+}
+
+/**
+ * @brief Sum of the `k` smallest values
+ */
+static float radar_window_prefix_sum(const radar_window_t *window, size_t k)
+{
+    float sum  = 0;
+    uint16_t t = window->root;
+
+    while (t != RADAR_WINDOW_NIL && k) {
+        const radar_window_node_t *node = &window->nodes[t];
+        size_t left_count = radar_window_count(window, node->left);
+
+        if (k <= left_count) {
+            t = node->left;
+        } else {
+            sum += radar_window_sum(window, node->left) + node->value;
+            k   -= left_count + 1;
+            t    = node->right;
+        }
+    }
+
+    return sum;
+}
+
+bool radar_window_init(radar_window_t *window, radar_window_node_t *nodes, size_t capacity)
+{
+    if (!capacity || capacity > RADAR_WINDOW_MAX_CAPACITY) {
+        return false;
+    }
+
+    window->nodes    = nodes;
+    window->capacity = capacity;
+    window->root     = RADAR_WINDOW_NIL;
+    window->count    = 0;
+    window->oldest   = 0;
+    window->seed     = 0x9e3779b9;
+
+    return true;
+}
+
+void radar_window_push(radar_window_t *window, float value)
+{
+    uint16_t n;
+
+    /**
+     * @brief Nodes are used in arrival order, so once the window is full
+     *        the node to reuse is always the oldest one
+     */
+    if (window->count < window->capacity) {
+        n = window->count++;
+    } else {
+        n = window->oldest;
+        window->root   = radar_window_erase(window, window->root, n);
+        window->oldest = (window->oldest + 1) % window->capacity;
+    }
+
+    /**
+     * @brief xorshift32 priorities keep the treap balanced in expectation
+     */
+    window->seed ^= window->seed << 13;
+    window->seed ^= window->seed >> 17;
+    window->seed ^= window->seed << 5;
+
+    radar_window_node_t *node = &window->nodes[n];
+    node->value    = value;
+    node->priority = window->seed;
+    node->left     = RADAR_WINDOW_NIL;
+    node->right    = RADAR_WINDOW_NIL;
+    radar_window_update(window, n);
+
+    window->root = radar_window_insert(window, window->root, n);
+}
+
+float radar_window_select(const radar_window_t *window, size_t index)
+{
+    uint16_t t = window->root;
+
+    while (t != RADAR_WINDOW_NIL) {
+        const radar_window_node_t *node = &window->nodes[t];
+        size_t left_count = radar_window_count(window, node->left);
+
+        if (index < left_count) {
+            t = node->left;
+        } else if (index == left_count) {
+            return node->value;
+        } else {
+            index -= left_count + 1;
+            t      = node->right;
+        }
+    }
+
+    return 0;
+}
+
+float radar_window_median(const radar_window_t *window)
+{
+    size_t count = window->count;
+
+    if (!count) {
+        return 0;
+    } else if (count % 2) {
+        return radar_window_select(window, count / 2);
+    }
+
+    return (radar_window_select(window, count / 2 - 1) + radar_window_select(window, count / 2)) / 2;
+}
+
+float radar_window_trimmean(const radar_window_t *window, float percent)
+{
+    size_t count = window->count;
+
+    if (!(percent > 0)) {
+        percent = 0;
+    }
+
+    /**
+     * esp-radar's trimmean(): the sorted values of index [count * percent / 2, count * (1 - percent / 2)),
+     * bounds in float, divided by count * (1 - percent) rather than by how many were summed
+     */
+    size_t first = (size_t)(count * percent / 2);
+    float end = count * (1 - percent / 2);
+    size_t last = (size_t)end;
+    float divisor = count * (1 - percent);
+
+    if (last < end) {
+        last++;
+    }
+
+    if (!count) {
+        return 0;
+    } else if (!(divisor > 0) || last > count || last <= first) {
+        return radar_window_median(window);
+    }
+
+    float sum = radar_window_prefix_sum(window, last) - radar_window_prefix_sum(window, first);
+
+    return sum / divisor;
+}
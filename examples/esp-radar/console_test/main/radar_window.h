@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Sliding window of the most recent radar values with order statistics
+ *
+ * The values are kept in a treap keyed by value, in a caller-provided node
+ * array, and every node carries the size and sum of its subtree. Pushing a
+ * value evicts the oldest one once the window is full; both are O(log n)
+ * expected. The median is one or two O(log n) rank selections and the
+ * trimmed mean two O(log n) prefix sums, so neither depends on how many
+ * values are trimmed and nothing is sorted per frame.
+ *
+ * No ESP-IDF dependency, the window builds on a host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RADAR_WINDOW_MAX_CAPACITY   0xfffe
+
+typedef struct {
+    float    value;
+    float    sum;                   /**< Sum of the values in this subtree */
+    uint32_t priority;
+    uint16_t left;
+    uint16_t right;
+    uint16_t count;                 /**< Number of nodes in this subtree */
+} radar_window_node_t;
+
+typedef struct {
+    radar_window_node_t *nodes;     /**< `capacity` nodes, also the ring of values in arrival order */
+    uint16_t capacity;
+    uint16_t root;
+    uint16_t count;                 /**< Values in the window, up to capacity */
+    uint16_t oldest;                /**< Node evicted by the next push once the window is full */
+    uint32_t seed;                  /**< State of the priority generator */
+} radar_window_t;
+
+/**
+ * @param nodes    Storage for `capacity` nodes
+ * @param capacity 1 ~ RADAR_WINDOW_MAX_CAPACITY
+ *
+ * @return false if capacity is out of range
+ */
+bool radar_window_init(radar_window_t *window, radar_window_node_t *nodes, size_t capacity);
+
+/**
+ * @brief Add a value, evicting the oldest one if the window is full
+ *
+ * @note NaN is not ordered and must not be pushed
+ */
+void radar_window_push(radar_window_t *window, float value);
+
+/**
+ * @brief Value of rank `index` in ascending order, index < count
+ */
+float radar_window_select(const radar_window_t *window, size_t index);
+
+/**
+ * @brief Median, the mean of the two middle values for an even count, 0 for an empty window
+ */
+float radar_window_median(const radar_window_t *window);
+
+/**
+ * @brief Trimmed mean by the rule of esp-radar's trimmean(), which wifi_radar_cb() thresholds were tuned on
+ *
+ * The sorted values of index floor(n * percent / 2) up to, excluding, ceil(n * (1 - percent / 2)) are
+ * summed and divided by n * (1 - percent). When n * percent / 2 is not whole, one value more is summed
+ * than the divisor counts: for 25 values and 0.5 the middle 13 are divided by 12.5.
+ *
+ * @param percent Fraction of the values excluded in total, 0 ~ 1; 0.5 averages the middle half.
+ *                Negative is taken as 0. From 1 on, where trimmean() divides by zero, the median.
+ *
+ * @return 0 for an empty window
+ */
+float radar_window_trimmean(const radar_window_t *window, float percent);
+
+#ifdef __cplusplus
+}
+#endif
@@ -33,6 +33,8 @@ from PyQt5.QtCore import QDate, QDate, QTime, QDateTime
 
 import threading
 import base64
+import binascii
+import struct
 import time
 from datetime import datetime
 from multiprocessing import Process, Queue
@@ -41,6 +43,11 @@ from PyQt5.QtWidgets import QApplication, QMainWindow, QMessageBox
 # from PyQt5.QtChart import QChart, QLineSeries,QValueAxis
 from esp_csi_tool_gui import Ui_MainWindow
 
+sys.path.insert(0, path.join(path.dirname(path.abspath(__file__)), '../../../../tools/csi_ingest'))
+from csi_ingest import decode_base64
+from csi_ring import RingBuffer
+from csi_capture import CaptureReader, CaptureWriter
+
 from scipy import signal
 import signal as signal_key
 import socket
@@ -83,12 +90,12 @@ RADAR_DATA_COLUMNS_NAMES = ['type', 'seq', 'timestamp',
                             'waveform_wander', 'wander_average', 'waveform_wander_threshold', 'someone_status',
                             'waveform_jitter', 'jitter_midean', 'waveform_jitter_threshold', 'move_status']
 
-g_csi_amplitude_array = np.zeros(
-    [CSI_DATA_INDEX, CSI_DATA_COLUMNS], dtype=np.int32)
-g_rssi_array = np.zeros(CSI_DATA_INDEX, dtype=np.int8)
+# Ring buffers filled by DataHandleThread, read oldest row first through snapshot()
+g_csi_amplitude_array = RingBuffer(CSI_DATA_INDEX, CSI_DATA_COLUMNS, dtype=np.int32)
+g_rssi_array = RingBuffer(CSI_DATA_INDEX, dtype=np.int8)
 # 使用 object 类型以支持混合数据类型（字符串、数字、时间戳等）
-g_radio_header_pd = pd.DataFrame(np.empty([10, len(
-    CSI_DATA_COLUMNS_NAMES[1:-1])], dtype=object), columns=CSI_DATA_COLUMNS_NAMES[1:-1])
+RADIO_HEADER_COLUMNS_NAMES = CSI_DATA_COLUMNS_NAMES[1:-1]
+g_radio_header_array = RingBuffer(10, len(RADIO_HEADER_COLUMNS_NAMES), dtype=object, fill=None)
 
 RADAR_STATUS_RECORD = ['room', 'human', 'spend_time', 'start_time', 'stop_time']
 g_status_record_pd = pd.DataFrame(np.zeros(
@@ -128,51 +135,15 @@ g_display_radar_model = False
 g_display_eigenvalues_table = False
 
 def base64_decode_bin(str_data):
+    # Decoded up to the first character outside the base64 alphabet, which drops
+    # log text glued to the data column (e.g. "->valid_len: 104")
     try:
-        # 清理数据：移除换行符、回车符、空格等无效字符
-        str_data = str(str_data).strip().replace('\n', '').replace('\r', '').replace(' ', '')
-
-        # 如果数据包含日志信息（如 "->valid_len: 104"），只取 base64 部分
-        # 使用更智能的方式检测日志信息：查找常见的日志模式
-        # 例如：">valid_len", ": 104", "(120933)" 等
-        log_patterns = [
-            r'->valid_len',
-            r':\s*\d+',  # 冒号后跟数字（如 ": 104"）
-            r'\(\d+\)',  # 括号中的数字（如 "(120933)"）
-            r'[DIWE]\s*\(',  # 日志级别（如 "I ("）
-        ]
-
-        # 查找日志模式的起始位置，只保留 base64 部分
-        min_log_start = len(str_data)
-        for pattern in log_patterns:
-            import re
-            match = re.search(pattern, str_data)
-            if match:
-                min_log_start = min(min_log_start, match.start())
-
-        # 如果找到日志信息，只保留 base64 部分（至少保留一定长度，避免误判）
-        if min_log_start < len(str_data) and min_log_start > 10:
-            str_data = str_data[:min_log_start]
-
-        # 如果数据长度不是4的倍数，尝试添加填充
-        missing_padding = len(str_data) % 4
-        if missing_padding:
-            str_data += '=' * (4 - missing_padding)
-
-        bin_data = base64.b64decode(str_data, validate=True)
+        return decode_base64(str(str_data).replace('\n', '').replace('\r', '').replace(' ', ''))
     except Exception as e:
-        print(f'Exception: {e}, data: {str_data[:100]}')
+        print(f'Exception: {e}, data: {str(str_data)[:100]}')
         # 解码失败时返回空列表，避免后续错误
         return []
 
-    list_data = list(bin_data)
-
-    for i in range(len(list_data)):
-        if list_data[i] > 127:
-            list_data[i] = list_data[i] - 256
-
-    return list_data
-
 
 def base64_encode_bin(list_data):
     for i in range(len(list_data)):
@@ -193,7 +164,105 @@ def get_label(folder_path):
     return parts[-1]
 
 
-def evaluate_data_send(serial_queue_write, folder_path):
+CSI_FRAME_HEADER = struct.Struct('<2BBBHHII6sbbBBBBBBBBHBBbBBBf')
+CSI_FRAME_TYPE_REPLAY = 2
+CSI_FRAME_REPLAY_TIMESTAMP_LEN = 32
+
+
+def csi_raw_data_int8(csi_raw_data):
+    """
+    Recorded CSI values as int8, raises ValueError for values outside -128..127 instead of wrapping them around
+    """
+    values = np.asarray(csi_raw_data, dtype=np.int64)
+    if values.size and (values.min() < -128 or values.max() > 127):
+        raise ValueError(f'CSI values {values.min()}..{values.max()} outside the int8 range')
+
+    return values.astype(np.int8)
+
+
+def csi_replay_frame_pack(data_series, csi_raw_data):
+    """
+    Pack one recorded CSI_DATA row as a binary replay frame, see components/csi_frame/include/csi_frame.h:
+    header, the timestamp text NUL-padded to 32 bytes, the raw I/Q bytes and a CRC-16/CCITT-FALSE
+    """
+    timestamp = str(data_series['timestamp']).encode('utf-8')[:CSI_FRAME_REPLAY_TIMESTAMP_LEN - 1]
+    payload = timestamp.ljust(CSI_FRAME_REPLAY_TIMESTAMP_LEN, b'\0') + csi_raw_data_int8(csi_raw_data).tobytes()
+    mac = bytes(int(value, 16) for value in str(data_series['mac']).split(':'))
+    flags = (int(data_series['first_word_invalid']) & 1)
+
+    header = CSI_FRAME_HEADER.pack(
+        0xC5, 0x1F, 1, CSI_FRAME_TYPE_REPLAY,
+        CSI_FRAME_HEADER.size + len(payload) + 2, len(payload),
+        int(data_series['seq']) & 0xffffffff, int(data_series['local_timestamp']) & 0xffffffff, mac,
+        int(data_series['rssi']), int(data_series['noise_floor']), int(data_series['rate']),
+        int(data_series['sig_mode']), int(data_series['mcs']), int(data_series['cwb']),
+        int(data_series['channel_primary']), int(data_series['channel_secondary']),
+        int(data_series['stbc']), int(data_series['sgi']), int(data_series['sig_len']),
+        int(data_series['rx_state']), int(data_series.get('agc_gain', 0)), int(data_series.get('fft_gain', 0)),
+        flags, int(data_series['ampdu_cnt']), 0, 1.0)
+    frame = header + payload
+
+    return frame + struct.pack('<H', binascii.crc_hqx(frame, 0xffff))
+
+
+CSI_FRAME_MISC_BITS = {'smoothing': 0, 'not_sounding': 1, 'aggregation': 2, 'fec_coding': 3}
+CSI_FRAME_MISC_ANT_SHIFT = 4
+CSI_TIMESTAMP_FORMAT = '%Y-%m-%d %H:%M:%S.%f'
+
+
+def csi_capture_append(capture, data_series, csi_raw_data):
+    """
+    Append one CSI_DATA row to a target capture, see tools/csi_ingest/csi_capture.py.
+    'taget' and 'taget_seq' are kept in the folder and file name, the rx_ctrl bits in rx_misc
+    """
+    rx_misc = sum(int(data_series[name]) << bit for name, bit in CSI_FRAME_MISC_BITS.items()) | \
+        ((int(data_series['ant']) & 0x3) << CSI_FRAME_MISC_ANT_SHIFT)
+    host_time = int(datetime.strptime(data_series['timestamp'], CSI_TIMESTAMP_FORMAT).timestamp() * 1000000)
+    fields = {name: int(data_series[name]) for name in ('seq', 'rssi', 'rate', 'sig_mode', 'mcs', 'cwb', 'stbc',
+                                                          'sgi', 'noise_floor', 'ampdu_cnt', 'sig_len', 'rx_state',
+                                                          'agc_gain', 'fft_gain')}
+
+    capture.append(csi_raw_data, host_time=host_time, timestamp=int(data_series['local_timestamp']) & 0xffffffff,
+                   mac=[int(value, 16) for value in str(data_series['mac']).split(':')],
+                   channel=int(data_series['channel_primary']),
+                   secondary_channel=int(data_series['channel_secondary']),
+                   flags=int(data_series['first_word_invalid']) & 1, rx_misc=rx_misc, compensate_gain=1.0,
+                   **fields)
+
+
+def csi_capture_read(file_path):
+    """
+    Rows of a target capture with the CSI_DATA columns of the CSV files, 'data' as lists of values
+    """
+    taget_seq = path.splitext(path.basename(file_path))[0].split('_')[-1]
+
+    with CaptureReader(file_path) as capture:
+        iq, table = capture.read()
+
+    rx_misc = table['rx_misc']
+    columns = {name: table[name] for name in ('seq', 'rssi', 'rate', 'sig_mode', 'mcs', 'cwb', 'stbc', 'sgi',
+                                              'noise_floor', 'ampdu_cnt', 'sig_len', 'rx_state', 'agc_gain',
+                                              'fft_gain', 'len')}
+    columns.update({name: (rx_misc >> bit) & 1 for name, bit in CSI_FRAME_MISC_BITS.items()})
+    columns.update({
+        'type': 'CSI_DATA',
+        'timestamp': [datetime.fromtimestamp(value / 1000000).strftime(CSI_TIMESTAMP_FORMAT)[:-3]
+                      for value in table['host_time']],
+        'taget_seq': taget_seq,
+        'taget': get_label(path.dirname(file_path)),
+        'mac': [':'.join(f'{value:02x}' for value in mac) for mac in table['mac']],
+        'channel_primary': table['channel'],
+        'channel_secondary': table['secondary_channel'],
+        'local_timestamp': table['timestamp'] & 0xffffffff,
+        'ant': (rx_misc >> CSI_FRAME_MISC_ANT_SHIFT) & 0x3,
+        'first_word_invalid': table['flags'] & 1,
+        'data': [row[:length].tolist() for row, length in zip(iq, table['len'])],
+    })
+
+    return pd.DataFrame(columns, columns=CSI_DATA_COLUMNS_NAMES)
+
+
+def evaluate_data_send(serial_queue_write, folder_path, binary=False):
     label = get_label(folder_path)
     if label == 'train':
         command = f'radar --train_start'
@@ -209,17 +278,31 @@ def evaluate_data_send(serial_queue_write, folder_path):
     print(file_name_list)
     for file_name in file_name_list:
         file_path = folder_path + os.path.sep + file_name
-        data_pd = pd.read_csv(file_path)
+        if file_path.endswith('.csicap'):
+            data_pd = csi_capture_read(file_path)
+        else:
+            data_pd = pd.read_csv(file_path)
         for index, data_series in enumerate(data_pd.iloc):
-            csi_raw_data = json.loads(data_series['data'])
-            data_pd.loc[index, 'data'] = base64_encode_bin(csi_raw_data)
+            csi_raw_data = data_series['data']
+            if isinstance(csi_raw_data, str):
+                csi_raw_data = json.loads(csi_raw_data)
+            try:
+                csi_raw_data = csi_raw_data_int8(csi_raw_data)
+            except ValueError as e:
+                print(f'Skip row {index} of {file_name}: {e}')
+                continue
+            if binary:
+                tcpCliSock.sendall(csi_replay_frame_pack(data_series, csi_raw_data))
+                continue
+
+            data_pd.loc[index, 'data'] = base64_encode_bin(csi_raw_data.tolist())
             temp_list = base64_decode_bin(data_pd.loc[index, 'data'])
             # print(f"temp_list: {temp_list}")
             data_str = ','.join(str(value)
                                 for value in data_pd.loc[index]) + '\n'
             data_str = data_str.encode('utf-8')
             # print(f"data_str: {data_str}")
-            tcpCliSock.send(data_str)
+            tcpCliSock.sendall(data_str)
 
     tcpCliSock.close()
     time.sleep(1)
@@ -282,11 +365,11 @@ class DataGraphicalWindow(QMainWindow, Ui_MainWindow):
 
         for i in range(CSI_DATA_COLUMNS):
             curve = self.graphicsView_subcarrier.plot(
-                g_csi_amplitude_array[:, i], name=str(i), pen=csi_vaid_subcarrier_color[i])
+                g_csi_amplitude_array.snapshot()[:, i], name=str(i), pen=csi_vaid_subcarrier_color[i])
             self.curve_subcarrier.append(curve)
 
         self.curve_rssi = self.graphicsView_rssi.plot(
-            g_rssi_array, name='rssi', pen=(255, 255, 255))
+            g_rssi_array.snapshot(), name='rssi', pen=(255, 255, 255))
 
         self.wave_filtering_flag = self.checkBox_wave_filtering.isCheckable()
         self.checkBox_wave_filtering.released.connect(
@@ -321,9 +404,9 @@ class DataGraphicalWindow(QMainWindow, Ui_MainWindow):
                 curve_eigenvalue_threshold)
 
         self.model_radio_header = QStandardItemModel(
-            1, len(g_radio_header_pd.columns.values))
+            1, len(RADIO_HEADER_COLUMNS_NAMES))
         self.model_radio_header.setHorizontalHeaderLabels(
-            g_radio_header_pd.columns.values)
+            RADIO_HEADER_COLUMNS_NAMES)
         self.tableView_radioHeader.setModel(self.model_radio_header)
         self.tableView_radioHeader.horizontalHeader(
         ).setSectionResizeMode(QHeaderView.ResizeToContents)
@@ -546,12 +629,14 @@ class DataGraphicalWindow(QMainWindow, Ui_MainWindow):
     def show_curve_subcarrier(self):
         wn = 20 / (CSI_SAMPLE_RATE / 2)
         b, a = signal.butter(8, wn, 'lowpass')
+        csi_amplitude_array = g_csi_amplitude_array.snapshot()
+        rssi_array = g_rssi_array.snapshot()
 
         if self.wave_filtering_flag:
-            self.median_filtering(g_csi_amplitude_array)
-            csi_filtfilt_data = signal.filtfilt(b, a, g_csi_amplitude_array.T).T
+            self.median_filtering(csi_amplitude_array)
+            csi_filtfilt_data = signal.filtfilt(b, a, csi_amplitude_array.T).T
         else:
-            csi_filtfilt_data = g_csi_amplitude_array
+            csi_filtfilt_data = csi_amplitude_array
 
         if self.curve_subcarrier_range[0] > csi_filtfilt_data.min() or self.curve_subcarrier_range[1] < csi_filtfilt_data.max():
             if csi_filtfilt_data.min() > 0 and self.curve_subcarrier_range[0] > csi_filtfilt_data.min():
@@ -566,24 +651,26 @@ class DataGraphicalWindow(QMainWindow, Ui_MainWindow):
 
         if self.wave_filtering_flag:
             csi_filtfilt_rssi = signal.filtfilt(
-                b, a, g_rssi_array).astype(np.int32)
+                b, a, rssi_array).astype(np.int32)
         else:
-            csi_filtfilt_rssi = g_rssi_array
+            csi_filtfilt_rssi = rssi_array
         self.curve_rssi.setData(csi_filtfilt_rssi)
 
-        for i in range(g_radio_header_pd.shape[0]):
-            for j in range(g_radio_header_pd.shape[1]):
-                cell_value = g_radio_header_pd.iloc[i, j]
+        # Newest first
+        radio_header_array = g_radio_header_array.snapshot()[::-1]
+        for i in range(radio_header_array.shape[0]):
+            for j in range(radio_header_array.shape[1]):
+                cell_value = radio_header_array[i, j]
                 if cell_value is None or (isinstance(cell_value, float) and np.isnan(cell_value)):
                     item = QStandardItem('')
-                elif g_radio_header_pd.columns.values[j] in self.tableView_values.keys():
+                elif RADIO_HEADER_COLUMNS_NAMES[j] in self.tableView_values.keys():
                     try:
-                        str_values = self.tableView_values[g_radio_header_pd.columns.values[j]][int(cell_value)]
+                        str_values = self.tableView_values[RADIO_HEADER_COLUMNS_NAMES[j]][int(cell_value)]
                         item = QStandardItem(str_values)
                     except (ValueError, TypeError, KeyError):
                         item = QStandardItem(str(cell_value))
                 else:
-                    # print(j, g_radio_header_pd.columns.values[j])
+                    # print(j, RADIO_HEADER_COLUMNS_NAMES[j])
                     item = QStandardItem(str(cell_value) if cell_value is not None else '')
                 self.model_radio_header.setItem(i, j, item)
 
@@ -939,11 +1026,7 @@ class DataGraphicalWindow(QMainWindow, Ui_MainWindow):
 
 
 def csi_data_handle(self, data):
-    # Rotate data
-    g_csi_amplitude_array[:-1] = g_csi_amplitude_array[1:]
-    g_rssi_array[:-1] = g_rssi_array[1:]
-    g_radio_header_pd.iloc[1:] = g_radio_header_pd.iloc[:-1]
-
+    csi_amplitude = np.zeros(CSI_DATA_COLUMNS, dtype=np.int32)
     csi_raw_data = data['data']
     data_len = int(data['len']) if 'len' in data else len(csi_raw_data)
 
@@ -965,16 +1048,17 @@ def csi_data_handle(self, data):
             if imag > 32767:
                 imag = imag - 65536
 
-            g_csi_amplitude_array[-1][i] = np.abs(complex(real, imag))
+            csi_amplitude[i] = np.abs(complex(real, imag))
     else:
         for i in range(CSI_DATA_COLUMNS):
             if csi_vaid_subcarrier_index[i]*2+1 >= len(csi_raw_data):
                 return
-            g_csi_amplitude_array[-1][i] = np.abs(complex(csi_raw_data[csi_vaid_subcarrier_index[i]*2], csi_raw_data[csi_vaid_subcarrier_index[i]*2+1]))
+            csi_amplitude[i] = np.abs(complex(csi_raw_data[csi_vaid_subcarrier_index[i]*2], csi_raw_data[csi_vaid_subcarrier_index[i]*2+1]))
 
-    g_rssi_array[-1] = data['rssi']
-    g_radio_header_pd.loc[0] = data[1:len(CSI_DATA_COLUMNS_NAMES)-1]
-    # print(g_radio_header_pd.loc[0])
+    # Appended once complete, no history row is moved
+    g_csi_amplitude_array.append(csi_amplitude)
+    g_rssi_array.append(data['rssi'])
+    g_radio_header_array.append(data[1:len(CSI_DATA_COLUMNS_NAMES)-1].to_numpy(dtype=object))
 
     return
 
@@ -1137,6 +1221,7 @@ def serial_handle(queue_read, queue_write, port):
     log_data_writer = open('log/log_data.txt', 'w+')
     taget_last = 'unknown'
     taget_seq_last = 0
+    taget_capture = None
 
     set.write('restart\r\n'.encode('utf-8'))
     time.sleep(0.01)
@@ -1241,22 +1326,24 @@ def serial_handle(queue_read, queue_write, port):
 
                         data_series['data'] = csi_raw_data
 
+                        # Each collection is recorded to a columnar capture, see tools/csi_ingest/csi_capture.py;
+                        # evaluate_data_send() reads these as well as the .csv files of earlier versions
+                        if taget_capture and (data_series['taget'] != taget_last or
+                                              data_series['taget_seq'] != taget_seq_last):
+                            taget_capture.close()
+                            taget_capture = None
+
                         if data_series['taget'] != 'unknown':
-                            if data_series['taget'] != taget_last or data_series['taget_seq'] != taget_seq_last:
+                            if not taget_capture:
                                 folder = f"data/{data_series['taget']}"
                                 if not path.exists(folder):
                                     mkdir(folder)
 
-                                csi_target_data_file_name = f"{folder}/{datetime.now().strftime('%Y-%m-%d_%H-%M-%S-%f')[:-3]}_{data_series['len']}_{data_series['taget_seq']}.csv"
+                                csi_target_data_file_name = f"{folder}/{datetime.now().strftime('%Y-%m-%d_%H-%M-%S-%f')[:-3]}_{data_series['len']}_{data_series['taget_seq']}.csicap"
                                 print(csi_target_data_file_name)
-                                csi_target_data_file_fd = open(
-                                    csi_target_data_file_name, 'w+')
-                                taget_data_writer = csv.writer(
-                                    csi_target_data_file_fd)
-                                taget_data_writer.writerow(data_series.index)
-
-                            taget_data_writer.writerow(
-                                data_series.astype(str))
+                                taget_capture = CaptureWriter(csi_target_data_file_name, int(data_series['len']))
+
+                            csi_capture_append(taget_capture, data_series, csi_raw_data)
 
                         taget_last = data_series['taget']
                         taget_seq_last = data_series['taget_seq']
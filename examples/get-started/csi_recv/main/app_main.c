@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/param.h>
 
 #include "nvs_flash.h"
 
@@ -25,6 +26,9 @@
 #include "esp_netif.h"
 #include "esp_now.h"
 #include "esp_csi_gain_ctrl.h"
+#include "csi_frame.h"
+#include "csi_dsp.h"
+#include "csi_dsp_gain_ctrl.h"
 
 #define CONFIG_LESS_INTERFERENCE_CHANNEL   11
 #if CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61 || (CONFIG_IDF_TARGET_ESP32C6 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 4, 0))
@@ -40,6 +44,8 @@
 #define CONFIG_ESP_NOW_PHYMODE           WIFI_PHY_MODE_HT40
 #define CONFIG_ESP_NOW_RATE             WIFI_PHY_RATE_MCS0_LGI
 #define CONFIG_FORCE_GAIN                   0
+#define CONFIG_CSI_OUTPUT_BINARY            0   // 1: compact binary frames (components/csi_frame), 0: CSV text
+#define CSI_SCALED_MAX_LEN                  612 // Longest CSI buffer printed as CSV
 
 #if CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61
 #define CSI_FORCE_LLTF                      0
@@ -134,6 +140,9 @@ static void wifi_esp_now_init(esp_now_peer_info_t peer)
 
 }
 
+static csi_dsp_gain_ctrl_t s_gain_ctrl;
+static int s_truncated_count;
+
 static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
 {
     if (!info || !info->buf) {
@@ -147,27 +156,26 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
 
     const wifi_pkt_rx_ctrl_t *rx_ctrl = &info->rx_ctrl;
     static int s_count = 0;
-    float compensate_gain = 1.0f;
+    const csi_dsp_gain_t *gain = &csi_dsp_gain_unity;
     static uint8_t agc_gain = 0;
     static int8_t fft_gain = 0;
 #if CONFIG_GAIN_CONTROL
-    static uint8_t agc_gain_baseline = 0;
-    static int8_t fft_gain_baseline = 0;
-    esp_csi_gain_ctrl_get_rx_gain(rx_ctrl, &agc_gain, &fft_gain);
-    if (s_count < 100) {
-        esp_csi_gain_ctrl_record_rx_gain(agc_gain, fft_gain);
-    } else if (s_count == 100) {
-        esp_csi_gain_ctrl_get_rx_gain_baseline(&agc_gain_baseline, &fft_gain_baseline);
-#if CONFIG_FORCE_GAIN
-        esp_csi_gain_ctrl_set_rx_force_gain(agc_gain_baseline, fft_gain_baseline);
-        ESP_LOGD(TAG, "fft_force %d, agc_force %d", fft_gain_baseline, agc_gain_baseline);
-#endif
-    }
-    esp_csi_gain_ctrl_get_gain_compensation(&compensate_gain, agc_gain, fft_gain);
-    ESP_LOGI(TAG, "compensate_gain %f, agc_gain %d, fft_gain %d", compensate_gain, agc_gain, fft_gain);
+    gain = csi_dsp_gain_ctrl_update(&s_gain_ctrl, rx_ctrl, &agc_gain, &fft_gain);
+    ESP_LOGI(TAG, "compensate_gain %f, agc_gain %d, fft_gain %d", gain->gain, agc_gain, fft_gain);
 #endif
 
     uint32_t rx_id = *(uint32_t *)(info->payload + 15);
+#if CONFIG_CSI_OUTPUT_BINARY
+    if (!s_count) {
+        ESP_LOGI(TAG, "================ CSI RECV (binary) ================");
+    }
+
+#if (CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61) && CSI_FORCE_LLTF
+    csi_frame_print(info, rx_id, agc_gain, fft_gain, gain->gain, CSI_FRAME_FLAG_PAYLOAD_INT12);
+#else
+    csi_frame_print(info, rx_id, agc_gain, fft_gain, gain->gain, 0);
+#endif
+#else
 #if CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32C61
     if (!s_count) {
         ESP_LOGI(TAG, "================ CSI RECV ================");
@@ -192,25 +200,40 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
                rx_ctrl->timestamp, rx_ctrl->ant, rx_ctrl->sig_len, rx_ctrl->rx_state);
 
 #endif
+    /**
+     * @brief Gain compensation of the whole buffer in one integer pass, the CSI callbacks are
+     *        serialized so a static output buffer is enough
+     */
+    static int16_t s_csi_scaled[CSI_SCALED_MAX_LEN];
 #if (CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61) && CSI_FORCE_LLTF
-    int16_t csi = ((int16_t)(((((uint16_t)info->buf[1]) << 8) | info->buf[0]) << 4) >> 4);
-    ets_printf(",%d,%d,\"[%d", (info->len - 2) / 2, info->first_word_invalid, (int16_t)(compensate_gain * csi));
-    for (int i = 2; i < (info->len - 2); i += 2) {
-        csi = ((int16_t)(((((uint16_t)info->buf[i + 1]) << 8) | info->buf[i]) << 4) >> 4);
-        ets_printf(",%d", (int16_t)(compensate_gain * csi));
-    }
+    int info_len = MAX((info->len - 2) / 2, 0);
+    int csi_len = MIN(info_len, CSI_SCALED_MAX_LEN);
+    csi_dsp_scale_i12_i16_q15((const uint8_t *)info->buf, s_csi_scaled, csi_len, gain->gain_q15);
 #else
-    ets_printf(",%d,%d,\"[%d", info->len, info->first_word_invalid, (int16_t)(compensate_gain * info->buf[0]));
-    for (int i = 1; i < info->len; i++) {
-        ets_printf(",%d", (int16_t)(compensate_gain * info->buf[i]));
-    }
+    int info_len = info->len;
+    int csi_len = MIN(info_len, CSI_SCALED_MAX_LEN);
+    csi_dsp_scale_i8_i16_q15(info->buf, s_csi_scaled, csi_len, gain->gain_q15);
 #endif
+
+    /**
+     * @brief The len column is the number of values that follow, so a parser never reads past the list
+     */
+    if (csi_len < info_len && ++s_truncated_count % 100 == 1) {
+        ESP_LOGW(TAG, "CSI of %d values truncated to %d, %d frames so far", info_len, csi_len, s_truncated_count);
+    }
+
+    ets_printf(",%d,%d,\"[%d", csi_len, info->first_word_invalid, csi_len ? s_csi_scaled[0] : 0);
+    for (int i = 1; i < csi_len; i++) {
+        ets_printf(",%d", s_csi_scaled[i]);
+    }
     ets_printf("]\"\n");
+#endif
     s_count++;
 }
 
 static void wifi_csi_init()
 {
+    csi_dsp_gain_ctrl_init(&s_gain_ctrl, CONFIG_FORCE_GAIN);
     ESP_ERROR_CHECK(esp_wifi_set_promiscuous(true));
 
     /**< default config */
@@ -293,5 +316,8 @@ void app_main()
 
     wifi_esp_now_init(peer);
 
+#if CONFIG_CSI_OUTPUT_BINARY
+    ESP_ERROR_CHECK(csi_frame_print_init());
+#endif
     wifi_csi_init();
 }
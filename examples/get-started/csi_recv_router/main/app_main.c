@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/param.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -34,12 +35,17 @@
 
 #include "protocol_examples_common.h"
 #include "esp_csi_gain_ctrl.h"
+#include "csi_frame.h"
+#include "csi_dsp.h"
+#include "csi_dsp_gain_ctrl.h"
 
 #define CONFIG_SEND_FREQUENCY      100
+#define CSI_SCALED_MAX_LEN         612 // Longest CSI buffer printed as CSV
 #if CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61
 #define CSI_FORCE_LLTF                      0
 #endif
 #define CONFIG_FORCE_GAIN                   0
+#define CONFIG_CSI_OUTPUT_BINARY            0   // 1: compact binary frames (components/csi_frame), 0: CSV text
 
 #if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32C3 || CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32C61
 #define CONFIG_GAIN_CONTROL                 1
@@ -51,6 +57,9 @@
 
 static const char *TAG = "csi_recv_router";
 
+static csi_dsp_gain_ctrl_t s_gain_ctrl;
+static int s_truncated_count;
+
 static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
 {
     if (!info || !info->buf) {
@@ -64,26 +73,25 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
 
     const wifi_pkt_rx_ctrl_t *rx_ctrl = &info->rx_ctrl;
     static int s_count = 0;
-    float compensate_gain = 1.0f;
+    const csi_dsp_gain_t *gain = &csi_dsp_gain_unity;
     static uint8_t agc_gain = 0;
     static int8_t fft_gain = 0;
 #if CONFIG_GAIN_CONTROL
-    static uint8_t agc_gain_baseline = 0;
-    static int8_t fft_gain_baseline = 0;
-    esp_csi_gain_ctrl_get_rx_gain(rx_ctrl, &agc_gain, &fft_gain);
-    if (s_count < 100) {
-        esp_csi_gain_ctrl_record_rx_gain(agc_gain, fft_gain);
-    } else if (s_count == 100) {
-        esp_csi_gain_ctrl_get_rx_gain_baseline(&agc_gain_baseline, &fft_gain_baseline);
-#if CONFIG_FORCE_GAIN
-        esp_csi_gain_ctrl_set_rx_force_gain(agc_gain_baseline, fft_gain_baseline);
-        ESP_LOGI(TAG, "fft_force %d, agc_force %d", fft_gain_baseline, agc_gain_baseline);
+    gain = csi_dsp_gain_ctrl_update(&s_gain_ctrl, rx_ctrl, &agc_gain, &fft_gain);
+    ESP_LOGD(TAG, "compensate_gain %f, agc_gain %d, fft_gain %d", gain->gain, agc_gain, fft_gain);
 #endif
+
+#if CONFIG_CSI_OUTPUT_BINARY
+    if (!s_count) {
+        ESP_LOGI(TAG, "================ CSI RECV (binary) ================");
     }
-    esp_csi_gain_ctrl_get_gain_compensation(&compensate_gain, agc_gain, fft_gain);
-    ESP_LOGD(TAG, "compensate_gain %f, agc_gain %d, fft_gain %d", compensate_gain, agc_gain, fft_gain);
-#endif
 
+#if (CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61) && CSI_FORCE_LLTF
+    csi_frame_print(info, s_count, agc_gain, fft_gain, gain->gain, CSI_FRAME_FLAG_PAYLOAD_INT12);
+#else
+    csi_frame_print(info, s_count, agc_gain, fft_gain, gain->gain, 0);
+#endif
+#else
 #if CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32C61
     if (!s_count) {
         ESP_LOGI(TAG, "================ CSI RECV ================");
@@ -106,27 +114,40 @@ static void wifi_csi_rx_cb(void *ctx, wifi_csi_info_t *info)
                rx_ctrl->timestamp, rx_ctrl->ant, rx_ctrl->sig_len, rx_ctrl->rx_state);
 #endif
 
+    /**
+     * @brief Gain compensation of the whole buffer in one integer pass, the CSI callbacks are
+     *        serialized so a static output buffer is enough
+     */
+    static int16_t s_csi_scaled[CSI_SCALED_MAX_LEN];
 #if (CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32C61) && CSI_FORCE_LLTF
+    int info_len = MAX((info->len - 2) / 2, 0);
+    int csi_len = MIN(info_len, CSI_SCALED_MAX_LEN);
+    csi_dsp_scale_i12_i16_q15((const uint8_t *)info->buf, s_csi_scaled, csi_len, gain->gain_q15);
+#else
+    int info_len = info->len;
+    int csi_len = MIN(info_len, CSI_SCALED_MAX_LEN);
+    csi_dsp_scale_i8_i16_q15(info->buf, s_csi_scaled, csi_len, gain->gain_q15);
+#endif
 
-    int16_t csi = ((int16_t)(((((uint16_t)info->buf[1]) << 8) | info->buf[0]) << 4) >> 4);
-    ets_printf(",%d,%d,\"[%d", (info->len - 2) / 2, info->first_word_invalid, (int16_t)(compensate_gain * csi));
-    for (int i = 2; i < (info->len - 2); i += 2) {
-        csi = ((int16_t)(((((uint16_t)info->buf[i + 1]) << 8) | info->buf[i]) << 4) >> 4);
-        ets_printf(",%d", (int16_t)(compensate_gain * csi));
+    /**
+     * @brief The len column is the number of values that follow, so a parser never reads past the list
+     */
+    if (csi_len < info_len && ++s_truncated_count % 100 == 1) {
+        ESP_LOGW(TAG, "CSI of %d values truncated to %d, %d frames so far", info_len, csi_len, s_truncated_count);
     }
 
-#else
-    ets_printf(",%d,%d,\"[%d", info->len, info->first_word_invalid, (int16_t)(compensate_gain * info->buf[0]));
-    for (int i = 1; i < info->len; i++) {
-        ets_printf(",%d", (int16_t)(compensate_gain * info->buf[i]));
+    ets_printf(",%d,%d,\"[%d", csi_len, info->first_word_invalid, csi_len ? s_csi_scaled[0] : 0);
+    for (int i = 1; i < csi_len; i++) {
+        ets_printf(",%d", s_csi_scaled[i]);
     }
-#endif
     ets_printf("]\"\n");
+#endif
     s_count++;
 }
 
 static void wifi_csi_init()
 {
+    csi_dsp_gain_ctrl_init(&s_gain_ctrl, CONFIG_FORCE_GAIN);
     /**
      * @brief In order to ensure the compatibility of routers, only LLTF sub-carriers are selected.
      */
@@ -216,6 +237,9 @@ void app_main()
      */
     ESP_ERROR_CHECK(example_connect());
 
+#if CONFIG_CSI_OUTPUT_BINARY
+    ESP_ERROR_CHECK(csi_frame_print_init());
+#endif
     wifi_csi_init();
     wifi_ping_router_start();
 }
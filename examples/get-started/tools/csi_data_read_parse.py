@@ -11,15 +11,17 @@
 # their specific function instead.
 
 import sys
-import csv
-import json
 import argparse
 import pandas as pd
 import numpy as np
 
 import serial
 from os import path
-from io import StringIO
+
+sys.path.insert(0, path.join(path.dirname(path.abspath(__file__)), '../../../tools/csi_ingest'))
+from csi_ingest import CsiIngest, to_complex
+from csi_ring import RingBuffer
+from csi_capture import CaptureWriter
 
 from PyQt5.Qt import *
 from pyqtgraph import PlotWidget
@@ -47,17 +49,54 @@ DATA_COLUMNS_NAMES = ['type', 'id', 'mac', 'rssi', 'rate', 'sig_mode', 'mcs', 'b
 csi_data_array = np.zeros(
     [CSI_DATA_INDEX, CSI_DATA_COLUMNS], dtype=np.float64)
 csi_data_phase = np.zeros([CSI_DATA_INDEX, CSI_DATA_COLUMNS], dtype=np.float64)
-csi_data_complex = np.zeros([CSI_DATA_INDEX, CSI_DATA_COLUMNS], dtype=np.complex64)
-agc_gain_data = np.zeros([CSI_DATA_INDEX], dtype=np.float64)
-fft_gain_data = np.zeros([CSI_DATA_INDEX], dtype=np.float64)
-fft_gains = []
-agc_gains = []
+# Filled by the serial reader thread, plotted through snapshot(), oldest row first
+csi_data_complex = RingBuffer(CSI_DATA_INDEX, CSI_DATA_COLUMNS, dtype=np.complex64)
+agc_gain_data = RingBuffer(CSI_DATA_INDEX)
+fft_gain_data = RingBuffer(CSI_DATA_INDEX)
+
+# Rendering of the subcarrier history, see csi_data_graphical_window
+RENDER_MODES = ['image', 'bands', 'curves']
+RENDER_BANDS = 8            # aggregate curves of the 'bands' mode
+RENDER_MAX_POINTS = 1000    # time points drawn per curve or image row before decimation
+
+
+def minmax_decimate(data, max_points):
+    """Reduce `data` along its first axis to at most `max_points` rows.
+
+    Each bucket of consecutive rows becomes its minimum and its maximum, so
+    peaks stay visible in the decimated curve. Returns the packet index of every
+    kept row and the rows.
+    """
+    count = len(data)
+    if count <= max_points:
+        return np.arange(count), data
+
+    buckets = max(max_points // 2, 1)
+    size = count // buckets
+    start = count - buckets * size
+    blocks = data[start:].reshape((buckets, size) + data.shape[1:])
+    decimated = np.empty((buckets * 2,) + data.shape[1:], dtype=data.dtype)
+    decimated[0::2] = blocks.min(axis=1)
+    decimated[1::2] = blocks.max(axis=1)
+    index = start + np.repeat(np.arange(buckets) * size, 2) + np.tile([0, size - 1], buckets)
+    return index, decimated
+
 
 class csi_data_graphical_window(QWidget):
-    def __init__(self):
+    """
+    render_mode selects how the subcarrier history is drawn:
+    - 'image':  amplitude and phase as one heatmap each (time x subcarrier)
+    - 'bands':  RENDER_BANDS curves, the mean amplitude and the phase of the summed
+                subcarriers of each band
+    - 'curves': one curve per subcarrier
+    Curves are min/max decimated to RENDER_MAX_POINTS, the heatmaps subsampled.
+    """
+
+    def __init__(self, render_mode='image'):
         super().__init__()
 
         self.resize(1280, 900)
+        self.render_mode = render_mode
 
         self.plotWidget_ted = PlotWidget(self)
         self.plotWidget_ted.setGeometry(QtCore.QRect(0, 0, 640, 300))
@@ -67,48 +106,62 @@ class csi_data_graphical_window(QWidget):
         self.plotWidget_ted.setLabel('left', 'Phase (rad)')  # Y轴标签
         self.plotWidget_ted.setLabel('bottom', 'Subcarrier Index')  # X轴标签
 
-        self.csi_amplitude_array = np.abs(csi_data_complex)
-        self.csi_phase_array = np.angle(csi_data_complex)
         self.curve = self.plotWidget_ted.plot([], name='CSI Row Data', pen='r')
 
         self.plotWidget_multi_data = PlotWidget(self)
         self.plotWidget_multi_data.setGeometry(QtCore.QRect(0, 300, 1280, 300))
-        self.plotWidget_multi_data.getViewBox().enableAutoRange(axis=pg.ViewBox.YAxis)
         self.plotWidget_multi_data.addLegend()
         self.plotWidget_multi_data.setTitle('Subcarrier Amplitude Data')  # 添加标题
-        self.plotWidget_multi_data.setLabel('left', 'Amplitude')  # Y轴标签
         self.plotWidget_multi_data.setLabel('bottom', 'Time (Cumulative Packet Count)')  # X轴标签
 
-        self.curve_list = []
-        agc_curve = self.plotWidget_multi_data.plot(
-            agc_gain_data, name='AGC Gain', pen=[255,255,0])
-        fft_curve = self.plotWidget_multi_data.plot(
-            fft_gain_data, name='FFT Gain', pen=[255,255,0])
-        self.curve_list.append(agc_curve)
-        self.curve_list.append(fft_curve)
-
-        for i in range(CSI_DATA_COLUMNS):
-            curve = self.plotWidget_multi_data.plot(
-                self.csi_amplitude_array[:, i], name=str(i), pen=(255, 255, 255))
-            self.curve_list.append(curve)
-
-
-
         self.plotWidget_phase_data = PlotWidget(self)
         self.plotWidget_phase_data.setGeometry(QtCore.QRect(0, 600, 1280, 300))
-        self.plotWidget_phase_data.getViewBox().enableAutoRange(axis=pg.ViewBox.YAxis)
         self.plotWidget_phase_data.addLegend()
-        self.plotWidget_multi_data.setTitle('Subcarrier Phase Data')  # 添加标题
-        self.plotWidget_multi_data.setLabel('left', 'Phase (rad)')  # Y轴标签
-        self.plotWidget_multi_data.setLabel('bottom', 'Time (Cumulative Packet Count)')  # X轴标签
-
+        self.plotWidget_phase_data.setTitle('Subcarrier Phase Data')  # 添加标题
+        self.plotWidget_phase_data.setLabel('bottom', 'Time (Cumulative Packet Count)')  # X轴标签
 
+        self.curve_list = []
         self.curve_phase_list = []
-        for i in range(CSI_DATA_COLUMNS):
-            phase_curve = self.plotWidget_phase_data.plot(
-                np.angle(self.csi_amplitude_array[:, i]), name=str(i), pen=(255, 255, 255))
-            self.curve_phase_list.append(phase_curve)
 
+        if render_mode == 'image':
+            self.plotWidget_multi_data.setLabel('left', 'Subcarrier Index')
+            self.plotWidget_phase_data.setLabel('left', 'Subcarrier Index')
+            self.amplitude_image = pg.ImageItem()
+            self.phase_image = pg.ImageItem()
+            lut = pg.colormap.get('viridis').getLookupTable()
+            for plot, image in ((self.plotWidget_multi_data, self.amplitude_image),
+                                (self.plotWidget_phase_data, self.phase_image)):
+                image.setLookupTable(lut)
+                plot.addItem(image)
+
+            # The gains on the right axis, over the amplitude image
+            plot_item = self.plotWidget_multi_data.getPlotItem()
+            gain_view = pg.ViewBox()
+            plot_item.showAxis('right')
+            plot_item.scene().addItem(gain_view)
+            plot_item.getAxis('right').linkToView(gain_view)
+            plot_item.getAxis('right').setLabel('Gain')
+            gain_view.setXLink(plot_item)
+            plot_item.vb.sigResized.connect(lambda: gain_view.setGeometry(plot_item.vb.sceneBoundingRect()))
+            self.agc_curve = pg.PlotDataItem(name='AGC Gain', pen=[255,255,0])
+            self.fft_curve = pg.PlotDataItem(name='FFT Gain', pen=[0,255,255])
+            for curve in (self.agc_curve, self.fft_curve):
+                gain_view.addItem(curve)
+                plot_item.legend.addItem(curve, curve.name())
+        else:
+            self.plotWidget_multi_data.getViewBox().enableAutoRange(axis=pg.ViewBox.YAxis)
+            self.plotWidget_phase_data.getViewBox().enableAutoRange(axis=pg.ViewBox.YAxis)
+            self.plotWidget_multi_data.setLabel('left', 'Amplitude')  # Y轴标签
+            self.plotWidget_phase_data.setLabel('left', 'Phase (rad)')  # Y轴标签
+            self.agc_curve = self.plotWidget_multi_data.plot([], name='AGC Gain', pen=[255,255,0])
+            self.fft_curve = self.plotWidget_multi_data.plot([], name='FFT Gain', pen=[0,255,255])
+
+            curves = RENDER_BANDS if render_mode == 'bands' else CSI_DATA_COLUMNS // 2
+            for i in range(curves):
+                pen = pg.intColor(i, curves) if render_mode == 'bands' else (255, 255, 255)
+                name = f'band {i}' if render_mode == 'bands' else None
+                self.curve_list.append(self.plotWidget_multi_data.plot([], name=name, pen=pen))
+                self.curve_phase_list.append(self.plotWidget_phase_data.plot([], pen=pen))
 
         # IQ 图窗口
         self.plotWidget_iq = PlotWidget(self)
@@ -120,12 +173,10 @@ class csi_data_graphical_window(QWidget):
         view_box.setRange(QtCore.QRectF(-30, -30, 60, 60))  # 可以调整范围的大小，保证原点在中间
 
         self.plotWidget_iq.getViewBox().setAspectLocked(True)
-        self.iq_scatter = ScatterPlotItem(size=6)
+        self.iq_scatter = ScatterPlotItem(size=6, pen=None)
         self.plotWidget_iq.addItem(self.iq_scatter)
 
-        self.iq_colors = []
-
-
+        self.iq_brushes = []
 
         self.timer = pg.QtCore.QTimer()
         self.timer.timeout.connect(self.update_data)
@@ -134,40 +185,62 @@ class csi_data_graphical_window(QWidget):
 
     def update_curve_colors(self, color_list):
         self.deta_len = len(color_list)
-        self.iq_colors = color_list
         self.plotWidget_ted.setXRange(0, self.deta_len//2)
-        for i in range(self.deta_len):
-            self.curve_list[i].setPen(color_list[i])
-            self.curve_phase_list[i].setPen(color_list[i])
+        # Made once, the scatter reuses them every frame
+        self.iq_brushes = [pg.mkBrush(color) for color in color_list[:self.deta_len // 2]]
+        if self.render_mode == 'curves':
+            for i in range(min(self.deta_len // 2, len(self.curve_list))):
+                self.curve_list[i].setPen(color_list[i])
+                self.curve_phase_list[i].setPen(color_list[i])
 
     def update_data(self):
-
-        i = np.real(csi_data_complex[-1, :])
-        q = np.imag(csi_data_complex[-1, :])
-
-        points = []
-        for idx in range(self.deta_len):
-            if idx < len(self.iq_colors):
-                color = self.iq_colors[idx]
+        csi_complex = csi_data_complex.snapshot()
+        subcarriers = self.deta_len // 2 or CSI_DATA_COLUMNS // 2
+        csi_complex = csi_complex[:, :subcarriers]
+
+        # Last frame, straight from the contiguous row
+        last_frame = csi_complex[-1]
+        if self.iq_brushes:
+            self.iq_scatter.setData(x=last_frame.real, y=last_frame.imag, brush=self.iq_brushes)
+        else:
+            self.iq_scatter.setData(x=last_frame.real, y=last_frame.imag, brush=pg.mkBrush(200, 200, 200))
+        self.curve.setData(np.angle(last_frame))
+
+        index, gains = minmax_decimate(np.column_stack((agc_gain_data.snapshot(), fft_gain_data.snapshot())), RENDER_MAX_POINTS)
+        self.agc_curve.setData(index, gains[:, 0])
+        self.fft_curve.setData(index, gains[:, 1])
+
+        if self.render_mode == 'image':
+            # Subsampled, the image cannot show more rows than it has pixels
+            step = -(-len(csi_complex) // RENDER_MAX_POINTS)
+            start = (len(csi_complex) - 1) % step
+            rows = csi_complex[start::step]
+            rect = QtCore.QRectF(start, 0, len(rows) * step, subcarriers)
+            self.amplitude_image.setImage(np.abs(rows), autoLevels=True)
+            self.amplitude_image.setRect(rect)
+            self.phase_image.setImage(np.angle(rows), levels=(-np.pi, np.pi))
+            self.phase_image.setRect(rect)
+            return
+
+        if self.render_mode == 'bands':
+            bands = min(RENDER_BANDS, subcarriers)
+            edges = np.linspace(0, subcarriers, bands + 1).astype(int)[:-1]
+            amplitude = np.add.reduceat(np.abs(csi_complex), edges, axis=1) / np.diff(np.append(edges, subcarriers))
+            phase = np.angle(np.add.reduceat(csi_complex, edges, axis=1))
+        else:
+            amplitude = np.abs(csi_complex)
+            phase = np.angle(csi_complex)
+
+        index, amplitude = minmax_decimate(amplitude, RENDER_MAX_POINTS)
+        index, phase = minmax_decimate(phase, RENDER_MAX_POINTS)
+        for i in range(len(self.curve_list)):
+            if i < amplitude.shape[1]:
+                self.curve_list[i].setData(index, amplitude[:, i])
+                self.curve_phase_list[i].setData(index, phase[:, i])
             else:
-                color = (200, 200, 200)
-            points.append({'pos': (i[idx], q[idx]), 'brush': pg.mkBrush(color)})
+                self.curve_list[i].setData([])
+                self.curve_phase_list[i].setData([])
 
-        self.iq_scatter.setData(points)
-
-
-        self.csi_amplitude_array = np.abs(csi_data_complex)
-        self.csi_phase_array = np.angle(csi_data_complex)
-        self.csi_row_data = self.csi_phase_array[-1, :]
-
-        self.curve.setData(self.csi_row_data)
-
-        self.curve_list[CSI_DATA_COLUMNS].setData(agc_gain_data)
-        self.curve_list[CSI_DATA_COLUMNS+1].setData(fft_gain_data)
-
-        for i in range(CSI_DATA_COLUMNS):
-            self.curve_list[i].setData(self.csi_amplitude_array[:, i])
-            self.curve_phase_list[i].setData(self.csi_phase_array[:, i])
 
 def generate_subcarrier_colors(red_range, green_range, yellow_range, total_num,interval=1):
     colors = []
@@ -187,8 +260,7 @@ def generate_subcarrier_colors(red_range, green_range, yellow_range, total_num,i
     return colors
 
 
-def csi_data_read_parse(port: str, csv_writer, log_file_fd,callback=None):
-    global fft_gains, agc_gains
+def csi_data_read_parse(port: str, save_file_fd, log_file_fd,callback=None, capture=None):
     set = serial.Serial(port=port, baudrate=921600,bytesize=8, parity='N', stopbits=1)
     count =0
     if set.isOpen():
@@ -196,113 +268,96 @@ def csi_data_read_parse(port: str, csv_writer, log_file_fd,callback=None):
     else:
         print('open failed')
         return
-    while True:
-        strings = str(set.readline())
-        if not strings:
-            break
-        strings = strings.lstrip('b\'').rstrip('\\r\\n\'')
-        index = strings.find('CSI_DATA')
-
-        if index == -1:
-            log_file_fd.write(strings + '\n')
-            log_file_fd.flush()
-            continue
 
-        csv_reader = csv.reader(StringIO(strings))
-        csi_data = next(csv_reader)
-        csi_data_len = int (csi_data[-3])
-        if len(csi_data) != len(DATA_COLUMNS_NAMES) and len(csi_data) != len(DATA_COLUMNS_NAMES_C5C6):
-            print('element number is not equal',len(csi_data),len(DATA_COLUMNS_NAMES) )
-            # print(csi_data)
-            log_file_fd.write('element number is not equal\n')
-            log_file_fd.write(strings + '\n')
-            log_file_fd.flush()
-            continue
+    # Parsed in C into preallocated ring buffers, see tools/csi_ingest
+    ingest = CsiIngest(capacity=CSI_DATA_INDEX, width=CSI_DATA_COLUMNS,
+                       layouts=(DATA_COLUMNS_NAMES_C5C6, DATA_COLUMNS_NAMES), keep_text=True, save_file=save_file_fd,
+                       capture=capture)
+    stats_time = time.monotonic()
+    plotted = 0
 
+    while True:
         try:
-            csi_raw_data = json.loads(csi_data[-1])
-        except json.JSONDecodeError:
-            print('data is incomplete')
-            log_file_fd.write('data is incomplete\n')
-            log_file_fd.write(strings + '\n')
-            log_file_fd.flush()
-            continue
-        if csi_data_len != len(csi_raw_data):
-            print('csi_data_len is not equal',csi_data_len,len(csi_raw_data))
-            log_file_fd.write('csi_data_len is not equal\n')
-            log_file_fd.write(strings + '\n')
-            log_file_fd.flush()
-            continue
-
-        fft_gain = int(csi_data[6])
-        agc_gain = int(csi_data[7])
+            if not ingest.read_from(set):
+                continue
+        except EOFError:
+            break
 
-        fft_gains.append(fft_gain)
-        agc_gains.append(agc_gain)
+        for line in ingest.take_text():
+            log_file_fd.write(line.decode('utf-8', 'replace') + '\n')
+        log_file_fd.flush()
 
-        csv_writer.writerow(csi_data)
+        if ingest.count == plotted:
+            continue
 
-        # Rotate data to the left
-        # csi_data_array[:-1] = csi_data_array[1:]
-        # csi_data_phase[:-1] = csi_data_phase[1:]
-        csi_data_complex[:-1] = csi_data_complex[1:]
-        agc_gain_data[:-1] = agc_gain_data[1:]
-        fft_gain_data[:-1] = fft_gain_data[1:]
-        agc_gain_data[-1] = agc_gain
-        fft_gain_data[-1] = fft_gain
+        # Only the records parsed since the last read are appended
+        iq, meta = ingest.latest(ingest.count - plotted)
+        plotted = ingest.count
+        csi_rows = np.zeros([len(iq), CSI_DATA_COLUMNS], dtype=np.complex64)
+        csi_rows[:, :CSI_DATA_COLUMNS // 2] = to_complex(iq)
+        csi_data_complex.extend(csi_rows)
+        agc_gain_data.extend(meta['agc_gain'])
+        fft_gain_data.extend(meta['fft_gain'])
 
         if count ==0:
             count = 1
+            csi_data_len = int(meta['len'][-1])
             print('none',csi_data_len)
             if csi_data_len == 106:
-                colors = generate_subcarrier_colors((0,25), (27,53), None, len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,25), (27,53), None, csi_data_len)
             elif  csi_data_len == 114:
-                colors = generate_subcarrier_colors((0,27), (29,56), None, len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,27), (29,56), None, csi_data_len)
             elif  csi_data_len == 52:
-                colors = generate_subcarrier_colors((0,12), (13,26), None, len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,12), (13,26), None, csi_data_len)
             elif  csi_data_len == 234 :
-                colors = generate_subcarrier_colors((0,28), (29,56), (60,116), len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,28), (29,56), (60,116), csi_data_len)
             elif  csi_data_len == 228 :
-                colors = generate_subcarrier_colors((0,28), (29,57), (57,113), len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,28), (29,57), (57,113), csi_data_len)
             elif  csi_data_len == 490 :
-                colors = generate_subcarrier_colors((0,61), (62,122), (123,245), len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,61), (62,122), (123,245), csi_data_len)
             elif  csi_data_len == 128 :
-                colors = generate_subcarrier_colors((0,31), (32,63), None, len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,31), (32,63), None, csi_data_len)
             elif  csi_data_len == 256 :
-                colors = generate_subcarrier_colors((0,32), (32,63), (64,128), len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,32), (32,63), (64,128), csi_data_len)
             elif  csi_data_len == 512 :
-                colors = generate_subcarrier_colors((0,63), (64,127), (128,256), len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,63), (64,127), (128,256), csi_data_len)
             elif  csi_data_len == 384 :
-                colors = generate_subcarrier_colors((0,63), (64,127), (128,192), len(csi_raw_data))
+                colors = generate_subcarrier_colors((0,63), (64,127), (128,192), csi_data_len)
             elif csi_data_len > 0 and csi_data_len <= 612:
-                raw_len = len(csi_raw_data)
-                colors = generate_subcarrier_colors((0,raw_len//2), (raw_len//2+1,raw_len-1), None, raw_len)
+                colors = generate_subcarrier_colors((0,csi_data_len//2), (csi_data_len//2+1,csi_data_len-1), None, csi_data_len)
             callback(colors)
 
-        for i in range(csi_data_len // 2):
-            csi_data_complex[-1][i] = complex(csi_raw_data[i * 2 + 1],
-                                            csi_raw_data[i * 2])
+        if time.monotonic() - stats_time >= 10:
+            stats_time = time.monotonic()
+            stats = ingest.stats()
+            print('lines/s: %.0f, records/s: %.0f, records: %d, bad: %d' % (
+                stats['lines_per_second'], stats['records_per_second'], stats['records'], stats['bad']))
     set.close()
     return
 
 
 class SubThread (QThread):
     data_ready = pyqtSignal(object)
-    def __init__(self, serial_port, save_file_name, log_file_name):
+    def __init__(self, serial_port, save_file_name, log_file_name, capture_file_name=None):
         super().__init__()
         self.serial_port = serial_port
+        # Columnar copy of the records, indexed by time and sequence id, see tools/csi_ingest/csi_capture.py
+        self.capture = CaptureWriter(capture_file_name, CSI_DATA_COLUMNS) if capture_file_name else None
 
-        save_file_fd = open(save_file_name, 'w')
+        self.save_file_fd = open(save_file_name, 'wb')
         self.log_file_fd = open(log_file_name, 'w')
-        self.csv_writer = csv.writer(save_file_fd)
-        self.csv_writer.writerow(DATA_COLUMNS_NAMES)
+        self.save_file_fd.write((','.join(DATA_COLUMNS_NAMES) + '\n').encode())
 
     def run(self):
-        csi_data_read_parse(self.serial_port, self.csv_writer, self.log_file_fd,callback=self.data_ready.emit)
+        csi_data_read_parse(self.serial_port, self.save_file_fd, self.log_file_fd,callback=self.data_ready.emit,
+                            capture=self.capture)
 
     def __del__(self):
         self.wait()
         self.log_file_fd.close()
+        self.save_file_fd.close()
+        if self.capture:
+            self.capture.close()
 
 
 if __name__ == '__main__':
@@ -318,19 +373,33 @@ if __name__ == '__main__':
                         help='Save the data printed by the serial port to a file')
     parser.add_argument('-l', '--log', dest='log_file', action='store', default='./csi_data_log.txt',
                         help='Save other serial data the bad CSI data to a log file')
+    parser.add_argument('-r', '--render', dest='render_mode', choices=RENDER_MODES, default='image',
+                        help='Draw the subcarriers as heatmaps, as a few aggregate bands or as one curve each')
+    parser.add_argument('-n', '--history', dest='history', type=int, default=CSI_DATA_INDEX,
+                        help='Number of packets kept and plotted')
+    parser.add_argument('-c', '--capture', dest='capture_file', action='store', default=None,
+                        help='Also record the CSI data to a columnar capture file (.csicap), indexed by time')
 
     args = parser.parse_args()
+    if args.history != CSI_DATA_INDEX:
+        CSI_DATA_INDEX = args.history
+        csi_data_complex = RingBuffer(CSI_DATA_INDEX, CSI_DATA_COLUMNS, dtype=np.complex64)
+        agc_gain_data = RingBuffer(CSI_DATA_INDEX)
+        fft_gain_data = RingBuffer(CSI_DATA_INDEX)
     serial_port = args.port
     file_name = args.store_file
     log_file_name = args.log_file
 
     app = QApplication(sys.argv)
 
-    subthread = SubThread(serial_port, file_name, log_file_name)
+    subthread = SubThread(serial_port, file_name, log_file_name, args.capture_file)
 
-    window = csi_data_graphical_window()
+    window = csi_data_graphical_window(args.render_mode)
     subthread.data_ready.connect(window.update_curve_colors)
     subthread.start()
     window.show()
 
-    sys.exit(app.exec())
+    exit_code = app.exec()
+    if subthread.capture:
+        subthread.capture.close()
+    sys.exit(exit_code)
@@ -262,9 +262,9 @@ def csi_data_read_parse(port: str, csv_writer, log_file_fd,callback=None):
                 # RAW_DATA 不需要初始化颜色，只是接收数据显示相位
 
             # RAW_DATA 转换为复数存入独立数组
-            for i in range(csi_data_len // 2):
-                raw_data_complex[-1][i] = complex(csi_raw_data[i * 2 + 1],
-                                                csi_raw_data[i * 2])
+            # (imag, real) pairs, filled in one vectorized assignment
+            csi_iq = np.asarray(csi_raw_data[:csi_data_len // 2 * 2], dtype=np.float32).reshape(-1, 2)
+            raw_data_complex[-1, :len(csi_iq)] = csi_iq[:, 1] + 1j * csi_iq[:, 0]
             continue
 
         # CSI_DATA 处理
@@ -342,9 +342,9 @@ def csi_data_read_parse(port: str, csv_writer, log_file_fd,callback=None):
                 continue
             callback(colors)
 
-        for i in range(csi_data_len // 2):
-            csi_data_complex[-1][i] = complex(csi_raw_data[i * 2 + 1],
-                                            csi_raw_data[i * 2])
+        # (imag, real) pairs, filled in one vectorized assignment
+        csi_iq = np.asarray(csi_raw_data[:csi_data_len // 2 * 2], dtype=np.float32).reshape(-1, 2)
+        csi_data_complex[-1, :len(csi_iq)] = csi_iq[:, 1] + 1j * csi_iq[:, 0]
     set.close()
     return
 
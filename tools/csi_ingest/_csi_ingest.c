@@ -0,0 +1,1630 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief CPython extension behind csi_ingest.py
+ *
+ * Splits a serial or file stream into `CSI_DATA` CSV lines and csi_frame binary
+ * frames, and writes every record straight into two caller-provided ring
+ * buffers (NumPy arrays, taken through the buffer protocol, so no NumPy headers
+ * are needed to build): int16 I/Q values and a fixed csi_ingest_meta_t per
+ * record. No Python object is created per record or per field; only the lines
+ * that are not CSI records are handed back, and only when asked for.
+ *
+ * An Ingest object is not thread-safe, one thread feeds it. Readers of the rings
+ * in other threads may see the record being written half updated.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define write   _write
+#else
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+#include "csi_frame.h"
+#include "csi_capture.h"
+
+#define CSI_INGEST_LAYOUTS_MAX      8
+#define CSI_INGEST_COLUMNS_MAX      64
+#define CSI_INGEST_LINE_MAX         (64 * 1024)     /**< Longer text without a newline is dropped */
+#define CSI_INGEST_READ_SIZE        (64 * 1024)
+
+#define CSI_DATA_PREFIX             "CSI_DATA,"
+
+/**
+ * @brief Record formats, csi_ingest_meta_t::format
+ */
+enum {
+    CSI_INGEST_FORMAT_DECIMAL = 0,  /**< CSV line, data column `"[v0,v1,...]"` */
+    CSI_INGEST_FORMAT_BASE64,       /**< CSV line, data column base64 of the int8 buffer */
+    CSI_INGEST_FORMAT_BINARY,       /**< csi_frame frame */
+};
+
+/**
+ * @brief One entry of the meta ring, mirrored by META_DTYPE in csi_ingest.py
+ */
+typedef struct {
+    uint32_t seq;
+    uint32_t timestamp;             /**< rx_ctrl timestamp, microseconds */
+    float    compensate_gain;       /**< 1.0 unless a binary frame reports it */
+    uint16_t len;                   /**< Values in the I/Q row, before truncation to the row width */
+    int8_t   rssi;
+    int8_t   noise_floor;
+    uint8_t  rate;
+    uint8_t  channel;
+    uint8_t  agc_gain;
+    int8_t   fft_gain;
+    uint8_t  flags;                 /**< CSI_FRAME_FLAG_* */
+    uint8_t  mac[6];
+    uint8_t  format;                /**< CSI_INGEST_FORMAT_* */
+} csi_ingest_meta_t;
+
+_Static_assert(sizeof(csi_ingest_meta_t) == 28, "csi_ingest_meta_t is mirrored by META_DTYPE");
+
+/**
+ * @brief What a CSV column is parsed into
+ */
+typedef enum {
+    COLUMN_IGNORED = 0,
+    COLUMN_SEQ,
+    COLUMN_TIMESTAMP,
+    COLUMN_RSSI,
+    COLUMN_NOISE_FLOOR,
+    COLUMN_RATE,
+    COLUMN_CHANNEL,
+    COLUMN_AGC_GAIN,
+    COLUMN_FFT_GAIN,
+    COLUMN_FIRST_WORD,
+    COLUMN_MAC,
+    COLUMN_LEN,
+    COLUMN_DATA,
+} column_t;
+
+/**
+ * @brief Column names of the csi_recv, csi_recv_router and console_test CSV layouts
+ */
+static const struct {
+    const char *name;
+    column_t column;
+} s_column_names[] = {
+    {"id",                  COLUMN_SEQ},
+    {"seq",                 COLUMN_SEQ},
+    {"local_timestamp",     COLUMN_TIMESTAMP},
+    {"rssi",                COLUMN_RSSI},
+    {"noise_floor",         COLUMN_NOISE_FLOOR},
+    {"rate",                COLUMN_RATE},
+    {"channel",             COLUMN_CHANNEL},
+    {"channel_primary",     COLUMN_CHANNEL},
+    {"agc_gain",            COLUMN_AGC_GAIN},
+    {"fft_gain",            COLUMN_FFT_GAIN},
+    {"first_word",          COLUMN_FIRST_WORD},
+    {"first_word_invalid",  COLUMN_FIRST_WORD},
+    {"mac",                 COLUMN_MAC},
+    {"len",                 COLUMN_LEN},
+    {"data",                COLUMN_DATA},
+};
+
+/**
+ * @brief Values accepted in the integer columns, a line with any other value is bad
+ */
+static const struct {
+    long long min;
+    long long max;
+} s_column_range[] = {
+    [COLUMN_SEQ]         = {0, UINT32_MAX},
+    [COLUMN_TIMESTAMP]   = {0, UINT32_MAX},
+    [COLUMN_RSSI]        = {INT8_MIN, INT8_MAX},
+    [COLUMN_NOISE_FLOOR] = {INT8_MIN, INT8_MAX},
+    [COLUMN_RATE]        = {0, UINT8_MAX},
+    [COLUMN_CHANNEL]     = {0, UINT8_MAX},
+    [COLUMN_AGC_GAIN]    = {0, UINT8_MAX},
+    [COLUMN_FFT_GAIN]    = {INT8_MIN, INT8_MAX},
+    [COLUMN_FIRST_WORD]  = {0, 1},
+    [COLUMN_LEN]         = {0, UINT16_MAX},
+};
+
+typedef struct {
+    uint8_t column[CSI_INGEST_COLUMNS_MAX];
+    size_t  count;
+} layout_t;
+
+typedef struct {
+    PyObject_HEAD
+    FILE     *fp;
+    csi_capture_writer_t writer;
+    bool      open;
+} CaptureWriterObject;
+
+static PyTypeObject CaptureWriterType;
+
+typedef struct {
+    PyObject_HEAD
+    Py_buffer iq;                   /**< int16 [capacity][width] */
+    Py_buffer meta;                 /**< csi_ingest_meta_t [capacity] */
+    size_t    capacity;
+    size_t    width;
+    layout_t  layouts[CSI_INGEST_LAYOUTS_MAX];
+    size_t    layout_count;
+    uint8_t  *buf;                  /**< Input not parsed yet */
+    size_t    len;
+    size_t    size;
+    size_t    scanned;              /**< Bytes of buf parsed already, behind the start of an unfinished line */
+    PyObject *text;                 /**< List of the lines that are not records, NULL unless keep_text */
+    int       save_fd;              /**< Records are copied here as received, -1 for none */
+    uint8_t  *save_buf;
+    size_t    save_len;
+    size_t    save_size;
+    bool      busy;
+    CaptureWriterObject *capture;   /**< Every record is also appended here, NULL for none */
+    uint64_t  host_time;            /**< Wall clock of the data being parsed, microseconds since the epoch */
+    bool      capture_failed;
+    unsigned long long count;       /**< Records written, the next one goes to count % capacity */
+    unsigned long long bytes;
+    unsigned long long lines;
+    unsigned long long frames;
+    unsigned long long bad;         /**< CSI lines or frames that could not be decoded */
+    unsigned long long truncated;   /**< Records with more values than the row width */
+} IngestObject;
+
+static const int8_t s_base64_table[256] = {
+    ['A'] = 1,  ['B'] = 2,  ['C'] = 3,  ['D'] = 4,  ['E'] = 5,  ['F'] = 6,  ['G'] = 7,  ['H'] = 8,
+    ['I'] = 9,  ['J'] = 10, ['K'] = 11, ['L'] = 12, ['M'] = 13, ['N'] = 14, ['O'] = 15, ['P'] = 16,
+    ['Q'] = 17, ['R'] = 18, ['S'] = 19, ['T'] = 20, ['U'] = 21, ['V'] = 22, ['W'] = 23, ['X'] = 24,
+    ['Y'] = 25, ['Z'] = 26, ['a'] = 27, ['b'] = 28, ['c'] = 29, ['d'] = 30, ['e'] = 31, ['f'] = 32,
+    ['g'] = 33, ['h'] = 34, ['i'] = 35, ['j'] = 36, ['k'] = 37, ['l'] = 38, ['m'] = 39, ['n'] = 40,
+    ['o'] = 41, ['p'] = 42, ['q'] = 43, ['r'] = 44, ['s'] = 45, ['t'] = 46, ['u'] = 47, ['v'] = 48,
+    ['w'] = 49, ['x'] = 50, ['y'] = 51, ['z'] = 52, ['0'] = 53, ['1'] = 54, ['2'] = 55, ['3'] = 56,
+    ['4'] = 57, ['5'] = 58, ['6'] = 59, ['7'] = 60, ['8'] = 61, ['9'] = 62, ['+'] = 63, ['/'] = 64,
+};
+
+/**
+ * @brief Decode base64 up to the first byte outside the alphabet
+ *
+ * Log output that the device printed into the middle of a line ends the data there, like the
+ * regular expressions of esp_csi_tool.py did. Missing padding is accepted.
+ *
+ * @return Bytes decoded; at most max_count are written to out
+ */
+static size_t base64_decode(const uint8_t *p, const uint8_t *end, int8_t *out, size_t max_count, size_t *written)
+{
+    uint32_t acc = 0;
+    int bits = 0;
+    size_t count = 0;
+
+    *written = 0;
+
+    for (; p < end && s_base64_table[*p]; p++) {
+        acc = acc << 6 | (uint32_t)(s_base64_table[*p] - 1);
+        bits += 6;
+
+        if (bits >= 8) {
+            bits -= 8;
+
+            if (count < max_count) {
+                out[count] = (int8_t)(acc >> bits);
+                (*written)++;
+            }
+
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief A whole field as a decimal integer: spaces, an optional sign, digits, spaces and nothing else
+ *
+ * Values past 2^50 saturate, every caller range-checks or clamps far below that.
+ */
+static bool parse_int(const uint8_t *p, const uint8_t *end, long long *value)
+{
+    bool negative = false;
+    long long v = 0;
+
+    while (p < end && *p == ' ') {
+        p++;
+    }
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+
+    if (p == end || *p < '0' || *p > '9') {
+        return false;
+    }
+
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        v = v < (1LL << 50) ? v * 10 + (*p - '0') : v;
+    }
+
+    while (p < end && *p == ' ') {
+        p++;
+    }
+
+    if (p != end) {
+        return false;
+    }
+
+    *value = negative ? -v : v;
+
+    return true;
+}
+
+/**
+ * @brief Six hex byte pairs separated by ':' or '-', as MACSTR prints them, and nothing else
+ */
+static bool parse_mac(const uint8_t *p, const uint8_t *end, uint8_t mac[6])
+{
+    if (end - p != 17) {
+        return false;
+    }
+
+    for (int i = 0; i < 6; i++) {
+        const uint8_t *pair = p + 3 * i;
+        unsigned int byte = 0;
+
+        if (i && pair[-1] != ':' && pair[-1] != '-') {
+            return false;
+        }
+
+        for (int j = 0; j < 2; j++) {
+            unsigned int c = pair[j];
+            unsigned int nibble = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+                                  c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16;
+
+            if (nibble > 15) {
+                return false;
+            }
+
+            byte = byte << 4 | nibble;
+        }
+
+        mac[i] = byte;
+    }
+
+    return true;
+}
+
+static bool buf_reserve(uint8_t **buf, size_t *size, size_t needed)
+{
+    if (needed <= *size) {
+        return true;
+    }
+
+    size_t new_size = *size ? *size : 4096;
+
+    while (new_size < needed) {
+        new_size *= 2;
+    }
+
+    uint8_t *new_buf = PyMem_Realloc(*buf, new_size);
+
+    if (!new_buf) {
+        PyErr_NoMemory();
+        return false;
+    }
+
+    *buf  = new_buf;
+    *size = new_size;
+
+    return true;
+}
+
+static bool ingest_save(IngestObject *self, const uint8_t *data, size_t len, bool newline)
+{
+    if (self->save_fd < 0) {
+        return true;
+    }
+
+    if (!buf_reserve(&self->save_buf, &self->save_size, self->save_len + len + 1)) {
+        return false;
+    }
+
+    memcpy(self->save_buf + self->save_len, data, len);
+    self->save_len += len;
+
+    if (newline) {
+        self->save_buf[self->save_len++] = '\n';
+    }
+
+    return true;
+}
+
+static int ingest_save_flush(IngestObject *self)
+{
+    const uint8_t *p = self->save_buf;
+    size_t len = self->save_len;
+
+    self->save_len = 0;
+
+    while (len) {
+        Py_ssize_t ret = write(self->save_fd, p, (unsigned int)len);
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            PyErr_SetFromErrno(PyExc_OSError);
+            return -1;
+        }
+
+        p   += ret;
+        len -= ret;
+    }
+
+    return 0;
+}
+
+static inline csi_ingest_meta_t *ingest_meta_slot(IngestObject *self)
+{
+    return (csi_ingest_meta_t *)self->meta.buf + self->count % self->capacity;
+}
+
+static inline int16_t *ingest_iq_row(IngestObject *self)
+{
+    return (int16_t *)self->iq.buf + (self->count % self->capacity) * self->width;
+}
+
+/**
+ * @brief Append the record in the current slot to the capture
+ *
+ * @param header The frame it came from, NULL for a CSV line
+ */
+static void ingest_capture(IngestObject *self, const csi_ingest_meta_t *meta, const int16_t *row, size_t written,
+                           const csi_frame_header_t *header)
+{
+    csi_capture_record_t record = {
+        .host_time       = self->host_time,
+        .seq             = meta->seq,
+        .timestamp       = meta->timestamp,
+        .compensate_gain = meta->compensate_gain,
+        .len             = meta->len,
+        .rssi            = meta->rssi,
+        .noise_floor     = meta->noise_floor,
+        .rate            = meta->rate,
+        .channel         = meta->channel,
+        .agc_gain        = meta->agc_gain,
+        .fft_gain        = meta->fft_gain,
+        .flags           = meta->flags,
+        .format          = meta->format,
+    };
+    memcpy(record.mac, meta->mac, sizeof(record.mac));
+
+    if (header) {
+        record.sig_len           = header->sig_len;
+        record.sig_mode          = header->sig_mode;
+        record.mcs               = header->mcs;
+        record.cwb               = header->cwb;
+        record.secondary_channel = header->secondary_channel;
+        record.stbc              = header->stbc;
+        record.sgi               = header->sgi;
+        record.rx_state          = header->rx_state;
+        record.ampdu_cnt         = header->ampdu_cnt;
+        record.rx_misc           = header->rx_misc;
+    }
+
+    csi_capture_writer_t *writer = &self->capture->writer;
+
+    if (!csi_capture_writer_append(writer, &record, row, written)) {
+        self->capture_failed = true;
+    }
+
+    writer->truncated += written < record.len && written <= writer->iq_width;
+}
+
+/**
+ * @brief Finish the record in the current slot: zero the rest of its row and publish it
+ */
+static void ingest_commit(IngestObject *self, csi_ingest_meta_t *meta, size_t total, size_t written,
+                          const csi_frame_header_t *header)
+{
+    int16_t *row = ingest_iq_row(self);
+
+    memset(row + written, 0, (self->width - written) * sizeof(int16_t));
+    meta->len = total > UINT16_MAX ? UINT16_MAX : (uint16_t)total;
+    self->truncated += total > written;
+
+    if (self->capture && self->capture->open) {
+        ingest_capture(self, meta, row, written, header);
+    }
+
+    self->count++;
+}
+
+/**
+ * @brief Parse a CSI_DATA line into the next slot
+ *
+ * @param p   The `CSI_DATA,` prefix
+ */
+static bool ingest_csv(IngestObject *self, const uint8_t *p, const uint8_t *end)
+{
+    const uint8_t *field[CSI_INGEST_COLUMNS_MAX];
+    const uint8_t *field_end[CSI_INGEST_COLUMNS_MAX];
+    size_t count = 0;
+
+    /**
+     * @brief Split the columns, a quoted column may contain commas
+     */
+    while (p <= end) {
+        if (count == CSI_INGEST_COLUMNS_MAX) {
+            return false;
+        }
+
+        if (p < end && *p == '"') {
+            const uint8_t *quote = memchr(p + 1, '"', end - p - 1);
+
+            if (!quote) {
+                return false;
+            }
+
+            field[count] = p + 1;
+            field_end[count++] = quote;
+            p = quote + 1;
+        } else {
+            const uint8_t *comma = memchr(p, ',', end - p);
+            field[count] = p;
+            field_end[count++] = comma ? comma : end;
+            p = comma ? comma : end;
+        }
+
+        if (p == end) {
+            break;
+        }
+
+        if (*p++ != ',') {
+            return false;
+        }
+    }
+
+    const layout_t *layout = NULL;
+
+    for (size_t i = 0; i < self->layout_count && !layout; i++) {
+        if (self->layouts[i].count == count) {
+            layout = &self->layouts[i];
+        }
+    }
+
+    if (!layout) {
+        return false;
+    }
+
+    csi_ingest_meta_t *meta = ingest_meta_slot(self);
+    const uint8_t *data = NULL;
+    const uint8_t *data_end = NULL;
+    long long expected_len = -1;
+
+    memset(meta, 0, sizeof(csi_ingest_meta_t));
+    meta->compensate_gain = 1.0f;
+
+    for (size_t i = 0; i < count; i++) {
+        long long value = 0;
+
+        switch (layout->column[i]) {
+        case COLUMN_IGNORED:
+            continue;
+
+        case COLUMN_DATA:
+            data = field[i];
+            data_end = field_end[i];
+            continue;
+
+        case COLUMN_MAC:
+            if (!parse_mac(field[i], field_end[i], meta->mac)) {
+                return false;
+            }
+
+            continue;
+
+        default:
+            if (!parse_int(field[i], field_end[i], &value) || value < s_column_range[layout->column[i]].min ||
+                    value > s_column_range[layout->column[i]].max) {
+                return false;
+            }
+
+            break;
+        }
+
+        switch (layout->column[i]) {
+        case COLUMN_SEQ:         meta->seq = (uint32_t)value; break;
+        case COLUMN_TIMESTAMP:   meta->timestamp = (uint32_t)value; break;
+        case COLUMN_RSSI:        meta->rssi = (int8_t)value; break;
+        case COLUMN_NOISE_FLOOR: meta->noise_floor = (int8_t)value; break;
+        case COLUMN_RATE:        meta->rate = (uint8_t)value; break;
+        case COLUMN_CHANNEL:     meta->channel = (uint8_t)value; break;
+        case COLUMN_AGC_GAIN:    meta->agc_gain = (uint8_t)value; break;
+        case COLUMN_FFT_GAIN:    meta->fft_gain = (int8_t)value; break;
+        case COLUMN_FIRST_WORD:  meta->flags |= value ? CSI_FRAME_FLAG_FIRST_WORD_INVALID : 0; break;
+        case COLUMN_LEN:         expected_len = value; break;
+        default: break;
+        }
+    }
+
+    if (!data) {
+        return false;
+    }
+
+    int16_t *row = ingest_iq_row(self);
+    size_t total = 0;
+    size_t written = 0;
+
+    if (data < data_end && *data == '[') {
+        const uint8_t *q = data + 1;
+        bool closed = false;
+
+        meta->format = CSI_INGEST_FORMAT_DECIMAL;
+
+        /**
+         * @brief Every element a whole integer, the closing ']' the last byte of the column
+         */
+        while (!closed) {
+            const uint8_t *element_end = q;
+            long long value;
+
+            while (element_end < data_end && *element_end != ',' && *element_end != ']') {
+                element_end++;
+            }
+
+            if (element_end == data_end || !parse_int(q, element_end, &value)) {
+                return false;
+            }
+
+            if (written < self->width) {
+                row[written++] = value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : (int16_t)value;
+            }
+
+            total++;
+            closed = *element_end == ']';
+            q = element_end + 1;
+        }
+
+        if (q != data_end) {
+            return false;
+        }
+    } else {
+        /**
+         * @brief Decode into the tail of the row, then widen in place from the front
+         */
+        int8_t *bytes = (int8_t *)(row + self->width) - self->width;
+
+        meta->format = CSI_INGEST_FORMAT_BASE64;
+        total = base64_decode(data, data_end, bytes, self->width, &written);
+
+        for (size_t i = 0; i < written; i++) {
+            row[i] = bytes[i];
+        }
+    }
+
+    if (!total || (expected_len >= 0 && (size_t)expected_len != total)) {
+        return false;
+    }
+
+    ingest_commit(self, meta, total, written, NULL);
+
+    return true;
+}
+
+static void ingest_frame(IngestObject *self, const csi_frame_header_t *header, const uint8_t *payload)
+{
+    if (header->type != CSI_FRAME_TYPE_CSI) {
+        return;
+    }
+
+    csi_ingest_meta_t *meta = ingest_meta_slot(self);
+    size_t total = header->flags & CSI_FRAME_FLAG_PAYLOAD_INT12 ? header->payload_len / 2 : header->payload_len;
+
+    memset(meta, 0, sizeof(csi_ingest_meta_t));
+    meta->seq             = header->seq;
+    meta->timestamp       = header->timestamp;
+    meta->compensate_gain = header->compensate_gain;
+    meta->rssi            = header->rssi;
+    meta->noise_floor     = header->noise_floor;
+    meta->rate            = header->rate;
+    meta->channel         = header->channel;
+    meta->agc_gain        = header->agc_gain;
+    meta->fft_gain        = header->fft_gain;
+    meta->flags           = header->flags;
+    meta->format          = CSI_INGEST_FORMAT_BINARY;
+    memcpy(meta->mac, header->mac, sizeof(meta->mac));
+
+    size_t written = csi_frame_payload_to_int16(header, payload, ingest_iq_row(self), self->width);
+    ingest_commit(self, meta, total, written, header);
+}
+
+static bool ingest_text(IngestObject *self, const uint8_t *line, size_t len)
+{
+    if (!self->text) {
+        return true;
+    }
+
+    PyObject *bytes = PyBytes_FromStringAndSize((const char *)line, len);
+
+    if (!bytes || PyList_Append(self->text, bytes) < 0) {
+        Py_XDECREF(bytes);
+        return false;
+    }
+
+    Py_DECREF(bytes);
+
+    return true;
+}
+
+static bool ingest_line(IngestObject *self, const uint8_t *line, size_t len)
+{
+    while (len && (line[len - 1] == '\r' || line[len - 1] == '\n')) {
+        len--;
+    }
+
+    if (!len) {
+        return true;
+    }
+
+    self->lines++;
+
+    const uint8_t *end = line + len;
+    const uint8_t *p = line;
+
+    while ((p = memchr(p, 'C', end - p)) != NULL && (size_t)(end - p) >= sizeof(CSI_DATA_PREFIX) - 1 &&
+            memcmp(p, CSI_DATA_PREFIX, sizeof(CSI_DATA_PREFIX) - 1)) {
+        p++;
+    }
+
+    if (!p || (size_t)(end - p) < sizeof(CSI_DATA_PREFIX) - 1) {
+        return ingest_text(self, line, len);
+    }
+
+    if (!ingest_csv(self, p, end)) {
+        self->bad++;
+        return ingest_text(self, line, len);
+    }
+
+    return ingest_save(self, p, end - p, true);
+}
+
+/**
+ * @brief Parse everything complete in self->buf, keep the unfinished rest
+ *
+ * Text lines end at '\n'. A frame starts at the csi_frame sync bytes, which cannot appear in text.
+ */
+static int ingest_parse(IngestObject *self)
+{
+    size_t records = self->count;
+    size_t start = 0;
+    size_t pos = self->scanned;
+    struct timespec now;
+
+    if (self->capture && timespec_get(&now, TIME_UTC)) {
+        self->host_time = (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+    }
+
+    while (pos < self->len) {
+        const uint8_t *p = self->buf + pos;
+        size_t avail = self->len - pos;
+        uint8_t c = *p;
+
+        if (c == '\n') {
+            if (!ingest_line(self, self->buf + start, pos - start)) {
+                return -1;
+            }
+
+            start = pos = pos + 1;
+            continue;
+        }
+
+        if (c != CSI_FRAME_SYNC0) {
+            const uint8_t *next = p + 1;
+
+            while (next < self->buf + self->len && *next != '\n' && *next != CSI_FRAME_SYNC0) {
+                next++;
+            }
+
+            pos = next - self->buf;
+            continue;
+        }
+
+        csi_frame_header_t header;
+        const uint8_t *payload;
+        size_t consumed;
+        csi_frame_status_t status = csi_frame_decode(p, avail, &header, &payload, &consumed);
+
+        if (status == CSI_FRAME_NEED_MORE) {
+            break;
+        }
+
+        if (status == CSI_FRAME_INVALID) {
+            if (avail >= 2 && p[1] == CSI_FRAME_SYNC1) {
+                self->bad++;
+            }
+
+            pos++;
+            continue;
+        }
+
+        /**
+         * @brief Text printed right before the frame without a newline is a line of its own
+         */
+        if (pos > start && !ingest_line(self, self->buf + start, pos - start)) {
+            return -1;
+        }
+
+        self->frames++;
+        ingest_frame(self, &header, payload);
+
+        if (!ingest_save(self, p, consumed, false)) {
+            return -1;
+        }
+
+        start = pos = pos + consumed;
+    }
+
+    /**
+     * @brief Give up on text that never ends, it is not a CSI record
+     */
+    if (self->len - start > CSI_INGEST_LINE_MAX) {
+        if (!ingest_line(self, self->buf + start, self->len - start)) {
+            return -1;
+        }
+
+        start = self->len;
+        pos = start;
+    }
+
+    /**
+     * @brief Resume after what was parsed, so an invalid frame before the unfinished line is counted once
+     */
+    self->scanned = pos - start;
+    self->len -= start;
+
+    if (self->len && start) {
+        memmove(self->buf, self->buf + start, self->len);
+    }
+
+    if (self->save_len && ingest_save_flush(self) < 0) {
+        return -1;
+    }
+
+    if (self->capture_failed) {
+        self->capture_failed = false;
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+
+    return (int)(self->count - records);
+}
+
+static bool ingest_enter(IngestObject *self)
+{
+    if (!self->iq.buf) {
+        PyErr_SetString(PyExc_ValueError, "Ingest is not initialized");
+        return false;
+    }
+
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "Ingest is used by another thread");
+        return false;
+    }
+
+    self->busy = true;
+
+    return true;
+}
+
+static PyObject *Ingest_feed(IngestObject *self, PyObject *arg)
+{
+    Py_buffer data;
+
+    if (PyObject_GetBuffer(arg, &data, PyBUF_SIMPLE) < 0) {
+        return NULL;
+    }
+
+    if (!ingest_enter(self)) {
+        PyBuffer_Release(&data);
+        return NULL;
+    }
+
+    int records = -1;
+
+    if (buf_reserve(&self->buf, &self->size, self->len + data.len)) {
+        memcpy(self->buf + self->len, data.buf, data.len);
+        self->len   += data.len;
+        self->bytes += data.len;
+        records = ingest_parse(self);
+    }
+
+    self->busy = false;
+    PyBuffer_Release(&data);
+
+    return records < 0 ? NULL : PyLong_FromLong(records);
+}
+
+static PyObject *Ingest_read(IngestObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"fd", "timeout", NULL};
+    int fd;
+    double timeout = 0.1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|d", keywords, &fd, &timeout)) {
+        return NULL;
+    }
+
+    if (!ingest_enter(self)) {
+        return NULL;
+    }
+
+    if (!buf_reserve(&self->buf, &self->size, self->len + CSI_INGEST_READ_SIZE)) {
+        self->busy = false;
+        return NULL;
+    }
+
+    Py_ssize_t ret = 0;
+    int err = 0;
+
+    /**
+     * @brief Wait and read without the GIL, the GUI thread keeps running meanwhile
+     */
+    Py_BEGIN_ALLOW_THREADS
+#ifndef _WIN32
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    ret = poll(&pfd, 1, timeout < 0 ? -1 : (int)(timeout * 1000));
+
+    if (ret > 0) {
+        ret = read(fd, self->buf + self->len, CSI_INGEST_READ_SIZE);
+    } else if (!ret) {
+        ret = -1;
+        errno = EAGAIN;
+    }
+#else
+    ret = _read(fd, self->buf + self->len, CSI_INGEST_READ_SIZE);
+#endif
+    err = errno;
+    Py_END_ALLOW_THREADS
+
+    if (ret < 0) {
+        self->busy = false;
+
+        if (err == EAGAIN || err == EWOULDBLOCK || err == EINTR) {
+            if (err == EINTR && PyErr_CheckSignals() < 0) {
+                return NULL;
+            }
+
+            return PyLong_FromLong(0);
+        }
+
+        errno = err;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    if (!ret) {
+        self->busy = false;
+        PyErr_SetString(PyExc_EOFError, "end of stream");
+        return NULL;
+    }
+
+    self->len   += ret;
+    self->bytes += ret;
+    int records = ingest_parse(self);
+    self->busy = false;
+
+    return records < 0 ? NULL : PyLong_FromSsize_t(ret);
+}
+
+static PyObject *Ingest_take_text(IngestObject *self, PyObject *Py_UNUSED(ignored))
+{
+    if (!self->text) {
+        return PyList_New(0);
+    }
+
+    PyObject *text = self->text;
+    self->text = PyList_New(0);
+
+    if (!self->text) {
+        self->text = text;
+        return NULL;
+    }
+
+    return text;
+}
+
+static PyObject *Ingest_stats(IngestObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K}",
+                         "records", self->count, "bytes", self->bytes, "lines", self->lines,
+                         "frames", self->frames, "bad", self->bad, "truncated", self->truncated);
+}
+
+static PyObject *Ingest_get_count(IngestObject *self, void *closure)
+{
+    return PyLong_FromUnsignedLongLong(self->count);
+}
+
+static int Ingest_init(IngestObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"iq", "meta", "layouts", "keep_text", "save_fd", "capture", NULL};
+    PyObject *iq;
+    PyObject *meta;
+    PyObject *layouts;
+    int keep_text = 0;
+    int save_fd = -1;
+    PyObject *capture = Py_None;
+
+    if (self->iq.buf) {
+        PyErr_SetString(PyExc_RuntimeError, "Ingest is already initialized");
+        return -1;
+    }
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|piO", keywords, &iq, &meta, &layouts, &keep_text, &save_fd,
+                                     &capture)) {
+        return -1;
+    }
+
+    if (capture != Py_None && !PyObject_TypeCheck(capture, &CaptureWriterType)) {
+        PyErr_SetString(PyExc_TypeError, "capture must be a CaptureWriter or None");
+        return -1;
+    }
+
+    if (PyObject_GetBuffer(iq, &self->iq, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) < 0) {
+        return -1;
+    }
+
+    if (self->iq.ndim != 2 || self->iq.itemsize != sizeof(int16_t) || !self->iq.shape[0] || !self->iq.shape[1] ||
+            !self->iq.format || (strcmp(self->iq.format, "h") && strcmp(self->iq.format, "<h") && strcmp(self->iq.format, "=h"))) {
+        PyErr_SetString(PyExc_ValueError, "iq must be a C-contiguous 2-D int16 array");
+        goto ERR;
+    }
+
+    self->capacity = self->iq.shape[0];
+    self->width    = self->iq.shape[1];
+
+    if (PyObject_GetBuffer(meta, &self->meta, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) < 0) {
+        goto ERR;
+    }
+
+    if ((size_t)self->meta.len != self->capacity * sizeof(csi_ingest_meta_t)) {
+        PyErr_Format(PyExc_ValueError, "meta must be %zu records of %zu bytes", self->capacity, sizeof(csi_ingest_meta_t));
+        goto ERR;
+    }
+
+    PyObject *layout_seq = PySequence_Fast(layouts, "layouts must be a sequence of column name sequences");
+
+    if (!layout_seq) {
+        goto ERR;
+    }
+
+    Py_ssize_t layout_count = PySequence_Fast_GET_SIZE(layout_seq);
+
+    if (layout_count < 1 || layout_count > CSI_INGEST_LAYOUTS_MAX) {
+        PyErr_Format(PyExc_ValueError, "1 to %d layouts are supported", CSI_INGEST_LAYOUTS_MAX);
+        Py_DECREF(layout_seq);
+        goto ERR;
+    }
+
+    for (Py_ssize_t i = 0; i < layout_count; i++) {
+        PyObject *names = PySequence_Fast(PySequence_Fast_GET_ITEM(layout_seq, i), "a layout must be a sequence of column names");
+        layout_t *layout = &self->layouts[i];
+
+        if (!names) {
+            Py_DECREF(layout_seq);
+            goto ERR;
+        }
+
+        layout->count = PySequence_Fast_GET_SIZE(names);
+
+        if (layout->count > CSI_INGEST_COLUMNS_MAX) {
+            PyErr_Format(PyExc_ValueError, "at most %d columns are supported", CSI_INGEST_COLUMNS_MAX);
+            Py_DECREF(names);
+            Py_DECREF(layout_seq);
+            goto ERR;
+        }
+
+        bool has_data = false;
+
+        for (size_t j = 0; j < layout->count; j++) {
+            const char *name = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(names, j));
+
+            if (!name) {
+                Py_DECREF(names);
+                Py_DECREF(layout_seq);
+                goto ERR;
+            }
+
+            layout->column[j] = COLUMN_IGNORED;
+
+            for (size_t k = 0; k < sizeof(s_column_names) / sizeof(s_column_names[0]); k++) {
+                if (!strcmp(name, s_column_names[k].name)) {
+                    layout->column[j] = s_column_names[k].column;
+                }
+            }
+
+            has_data |= layout->column[j] == COLUMN_DATA;
+        }
+
+        Py_DECREF(names);
+
+        if (!has_data) {
+            PyErr_SetString(PyExc_ValueError, "every layout needs a 'data' column");
+            Py_DECREF(layout_seq);
+            goto ERR;
+        }
+    }
+
+    Py_DECREF(layout_seq);
+    self->layout_count = layout_count;
+    self->save_fd = save_fd;
+
+    if (keep_text && !(self->text = PyList_New(0))) {
+        goto ERR;
+    }
+
+    if (capture != Py_None) {
+        Py_INCREF(capture);
+        self->capture = (CaptureWriterObject *)capture;
+    }
+
+    return 0;
+
+ERR:
+    if (self->meta.obj) {
+        PyBuffer_Release(&self->meta);
+    }
+
+    PyBuffer_Release(&self->iq);
+    memset(&self->iq, 0, sizeof(Py_buffer));
+    memset(&self->meta, 0, sizeof(Py_buffer));
+
+    return -1;
+}
+
+static void Ingest_dealloc(IngestObject *self)
+{
+    if (self->iq.obj) {
+        PyBuffer_Release(&self->iq);
+    }
+
+    if (self->meta.obj) {
+        PyBuffer_Release(&self->meta);
+    }
+
+    Py_XDECREF(self->text);
+    Py_XDECREF(self->capture);
+    PyMem_Free(self->buf);
+    PyMem_Free(self->save_buf);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyMethodDef Ingest_methods[] = {
+    {"feed", (PyCFunction)Ingest_feed, METH_O,
+     "feed(data) -> records\n\nParse a chunk of the stream, any split is fine."},
+    {"read", (PyCFunction)(void (*)(void))Ingest_read, METH_VARARGS | METH_KEYWORDS,
+     "read(fd, timeout=0.1) -> bytes read\n\nWait up to timeout seconds for data on fd without the GIL, read and parse it.\n"
+     "Returns 0 on timeout, raises EOFError at the end of the stream."},
+    {"take_text", (PyCFunction)Ingest_take_text, METH_NOARGS,
+     "take_text() -> list of bytes\n\nLines that were not CSI records since the last call (keep_text=True)."},
+    {"stats", (PyCFunction)Ingest_stats, METH_NOARGS,
+     "stats() -> dict\n\nTotal records, bytes, lines, frames, bad records and truncated records."},
+    {NULL},
+};
+
+static PyGetSetDef Ingest_getset[] = {
+    {"count", (getter)Ingest_get_count, NULL, "Records written so far, the newest is at (count - 1) % capacity", NULL},
+    {NULL},
+};
+
+static PyTypeObject IngestType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "_csi_ingest.Ingest",
+    .tp_doc       = "Ingest(iq, meta, layouts, keep_text=False, save_fd=-1, capture=None)\n\n"
+                    "Parse CSI_DATA lines and csi_frame frames into the iq (int16 [capacity, width])\n"
+                    "and meta (META_ITEMSIZE-byte records [capacity]) rings, and append them to the\n"
+                    "CaptureWriter capture if given.",
+    .tp_basicsize = sizeof(IngestObject),
+    .tp_flags     = Py_TPFLAGS_DEFAULT,
+    .tp_new       = PyType_GenericNew,
+    .tp_init      = (initproc)Ingest_init,
+    .tp_dealloc   = (destructor)Ingest_dealloc,
+    .tp_methods   = Ingest_methods,
+    .tp_getset    = Ingest_getset,
+};
+
+static int CaptureWriter_init(CaptureWriterObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"path", "iq_width", "chunk_records", "created", NULL};
+    PyObject *path;
+    unsigned int iq_width;
+    unsigned int chunk_records = 0;
+    unsigned long long created = 0;
+
+    if (self->open) {
+        PyErr_SetString(PyExc_RuntimeError, "CaptureWriter is already open");
+        return -1;
+    }
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&I|IK", keywords, PyUnicode_FSConverter, &path,
+                                     &iq_width, &chunk_records, &created)) {
+        return -1;
+    }
+
+    if (!iq_width || iq_width > CSI_CAPTURE_MAX_IQ_WIDTH) {
+        PyErr_Format(PyExc_ValueError, "iq_width must be 1 to %d", CSI_CAPTURE_MAX_IQ_WIDTH);
+        Py_DECREF(path);
+        return -1;
+    }
+
+    self->fp = fopen(PyBytes_AS_STRING(path), "wb");
+
+    if (!self->fp) {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        Py_DECREF(path);
+        return -1;
+    }
+
+    Py_DECREF(path);
+
+    if (!csi_capture_writer_open(&self->writer, self->fp, (uint16_t)iq_width, chunk_records, created)) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        fclose(self->fp);
+        self->fp = NULL;
+        return -1;
+    }
+
+    self->open = true;
+
+    return 0;
+}
+
+static bool capture_writer_check(CaptureWriterObject *self)
+{
+    if (!self->open) {
+        PyErr_SetString(PyExc_ValueError, "CaptureWriter is closed");
+    }
+
+    return self->open;
+}
+
+static PyObject *CaptureWriter_write(CaptureWriterObject *self, PyObject *args)
+{
+    PyObject *iq_obj;
+    PyObject *records_obj;
+    Py_buffer iq;
+    Py_buffer records;
+    PyObject *ret = NULL;
+
+    if (!PyArg_ParseTuple(args, "OO", &iq_obj, &records_obj) || !capture_writer_check(self)) {
+        return NULL;
+    }
+
+    if (PyObject_GetBuffer(iq_obj, &iq, PyBUF_C_CONTIGUOUS) < 0) {
+        return NULL;
+    }
+
+    if (PyObject_GetBuffer(records_obj, &records, PyBUF_C_CONTIGUOUS) < 0) {
+        PyBuffer_Release(&iq);
+        return NULL;
+    }
+
+    size_t count = records.len / sizeof(csi_capture_record_t);
+    size_t width = iq.ndim == 2 ? (size_t)iq.shape[1] : 0;
+
+    if (iq.ndim != 2 || iq.itemsize != sizeof(int16_t) || (size_t)iq.shape[0] != count ||
+            records.len % sizeof(csi_capture_record_t)) {
+        PyErr_Format(PyExc_ValueError, "iq must be int16 [n, width] and records n records of %zu bytes",
+                     sizeof(csi_capture_record_t));
+        goto EXIT;
+    }
+
+    const csi_capture_record_t *record = records.buf;
+    const int16_t *row = iq.buf;
+    bool ok = true;
+
+    for (size_t i = 0; i < count && ok; i++, record++, row += width) {
+        size_t kept = record->len < width ? record->len : width;
+        ok = csi_capture_writer_append(&self->writer, record, row, kept);
+        self->writer.truncated += kept < record->len && kept <= self->writer.iq_width;
+    }
+
+    ret = ok ? PyLong_FromSize_t(count) : PyErr_SetFromErrno(PyExc_OSError);
+
+EXIT:
+    PyBuffer_Release(&records);
+    PyBuffer_Release(&iq);
+
+    return ret;
+}
+
+static PyObject *CaptureWriter_flush(CaptureWriterObject *self, PyObject *Py_UNUSED(ignored))
+{
+    if (!capture_writer_check(self)) {
+        return NULL;
+    }
+
+    if (!csi_capture_writer_flush(&self->writer)) {
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *CaptureWriter_close(CaptureWriterObject *self, PyObject *Py_UNUSED(ignored))
+{
+    if (!self->open) {
+        Py_RETURN_NONE;
+    }
+
+    bool ok = csi_capture_writer_close(&self->writer);
+    ok = !fclose(self->fp) && ok;
+    self->fp = NULL;
+    self->open = false;
+
+    if (!ok) {
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *CaptureWriter_get_records(CaptureWriterObject *self, void *closure)
+{
+    return PyLong_FromUnsignedLongLong(self->writer.records);
+}
+
+static PyObject *CaptureWriter_get_truncated(CaptureWriterObject *self, void *closure)
+{
+    return PyLong_FromUnsignedLongLong(self->writer.truncated);
+}
+
+static PyObject *CaptureWriter_get_closed(CaptureWriterObject *self, void *closure)
+{
+    return PyBool_FromLong(!self->open);
+}
+
+static void CaptureWriter_dealloc(CaptureWriterObject *self)
+{
+    if (self->open) {
+        csi_capture_writer_close(&self->writer);
+        fclose(self->fp);
+    }
+
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyMethodDef CaptureWriter_methods[] = {
+    {"write", (PyCFunction)CaptureWriter_write, METH_VARARGS,
+     "write(iq, records) -> records\n\nAppend int16 I/Q rows [n, width] and their RECORD_ITEMSIZE-byte records.\n"
+     "min(len, width) values of each row are kept."},
+    {"flush", (PyCFunction)CaptureWriter_flush, METH_NOARGS,
+     "flush()\n\nWrite the pending records as a chunk, so a reader sees them."},
+    {"close", (PyCFunction)CaptureWriter_close, METH_NOARGS,
+     "close()\n\nFlush and close the file."},
+    {NULL},
+};
+
+static PyGetSetDef CaptureWriter_getset[] = {
+    {"records", (getter)CaptureWriter_get_records, NULL, "Records appended", NULL},
+    {"truncated", (getter)CaptureWriter_get_truncated, NULL, "Records with more values than iq_width", NULL},
+    {"closed", (getter)CaptureWriter_get_closed, NULL, "close() was called, an Ingest stops appending", NULL},
+    {NULL},
+};
+
+static PyTypeObject CaptureWriterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "_csi_ingest.CaptureWriter",
+    .tp_doc       = "CaptureWriter(path, iq_width, chunk_records=0, created=0)\n\n"
+                    "Write a csi_capture file, see components/csi_capture.",
+    .tp_basicsize = sizeof(CaptureWriterObject),
+    .tp_flags     = Py_TPFLAGS_DEFAULT,
+    .tp_new       = PyType_GenericNew,
+    .tp_init      = (initproc)CaptureWriter_init,
+    .tp_dealloc   = (destructor)CaptureWriter_dealloc,
+    .tp_methods   = CaptureWriter_methods,
+    .tp_getset    = CaptureWriter_getset,
+};
+
+typedef struct {
+    PyObject_HEAD
+    Py_buffer data;
+    csi_capture_reader_t reader;
+} CaptureReaderObject;
+
+static int CaptureReader_init(CaptureReaderObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"data", NULL};
+    PyObject *data;
+
+    if (self->data.obj) {
+        PyErr_SetString(PyExc_RuntimeError, "CaptureReader is already open");
+        return -1;
+    }
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", keywords, &data) ||
+            PyObject_GetBuffer(data, &self->data, PyBUF_SIMPLE) < 0) {
+        return -1;
+    }
+
+    if (!csi_capture_reader_open(&self->reader, self->data.buf, self->data.len)) {
+        PyErr_SetString(PyExc_ValueError, "not a csi_capture file");
+        PyBuffer_Release(&self->data);
+        memset(&self->data, 0, sizeof(Py_buffer));
+        return -1;
+    }
+
+    return 0;
+}
+
+static bool capture_reader_check(CaptureReaderObject *self)
+{
+    if (!self->data.obj) {
+        PyErr_SetString(PyExc_ValueError, "CaptureReader is closed");
+    }
+
+    return self->data.obj != NULL;
+}
+
+static PyObject *CaptureReader_columns(CaptureReaderObject *self, PyObject *Py_UNUSED(ignored))
+{
+    if (!capture_reader_check(self)) {
+        return NULL;
+    }
+
+    PyObject *list = PyList_New(self->reader.header.column_count);
+
+    for (Py_ssize_t i = 0; list && i < self->reader.header.column_count; i++) {
+        const csi_capture_column_t *column = &self->reader.columns[i];
+        PyObject *item = Py_BuildValue("(s#s#)", column->name, strnlen(column->name, sizeof(column->name)),
+                                       column->type, strnlen(column->type, sizeof(column->type)));
+
+        if (!item) {
+            Py_CLEAR(list);
+            break;
+        }
+
+        PyList_SET_ITEM(list, i, item);
+    }
+
+    return list;
+}
+
+static PyObject *CaptureReader_chunks(CaptureReaderObject *self, PyObject *Py_UNUSED(ignored))
+{
+    if (!capture_reader_check(self)) {
+        return NULL;
+    }
+
+    PyObject *list = PyList_New(self->reader.chunk_count);
+
+    for (size_t i = 0; list && i < self->reader.chunk_count; i++) {
+        const csi_capture_chunk_t *chunk = &self->reader.chunks[i];
+        PyObject *offsets = PyTuple_New(self->reader.header.column_count);
+        PyObject *item = NULL;
+
+        for (Py_ssize_t j = 0; offsets && j < self->reader.header.column_count; j++) {
+            PyObject *offset = PyLong_FromUnsignedLongLong(chunk->column_offset[j]);
+
+            if (!offset) {
+                Py_CLEAR(offsets);
+                break;
+            }
+
+            PyTuple_SET_ITEM(offsets, j, offset);
+        }
+
+        if (offsets) {
+            item = Py_BuildValue("{s:K,s:I,s:N,s:K,s:K,s:K,s:K,s:K,s:I,s:I}",
+                                 "first_record", chunk->first_record, "count", chunk->index.count,
+                                 "column_offsets", offsets, "iq_offset", chunk->iq_offset,
+                                 "first_timestamp", chunk->index.first_timestamp,
+                                 "last_timestamp", chunk->index.last_timestamp,
+                                 "first_host_time", chunk->index.first_host_time,
+                                 "last_host_time", chunk->index.last_host_time,
+                                 "min_seq", chunk->index.min_seq, "max_seq", chunk->index.max_seq);
+        }
+
+        if (!item) {
+            Py_CLEAR(list);
+            break;
+        }
+
+        PyList_SET_ITEM(list, i, item);
+    }
+
+    return list;
+}
+
+static PyObject *CaptureReader_find_time(CaptureReaderObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"value", "host_time", NULL};
+    unsigned long long value;
+    int host_time = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "K|p", keywords, &value, &host_time) ||
+            !capture_reader_check(self)) {
+        return NULL;
+    }
+
+    return PyLong_FromUnsignedLongLong(csi_capture_reader_find_time(&self->reader, host_time, value));
+}
+
+static PyObject *CaptureReader_find_seq(CaptureReaderObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"seq", "start", NULL};
+    unsigned int seq;
+    unsigned long long start = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "I|K", keywords, &seq, &start) || !capture_reader_check(self)) {
+        return NULL;
+    }
+
+    return PyLong_FromUnsignedLongLong(csi_capture_reader_find_seq(&self->reader, seq, start));
+}
+
+static PyObject *CaptureReader_close(CaptureReaderObject *self, PyObject *Py_UNUSED(ignored))
+{
+    if (self->data.obj) {
+        csi_capture_reader_close(&self->reader);
+        PyBuffer_Release(&self->data);
+        memset(&self->data, 0, sizeof(Py_buffer));
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *CaptureReader_get_header(CaptureReaderObject *self, void *closure)
+{
+    if (!capture_reader_check(self)) {
+        return NULL;
+    }
+
+    return Py_BuildValue("{s:K,s:H,s:I,s:K,s:O}", "records", self->reader.records,
+                         "iq_width", self->reader.header.iq_width, "chunk_records", self->reader.header.chunk_records,
+                         "created", self->reader.header.created, "truncated", self->reader.truncated ? Py_True : Py_False);
+}
+
+static void CaptureReader_dealloc(CaptureReaderObject *self)
+{
+    Py_XDECREF(CaptureReader_close(self, NULL));
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyMethodDef CaptureReader_methods[] = {
+    {"columns", (PyCFunction)CaptureReader_columns, METH_NOARGS,
+     "columns() -> [(name, type)]\n\nThe column directory, type is a NumPy type string."},
+    {"chunks", (PyCFunction)CaptureReader_chunks, METH_NOARGS,
+     "chunks() -> [dict]\n\nThe chunk index: first record, count, block offsets and the footer ranges."},
+    {"find_time", (PyCFunction)(void (*)(void))CaptureReader_find_time, METH_VARARGS | METH_KEYWORDS,
+     "find_time(value, host_time=False) -> record\n\nFirst record whose unwrapped timestamp (or host_time) is >= value."},
+    {"find_seq", (PyCFunction)(void (*)(void))CaptureReader_find_seq, METH_VARARGS | METH_KEYWORDS,
+     "find_seq(seq, start=0) -> record\n\nFirst record at or after start with this sequence id."},
+    {"close", (PyCFunction)CaptureReader_close, METH_NOARGS,
+     "close()\n\nRelease the buffer, e.g. so the mmap can be closed."},
+    {NULL},
+};
+
+static PyGetSetDef CaptureReader_getset[] = {
+    {"header", (getter)CaptureReader_get_header, NULL, "records, iq_width, chunk_records, created and truncated", NULL},
+    {NULL},
+};
+
+static PyTypeObject CaptureReaderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "_csi_ingest.CaptureReader",
+    .tp_doc       = "CaptureReader(data)\n\n"
+                    "Index a csi_capture file held in a buffer, typically an mmap. Records beyond a trailing\n"
+                    "incomplete chunk are ignored.",
+    .tp_basicsize = sizeof(CaptureReaderObject),
+    .tp_flags     = Py_TPFLAGS_DEFAULT,
+    .tp_new       = PyType_GenericNew,
+    .tp_init      = (initproc)CaptureReader_init,
+    .tp_dealloc   = (destructor)CaptureReader_dealloc,
+    .tp_methods   = CaptureReader_methods,
+    .tp_getset    = CaptureReader_getset,
+};
+
+static PyObject *csi_ingest_decode_base64(PyObject *module, PyObject *arg)
+{
+    Py_buffer data;
+    PyObject *text = NULL;
+
+    if (PyUnicode_Check(arg)) {
+        text = PyUnicode_AsASCIIString(arg);
+
+        if (!text) {
+            return NULL;
+        }
+
+        arg = text;
+    }
+
+    if (PyObject_GetBuffer(arg, &data, PyBUF_SIMPLE) < 0) {
+        Py_XDECREF(text);
+        return NULL;
+    }
+
+    const uint8_t *p = data.buf;
+    const uint8_t *end = p + data.len;
+    size_t max_count = data.len * 3 / 4 + 1;
+    int8_t *bytes = PyMem_Malloc(max_count);
+    PyObject *list = NULL;
+
+    while (p < end && (*p == ' ' || *p == '\r' || *p == '\n')) {
+        p++;
+    }
+
+    if (!bytes) {
+        PyErr_NoMemory();
+        goto EXIT;
+    }
+
+    size_t written;
+    base64_decode(p, end, bytes, max_count, &written);
+    list = PyList_New(written);
+
+    for (size_t i = 0; list && i < written; i++) {
+        PyList_SET_ITEM(list, i, PyLong_FromLong(bytes[i]));
+    }
+
+EXIT:
+    PyMem_Free(bytes);
+    PyBuffer_Release(&data);
+    Py_XDECREF(text);
+
+    return list;
+}
+
+static PyMethodDef csi_ingest_methods[] = {
+    {"decode_base64", csi_ingest_decode_base64, METH_O,
+     "decode_base64(text) -> list of int\n\nSigned bytes of a base64 data column, up to the first character outside the alphabet."},
+    {NULL},
+};
+
+static struct PyModuleDef csi_ingest_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name    = "_csi_ingest",
+    .m_doc     = "Native CSI stream ingest and capture files, see csi_ingest.py and csi_capture.py",
+    .m_size    = -1,
+    .m_methods = csi_ingest_methods,
+};
+
+PyMODINIT_FUNC PyInit__csi_ingest(void)
+{
+    if (PyType_Ready(&IngestType) < 0 || PyType_Ready(&CaptureWriterType) < 0 || PyType_Ready(&CaptureReaderType) < 0) {
+        return NULL;
+    }
+
+    PyObject *module = PyModule_Create(&csi_ingest_module);
+
+    if (!module) {
+        return NULL;
+    }
+
+    Py_INCREF(&IngestType);
+    Py_INCREF(&CaptureWriterType);
+    Py_INCREF(&CaptureReaderType);
+
+    if (PyModule_AddObject(module, "Ingest", (PyObject *)&IngestType) < 0 ||
+            PyModule_AddObject(module, "CaptureWriter", (PyObject *)&CaptureWriterType) < 0 ||
+            PyModule_AddObject(module, "CaptureReader", (PyObject *)&CaptureReaderType) < 0 ||
+            PyModule_AddIntConstant(module, "META_ITEMSIZE", sizeof(csi_ingest_meta_t)) < 0 ||
+            PyModule_AddIntConstant(module, "RECORD_ITEMSIZE", sizeof(csi_capture_record_t)) < 0) {
+        Py_DECREF(&IngestType);
+        Py_DECREF(&CaptureWriterType);
+        Py_DECREF(&CaptureReaderType);
+        Py_DECREF(module);
+        return NULL;
+    }
+
+    return module;
+}
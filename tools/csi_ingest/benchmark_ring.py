@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""Per-packet cost of RingBuffer.append versus shifting the whole history array.
+
+    python benchmark_ring.py [--columns 245] [--packets 2000]
+
+The shift grows with the history length, the ring buffer append does not.
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+from csi_ring import RingBuffer
+
+
+def shift_append(array, row):
+    array[:-1] = array[1:]
+    array[-1] = row
+
+
+def time_per_packet(append, rows, packets):
+    start = time.perf_counter()
+    for i in range(packets):
+        append(rows[i % len(rows)])
+    return (time.perf_counter() - start) / packets
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--columns', type=int, default=245, help='Subcarriers per row')
+    parser.add_argument('--packets', type=int, default=2000, help='Packets appended per measurement')
+    args = parser.parse_args()
+
+    rows = (np.random.randn(64, args.columns) + 1j * np.random.randn(64, args.columns)).astype(np.complex64)
+    print(f'{"history":>8} {"shift (us)":>12} {"ring (us)":>12} {"view (us)":>12} {"snapshot (us)":>14}')
+
+    for history in (100, 1000, 10000, 100000):
+        array = np.zeros((history, args.columns), dtype=np.complex64)
+        ring = RingBuffer(history, args.columns, dtype=np.complex64)
+        shift = time_per_packet(lambda row: shift_append(array, row), rows, max(args.packets * 100 // history, 10))
+        append = time_per_packet(ring.append, rows, args.packets)
+        view = time_per_packet(lambda row: ring.view(), rows, args.packets)
+        snapshot = time_per_packet(lambda row: ring.snapshot(), rows, max(args.packets * 100 // history, 10))
+        print(f'{history:>8} {shift * 1e6:>12.1f} {append * 1e6:>12.1f} {view * 1e6:>12.1f} {snapshot * 1e6:>14.1f}')
+
+
+if __name__ == '__main__':
+    main()
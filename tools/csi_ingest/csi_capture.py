@@ -0,0 +1,455 @@
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""Chunked columnar CSI capture files, see components/csi_capture.
+
+A capture stores each header field (rssi, gains, timestamps, mac, ...) as its
+own column and the I/Q values as a fixed-width int16 block, chunk by chunk,
+with a footer per chunk holding its timestamp and sequence range. Opening a
+capture maps the file and reads only the chunk headers and footers, so a
+multi-hour capture opens in milliseconds and a column or a time range is read
+without touching the rest:
+
+    with CaptureWriter('walk.csicap', iq_width=128) as capture:
+        capture.append(iq_row, seq=1, timestamp=1000, rssi=-40)
+
+    with CaptureReader('walk.csicap') as capture:
+        rssi = capture.column('rssi')
+        start = capture.find_time(capture.column('timestamp', 0, 1)[0] + 60_000_000)
+        iq, table = capture.read(start, start + 100)
+
+Timestamps are stored unwrapped to 64 bits, so they never decrease along a
+capture. The `_csi_ingest` C extension writes and indexes the files; without it
+the same API runs in pure Python.
+"""
+
+import mmap
+import re
+import struct
+import time
+
+import numpy as np
+
+MAGIC = b'CCAP'
+CHUNK_MAGIC = b'CHNK'
+FOOTER_MAGIC = b'CIDX'
+VERSION = 1
+ALIGN = 8
+MAX_IQ_WIDTH = 1024
+DEFAULT_CHUNK_RECORDS = 4096
+MAX_VALUE_SIZE = 512        # largest value of one column the readers accept
+
+# csi_capture_record_t
+RECORD_DTYPE = np.dtype({
+    'names': ['host_time', 'seq', 'timestamp', 'compensate_gain', 'len', 'sig_len', 'mac', 'rssi', 'noise_floor',
+              'rate', 'sig_mode', 'mcs', 'cwb', 'channel', 'secondary_channel', 'stbc', 'sgi', 'rx_state',
+              'agc_gain', 'fft_gain', 'flags', 'ampdu_cnt', 'rx_misc', 'format'],
+    'formats': ['<u8', '<u4', '<u4', '<f4', '<u2', '<u2', ('u1', 6), 'i1', 'i1', 'u1', 'u1', 'u1', 'u1', 'u1', 'u1',
+                'u1', 'u1', 'u1', 'u1', 'i1', 'u1', 'u1', 'u1', 'u1'],
+    'offsets': [0, 8, 12, 16, 20, 22, 24, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46],
+    'itemsize': 48,
+})
+
+# The columns a capture is written with, in file order; `timestamp` is the unwrapped one
+COLUMNS = [('host_time', '<u8'), ('timestamp', '<u8'), ('seq', '<u4'), ('compensate_gain', '<f4'), ('len', '<u2'),
+           ('sig_len', '<u2'), ('mac', '(6,)u1'), ('rssi', 'i1'), ('noise_floor', 'i1')] + \
+          [(name, 'u1') for name in ('rate', 'sig_mode', 'mcs', 'cwb', 'channel', 'secondary_channel', 'stbc', 'sgi',
+                                     'rx_state', 'agc_gain')] + \
+          [('fft_gain', 'i1'), ('flags', 'u1'), ('ampdu_cnt', 'u1'), ('rx_misc', 'u1'), ('format', 'u1')]
+
+_FILE_HEADER = struct.Struct('<4sHHHHIQQ')
+_COLUMN = struct.Struct('<20s12s')
+_CHUNK_HEADER = struct.Struct('<4sIQ')
+_CHUNK_FOOTER = struct.Struct('<QQQQQIII4s')
+
+try:
+    from _csi_ingest import CaptureWriter as _CaptureWriter
+    from _csi_ingest import CaptureReader as _CaptureReader
+    from _csi_ingest import RECORD_ITEMSIZE
+    NATIVE = True
+    assert RECORD_ITEMSIZE == RECORD_DTYPE.itemsize
+except ImportError:
+    NATIVE = False
+
+
+def _align(n):
+    return (n + ALIGN - 1) & ~(ALIGN - 1)
+
+
+_COLUMN_TYPE = re.compile(r'(?:\((\d+),\))?[<|]?([iuf])(\d+)')
+
+
+def _column_size(type_):
+    """Bytes of one value of a column type, 0 for one the C reader rejects (csi_capture_column_size)."""
+    match = _COLUMN_TYPE.fullmatch(type_)
+    if not match:
+        return 0
+    count = int(match.group(1) or 1)
+    size = int(match.group(3))
+    if size not in (1, 2, 4, 8) or (size == 1 and match.group(2) == 'f') or not 0 < count * size <= MAX_VALUE_SIZE:
+        return 0
+    return count * size
+
+
+def _chunk_size(column_sizes, iq_width, count):
+    return (_CHUNK_HEADER.size + _CHUNK_FOOTER.size + sum(_align(size * count) for size in column_sizes)
+            + _align(iq_width * 2 * count))
+
+
+def host_time_now():
+    """Wall clock in microseconds since the epoch, the unit of host_time."""
+    return time.time_ns() // 1000
+
+
+if not NATIVE:
+    class _CaptureWriter:
+        """Pure Python version of _csi_ingest.CaptureWriter."""
+
+        def __init__(self, path, iq_width, chunk_records=0, created=0):
+            if not 0 < iq_width <= MAX_IQ_WIDTH:
+                raise ValueError(f'iq_width must be 1 to {MAX_IQ_WIDTH}')
+            self._iq_width = iq_width
+            self._chunk_records = chunk_records or DEFAULT_CHUNK_RECORDS
+            self._file = open(path, 'wb')
+            self._file.write(_FILE_HEADER.pack(MAGIC, VERSION, _FILE_HEADER.size + len(COLUMNS) * _COLUMN.size,
+                                               len(COLUMNS), iq_width, self._chunk_records, created, 0))
+            for name, type_ in COLUMNS:
+                self._file.write(_COLUMN.pack(name.encode(), type_.encode()))
+            self._offset = self._file.tell()
+            self._table = np.zeros(self._chunk_records, dtype=RECORD_DTYPE)
+            self._timestamps = np.zeros(self._chunk_records, dtype=np.uint64)
+            self._iq = np.zeros((self._chunk_records, iq_width), dtype=np.int16)
+            self._count = 0
+            self._timestamp = None
+            self.records = 0
+            self.truncated = 0
+
+        @property
+        def closed(self):
+            return self._file is None
+
+        def _check(self):
+            if self._file is None:
+                raise ValueError('CaptureWriter is closed')
+
+        def _write_chunk(self):
+            count = self._count
+            if not count:
+                return
+            blocks = []
+            for name, type_ in COLUMNS:
+                values = self._timestamps[:count] if name == 'timestamp' else self._table[name][:count]
+                blocks.append(np.ascontiguousarray(values, dtype=np.dtype(type_).base).tobytes())
+            blocks.append(self._iq[:count].tobytes())
+            size = _CHUNK_HEADER.size + _CHUNK_FOOTER.size + sum(_align(len(block)) for block in blocks)
+            self._file.write(_CHUNK_HEADER.pack(CHUNK_MAGIC, count, size))
+            for block in blocks:
+                self._file.write(block + bytes(_align(len(block)) - len(block)))
+            seq = self._table['seq'][:count]
+            host_time = self._table['host_time']
+            self._file.write(_CHUNK_FOOTER.pack(self._offset, int(self._timestamps[0]), int(self._timestamps[count - 1]),
+                                                int(host_time[0]), int(host_time[count - 1]), int(seq.min()),
+                                                int(seq.max()), count, FOOTER_MAGIC))
+            self._offset += size
+            self._count = 0
+
+        def write(self, iq, records):
+            self._check()
+            iq = np.asarray(iq, dtype=np.int16)
+            records = np.frombuffer(records, dtype=RECORD_DTYPE) if not isinstance(records, np.ndarray) else \
+                records.view(RECORD_DTYPE).reshape(-1)
+            if iq.ndim != 2 or len(iq) != len(records):
+                raise ValueError('iq must be int16 [n, width] and records n records')
+            width = iq.shape[1]
+            for row, record in zip(iq, records):
+                if self._count == self._chunk_records:
+                    self._write_chunk()
+                slot = self._count
+                timestamp = int(record['timestamp'])
+                if self._timestamp is None:
+                    self._timestamp = timestamp
+                else:
+                    self._timestamp += (timestamp - self._last_timestamp) & 0xffffffff
+                self._last_timestamp = timestamp
+                kept = min(int(record['len']), width, self._iq_width)
+                self._table[slot] = record
+                self._timestamps[slot] = self._timestamp
+                self._iq[slot, :kept] = row[:kept]
+                self._iq[slot, kept:] = 0
+                self.truncated += int(record['len']) > kept
+                self._count += 1
+                self.records += 1
+            return len(records)
+
+        def flush(self):
+            self._check()
+            self._write_chunk()
+            self._file.flush()
+
+        def close(self):
+            if self._file is not None:
+                self._write_chunk()
+                self._file.close()
+                self._file = None
+
+    class _CaptureReader:
+        """Pure Python version of _csi_ingest.CaptureReader."""
+
+        def __init__(self, data):
+            data = memoryview(data).cast('B')
+            try:
+                self._open(data)
+            except ValueError:
+                data.release()      # or the caller cannot close the map it passed
+                raise
+
+        def _open(self, data):
+            if len(data) < _FILE_HEADER.size:
+                raise ValueError('not a csi_capture file')
+            magic, version, header_size, column_count, iq_width, chunk_records, created, _ = \
+                _FILE_HEADER.unpack_from(data)
+            if magic != MAGIC or version != VERSION or not 0 < iq_width <= MAX_IQ_WIDTH or header_size % ALIGN or \
+                    header_size < _FILE_HEADER.size + column_count * _COLUMN.size or header_size > len(data):
+                raise ValueError('not a csi_capture file')
+            self._columns = []
+            for i in range(column_count):
+                name, type_ = _COLUMN.unpack_from(data, _FILE_HEADER.size + i * _COLUMN.size)
+                self._columns.append((name.split(b'\0')[0].decode('latin-1'), type_.split(b'\0')[0].decode('latin-1')))
+            sizes = [_column_size(type_) for _, type_ in self._columns]
+            if not all(sizes):
+                raise ValueError('not a csi_capture file')
+            self._sizes = dict(zip([name for name, _ in self._columns], sizes))
+            self._chunks = []
+            records = 0
+            truncated = False
+            offset = header_size
+            while offset < len(data):
+                if len(data) - offset < _CHUNK_HEADER.size + _CHUNK_FOOTER.size:
+                    truncated = True
+                    break
+                magic, count, size = _CHUNK_HEADER.unpack_from(data, offset)
+                if magic != CHUNK_MAGIC or size > len(data) - offset or size != _chunk_size(sizes, iq_width, count):
+                    truncated = True
+                    break
+                footer = _CHUNK_FOOTER.unpack_from(data, offset + size - _CHUNK_FOOTER.size)
+                if footer[8] != FOOTER_MAGIC or footer[0] != offset or footer[7] != count:
+                    truncated = True
+                    break
+                block = offset + _CHUNK_HEADER.size
+                column_offsets = []
+                for column_size in sizes:
+                    column_offsets.append(block)
+                    block += _align(column_size * count)
+                self._chunks.append({'first_record': records, 'count': count, 'column_offsets': tuple(column_offsets),
+                                     'iq_offset': block, 'first_timestamp': footer[1], 'last_timestamp': footer[2],
+                                     'first_host_time': footer[3], 'last_host_time': footer[4],
+                                     'min_seq': footer[5], 'max_seq': footer[6]})
+                records += count
+                offset += size
+            self._data = data
+            self.header = {'records': records, 'iq_width': iq_width, 'chunk_records': chunk_records,
+                           'created': created, 'truncated': truncated}
+
+        def columns(self):
+            return list(self._columns)
+
+        def chunks(self):
+            return [dict(chunk) for chunk in self._chunks]
+
+        def _column(self, chunk, name, dtype):
+            index = [column for column, _ in self._columns].index(name)
+            return np.frombuffer(self._data, dtype=dtype, count=chunk['count'], offset=chunk['column_offsets'][index])
+
+        def find_time(self, value, host_time=False):
+            name = 'host_time' if host_time else 'timestamp'
+            if self._sizes.get(name) != 8:
+                return self.header['records']
+            last = [chunk['last_' + name] for chunk in self._chunks]
+            i = int(np.searchsorted(last, value, side='left'))
+            if i == len(self._chunks):
+                return self.header['records']
+            chunk = self._chunks[i]
+            return chunk['first_record'] + int(np.searchsorted(self._column(chunk, name, '<u8'), value, side='left'))
+
+        def find_seq(self, seq, start=0):
+            if self._sizes.get('seq') != 4:
+                return self.header['records']
+            for chunk in self._chunks:
+                if chunk['first_record'] + chunk['count'] <= start or not chunk['min_seq'] <= seq <= chunk['max_seq']:
+                    continue
+                first = max(start - chunk['first_record'], 0)
+                hits = np.flatnonzero(self._column(chunk, 'seq', '<u4')[first:] == seq)
+                if len(hits):
+                    return chunk['first_record'] + first + int(hits[0])
+            return self.header['records']
+
+        def close(self):
+            self._data = None
+
+
+class CaptureWriter:
+    """Write a capture file record by record or in batches.
+
+    :param path:          File to create
+    :param iq_width:      int16 I/Q values kept per record, longer records are truncated
+    :param chunk_records: Records per chunk, 0 for DEFAULT_CHUNK_RECORDS; a chunk is only
+                          visible to readers once full or flushed
+    """
+
+    def __init__(self, path, iq_width, chunk_records=0):
+        self.native = _CaptureWriter(str(path), iq_width, chunk_records, host_time_now())
+        self.iq_width = iq_width
+        self._record = np.zeros(1, dtype=RECORD_DTYPE)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    @property
+    def records(self):
+        """Records written so far."""
+        return self.native.records
+
+    @property
+    def truncated(self):
+        """Records that had more than iq_width values."""
+        return self.native.truncated
+
+    @property
+    def closed(self):
+        return self.native.closed
+
+    def write(self, iq, records):
+        """Append int16 rows `iq` [n, width] and their RECORD_DTYPE `records` [n]."""
+        iq = np.ascontiguousarray(iq, dtype=np.int16)
+        records = np.ascontiguousarray(records, dtype=RECORD_DTYPE)
+        return self.native.write(iq.reshape(len(records), -1), records)
+
+    def append(self, iq, **fields):
+        """Append one record: its I/Q values and any RECORD_DTYPE fields; `len` defaults to len(iq)
+        and `host_time` to now."""
+        iq = np.asarray(iq, dtype=np.int16).reshape(1, -1)
+        record = self._record
+        record[0] = 0
+        record['len'] = iq.shape[1]
+        record['host_time'] = host_time_now()
+        for name, value in fields.items():
+            record[name] = value
+        return self.native.write(iq, record)
+
+    def flush(self):
+        """Write the pending records as a (short) chunk."""
+        self.native.flush()
+
+    def close(self):
+        self.native.close()
+
+
+class CaptureReader:
+    """A capture file, memory-mapped; the arrays it returns are read-only views into the
+    file when they lie in one chunk, copies otherwise.
+
+    A capture still being written, or whose writer was killed, reads up to its last
+    complete chunk; `truncated` tells.
+    """
+
+    def __init__(self, path):
+        with open(path, 'rb') as file:
+            self._mmap = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+        try:
+            self._index = _CaptureReader(self._mmap)
+        except ValueError:
+            self._mmap.close()
+            raise
+        header = self._index.header
+        self.records = header['records']
+        self.iq_width = header['iq_width']
+        self.chunk_records = header['chunk_records']
+        self.created = header['created']
+        self.truncated = header['truncated']
+        self.columns = self._index.columns()
+        self.dtypes = {name: np.dtype(type_) for name, type_ in self.columns}
+        self.chunks = self._index.chunks()
+        self._starts = np.array([chunk['first_record'] for chunk in self.chunks], dtype=np.int64)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __len__(self):
+        return self.records
+
+    def close(self):
+        if self._mmap is not None:
+            self._index.close()
+            try:
+                self._mmap.close()
+            except BufferError:
+                pass                # arrays returned earlier still map the file, it is unmapped with them
+            self._mmap = None
+
+    def chunk(self, i):
+        """Views of chunk `i`: (iq [count, iq_width], {column: values})."""
+        chunk = self.chunks[i]
+        count = chunk['count']
+        columns = {name: np.frombuffer(self._mmap, dtype=self.dtypes[name], count=count, offset=offset)
+                   for (name, _), offset in zip(self.columns, chunk['column_offsets'])}
+        iq = np.frombuffer(self._mmap, dtype=np.int16, count=count * self.iq_width, offset=chunk['iq_offset'])
+        return iq.reshape(count, self.iq_width), columns
+
+    def _spans(self, start, stop):
+        start, stop, _ = slice(start, stop).indices(self.records)
+        if start >= stop:
+            return
+        first = int(np.searchsorted(self._starts, start, side='right')) - 1
+        for i in range(first, len(self.chunks)):
+            chunk = self.chunks[i]
+            if chunk['first_record'] >= stop:
+                break
+            yield i, max(start - chunk['first_record'], 0), min(stop - chunk['first_record'], chunk['count'])
+
+    def _gather(self, arrays, empty):
+        if not arrays:
+            return empty
+        return arrays[0] if len(arrays) == 1 else np.concatenate(arrays)
+
+    def column(self, name, start=0, stop=None):
+        """Values of column `name` for records [start, stop)."""
+        dtype = self.dtypes[name]
+        index = [column for column, _ in self.columns].index(name)
+        arrays = []
+        for i, first, last in self._spans(start, stop):
+            chunk = self.chunks[i]
+            offset = chunk['column_offsets'][index] + first * dtype.itemsize
+            arrays.append(np.frombuffer(self._mmap, dtype=dtype, count=last - first, offset=offset))
+        return self._gather(arrays, np.zeros(0, dtype=dtype))
+
+    def iq(self, start=0, stop=None):
+        """int16 I/Q rows [n, iq_width] of records [start, stop)."""
+        arrays = []
+        for i, first, last in self._spans(start, stop):
+            offset = self.chunks[i]['iq_offset'] + first * self.iq_width * 2
+            rows = np.frombuffer(self._mmap, dtype=np.int16, count=(last - first) * self.iq_width, offset=offset)
+            arrays.append(rows.reshape(-1, self.iq_width))
+        return self._gather(arrays, np.zeros((0, self.iq_width), dtype=np.int16))
+
+    def read(self, start=0, stop=None, columns=None):
+        """Records [start, stop): (iq rows, structured table of `columns`, all by default)."""
+        names = columns or [name for name, _ in self.columns]
+        values = [self.column(name, start, stop) for name in names]
+        table = np.zeros(len(values[0]) if values else 0, dtype=[(name, self.dtypes[name]) for name in names])
+        for name, value in zip(names, values):
+            table[name] = value
+        return self.iq(start, stop), table
+
+    def find_time(self, value, host_time=False):
+        """First record whose unwrapped timestamp (or host_time) is at least `value`, len(self) if none."""
+        return self._index.find_time(int(value), host_time=host_time)
+
+    def find_seq(self, seq, start=0):
+        """First record at or after `start` with sequence id `seq`, len(self) if none."""
+        return self._index.find_seq(int(seq), start=int(start))
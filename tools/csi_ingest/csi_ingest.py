@@ -0,0 +1,419 @@
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""CSI stream ingest for the PC tools.
+
+Reads the serial port (or a capture file) of a CSI receiver, parses the
+`CSI_DATA` CSV lines (decimal or base64 data column) and the binary csi_frame
+frames, and writes every record into preallocated ring buffers:
+
+    ingest = CsiIngest(capacity=200, width=490)
+    while True:
+        ingest.read_from(serial_port)
+        iq, meta = ingest.latest()          # chronological copies, oldest first
+
+`iq` rows hold the int16 I/Q values as the device sent them (imaginary first),
+`meta` rows the META_DTYPE fields. The parsing is done by the `_csi_ingest`
+C extension (see README.md to build it); without it the same API runs in pure
+Python, only slower.
+"""
+
+import base64
+import os
+import re
+import struct
+import time
+
+import numpy as np
+
+FORMAT_DECIMAL = 0
+FORMAT_BASE64 = 1
+FORMAT_BINARY = 2
+
+META_DTYPE = np.dtype({
+    'names': ['seq', 'timestamp', 'compensate_gain', 'len', 'rssi', 'noise_floor', 'rate', 'channel',
+              'agc_gain', 'fft_gain', 'flags', 'mac', 'format'],
+    'formats': ['<u4', '<u4', '<f4', '<u2', 'i1', 'i1', 'u1', 'u1', 'u1', 'i1', 'u1', ('u1', 6), 'u1'],
+    'offsets': [0, 4, 8, 12, 14, 15, 16, 17, 18, 19, 20, 21, 27],
+    'itemsize': 28,
+})
+
+# csi_recv and csi_recv_router on ESP32-C5/C6/C61
+LAYOUT_C5C6 = ['type', 'id', 'mac', 'rssi', 'rate', 'noise_floor', 'fft_gain', 'agc_gain', 'channel',
+               'local_timestamp', 'sig_len', 'rx_state', 'len', 'first_word', 'data']
+# csi_recv and csi_recv_router on the other targets
+LAYOUT_LEGACY = ['type', 'id', 'mac', 'rssi', 'rate', 'sig_mode', 'mcs', 'bandwidth', 'smoothing', 'not_sounding',
+                 'aggregation', 'stbc', 'fec_coding', 'sgi', 'noise_floor', 'ampdu_cnt', 'channel', 'secondary_channel',
+                 'local_timestamp', 'ant', 'sig_len', 'rx_state', 'len', 'first_word', 'data']
+# esp-radar console_test
+LAYOUT_CONSOLE = ['type', 'seq', 'timestamp', 'taget_seq', 'taget', 'mac', 'rssi', 'rate', 'sig_mode', 'mcs',
+                  'cwb', 'smoothing', 'not_sounding', 'aggregation', 'stbc', 'fec_coding', 'sgi', 'noise_floor',
+                  'ampdu_cnt', 'channel_primary', 'channel_secondary', 'local_timestamp', 'ant', 'sig_len',
+                  'rx_state', 'agc_gain', 'fft_gain', 'len', 'first_word_invalid', 'data']
+DEFAULT_LAYOUTS = (LAYOUT_C5C6, LAYOUT_LEGACY)
+
+try:
+    from _csi_ingest import Ingest as _Ingest
+    from _csi_ingest import decode_base64
+    from _csi_ingest import META_ITEMSIZE
+    NATIVE = True
+    assert META_ITEMSIZE == META_DTYPE.itemsize
+except ImportError:
+    NATIVE = False
+
+
+if not NATIVE:
+    _CSI_DATA_PREFIX = b'CSI_DATA,'
+    _FRAME_SYNC = b'\xc5\x1f'
+    _FRAME_HEADER = struct.Struct('<2sBBHHII6sbbBBBBBBBBHBBbBBBf')
+    _FRAME_FLAG_FIRST_WORD_INVALID = 1 << 0
+    _FRAME_FLAG_PAYLOAD_INT12 = 1 << 1
+    _FRAME_MAX_PAYLOAD_LEN = 1024
+    _LINE_MAX = 64 * 1024
+    _COLUMNS_MAX = 64
+    _BASE64_ALPHABET = frozenset(b'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/')
+    # Meta field and accepted range of the integer columns
+    _META_COLUMNS = {'id': ('seq', 0, 0xffffffff), 'seq': ('seq', 0, 0xffffffff),
+                     'local_timestamp': ('timestamp', 0, 0xffffffff), 'rssi': ('rssi', -128, 127),
+                     'noise_floor': ('noise_floor', -128, 127), 'rate': ('rate', 0, 255),
+                     'channel': ('channel', 0, 255), 'channel_primary': ('channel', 0, 255),
+                     'agc_gain': ('agc_gain', 0, 255), 'fft_gain': ('fft_gain', -128, 127)}
+    _INT = re.compile(rb' *([+-]?)0*([0-9]+?) *')
+    _MAC = re.compile(rb'[0-9A-Fa-f]{2}(?:[:-][0-9A-Fa-f]{2}){5}')
+
+    def _int(field, low=None, high=None):
+        """A whole field as an integer like parse_int() of _csi_ingest.c, past 18 digits it saturates."""
+        match = _INT.fullmatch(field)
+        if not match:
+            raise ValueError(field)
+        value = int(match[2]) if len(match[2]) <= 18 else 1 << 60
+        value = -value if match[1] == b'-' else value
+        if low is not None and not low <= value <= high:
+            raise ValueError(field)
+        return value
+
+    def _split(line):
+        """Columns of a CSV line like ingest_csv() of _csi_ingest.c, a quoted column may contain commas."""
+        fields = []
+        pos = 0
+        while True:
+            if len(fields) == _COLUMNS_MAX:
+                return None
+            if line[pos:pos + 1] == b'"':
+                quote = line.find(b'"', pos + 1)
+                if quote < 0:
+                    return None
+                fields.append(line[pos + 1:quote])
+                pos = quote + 1
+            else:
+                comma = line.find(b',', pos)
+                comma = len(line) if comma < 0 else comma
+                fields.append(line[pos:comma])
+                pos = comma
+            if pos == len(line):
+                return fields
+            if line[pos:pos + 1] != b',':
+                return None
+            pos += 1
+
+    def _crc16(data):
+        crc = 0xffff
+        for byte in data:
+            crc ^= byte << 8
+            for _ in range(8):
+                crc = (crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1
+            crc &= 0xffff
+        return crc
+
+    def _base64_bytes(text):
+        end = 0
+        while end < len(text) and text[end] in _BASE64_ALPHABET:
+            end += 1
+        text = text[:end - (end % 4 == 1)]
+        return base64.b64decode(text + b'=' * (-len(text) % 4))
+
+    def decode_base64(text):
+        """Signed bytes of a base64 data column, up to the first character outside the alphabet."""
+        if isinstance(text, str):
+            text = text.encode('ascii')
+        return np.frombuffer(_base64_bytes(text.strip()), dtype=np.int8).tolist()
+
+    class _Ingest:
+        """Pure Python version of _csi_ingest.Ingest."""
+
+        def __init__(self, iq, meta, layouts, keep_text=False, save_fd=-1, capture=None):
+            self._iq = iq
+            self._meta = meta.view(META_DTYPE)
+            self._layouts = {}
+            for layout in layouts:
+                self._layouts.setdefault(len(layout), list(layout))
+            self._text = [] if keep_text else None
+            self._save_fd = save_fd
+            self._capture = capture
+            self._host_time = 0
+            if capture is not None:
+                from csi_capture import RECORD_DTYPE
+                self._record = np.zeros(1, dtype=RECORD_DTYPE)
+            self._buf = b''
+            self._scanned = 0
+            self.count = 0
+            self._stats = dict.fromkeys(['records', 'bytes', 'lines', 'frames', 'bad', 'truncated'], 0)
+
+        def _capture_record(self, meta, values, header):
+            record = self._record
+            record[0] = 0
+            for name in META_DTYPE.names:
+                record[name] = meta[name]
+            record['host_time'] = self._host_time
+            for name, value in (header or {}).items():
+                record[name] = value
+            self._capture.write(values[:self._iq.shape[1]].reshape(1, -1), record)
+
+        def _commit(self, meta, values, header=None):
+            slot = self.count % len(self._iq)
+            width = self._iq.shape[1]
+            self._meta[slot] = meta
+            self._meta[slot]['len'] = min(len(values), 0xffff)
+            self._iq[slot, :min(width, len(values))] = values[:width]
+            self._iq[slot, len(values):] = 0
+            self._stats['truncated'] += len(values) > width
+            if self._capture is not None and not self._capture.closed:
+                self._capture_record(self._meta[slot], values, header)
+            self.count += 1
+
+        def _csv(self, line):
+            fields = _split(line) or []
+            layout = self._layouts.get(len(fields))
+            if not layout:
+                return False
+            meta = np.zeros((), META_DTYPE)
+            meta['compensate_gain'] = 1.0
+            data = None
+            expected_len = None
+            try:
+                for name, field in zip(layout, fields):
+                    if name in _META_COLUMNS:
+                        column, low, high = _META_COLUMNS[name]
+                        meta[column] = _int(field, low, high)
+                    elif name in ('first_word', 'first_word_invalid'):
+                        meta['flags'] |= _FRAME_FLAG_FIRST_WORD_INVALID if _int(field, 0, 1) else 0
+                    elif name == 'mac':
+                        if not _MAC.fullmatch(field):
+                            raise ValueError(field)
+                        meta['mac'] = [int(field[i:i + 2], 16) for i in range(0, 17, 3)]
+                    elif name == 'len':
+                        expected_len = _int(field, 0, 0xffff)
+                    elif name == 'data':
+                        data = field
+                if data.startswith(b'['):
+                    if not data.endswith(b']'):
+                        raise ValueError(data)
+                    meta['format'] = FORMAT_DECIMAL
+                    values = np.array([max(-32768, min(32767, _int(v))) for v in data[1:-1].split(b',')],
+                                      dtype=np.int16)
+                else:
+                    meta['format'] = FORMAT_BASE64
+                    values = np.frombuffer(_base64_bytes(data), dtype=np.int8).astype(np.int16)
+            except (ValueError, TypeError, AttributeError, OverflowError):
+                return False
+            if not len(values) or (expected_len is not None and expected_len != len(values)):
+                return False
+            self._commit(meta, values)
+            return True
+
+        def _line(self, line):
+            line = line.rstrip(b'\r\n')
+            if not line:
+                return
+            self._stats['lines'] += 1
+            index = line.find(_CSI_DATA_PREFIX)
+            if index >= 0 and self._csv(line[index:]):
+                self._save(line[index:] + b'\n')
+                return
+            if index >= 0:
+                self._stats['bad'] += 1
+            if self._text is not None:
+                self._text.append(line)
+
+        def _frame(self, data):
+            """Length of the frame at the start of data, 0 if incomplete, -1 if not a frame."""
+            if data[1:2] and data[:2] != _FRAME_SYNC:
+                return -1
+            if len(data) < _FRAME_HEADER.size:
+                return 0
+            header = _FRAME_HEADER.unpack_from(data)
+            version, frame_type, length, payload_len = header[1:5]
+            if version != 1 or length != _FRAME_HEADER.size + payload_len + 2 or payload_len > _FRAME_MAX_PAYLOAD_LEN:
+                return -1
+            if len(data) < length:
+                return 0
+            if _crc16(data[:length - 2]) != int.from_bytes(data[length - 2:length], 'little'):
+                return -1
+            self._stats['frames'] += 1
+            if frame_type == 1:
+                (seq, timestamp, mac, rssi, noise_floor, rate, sig_mode, mcs, cwb, channel, secondary_channel,
+                 stbc, sgi, rx_state, sig_len, agc_gain, fft_gain, flags, ampdu_cnt, rx_misc,
+                 compensate_gain) = header[5:]
+                payload = data[_FRAME_HEADER.size:length - 2]
+                if flags & _FRAME_FLAG_PAYLOAD_INT12:
+                    values = np.frombuffer(payload[:len(payload) // 2 * 2], dtype='<i2') << 4 >> 4
+                else:
+                    values = np.frombuffer(payload, dtype=np.int8)
+                meta = np.zeros((), META_DTYPE)
+                for name, value in (('seq', seq), ('timestamp', timestamp), ('compensate_gain', compensate_gain),
+                                    ('rssi', rssi), ('noise_floor', noise_floor), ('rate', rate),
+                                    ('channel', channel), ('agc_gain', agc_gain), ('fft_gain', fft_gain),
+                                    ('flags', flags), ('format', FORMAT_BINARY)):
+                    meta[name] = value
+                meta['mac'] = list(mac)
+                self._commit(meta, values.astype(np.int16), {
+                    'sig_mode': sig_mode, 'mcs': mcs, 'cwb': cwb, 'secondary_channel': secondary_channel,
+                    'stbc': stbc, 'sgi': sgi, 'rx_state': rx_state, 'sig_len': sig_len, 'ampdu_cnt': ampdu_cnt,
+                    'rx_misc': rx_misc})
+            self._save(data[:length])
+            return length
+
+        def _save(self, data):
+            if self._save_fd >= 0:
+                os.write(self._save_fd, data)
+
+        def feed(self, data):
+            records = self.count
+            self._host_time = time.time_ns() // 1000
+            self._stats['bytes'] += len(data)
+            buf = self._buf + bytes(data)
+            start, pos = 0, self._scanned
+            while pos < len(buf):
+                newline = buf.find(b'\n', pos)
+                sync = buf.find(_FRAME_SYNC[:1], pos)
+                if sync < 0 or (0 <= newline < sync):
+                    if newline < 0:
+                        pos = len(buf)
+                        break
+                    self._line(buf[start:newline])
+                    start = pos = newline + 1
+                    continue
+                length = self._frame(buf[sync:])
+                if length == 0 and len(buf) - sync < _FRAME_HEADER.size + _FRAME_MAX_PAYLOAD_LEN + 2:
+                    pos = sync
+                    break
+                if length <= 0:
+                    self._stats['bad'] += buf[sync + 1:sync + 2] == _FRAME_SYNC[1:]
+                    pos = sync + 1
+                    continue
+                if sync > start:
+                    self._line(buf[start:sync])
+                start = pos = sync + length
+            if len(buf) - start > _LINE_MAX:
+                self._line(buf[start:])
+                start = pos = len(buf)
+            self._buf = buf[start:]
+            self._scanned = pos - start
+            self._stats['records'] = self.count
+            return self.count - records
+
+        def read(self, fd, timeout=0.1):
+            import select
+            if not select.select([fd], [], [], timeout)[0]:
+                return 0
+            data = os.read(fd, 64 * 1024)
+            if not data:
+                raise EOFError('end of stream')
+            self.feed(data)
+            return len(data)
+
+        def take_text(self):
+            text = self._text or []
+            if self._text is not None:
+                self._text = []
+            return text
+
+        def stats(self):
+            return dict(self._stats)
+
+
+class CsiIngest:
+    """Ring buffers of the latest `capacity` CSI records and the parser that fills them.
+
+    :param capacity:  Records kept
+    :param width:     Values kept per record, longer records are truncated
+    :param layouts:   Column names of the CSV layouts to accept, told apart by their column count
+    :param keep_text: Keep the lines that are not CSI records for take_text()
+    :param save_file: Binary file that receives every CSI record as received, CSV lines and frames alike
+    :param capture:   csi_capture.CaptureWriter that receives every record, parsed; its iq_width may
+                      differ from `width`, rows are cut to the narrower of the two
+    """
+
+    def __init__(self, capacity=200, width=490, layouts=DEFAULT_LAYOUTS, keep_text=False, save_file=None,
+                 capture=None):
+        self.iq = np.zeros((capacity, width), dtype=np.int16)
+        self.meta = np.zeros(capacity, dtype=META_DTYPE)
+        self._save_file = save_file
+        save_fd = -1
+        if save_file is not None:
+            save_file.flush()
+            save_fd = save_file.fileno()
+        self._ingest = _Ingest(self.iq, self.meta, layouts, keep_text=keep_text, save_fd=save_fd,
+                               capture=None if capture is None else capture.native)
+        self._rate_time = time.monotonic()
+        self._rate_stats = self._ingest.stats()
+
+    @property
+    def native(self):
+        return NATIVE
+
+    @property
+    def count(self):
+        """Records written so far."""
+        return self._ingest.count
+
+    def feed(self, data):
+        """Parse a chunk of the stream, return the number of records it completed."""
+        return self._ingest.feed(data)
+
+    def read_from(self, stream, timeout=0.1):
+        """Read what `stream` (a pyserial port or a binary file) has within `timeout` seconds and parse it.
+
+        On POSIX the C extension waits and reads the file descriptor itself, without the GIL.
+        Returns the number of bytes read, raises EOFError at the end of a file.
+        """
+        fileno = getattr(stream, 'fileno', None)
+        if os.name != 'nt' and fileno is not None:
+            return self._ingest.read(fileno(), timeout)
+
+        size = getattr(stream, 'in_waiting', 0) or 4096
+        data = stream.read(size)
+        if not data:
+            if not hasattr(stream, 'in_waiting'):
+                raise EOFError('end of stream')
+            return 0
+        self._ingest.feed(data)
+        return len(data)
+
+    def take_text(self):
+        """Lines that were not CSI records since the last call, as bytes, if keep_text is set."""
+        return self._ingest.take_text()
+
+    def latest(self, n=None):
+        """Copies of the last `n` records (all kept ones by default), oldest first: (iq, meta)."""
+        count = self.count
+        n = min(len(self.iq) if n is None else n, count, len(self.iq))
+        index = np.arange(count - n, count) % len(self.iq)
+        return self.iq[index], self.meta[index]
+
+    def stats(self):
+        """Totals since the start, plus lines_per_second and records_per_second since the previous call."""
+        stats = self._ingest.stats()
+        now = time.monotonic()
+        elapsed = max(now - self._rate_time, 1e-9)
+        stats['lines_per_second'] = (stats['lines'] - self._rate_stats['lines']) / elapsed
+        stats['records_per_second'] = (stats['records'] - self._rate_stats['records']) / elapsed
+        self._rate_time = now
+        self._rate_stats = stats
+        return stats
+
+
+def to_complex(iq):
+    """Complex subcarrier values of int8-style I/Q rows (imaginary first), e.g. from CsiIngest.latest()."""
+    iq = np.asarray(iq)
+    return iq[..., 1::2].astype(np.float32) + 1j * iq[..., 0::2].astype(np.float32)
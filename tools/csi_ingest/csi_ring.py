@@ -0,0 +1,86 @@
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""Fixed-size history of rows for the plotting arrays of the PC tools.
+
+Shifting a (history, columns) array by one row per packet costs a memmove of
+the whole array. RingBuffer writes each row once at the head instead, and
+keeps a mirrored second copy of the storage so the rows are always available,
+oldest first, as one contiguous slice:
+
+    amplitude = RingBuffer(500, (245,), dtype=np.float32)
+    amplitude.append(row)       # O(columns), whatever the history length
+    curve.setData(amplitude.view()[:, 0])
+
+view() is a read-only NumPy view of the storage, not a copy. The next append
+overwrites the row at its start, so a view is in order only until then, and
+must not be kept across appends. When another thread appends, as the serial
+reader threads of the GUIs do, read through snapshot() instead: a copy taken
+under the lock that append() and extend() hold.
+"""
+
+import threading
+
+import numpy as np
+
+
+class RingBuffer:
+    """The last `capacity` rows of shape `shape`, initially all `fill`.
+
+    :param capacity: Rows kept, the length of view()
+    :param shape:    Shape of one row, () for a scalar per row
+    :param dtype:    NumPy dtype of the rows
+    :param fill:     Value of the rows before the first append
+    """
+
+    def __init__(self, capacity, shape=(), dtype=np.float64, fill=0):
+        if capacity < 1:
+            raise ValueError('capacity must be positive')
+        self.capacity = capacity
+        self.count = 0
+        self._head = 0
+        shape = (shape,) if isinstance(shape, int) else tuple(shape)
+        self._buf = np.full((2 * capacity,) + shape, fill, dtype=dtype)
+        self._lock = threading.Lock()
+
+    def __len__(self):
+        return self.capacity
+
+    def append(self, row):
+        """Replace the oldest row with `row`."""
+        with self._lock:
+            head = self._head
+            self._buf[head] = row
+            self._buf[head + self.capacity] = row
+            self._head = head + 1 if head + 1 < self.capacity else 0
+            self.count += 1
+
+    def extend(self, rows):
+        """Append each row of `rows` in order, with at most four slice copies."""
+        rows = np.asarray(rows, dtype=self._buf.dtype)
+        n = len(rows)
+        if n >= self.capacity:
+            rows = rows[n - self.capacity:]
+        with self._lock:
+            self.count += n
+            n = min(n, self.capacity)
+            first = min(n, self.capacity - self._head)
+            for start, part in ((self._head, rows[:first]), (0, rows[first:n])):
+                self._buf[start:start + len(part)] = part
+                self._buf[start + self.capacity:start + self.capacity + len(part)] = part
+            self._head = (self._head + n) % self.capacity
+
+    def view(self):
+        """All rows, oldest first, without copying. Only in order until the next append."""
+        view = self._buf[self._head:self._head + self.capacity]
+        view.flags.writeable = False
+        return view
+
+    def latest(self, n=1):
+        """The last `n` rows, oldest first, without copying. Only in order until the next append."""
+        return self.view()[self.capacity - min(n, self.capacity):]
+
+    def snapshot(self):
+        """A copy of all rows, oldest first, consistent even while another thread appends."""
+        with self._lock:
+            return self._buf[self._head:self._head + self.capacity].copy()
@@ -0,0 +1,25 @@
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+# Build the _csi_ingest extension next to csi_ingest.py:
+#   python setup.py build_ext --inplace
+
+from os import path
+
+from setuptools import Extension, setup
+
+COMPONENTS_DIR = path.abspath(path.join(path.dirname(__file__), '..', '..', 'components'))
+CSI_FRAME_DIR = path.join(COMPONENTS_DIR, 'csi_frame')
+CSI_CAPTURE_DIR = path.join(COMPONENTS_DIR, 'csi_capture')
+
+setup(
+    name='csi_ingest',
+    version='0.1.0',
+    py_modules=['csi_ingest', 'csi_ring', 'csi_capture'],
+    ext_modules=[
+        Extension('_csi_ingest',
+                  sources=['_csi_ingest.c', path.join(CSI_FRAME_DIR, 'csi_frame.c'),
+                           path.join(CSI_CAPTURE_DIR, 'csi_capture.c')],
+                  include_dirs=[path.join(CSI_FRAME_DIR, 'include'), path.join(CSI_CAPTURE_DIR, 'include')]),
+    ],
+)
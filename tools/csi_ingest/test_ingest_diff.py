@@ -0,0 +1,282 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""The _csi_ingest extension against the pure Python fallback, on the same streams.
+
+    python setup.py build_ext --inplace && python test_ingest_diff.py [--rounds 20] [--seed 1]
+
+Each round builds a stream of CSI_DATA lines in both CSV layouts, decimal and base64, with MAC
+variants, out-of-range and malformed values, random byte corruptions, log text and csi_frame
+frames (some with a bad CRC), feeds it to both parsers in different random chunks and compares
+the records, the rejected text, the save file and the statistics. Every line is also fed on its
+own, so a disagreement is reported with the line that causes it.
+"""
+
+import argparse
+import base64
+import importlib.util
+import os
+import struct
+import sys
+import tempfile
+
+import numpy as np
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, HERE)
+
+import csi_ingest as native  # noqa: E402
+
+
+def load_fallback():
+    """A second csi_ingest module that cannot import the extension."""
+    saved = sys.modules.get('_csi_ingest')
+    sys.modules['_csi_ingest'] = None
+    try:
+        spec = importlib.util.spec_from_file_location('csi_ingest_fallback', os.path.join(HERE, 'csi_ingest.py'))
+        module = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(module)
+    finally:
+        if saved is None:
+            del sys.modules['_csi_ingest']
+        else:
+            sys.modules['_csi_ingest'] = saved
+    return module
+
+
+FRAME_HEADER = struct.Struct('<2sBBHHII6sbbBBBBBBBBHBBbBBBf')
+CORRUPT_BYTES = b'0123456789-+ ,"[]:xZ/=\t\r\xff'
+
+
+def crc16(data):
+    crc = 0xffff
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = (crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1
+        crc &= 0xffff
+    return crc
+
+
+def mac_text(rng, mac):
+    variant = rng.integers(30)
+    text = ':'.join(f'{byte:02x}' for byte in mac)
+    if variant == 1:
+        text = text.upper()
+    elif variant == 2:
+        text = text.replace(':', '-')
+    elif variant == 3:
+        text = text.replace(':', '')                    # no separators
+    elif variant == 4:
+        text = text[:-3]                                # five bytes
+    elif variant == 5:
+        text = ' ' + text                               # padded
+    elif variant == 6:
+        text = text[:5] + 'g' + text[6:]                # not hex
+    elif variant == 7:
+        text = text + 'x'
+    return text
+
+
+def number(rng, low, high):
+    variant = rng.integers(400)
+    value = int(rng.integers(low, high + 1))
+    if variant == 0:
+        return str(high + 1 + int(rng.integers(1000)))  # out of range
+    if variant == 1:
+        return str(low - 1 - int(rng.integers(1000)))
+    if variant == 2:
+        return f' {value} '
+    if variant == 3:
+        return f'{value}x'
+    if variant == 4:
+        return f'{value} {value}'
+    if variant in (5, 9, 10, 11):
+        return '+' + str(value) if value >= 0 else str(value)
+    if variant == 6:
+        return '9' * int(rng.integers(18, 40))          # saturates
+    if variant == 7:
+        return '0' * int(rng.integers(1, 30)) + str(abs(value))
+    if variant == 8:
+        return ''
+    return str(value)
+
+
+def csv_line(rng, layout):
+    count = int(rng.choice([52, 104, 114, 128, 234]))
+    values = rng.integers(-128, 128, count)
+    decimal = rng.integers(3) != 0
+    fields = []
+
+    for name in layout:
+        if name == 'type':
+            fields.append('CSI_DATA')
+        elif name == 'id':
+            fields.append(number(rng, 0, 0xffffffff))
+        elif name == 'local_timestamp':
+            fields.append(number(rng, 0, 0xffffffff))
+        elif name == 'mac':
+            fields.append(mac_text(rng, rng.integers(256, size=6)))
+        elif name in ('rssi', 'noise_floor', 'fft_gain'):
+            fields.append(number(rng, -128, 127))
+        elif name in ('rate', 'channel', 'agc_gain'):
+            fields.append(number(rng, 0, 255))
+        elif name == 'first_word':
+            fields.append(number(rng, 0, 1))
+        elif name == 'len':
+            fields.append(str(count + (rng.integers(30) == 0)))
+        elif name == 'data':
+            if decimal:
+                elements = [str(v) for v in values]
+                variant = rng.integers(30)
+                if variant == 0:
+                    elements[rng.integers(count)] = str(int(rng.integers(-10**6, 10**6)))    # clamped
+                elif variant == 1:
+                    elements[rng.integers(count)] = ''
+                elif variant == 2:
+                    elements[rng.integers(count)] = ' 5 '
+                elif variant == 3:
+                    elements[rng.integers(count)] = '5z'
+                elif variant == 4:
+                    elements[-1] += ']'
+                text = '[' + ','.join(elements) + ']'
+                if variant == 5:
+                    text = text[:-1]
+                elif variant == 6:
+                    text += 'xyz'
+            else:
+                text = base64.b64encode(values.astype(np.int8).tobytes()).decode()
+            fields.append(f'"{text}"')
+        else:
+            fields.append(str(int(rng.integers(0, 16))))
+
+    return ','.join(fields).encode()
+
+
+def corrupt(rng, line):
+    line = bytearray(line)
+    for _ in range(int(rng.integers(1, 4))):
+        pos = int(rng.integers(len(line)))
+        action = rng.integers(4)
+        if action == 0:
+            line[pos] = CORRUPT_BYTES[rng.integers(len(CORRUPT_BYTES))]
+        elif action == 1:
+            del line[pos]
+        elif action == 2:
+            line.insert(pos, CORRUPT_BYTES[rng.integers(len(CORRUPT_BYTES))])
+        else:
+            del line[pos:]
+            break
+    return bytes(line)
+
+
+def frame(rng):
+    payload = rng.integers(-128, 128, int(rng.choice([104, 128, 234]))).astype(np.int8).tobytes()
+    header = FRAME_HEADER.pack(b'\xc5\x1f', 1, 1, FRAME_HEADER.size + len(payload) + 2, len(payload),
+                               int(rng.integers(2**32)), int(rng.integers(2**32)), rng.bytes(6),
+                               -40, -95, 11, 1, 7, 1, 6, 0, 0, 0, 200, 0, 30, 3, 0, 0, 0, 0.5)
+    data = header + payload
+    data += struct.pack('<H', crc16(data) ^ (rng.integers(10) == 0))
+    return data
+
+
+def stream_items(rng, count):
+    """(bytes, whether it is a text line) for one stream"""
+    items = []
+    for _ in range(count):
+        kind = rng.integers(10)
+        if kind < 6:
+            line = csv_line(rng, native.LAYOUT_C5C6 if rng.integers(2) else native.LAYOUT_LEGACY)
+            line = corrupt(rng, line) if rng.integers(4) == 0 else line
+            prefix = [b'', b'I (1234) csi_recv: ', b'AC:67:B2:01:02:03,'][rng.integers(3)]
+            items.append((prefix + line + [b'\n', b'\r\n'][rng.integers(2)], True))
+        elif kind < 8:
+            items.append((b'I (%d) wifi: some log text, CSI_DATA\n' % rng.integers(10**6), True))
+        else:
+            items.append((frame(rng), False))
+    return items
+
+
+def run(module, stream, chunks, layouts):
+    with tempfile.TemporaryFile() as save_file:
+        ingest = module.CsiIngest(capacity=64, width=192, layouts=layouts, keep_text=True, save_file=save_file)
+        pos = 0
+        for size in chunks:
+            ingest.feed(stream[pos:pos + size])
+            pos += size
+        ingest.feed(stream[pos:])
+        save_file.seek(0)
+        saved = save_file.read()
+        stats = ingest.stats()
+        stats = {name: stats[name] for name in ('records', 'bytes', 'lines', 'frames', 'bad', 'truncated')}
+        # A line rejected after the parse started may clobber the slot of the oldest record, the one
+        # the next record goes to, so only the newer records are compared
+        iq, meta = ingest.latest(min(ingest.count, 63))
+        return iq, meta.tobytes(), ingest.take_text(), saved, stats, ingest.count
+
+
+def random_chunks(rng, total):
+    chunks = []
+    while sum(chunks) < total:
+        chunks.append(int(rng.choice([1, 7, 64, 1000, 4096, 65536])))
+    return chunks
+
+
+def compare(a, b):
+    return (np.array_equal(a[0], b[0]), a[1] == b[1], a[2] == b[2], a[3] == b[3], a[4] == b[4], a[5] == b[5])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--rounds', type=int, default=20, help='Streams compared')
+    parser.add_argument('--lines', type=int, default=400, help='Items per stream')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    if not native.NATIVE:
+        print('the _csi_ingest extension is not built, see README.md')
+        return 1
+
+    fallback = load_fallback()
+    assert not fallback.NATIVE
+    rng = np.random.default_rng(args.seed)
+    layouts = (native.LAYOUT_C5C6, native.LAYOUT_LEGACY)
+    lines = disagree = records = failures = 0
+
+    for _ in range(args.rounds):
+        items = stream_items(rng, args.lines)
+        stream = b''.join(data for data, _ in items)
+
+        for data, is_line in items:
+            if not is_line:
+                continue
+            lines += 1
+            one = run(native, data, [], layouts)
+            other = run(fallback, data, [], layouts)
+            records += one[5]
+            if not all(compare(one, other)):
+                disagree += 1
+                if disagree <= 10:
+                    print(f'disagree ({one[5]} native, {other[5]} fallback records): {data!r}')
+
+        reference = run(native, stream, [], layouts)
+        for name, module in (('native', native), ('fallback', fallback)):
+            result = run(module, stream, random_chunks(rng, len(stream)), layouts)
+            same = compare(reference, result)
+            if not all(same):
+                failures += 1
+                print(f'{name} in chunks differs from native in one piece: iq, meta, text, save, stats, count = {same}')
+
+    print(f'{lines} lines, {records} accepted, {disagree} ({disagree / max(lines, 1):.1%}) parsed differently; '
+          f'{failures} of {2 * args.rounds} chunked streams differ')
+
+    if disagree or failures:
+        return 1
+
+    print('test_ingest_diff: all tests passed')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())